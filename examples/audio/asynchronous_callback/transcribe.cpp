@@ -50,85 +50,27 @@ inline int describe_pa_error(const PaError& err) {
 
 /// @brief A bi-directional stream reactor for audio signal transcription.
 ///
-class PortAudioReactor :
-    public AudioService<FileSystemCredentialStore>::TranscribeBidiReactor {
+/// @details
+/// Audio is captured on the main thread and pushed into the write queue of
+/// the reactor, which chains the writes to the server in the background. The
+/// capture loop never waits on the network.
+///
+class TranscriptionReactor :
+    public AudioService<FileSystemCredentialStore>::TranscribeQueuedBidiReactor {
  private:
-    /// The capture device that input audio is streaming in from.
-    PaStream* capture;
-    /// The number of channels in the input audio.
-    uint32_t num_channels;
-    /// The number of bytes per audio sample (i.e., 2 for 16-bit audio)
-    uint32_t sample_size;
-    /// The sample rate of the audio input stream.
-    uint32_t sample_rate;
-    /// The number of frames per block of audio.
-    uint32_t frames_per_block;
-    /// The maximum duration of the stream in seconds.
-    float duration;
     /// An aggregator for accumulating partial updates into a transcript.
     TranscriptAggregator aggregator;
     /// Whether to produce verbose output from the reactor
     bool verbose = false;
-    /// The buffer for the block of samples from the port audio input device.
-    std::unique_ptr<uint8_t> sample_block;
-    /// The number of blocks that have been written to the server.
-    std::atomic<uint32_t> blocks_written;
 
  public:
     /// @brief Initialize a reactor for streaming audio from a PortAudio stream.
     ///
-    /// @param capture_ The PortAudio capture device.
-    /// @param num_channels_ The number of channels in the input stream.
-    /// @param sample_size_ The number of bytes in an individual frame.
-    /// @param sample_rate_ The sampling rate of the audio stream.
-    /// @param frames_per_block_ The number of frames in a block of audio.
-    /// @param duration_ The maximum duration for the audio capture.
     /// @param verbose_ True to enable verbose outputs.
     ///
-    PortAudioReactor(PaStream* capture_,
-        uint32_t num_channels_ = 1,
-        uint32_t sample_size_ = 2,
-        uint32_t sample_rate_ = 16000,
-        uint32_t frames_per_block_ = 4096,
-        float duration_ = 60,
-        bool verbose_ = false
-    ) :
-        AudioService<FileSystemCredentialStore>::TranscribeBidiReactor(),
-        capture(capture_),
-        num_channels(num_channels_),
-        sample_size(sample_size_),
-        sample_rate(sample_rate_),
-        frames_per_block(frames_per_block_),
-        duration(duration_),
-        verbose(verbose_),
-        sample_block(static_cast<uint8_t*>(malloc(frames_per_block_ * num_channels_ * sample_size_))),
-        blocks_written(0) {
-        if (capture == nullptr)
-            throw std::runtime_error("capture must point to an allocated stream.");
-    }
-
-    /// @brief React to a _write done_ event.
-    ///
-    /// @param ok whether the write succeeded.
-    ///
-    void OnWriteDone(bool ok) override {
-        // If the status is not OK, then an error occurred during the stream.
-        if (!ok) return;
-        // If max duration samples have elapsed, send the writes done signal.
-        if (blocks_written++ > (duration * sample_rate) / frames_per_block) {
-            StartWritesDone();
-            return;
-        }
-        // Read a block of samples from the ADC.
-        auto err = Pa_ReadStream(capture, sample_block.get(), frames_per_block);
-        if (err) {
-            describe_pa_error(err);
-            return;
-        }
-        // Set the audio content for the request and start the write request
-        request.set_audiocontent(sample_block.get(), num_channels * frames_per_block * sample_size);
-        StartWrite(&request);
-    }
+    explicit TranscriptionReactor(bool verbose_ = false) :
+        AudioService<FileSystemCredentialStore>::TranscribeQueuedBidiReactor(),
+        verbose(verbose_) { }
 
     /// @brief React to a _read done_ event.
     ///
@@ -248,7 +190,9 @@ int main(int argc, const char** argv) {
         WAKE_WORD_SENSITIVITY = ThresholdSensitivity::HIGH;
     else if (args.get<std::string>("wake-word-sensitivity") == "HIGHEST")
         WAKE_WORD_SENSITIVITY = ThresholdSensitivity::HIGHEST;
-    const uint32_t CHUNK_SIZE = 4096;//args.get<int>("chunksize");
+    // The number of frames in each block from the capture device. Chunks
+    // for the server are sized adaptively from multiples of these blocks.
+    const uint32_t CHUNK_SIZE = 160;//args.get<int>("chunksize");
     const auto SAMPLE_RATE = 16000;//args.get<uint32_t>("samplerate");
     const auto VERBOSE = args.get<bool>("verbose");
 
@@ -320,8 +264,6 @@ int main(int argc, const char** argv) {
     const auto NUM_CHANNELS = 1;
     // The number of bytes per sample, for 16-bit audio, this is 2 bytes.
     const auto SAMPLE_SIZE = 2;
-    // The number of bytes in a given chunk of samples.
-    const auto BYTES_PER_BLOCK = CHUNK_SIZE * NUM_CHANNELS * SAMPLE_SIZE;
 
     // Initialize the PortAudio driver.
     PaError err = paNoError;
@@ -341,6 +283,12 @@ int main(int argc, const char** argv) {
         Pa_GetDeviceInfo(input_parameters.device)->defaultHighInputLatency;
     input_parameters.hostApiSpecificStreamInfo = NULL;
 
+    // Capture audio into a lock-free ring from the real-time callback of the
+    // device so that slow network writes never cause capture overruns. The
+    // ring holds one second of audio.
+    sensory::audio::AudioRingBuffer ring(SAMPLE_RATE, NUM_CHANNELS);
+    sensory::audio::AudioCaptureAdapter adapter(ring);
+
     // Open the PortAudio stream with the input device.
     PaStream* capture;
     err = Pa_OpenStream(&capture,
@@ -349,8 +297,8 @@ int main(int argc, const char** argv) {
         SAMPLE_RATE,
         CHUNK_SIZE,
         paClipOff,  // we won't output out-of-range samples so don't clip them
-        NULL,       // using the blocking interface (no callback)
-        NULL        // no data for the callback since there is none
+        &sensory::audio::AudioCaptureAdapter::callback<PaStreamCallbackTimeInfo>,
+        &adapter    // the adapter that fills the ring
     );
     if (err != paNoError) return describe_pa_error(err);
 
@@ -387,18 +335,36 @@ int main(int argc, const char** argv) {
         transcribe_config->set_allocated_wakewordconfig(wake_word_config);
     }
     // Initialize the stream with the cloud.
-    PortAudioReactor reactor(capture,
-        NUM_CHANNELS,
-        SAMPLE_SIZE,
-        SAMPLE_RATE,
-        CHUNK_SIZE,
-        DURATION,
-        VERBOSE
-    );
+    TranscriptionReactor reactor(VERBOSE);
+    // Size the chunks from the latency of the writes: small chunks while the
+    // link keeps up for a fast first word, larger chunks when writes back up.
+    sensory::audio::AdaptiveChunkOptions chunk_options;
+    chunk_options.sample_rate = SAMPLE_RATE;
+    sensory::audio::AdaptiveChunkSizer sizer(chunk_options);
+    reactor.setWriteDoneCallback([&sizer](const std::chrono::microseconds& latency, const std::size_t& backlog) {
+        sizer.record_write(latency, backlog);
+    });
     cloud.audio.transcribe(&reactor, audio_config, transcribe_config);
-
-    // Start the RPC and wait for the final response.
     reactor.StartCall();
+
+    // Drain the captured audio in chunks and queue it for the server. The
+    // reactor writes the blocks to the stream as earlier writes complete.
+    std::vector<int16_t> sample_block;
+    for (uint32_t frames = 0; frames < DURATION * SAMPLE_RATE;) {
+        const auto chunk_size = sizer.get_chunk_size();
+        sample_block.resize(chunk_size * NUM_CHANNELS);
+        if (!ring.read_chunk(sample_block.data(), chunk_size, std::chrono::milliseconds(1000))) {
+            fprintf(stderr, "Error: No audio was captured for 1 second.\n");
+            break;
+        }
+        frames += chunk_size;
+        sensory::api::v1::audio::TranscribeRequest request;
+        request.set_audiocontent(sample_block.data(), sample_block.size() * SAMPLE_SIZE);
+        // The queue rejects writes once the stream has terminated.
+        if (!reactor.enqueueWrite(std::move(request))) break;
+    }
+    // Close the write side of the stream and wait for the final response.
+    reactor.enqueueWritesDone();
     status = reactor.await();
 
     // Stop the audio stream.
@@ -408,6 +374,17 @@ int main(int argc, const char** argv) {
     // Terminate the port audio session.
     Pa_Terminate();
 
+    if (ring.get_num_overruns() > 0 || adapter.get_num_input_overflows() > 0)
+        std::cout << "Dropped " << ring.get_num_dropped_frames() << " frames in "
+            << ring.get_num_overruns() << " ring overruns and "
+            << adapter.get_num_input_overflows() << " input overflows" << std::endl;
+    if (VERBOSE) {
+        std::cout << "Chunk sizes (frames: writes):";
+        for (const auto& entry : sizer.get_size_histogram())
+            std::cout << " " << entry.first << ": " << entry.second;
+        std::cout << std::endl;
+    }
+
     if (!status.ok()) {  // The call failed, print a descriptive message.
         std::cout << "Transcription stream broke ("
             << status.error_code() << "): "
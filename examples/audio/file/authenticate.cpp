@@ -33,6 +33,7 @@
 #include "../dep/tqdm.hpp"
 
 using sensory::SensoryCloud;
+using sensory::audio::AudioPacer;
 using sensory::token_manager::TokenManager;
 using sensory::token_manager::FileSystemCredentialStore;
 using sensory::service::HealthService;
@@ -69,12 +70,15 @@ int main(int argc, const char** argv) {
         .action("store_true")
         .help("A flag determining whether the enrollment ID is for an enrollment group.");
     parser.add_argument({ "-T", "--token" })
-        .help("A path to the binary feature vector if the server is not to store enrollments.");
+        .help("A path to the binary feature vector if the server is not to store enrollments. Without a path, a feature vector cached by the enroll example is used.");
     parser.add_argument({ "-L", "--language" }).required(true)
         .help("The IETF BCP 47 language tag for the input audio (e.g., en-US).");
     parser.add_argument({ "-C", "--chunksize" })
         .help("The number of audio samples per message; 0 to stream all samples in one message (default).")
         .default_value(4096);
+    parser.add_argument({ "-X", "--speed" })
+        .help("The multiple of real time to stream the audio at, e.g., 1 to reproduce a live microphone; 0 to stream as fast as possible (default 0).")
+        .default_value(0.f);
     parser.add_argument({ "-p", "--padding" })
         .help("The number of milliseconds of padding to append to the audio buffer.")
         .default_value(300);
@@ -105,10 +109,13 @@ int main(int argc, const char** argv) {
     const auto TOKEN_FILE = args.get<std::string>("token");
     const auto LANGUAGE = args.get<std::string>("language");
     auto CHUNK_SIZE = args.get<int>("chunksize");
+    const auto SPEED = args.get<float>("speed");
     const auto VERBOSE = args.get<bool>("verbose");
 
     // Create a credential store for keeping OAuth credentials in.
     FileSystemCredentialStore keychain(".", "com.sensory.cloud.examples");
+    // Open the cache of enrollment tokens that the `enroll` example writes.
+    sensory::token_manager::EnrollmentTokenCache<FileSystemCredentialStore> token_cache(keychain);
 
     // Create the cloud services handle.
     SensoryCloud<FileSystemCredentialStore> cloud(PATH, keychain);
@@ -226,6 +233,8 @@ int main(int argc, const char** argv) {
         file.close();
         // Copy the buffer into the authenticate config
         authenticate_config->set_enrollmenttoken(buffer, length);
+    } else if (token_cache.attach(*authenticate_config)) {
+        std::cout << "using cached feature vector for enrollment " << ENROLLMENT_ID << std::endl;
     }
 
     grpc::ClientContext context;
@@ -264,10 +273,13 @@ int main(int argc, const char** argv) {
     });
 
     int num_frames;
+    // Release the chunks on the schedule of a live capture at the given speed.
+    AudioPacer pacer(sfinfo.samplerate, SPEED);
     for (int i = 0; i < num_chunks; i++) {
         auto num_frames = sf_read_short(infile, &samples[0], CHUNK_SIZE);
         sensory::api::v1::audio::AuthenticateRequest request;
         request.set_audiocontent((uint8_t*) samples, sizeof(int16_t) * num_frames);
+        pacer.pace(num_frames);
         if (!stream->Write(request)) break;
         if (!VERBOSE) progress();
     }
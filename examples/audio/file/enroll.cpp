@@ -32,6 +32,9 @@
 #include "../dep/tqdm.hpp"
 
 using sensory::SensoryCloud;
+using sensory::audio::AudioPacer;
+using sensory::audio::CreateEnrollmentSession;
+using sensory::audio::EnrollmentProgress;
 using sensory::token_manager::TokenManager;
 using sensory::token_manager::FileSystemCredentialStore;
 using sensory::service::HealthService;
@@ -49,6 +52,9 @@ int main(int argc, const char** argv) {
         .help("The input audio file to stream to Sensory Cloud.");
     parser.add_argument({ "-o", "--output" })
         .help("An optional path to a bin file to save the enrollment to.");
+    parser.add_argument({ "-c", "--cache" })
+        .action("store_true")
+        .help("Keep the enrollment on the device in an encrypted enrollment token cache.");
     parser.add_argument({ "-g", "--getmodels" })
         .action("store_true")
         .help("Whether to query for a list of available models.");
@@ -74,6 +80,9 @@ int main(int argc, const char** argv) {
     parser.add_argument({ "-C", "--chunksize" })
         .help("The number of audio samples per message; 0 to stream all samples in one message (default).")
         .default_value(4096);
+    parser.add_argument({ "-X", "--speed" })
+        .help("The multiple of real time to stream the audio at, e.g., 1 to reproduce a live microphone; 0 to stream as fast as possible (default 0).")
+        .default_value(0.f);
     parser.add_argument({ "-v", "--verbose" }).action("store_true")
         .help("Produce verbose output during transcription.");
     // Parse the arguments from the command line.
@@ -91,10 +100,15 @@ int main(int argc, const char** argv) {
     const auto REFERENCE_ID = args.get<std::string>("reference-id");
     const auto LANGUAGE = args.get<std::string>("language");
     auto CHUNK_SIZE = args.get<int>("chunksize");
+    const auto SPEED = args.get<float>("speed");
     const auto VERBOSE = args.get<bool>("verbose");
+    const auto CACHE = args.get<bool>("cache");
 
     // Create a credential store for keeping OAuth credentials in.
     sensory::token_manager::FileSystemCredentialStore keychain(".", "com.sensory.cloud.examples");
+    // Create a cache for the enrollment tokens of enrollments that are not
+    // stored on the server. The `authenticate` example reads from it.
+    sensory::token_manager::EnrollmentTokenCache<FileSystemCredentialStore> token_cache(keychain);
 
     // Create the cloud services handle.
     SensoryCloud<FileSystemCredentialStore> cloud(PATH, keychain);
@@ -189,7 +203,7 @@ int main(int argc, const char** argv) {
     create_enrollment_config->set_userid(USER_ID);
     create_enrollment_config->set_description(DESCRIPTION);
     create_enrollment_config->set_islivenessenabled(LIVENESS);
-    create_enrollment_config->set_disableserverenrollmenttemplatestorage(!OUTPUT_FILE.empty());
+    create_enrollment_config->set_disableserverenrollmenttemplatestorage(!OUTPUT_FILE.empty() || CACHE);
     if (DURATION > 0)
         create_enrollment_config->set_enrollmentduration(DURATION);
     if (NUM_UTTERANCES > 0)
@@ -197,7 +211,6 @@ int main(int argc, const char** argv) {
     create_enrollment_config->set_referenceid(REFERENCE_ID);
 
     grpc::ClientContext context;
-    auto stream = cloud.audio.create_enrollment(&context, audio_config, create_enrollment_config);
 
     // If the chunk size is zero, disable chunking by setting the chunk size
     // to be equal to the number of samples.
@@ -206,14 +219,12 @@ int main(int argc, const char** argv) {
     auto num_chunks = sfinfo.frames / CHUNK_SIZE + (bool)(sfinfo.frames % CHUNK_SIZE);
     tqdm progress(num_chunks);
     int16_t samples[CHUNK_SIZE];
-    std::string enrollment_id = "";
 
-    // Create a background thread for handling the transcription responses.
-    std::thread receipt_thread([&](){
-        while (true) {
-            // Read a message and break out of the loop when the read fails.
-            sensory::api::v1::audio::CreateEnrollmentResponse response;
-            if (!stream->Read(&response)) break;
+    // The session handles the responses on a background thread and stops
+    // the upload as soon as the server reports that the enrollment is done.
+    CreateEnrollmentSession session(
+        cloud.audio.create_enrollment(&context, audio_config, create_enrollment_config),
+        [&](const EnrollmentProgress&, const sensory::api::v1::audio::CreateEnrollmentResponse& response) {
             if (VERBOSE) {  // Verbose output, dump the message to the terminal
                 google::protobuf::util::JsonPrintOptions options;
                 options.add_whitespace = false;
@@ -226,30 +237,33 @@ int main(int argc, const char** argv) {
             } else {  // Friendly output, use a progress bar and display the prompt
                 progress.set_postfix("enrollment progress: " + std::to_string(response.percentcomplete()) + "%");
             }
-            if (response.percentcomplete() >= 100) {  // Check for enrollment success
-                enrollment_id = response.enrollmentid();
-                if (!OUTPUT_FILE.empty()) {  // Enrollment stored on the local file-system
-                    std::ofstream file(OUTPUT_FILE, std::ios::out | std::ios::binary);
-                    file << response.enrollmenttoken().token();
-                    file.close();  // We're done writing to the WAV file.
-                    std::cout << "wrote feature vector to " << OUTPUT_FILE << std::endl;
-                    std::cout << "feature vector expires in " << response.enrollmenttoken().expiration() << " seconds" << std::endl;
-                }
-            }
-        }
-    });
+        });
 
-    int num_frames;
+    // Release the chunks on the schedule of a live capture at the given speed.
+    AudioPacer pacer(sfinfo.samplerate, SPEED);
     for (int i = 0; i < num_chunks; i++) {
         auto num_frames = sf_read_short(infile, &samples[0], CHUNK_SIZE);
-        sensory::api::v1::audio::CreateEnrollmentRequest request;
-        request.set_audiocontent((uint8_t*) samples, sizeof(int16_t) * num_frames);
-        if (!stream->Write(request)) break;
+        pacer.pace(num_frames);
+        if (!session.write(samples, num_frames)) break;
         if (!VERBOSE) progress();
     }
-    stream->WritesDone();
     sf_close(infile);
-    receipt_thread.join();
+    status = session.finish();
+
+    std::string enrollment_id = "";
+    if (session.is_complete()) {  // Check for enrollment success
+        const auto response = session.get_response();
+        enrollment_id = response.enrollmentid();
+        if (!OUTPUT_FILE.empty()) {  // Enrollment stored on the local file-system
+            std::ofstream file(OUTPUT_FILE, std::ios::out | std::ios::binary);
+            file << response.enrollmenttoken().token();
+            file.close();  // We're done writing to the WAV file.
+            std::cout << "wrote feature vector to " << OUTPUT_FILE << std::endl;
+            std::cout << "feature vector expires in " << response.enrollmenttoken().expiration() << " seconds" << std::endl;
+        }
+        if (CACHE && token_cache.put(response))
+            std::cout << "cached feature vector for enrollment " << enrollment_id << std::endl;
+    }
     // Finish the progress bar according to the authentication status
     progress.set_postfix(enrollment_id.empty() ? "enrollment failure" : "enrollment success");
     if (!VERBOSE) progress.complete();
@@ -257,8 +271,7 @@ int main(int argc, const char** argv) {
     if (!enrollment_id.empty())
         std::cout << "enrollment ID: " + enrollment_id << std::endl;
 
-    // Close the stream and check the status code in case the stream broke.
-    status = stream->Finish();
+    // Check the status code in case the stream broke.
     if (!status.ok()) {  // The call failed, print a descriptive message.
         std::cout << "stream broke with ("
             << status.error_code() << "): "
@@ -32,6 +32,9 @@
 #include "../dep/tqdm.hpp"
 
 using sensory::SensoryCloud;
+using sensory::audio::AudioPacer;
+using sensory::audio::CreateEnrolledEventSession;
+using sensory::audio::EnrollmentProgress;
 using sensory::token_manager::TokenManager;
 using sensory::token_manager::FileSystemCredentialStore;
 using sensory::service::HealthService;
@@ -67,6 +70,9 @@ int main(int argc, const char** argv) {
     parser.add_argument({ "-C", "--chunksize" })
         .help("The number of audio samples per message; 0 to stream all samples in one message (default).")
         .default_value(4096);
+    parser.add_argument({ "-X", "--speed" })
+        .help("The multiple of real time to stream the audio at, e.g., 1 to reproduce a live microphone; 0 to stream as fast as possible (default 0).")
+        .default_value(0.f);
     parser.add_argument({ "-v", "--verbose" }).action("store_true")
         .help("Produce verbose output during transcription.");
     // Parse the arguments from the command line.
@@ -81,6 +87,7 @@ int main(int argc, const char** argv) {
     const auto DURATION = args.get<float>("duration");
     const auto REFERENCE_ID = args.get<std::string>("reference-id");
     auto CHUNK_SIZE = args.get<int>("chunksize");
+    const auto SPEED = args.get<float>("speed");
     const auto VERBOSE = args.get<bool>("verbose");
 
     // Create a credential store for keeping OAuth credentials in.
@@ -156,14 +163,12 @@ int main(int argc, const char** argv) {
     create_enrollment_event_config->set_referenceid(REFERENCE_ID);
 
     grpc::ClientContext context;
-    auto stream = cloud.audio.create_event_enrollment(&context, audio_config, create_enrollment_event_config);
-
-    // Create a background thread for handling the transcription responses.
-    std::thread receipt_thread([&stream, &VERBOSE](){
-        while (true) {
-            // Read a message and break out of the loop when the read fails.
-            sensory::api::v1::audio::CreateEnrollmentResponse response;
-            if (!stream->Read(&response)) break;
+
+    // The session handles the responses on a background thread and stops
+    // the upload as soon as the server reports that the enrollment is done.
+    CreateEnrolledEventSession session(
+        cloud.audio.create_event_enrollment(&context, audio_config, create_enrollment_event_config),
+        [&VERBOSE](const EnrollmentProgress&, const sensory::api::v1::audio::CreateEnrollmentResponse& response) {
             if (VERBOSE) {  // Verbose output, dump the message to the terminal
                 google::protobuf::util::JsonPrintOptions options;
                 options.add_whitespace = false;
@@ -194,14 +199,7 @@ int main(int argc, const char** argv) {
                     << progress[int(response.percentcomplete() / 10.f)]
                     << prompt << std::flush;
             }
-            // Check for enrollment success
-            if (response.percentcomplete() >= 100) {
-                std::cout << std::endl;
-                std::cout << "Successfully enrolled with ID: "
-                    << response.enrollmentid() << std::endl;
-            }
-        }
-    });
+        });
 
     // If the chunk size is zero, disable chunking by setting the chunk size
     // to be equal to the number of samples.
@@ -210,20 +208,25 @@ int main(int argc, const char** argv) {
     auto num_chunks = sfinfo.frames / CHUNK_SIZE + (bool)(sfinfo.frames % CHUNK_SIZE);
     tqdm progress(num_chunks);
     int16_t samples[CHUNK_SIZE];
-    int num_frames;
+    // Release the chunks on the schedule of a live capture at the given speed.
+    AudioPacer pacer(sfinfo.samplerate, SPEED);
     for (int i = 0; i < num_chunks; i++) {
         auto num_frames = sf_read_short(infile, &samples[0], CHUNK_SIZE);
-        sensory::api::v1::audio::CreateEnrolledEventRequest request;
-        request.set_audiocontent((uint8_t*) samples, sizeof(int16_t) * num_frames);
-        if (!stream->Write(request)) break;
+        pacer.pace(num_frames);
+        if (!session.write(samples, num_frames)) break;
         progress();
     }
-    stream->WritesDone();
     sf_close(infile);
-    receipt_thread.join();
+    status = session.finish();
+
+    // Check for enrollment success
+    if (session.is_complete()) {
+        std::cout << std::endl;
+        std::cout << "Successfully enrolled with ID: "
+            << session.get_response().enrollmentid() << std::endl;
+    }
 
-    // Close the stream and check the status code in case the stream broke.
-    status = stream->Finish();
+    // Check the status code in case the stream broke.
     if (!status.ok()) {  // The call failed, print a descriptive message.
         std::cout << "stream broke ("
             << status.error_code() << "): "
@@ -122,19 +122,21 @@ int main(int argc, const char** argv) {
     grpc::ClientContext context;
     auto stream = cloud.audio.synthesize_speech(&context, MODEL, SAMPLE_RATE, PHRASE);
 
-    // Open a binary file-stream to write the audio contents to.
-    std::ofstream file(OUTPUT, std::ios::out | std::ios::binary);
-    while (true) {
-        sensory::api::v1::audio::SynthesizeSpeechResponse response;
-        // Break out on read failure. `Read` will fail if an error occurs or
-        // when we are done reading bytes from the server.
-        if (!stream->Read(&response)) break;
-        file << response.audiocontent();
+    // Write the audio to the WAV file as it arrives, the sizes in the header
+    // are patched when the stream ends.
+    sensory::audio::WavFileSink sink(OUTPUT, SAMPLE_RATE);
+    try {
+        status = sensory::audio::stream_speech(*stream, sink);
+    } catch (const std::exception& error) {
+        context.TryCancel();
+        stream->Finish();
+        std::cout << "Failed to write " << OUTPUT << ": " << error.what() << std::endl;
+        return 1;
     }
-    file.close();  // We're done writing to the WAV file.
-
-    // Close the stream and check the status code in case the stream broke.
-    status = stream->Finish();
+    if (VERBOSE)
+        std::cout << "Wrote " << sink.get_num_frames() << " frames at "
+            << sink.get_sample_rate() << "Hz, first audio after "
+            << sink.get_time_to_first_audio().count() / 1000 << "ms" << std::endl;
     if (!status.ok()) {  // The call failed, print a descriptive message.
         std::cout << "stream broke ("
             << status.error_code() << "): "
@@ -26,6 +26,7 @@
 #include <iostream>
 #include <regex>
 #include <mutex>
+#include <vector>
 #include <sensorycloud/sensorycloud.hpp>
 #include <sensorycloud/token_manager/file_system_credential_store.hpp>
 #include <sndfile.h>
@@ -33,6 +34,14 @@
 #include "../dep/tqdm.hpp"
 
 using sensory::SensoryCloud;
+using sensory::audio::AudioPacer;
+using sensory::audio::AudioEncoder;
+using sensory::audio::MultiChannelTranscribeOptions;
+using sensory::audio::MultiChannelTranscriber;
+using sensory::audio::PCMAudio;
+using sensory::audio::Resampler;
+using sensory::audio::downmix;
+using sensory::service::AudioService;
 using sensory::token_manager::FileSystemCredentialStore;
 using sensory::util::TranscriptAggregator;
 using sensory::api::v1::audio::WordState;
@@ -83,8 +92,20 @@ int main(int argc, const char** argv) {
     parser.add_argument({ "-C", "--chunksize" })
         .help("The number of audio samples per message; 0 to stream all samples in one message (default 4096).")
         .default_value(4096);
+    parser.add_argument({ "-X", "--speed" })
+        .help("The multiple of real time to stream the audio at, e.g., 1 to reproduce a live microphone; 0 to stream as fast as possible (default 0).")
+        .default_value(0.f);
     parser.add_argument({ "-off", "--offline"}).action("store_true")
         .help("Process data offline instead of in a real-time stream.");
+    parser.add_argument({ "-e", "--encoding"})
+        .help("The encoding of the uploaded audio: LINEAR16, FLAC (lossless compression), or MULAW (8-bit telephony).")
+        .choices({"LINEAR16", "FLAC", "MULAW"})
+        .default_value("LINEAR16");
+    parser.add_argument({ "-sc", "--split-channels"}).action("store_true")
+        .help("Transcribe each channel of a multi-channel file in its own stream and merge the transcripts by speaker.");
+    parser.add_argument({ "-sp", "--speakers"})
+        .help("The name of the speaker on each channel when splitting channels, e.g.,\n\t\t\t-sp agent customer")
+        .nargs("+");
     parser.add_argument({ "-v", "--verbose" }).action("store_true")
         .help("Produce verbose output during transcription.");
     // Parse the arguments from the command line.
@@ -129,8 +150,16 @@ int main(int argc, const char** argv) {
     else if (args.get<std::string>("wake-word-sensitivity") == "HIGHEST")
         WAKE_WORD_SENSITIVITY = ThresholdSensitivity::HIGHEST;
     auto CHUNK_SIZE = args.get<int>("chunksize");
+    const auto SPEED = args.get<float>("speed");
     const auto VERBOSE = args.get<bool>("verbose");
     const auto OFFLINE = args.get<bool>("offline");
+    const auto SPLIT_CHANNELS = args.get<bool>("split-channels");
+    const auto SPEAKERS = args.get<std::vector<std::string>>("--speakers");
+    auto ENCODING = sensory::api::v1::audio::AudioConfig_AudioEncoding_LINEAR16;
+    if (args.get<std::string>("encoding") == "FLAC")
+        ENCODING = sensory::api::v1::audio::AudioConfig_AudioEncoding_FLAC;
+    else if (args.get<std::string>("encoding") == "MULAW")
+        ENCODING = sensory::api::v1::audio::AudioConfig_AudioEncoding_MULAW;
 
     // Create a credential store for keeping OAuth credentials in.
     FileSystemCredentialStore keychain(".", "com.sensory.cloud.examples");
@@ -197,27 +226,16 @@ int main(int argc, const char** argv) {
         return 1;
     }
 
-    // Check that the audio is 16kHz.
-    if (sfinfo.samplerate != 16000) {
-        std::cout << "Attempting to load file with sample rate of "
-            << sfinfo.samplerate << "Hz, but only 16000Hz audio is supported."
-            << std::endl;
-        return 1;
-    }
-    // Check that the audio is monophonic.
-    if (sfinfo.channels > 1) {
-        std::cout << "Attempting to load file with "
-            << sfinfo.channels << " channels, but only mono audio is supported."
-            << std::endl;
-        return 1;
-    }
+    // Mix the audio down to mono and convert it to 16kHz for streaming.
+    Resampler resampler(sfinfo.samplerate, 16000);
 
     // Create an audio config that describes the format of the audio stream.
     auto audio_config = new sensory::api::v1::audio::AudioConfig;
-    audio_config->set_encoding(sensory::api::v1::audio::AudioConfig_AudioEncoding_LINEAR16);
-    audio_config->set_sampleratehertz(sfinfo.samplerate);
-    audio_config->set_audiochannelcount(sfinfo.channels);
+    audio_config->set_sampleratehertz(resampler.get_output_rate());
+    audio_config->set_audiochannelcount(1);
     audio_config->set_languagecode("en");
+    // Create an encoder for the audio content, which sets the encoding.
+    AudioEncoder encoder(audio_config, ENCODING);
     // Create the config with the transcription parameters.
     auto transcribe_config = new sensory::api::v1::audio::TranscribeConfig;
     transcribe_config->set_modelname(MODEL);
@@ -242,6 +260,41 @@ int main(int argc, const char** argv) {
     }
     transcribe_config->set_doofflinemode(OFFLINE);
 
+    // Transcribe each channel of a multi-channel file in a stream of its own.
+    if (SPLIT_CHANNELS && sfinfo.channels > 1) {
+        std::unique_ptr<sensory::api::v1::audio::AudioConfig> owned_audio_config(audio_config);
+        std::unique_ptr<sensory::api::v1::audio::TranscribeConfig> owned_transcribe_config(transcribe_config);
+        PCMAudio pcm;
+        pcm.sample_rate = sfinfo.samplerate;
+        pcm.num_channels = sfinfo.channels;
+        pcm.samples.resize(sfinfo.frames * sfinfo.channels);
+        pcm.samples.resize(sf_readf_short(infile, pcm.samples.data(), sfinfo.frames) * sfinfo.channels);
+        sf_close(infile);
+        MultiChannelTranscribeOptions options;
+        if (CHUNK_SIZE > 0) options.chunk_size = CHUNK_SIZE;
+        options.encoding = ENCODING;
+        options.transcribe_config = *transcribe_config;
+        options.speakers = SPEAKERS;
+        MultiChannelTranscriber<AudioService<FileSystemCredentialStore>> transcriber(cloud.audio, options);
+        std::cout << "Transcribing " << sfinfo.channels << " channels..." << std::endl;
+        const auto transcript = transcriber.transcribe(pcm);
+        for (std::size_t channel = 0; channel < transcript.statuses.size(); channel++) {
+            const auto& channel_status = transcript.statuses[channel];
+            if (channel_status.ok()) continue;
+            std::cout << "stream of channel " << channel << " broke ("
+                << channel_status.error_code() << "): "
+                << channel_status.error_message() << std::endl;
+        }
+        if (OUTPUT_FILE.empty()) {  // No output file, write to standard output.
+            std::cout << transcript.to_string() << std::endl;
+        } else {  // Write the results to the given filename.
+            std::ofstream output_file(OUTPUT_FILE, std::ofstream::out);
+            output_file << transcript.to_string() << std::endl;
+            output_file.close();
+        }
+        return transcript.ok() ? 0 : 1;
+    }
+
     grpc::ClientContext context;
     auto stream = cloud.audio.transcribe(&context, audio_config, transcribe_config);
 
@@ -280,19 +333,28 @@ int main(int argc, const char** argv) {
     // Pre-calculate the number of chunks to process for determining done-ness.
     auto num_chunks = sfinfo.frames / CHUNK_SIZE + (bool)(sfinfo.frames % CHUNK_SIZE);
     tqdm progress(num_chunks);
-    int16_t samples[CHUNK_SIZE];
+    std::vector<int16_t> samples(CHUNK_SIZE * sfinfo.channels);
+    std::vector<int16_t> resampled;
+    // Release the chunks on the schedule of a live capture at the given speed.
+    AudioPacer pacer(sfinfo.samplerate, SPEED);
     for (int i = 0; i < num_chunks; i++) {
-        auto num_frames = sf_read_short(infile, &samples[0], CHUNK_SIZE);
+        auto num_frames = sf_readf_short(infile, samples.data(), CHUNK_SIZE);
+        downmix(samples.data(), num_frames, sfinfo.channels, samples.data());
+        resampled.clear();
+        resampler.process(samples.data(), num_frames, resampled);
+        if (i == num_chunks - 1) resampler.flush(resampled);
         sensory::api::v1::audio::TranscribeRequest request;
-        request.set_audiocontent((uint8_t*) samples, sizeof(int16_t) * num_frames);
+        encoder.encode(resampled.data(), resampled.size(), *request.mutable_audiocontent());
         // Detect the last chunk and write the post-processing action
         if (i == num_chunks - 1) {
+            encoder.flush(*request.mutable_audiocontent());
             auto action = new ::sensory::api::v1::audio::AudioRequestPostProcessingAction;
             action->set_action(::sensory::api::v1::audio::FINAL);
             request.set_allocated_postprocessingaction(action);
             std::cout << "Audio uploaded, awaiting FINAL response..." << std::endl;
         }
         // Send the data to the server for transcription.
+        pacer.pace(num_frames);
         if (!stream->Write(request)) break;
         progress();
     }
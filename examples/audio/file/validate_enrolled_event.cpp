@@ -32,6 +32,7 @@
 #include "../dep/tqdm.hpp"
 
 using sensory::SensoryCloud;
+using sensory::audio::AudioPacer;
 using sensory::token_manager::FileSystemCredentialStore;
 using sensory::service::AudioService;
 using sensory::api::v1::audio::ThresholdSensitivity;
@@ -61,6 +62,9 @@ int main(int argc, const char** argv) {
     parser.add_argument({ "-C", "--chunksize" })
         .help("The number of audio samples per message; 0 to stream all samples in one message (default).")
         .default_value(4096);
+    parser.add_argument({ "-X", "--speed" })
+        .help("The multiple of real time to stream the audio at, e.g., 1 to reproduce a live microphone; 0 to stream as fast as possible (default 0).")
+        .default_value(0.f);
     parser.add_argument({ "-v", "--verbose" }).action("store_true")
         .help("Produce verbose output during transcription.");
     // Parse the arguments from the command line.
@@ -81,6 +85,7 @@ int main(int argc, const char** argv) {
         SENSITIVITY = ThresholdSensitivity::HIGHEST;
     const auto GROUP = args.get<bool>("group");
     auto CHUNK_SIZE = args.get<int>("chunksize");
+    const auto SPEED = args.get<float>("speed");
     const auto VERBOSE = args.get<bool>("verbose");
 
     // Create a credential store for keeping OAuth credentials in.
@@ -209,10 +214,13 @@ int main(int argc, const char** argv) {
     tqdm progress(num_chunks);
     int16_t samples[CHUNK_SIZE];
     int num_frames;
+    // Release the chunks on the schedule of a live capture at the given speed.
+    AudioPacer pacer(sfinfo.samplerate, SPEED);
     for (int i = 0; i < num_chunks; i++) {
         auto num_frames = sf_read_short(infile, &samples[0], CHUNK_SIZE);
         sensory::api::v1::audio::ValidateEnrolledEventRequest request;
         request.set_audiocontent((uint8_t*) samples, sizeof(int16_t) * num_frames);
+        pacer.pace(num_frames);
         if (!stream->Write(request)) break;
         progress();
     }
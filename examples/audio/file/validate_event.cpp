@@ -25,6 +25,7 @@
 
 #include <iostream>
 #include <regex>
+#include <vector>
 #include <sensorycloud/sensorycloud.hpp>
 #include <sensorycloud/token_manager/file_system_credential_store.hpp>
 #include <sndfile.h>
@@ -32,9 +33,12 @@
 #include "../dep/tqdm.hpp"
 
 using sensory::SensoryCloud;
+using sensory::audio::AudioPacer;
 using sensory::token_manager::TokenManager;
 using sensory::token_manager::FileSystemCredentialStore;
 using sensory::service::AudioService;
+using sensory::audio::Resampler;
+using sensory::audio::downmix;
 using sensory::api::v1::audio::ThresholdSensitivity;
 
 int main(int argc, const char** argv) {
@@ -63,6 +67,9 @@ int main(int argc, const char** argv) {
     parser.add_argument({ "-C", "--chunksize" })
         .help("The number of audio samples per message; 0 to stream all samples in one message (default).")
         .default_value(4096);
+    parser.add_argument({ "-X", "--speed" })
+        .help("The multiple of real time to stream the audio at, e.g., 1 to reproduce a live microphone; 0 to stream as fast as possible (default 0).")
+        .default_value(0.f);
     parser.add_argument({ "-v", "--verbose" }).action("store_true")
         .help("Produce verbose output during transcription.");
     // Parse the arguments from the command line.
@@ -83,6 +90,7 @@ int main(int argc, const char** argv) {
         THRESHOLD = ThresholdSensitivity::HIGHEST;
     const auto TOPN = args.get<uint32_t>("topN");
     auto CHUNK_SIZE = args.get<int>("chunksize");
+    const auto SPEED = args.get<float>("speed");
     const auto VERBOSE = args.get<bool>("verbose");
 
     // Create a credential store for keeping OAuth credentials in.
@@ -125,26 +133,14 @@ int main(int argc, const char** argv) {
         return 1;
     }
 
-    // Check that the audio is 16kHz.
-    if (sfinfo.samplerate != 16000) {
-        std::cout << "Attempting to load file with sample rate of "
-            << sfinfo.samplerate << "Hz, but only 16000Hz audio is supported."
-            << std::endl;
-        return 1;
-    }
-    // Check that the audio is monophonic.
-    if (sfinfo.channels > 1) {
-        std::cout << "Attempting to load file with "
-            << sfinfo.channels << " channels, but only mono audio is supported."
-            << std::endl;
-        return 1;
-    }
+    // Mix the audio down to mono and convert it to 16kHz for streaming.
+    Resampler resampler(sfinfo.samplerate, 16000);
 
     // Create an audio config that describes the format of the audio stream.
     auto audio_config = new sensory::api::v1::audio::AudioConfig;
     audio_config->set_encoding(sensory::api::v1::audio::AudioConfig_AudioEncoding_LINEAR16);
-    audio_config->set_sampleratehertz(sfinfo.samplerate);
-    audio_config->set_audiochannelcount(sfinfo.channels);
+    audio_config->set_sampleratehertz(resampler.get_output_rate());
+    audio_config->set_audiochannelcount(1);
     audio_config->set_languagecode("en");
     // Create the config with the event validation parameters.
     auto validate_event_config = new sensory::api::v1::audio::ValidateEventConfig;
@@ -196,12 +192,19 @@ int main(int argc, const char** argv) {
 
     auto num_chunks = sfinfo.frames / CHUNK_SIZE + (bool)(sfinfo.frames % CHUNK_SIZE);
     tqdm progress(num_chunks);
-    int16_t samples[CHUNK_SIZE];
-    int num_frames;
+    std::vector<int16_t> samples(CHUNK_SIZE * sfinfo.channels);
+    std::vector<int16_t> resampled;
+    // Release the chunks on the schedule of a live capture at the given speed.
+    AudioPacer pacer(sfinfo.samplerate, SPEED);
     for (int i = 0; i < num_chunks; i++) {
-        auto num_frames = sf_read_short(infile, &samples[0], CHUNK_SIZE);
+        auto num_frames = sf_readf_short(infile, samples.data(), CHUNK_SIZE);
+        downmix(samples.data(), num_frames, sfinfo.channels, samples.data());
+        resampled.clear();
+        resampler.process(samples.data(), num_frames, resampled);
+        if (i == num_chunks - 1) resampler.flush(resampled);
         sensory::api::v1::audio::ValidateEventRequest request;
-        request.set_audiocontent((uint8_t*) samples, sizeof(int16_t) * num_frames);
+        request.set_audiocontent((uint8_t*) resampled.data(), sizeof(int16_t) * resampled.size());
+        pacer.pace(num_frames);
         if (!stream->Write(request)) break;
         progress();
     }
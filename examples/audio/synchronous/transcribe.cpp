@@ -24,8 +24,10 @@
 //
 
 #include <portaudio.h>
+#include <cstdint>
 #include <iostream>
 #include <thread>
+#include <vector>
 #include <sensorycloud/sensorycloud.hpp>
 #include <sensorycloud/token_manager/file_system_credential_store.hpp>
 #include "../dep/argparse.hpp"
@@ -33,6 +35,8 @@
 using sensory::SensoryCloud;
 using sensory::token_manager::FileSystemCredentialStore;
 using sensory::util::TranscriptAggregator;
+using sensory::audio::LevelMeter;
+using sensory::audio::PcmConverter;
 using sensory::api::v1::audio::WordState;
 using sensory::api::v1::audio::ThresholdSensitivity;
 
@@ -200,7 +204,8 @@ int main(int argc, const char** argv) {
     // The number of input channels from the microphone. This should always be
     // mono.
     const auto NUM_CHANNELS = 1;
-    // The number of bytes per sample, for 16-bit audio, this is 2 bytes.
+    // The number of bytes per sample on the wire, for 16-bit audio, this is
+    // 2 bytes.
     const auto SAMPLE_SIZE = 2;
     // The number of bytes in a given chunk of samples.
     const auto BYTES_PER_BLOCK = CHUNK_SIZE * NUM_CHANNELS * SAMPLE_SIZE;
@@ -250,7 +255,9 @@ int main(int argc, const char** argv) {
         return 1;
     }
     input_parameters.channelCount = 1;
-    input_parameters.sampleFormat = paInt16;  // Sensory expects 16-bit audio
+    // Capture float audio and convert it to the 16-bit audio that Sensory
+    // expects with dither, instead of letting the driver truncate it.
+    input_parameters.sampleFormat = paFloat32;
     input_parameters.suggestedLatency =
         Pa_GetDeviceInfo(input_parameters.device)->defaultHighInputLatency;
     input_parameters.hostApiSpecificStreamInfo = NULL;
@@ -272,10 +279,14 @@ int main(int argc, const char** argv) {
     err = Pa_StartStream(audioStream);
     if (err != paNoError) return describe_pa_error(err);
 
+    // A meter for the level of the microphone, measured as each block is
+    // captured instead of waiting for the server to respond.
+    LevelMeter meter;
+
     // Create a thread to poll read requests in the background. Audio
     // transcription has a bursty response pattern, so a locked read-write loop
     // will not work with this service.
-    std::thread receipt_thread([&stream, &VERBOSE](){
+    std::thread receipt_thread([&stream, &VERBOSE, &meter](){
         /// An aggregator for accumulating partial updates into a transcript.
         TranscriptAggregator aggregator;
         while (true) {
@@ -300,22 +311,30 @@ int main(int argc, const char** argv) {
                 #else
                     std::system("clear");
                 #endif
+                std::cout << "Level: " << static_cast<int>(sensory::audio::to_dbfs(meter.get_level().rms))
+                    << " dBFS (peak " << static_cast<int>(sensory::audio::to_dbfs(meter.get_peak_hold()))
+                    << " dBFS)" << std::endl;
                 std::cout << aggregator.get_transcript() << std::endl;
             }
         }
     });
 
-    // Create a buffer for the audio samples based on the number of bytes in
-    // a block of samples.
-    uint8_t sample_block[BYTES_PER_BLOCK];
+    // Create buffers for a block of captured float samples and for the
+    // block after conversion to 16-bit samples.
+    std::vector<float> capture_block(CHUNK_SIZE * NUM_CHANNELS);
+    std::vector<int16_t> sample_block;
+    PcmConverter converter;
     for (int i = 0; i < (DURATION * SAMPLE_RATE) / CHUNK_SIZE; ++i) {
         // Read a block of samples from the ADC.
-        err = Pa_ReadStream(audioStream, sample_block, CHUNK_SIZE);
+        err = Pa_ReadStream(audioStream, capture_block.data(), CHUNK_SIZE);
         if (err) return describe_pa_error(err);
+        // Convert the block to 16-bit audio and measure its level.
+        converter.convert(capture_block.data(), capture_block.size(), sample_block);
+        meter.process(sample_block.data(), sample_block.size());
 
         // Create a new validate event request with the audio content.
         sensory::api::v1::audio::TranscribeRequest request;
-        request.set_audiocontent(sample_block, BYTES_PER_BLOCK);
+        request.set_audiocontent(sample_block.data(), BYTES_PER_BLOCK);
         // Send the data to the server to validate the trigger.
         if (!stream->Write(request)) break;
     }
@@ -334,6 +353,10 @@ int main(int argc, const char** argv) {
     // Terminate the port audio session.
     Pa_Terminate();
 
+    if (converter.get_num_clipped() > 0)
+        std::cout << "Clipped " << converter.get_num_clipped() << " of "
+            << converter.get_num_samples() << " samples" << std::endl;
+
     if (!status.ok()) {  // The call failed, print a descriptive message.
         std::cout << "Transcription stream broke ("
             << status.error_code() << "): "
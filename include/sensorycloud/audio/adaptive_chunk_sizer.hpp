@@ -0,0 +1,246 @@
+// A chunk size controller for audio streams driven by write latency.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_ADAPTIVE_CHUNK_SIZER_HPP_
+#define SENSORYCLOUD_AUDIO_ADAPTIVE_CHUNK_SIZER_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief Options for an adaptive chunk sizer.
+struct AdaptiveChunkOptions {
+    /// The sample rate of the audio in Hz.
+    uint32_t sample_rate = 16000;
+    /// The shortest duration of a chunk, the lower bound on the latency that
+    /// chunking adds to the stream.
+    std::chrono::milliseconds min_chunk_duration = std::chrono::milliseconds(50);
+    /// The longest duration of a chunk, the upper bound on the latency that
+    /// chunking adds to the stream.
+    std::chrono::milliseconds max_chunk_duration = std::chrono::milliseconds(500);
+    /// The duration of the first chunk.
+    std::chrono::milliseconds initial_chunk_duration = std::chrono::milliseconds(250);
+    /// The granularity of chunk durations.
+    std::chrono::milliseconds step_duration = std::chrono::milliseconds(10);
+    /// The weight of the newest write in the smoothed write latency.
+    float smoothing = 0.25f;
+    /// Chunks shrink while the smoothed write latency is below this fraction
+    /// of the chunk duration and nothing is waiting to be written.
+    float shrink_threshold = 0.25f;
+    /// Chunks grow while the smoothed write latency is above this fraction of
+    /// the chunk duration, i.e., when writes approach real time.
+    float grow_threshold = 0.75f;
+    /// The factor by which chunks shrink.
+    float shrink_factor = 0.75f;
+    /// The factor by which chunks grow.
+    float grow_factor = 2.f;
+    /// Chunks grow when more than this many chunks are waiting to be written.
+    std::size_t max_backlog = 1;
+    /// The number of writes at a chunk size before the size may change again.
+    std::size_t cooldown_writes = 4;
+};
+
+/// @brief A controller that sizes audio chunks from measured write latency.
+///
+/// @details
+/// Small chunks reduce the latency to the first word of a transcript, but
+/// every message carries a fixed overhead. Large chunks amortize the overhead
+/// at the cost of latency. The sizer tracks a smoothed latency of completed
+/// writes and the number of chunks waiting behind them. While the link keeps
+/// up (low latency and no backlog), chunks shrink multiplicatively toward
+/// the minimal duration. When writes back up, chunks grow toward the maximal
+/// duration. Every change is followed by a cooldown so the controller
+/// observes the effect of a size before changing it again.
+///
+/// The sizer is thread-safe. Writes are typically recorded from the write
+/// completions of a stream (see `QueuedBidiReactor::setWriteDoneCallback`)
+/// while the producer reads the chunk size from its own thread:
+///
+/// @code
+/// AdaptiveChunkSizer sizer;
+/// reactor.setWriteDoneCallback([&sizer](const std::chrono::microseconds& latency, const std::size_t& backlog) {
+///     sizer.record_write(latency, backlog);
+/// });
+/// while (capturing) {
+///     const auto chunk_size = sizer.get_chunk_size();
+///     ...  // capture and enqueue `chunk_size` frames
+/// }
+/// @endcode
+///
+class AdaptiveChunkSizer {
+ public:
+    /// A type for callbacks that respond to changes of the chunk size.
+    typedef std::function<void(const std::size_t&, const std::size_t&)> ResizeCallback;
+
+ private:
+    /// The options of the sizer.
+    const AdaptiveChunkOptions options;
+    /// The smallest chunk size in frames.
+    const std::size_t min_chunk_size;
+    /// The largest chunk size in frames.
+    const std::size_t max_chunk_size;
+    /// The granularity of chunk sizes in frames.
+    const std::size_t step_size;
+    /// A mutex for guarding access to the state of the sizer.
+    mutable std::mutex mutex;
+    /// The current chunk size in frames.
+    std::size_t chunk_size;
+    /// The smoothed write latency in microseconds.
+    double smoothed_latency;
+    /// The number of writes that were recorded.
+    uint64_t num_writes;
+    /// The number of writes since the last change of the chunk size.
+    std::size_t writes_since_resize;
+    /// The number of times that the chunk size grew.
+    uint64_t num_grows;
+    /// The number of times that the chunk size shrank.
+    uint64_t num_shrinks;
+    /// The number of writes that were recorded at each chunk size.
+    std::map<std::size_t, uint64_t> histogram;
+    /// The callback to fire when the chunk size changes.
+    ResizeCallback on_resize;
+
+    /// @brief Convert a duration to a number of frames.
+    ///
+    /// @param duration The duration to convert.
+    /// @returns The number of frames in the duration at the sample rate.
+    ///
+    std::size_t to_frames(const std::chrono::milliseconds& duration) const;
+
+    /// @brief Round a chunk size to the granularity and clamp it to the bounds.
+    ///
+    /// @param size The chunk size in frames.
+    /// @returns The rounded and clamped chunk size in frames.
+    ///
+    std::size_t quantize(const double& size) const;
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ///
+    AdaptiveChunkSizer(const AdaptiveChunkSizer& other) = delete;
+
+    /// @brief Assign to this object using the assignment operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const AdaptiveChunkSizer& other) = delete;
+
+ public:
+    /// @brief Initialize a new adaptive chunk sizer.
+    ///
+    /// @param options_ The options of the sizer.
+    ///
+    /// @exception std::invalid_argument If the sample rate or a duration is
+    /// zero, the durations are not ordered as `min <= initial <= max`, the
+    /// smoothing is not in `(0, 1]`, the thresholds are not ordered as
+    /// `shrink < grow`, or the factors do not shrink and grow.
+    ///
+    explicit AdaptiveChunkSizer(const AdaptiveChunkOptions& options_ = AdaptiveChunkOptions());
+
+    /// @brief Return the options of the sizer.
+    ///
+    /// @returns The options that the sizer was initialized with.
+    ///
+    inline const AdaptiveChunkOptions& get_options() const { return options; }
+
+    /// @brief Set the callback to fire when the chunk size changes.
+    ///
+    /// @param callback The callback to execute with the old and new chunk
+    /// sizes in frames. The callback is executed on the thread that recorded
+    /// the write and must not block.
+    ///
+    /// @details
+    /// This function is not thread-safe and should be called before writes
+    /// are recorded.
+    ///
+    inline void set_resize_callback(const ResizeCallback& callback) { on_resize = callback; }
+
+    /// @brief Return the current chunk size.
+    ///
+    /// @returns The number of frames in the next chunk.
+    ///
+    std::size_t get_chunk_size() const;
+
+    /// @brief Record a completed write and adapt the chunk size.
+    ///
+    /// @param latency The time from the start of the write to its completion.
+    /// @param backlog The number of chunks waiting to be written.
+    /// @returns The chunk size after the write in frames.
+    ///
+    std::size_t record_write(const std::chrono::microseconds& latency, const std::size_t& backlog = 0);
+
+    /// @brief Return the smoothed write latency.
+    ///
+    /// @returns The exponentially weighted average of the write latency.
+    ///
+    std::chrono::microseconds get_smoothed_latency() const;
+
+    /// @brief Return the number of recorded writes.
+    ///
+    /// @returns The number of writes that were recorded.
+    ///
+    uint64_t get_num_writes() const;
+
+    /// @brief Return the number of times that the chunk size grew.
+    ///
+    /// @returns The number of increases of the chunk size.
+    ///
+    uint64_t get_num_grows() const;
+
+    /// @brief Return the number of times that the chunk size shrank.
+    ///
+    /// @returns The number of decreases of the chunk size.
+    ///
+    uint64_t get_num_shrinks() const;
+
+    /// @brief Return the chosen chunk sizes.
+    ///
+    /// @returns A map from chunk sizes in frames to the number of writes that
+    /// were recorded at that size.
+    ///
+    std::map<std::size_t, uint64_t> get_size_histogram() const;
+};
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_ADAPTIVE_CHUNK_SIZER_HPP_
@@ -0,0 +1,159 @@
+// An encoder stage for the audio content of streams.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_AUDIO_ENCODER_HPP_
+#define SENSORYCLOUD_AUDIO_AUDIO_ENCODER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "sensorycloud/generated/v1/audio/audio.pb.h"
+#include "sensorycloud/audio/flac_encoder.hpp"
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief An encoder stage that converts 16-bit PCM to the audio content of
+/// a stream.
+///
+/// @details
+/// The encoder is selected once per audio session and updates the encoding
+/// of the session's `AudioConfig` so the server always agrees with the bytes
+/// on the wire. Each call to `encode` produces the audio content for one
+/// message. `LINEAR16` sends the raw samples, `FLAC` compresses them
+/// losslessly to roughly half the size, and `MULAW` sends 8 bits per sample
+/// for telephony audio. `FLAC` holds back chunks that are shorter than its
+/// minimal block size, so call `flush` when encoding the last chunk.
+///
+/// @code
+/// auto audio_config = new AudioConfig;
+/// audio_config->set_sampleratehertz(16000);
+/// audio_config->set_audiochannelcount(1);
+/// AudioEncoder encoder(audio_config, AudioConfig_AudioEncoding_FLAC);
+/// auto stream = cloud.audio.transcribe(&context, audio_config, transcribe_config);
+/// ...
+/// TranscribeRequest request;
+/// encoder.encode(samples, num_frames, *request.mutable_audiocontent());
+/// stream->Write(request);
+/// @endcode
+///
+class AudioEncoder {
+ private:
+    /// The encoding of the audio content.
+    const ::sensory::api::v1::audio::AudioConfig_AudioEncoding encoding;
+    /// The number of interleaved channels.
+    const uint32_t num_channels;
+    /// The FLAC encoder for the `FLAC` encoding.
+    std::unique_ptr<FLACEncoder> flac;
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ///
+    AudioEncoder(const AudioEncoder& other) = delete;
+
+    /// @brief Assign to this object using the assignment operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const AudioEncoder& other) = delete;
+
+ public:
+    /// @brief Initialize a new audio encoder for an audio session.
+    ///
+    /// @param config The audio config of the session. Its encoding is set to
+    /// `encoding_` and its sample rate and channel count configure the coder.
+    /// @param encoding_ The encoding to use for the audio content.
+    ///
+    /// @exception std::invalid_argument If `config` is `nullptr`, if the
+    /// encoding is not supported, or if the audio format is not supported by
+    /// the encoding.
+    ///
+    explicit AudioEncoder(
+        ::sensory::api::v1::audio::AudioConfig* config,
+        const ::sensory::api::v1::audio::AudioConfig_AudioEncoding& encoding_ =
+            ::sensory::api::v1::audio::AudioConfig_AudioEncoding_LINEAR16
+    );
+
+    /// @brief Return the encoding of the audio content.
+    ///
+    /// @returns The encoding that was written to the audio config.
+    ///
+    inline ::sensory::api::v1::audio::AudioConfig_AudioEncoding get_encoding() const {
+        return encoding;
+    }
+
+    /// @brief Return the number of channels of the audio.
+    ///
+    /// @returns The number of interleaved channels.
+    ///
+    inline uint32_t get_num_channels() const { return num_channels; }
+
+    /// @brief Encode a chunk of audio.
+    ///
+    /// @param samples The interleaved 16-bit samples.
+    /// @param num_frames The number of samples per channel.
+    /// @param output The string to append the encoded chunk to.
+    ///
+    void encode(const int16_t* samples, const std::size_t& num_frames, std::string& output);
+
+    /// @brief Encode a chunk of audio.
+    ///
+    /// @param samples The interleaved 16-bit samples.
+    /// @param num_frames The number of samples per channel.
+    /// @returns The encoded chunk.
+    ///
+    inline std::string encode(const int16_t* samples, const std::size_t& num_frames) {
+        std::string output;
+        encode(samples, num_frames, output);
+        return output;
+    }
+
+    /// @brief Encode the audio that the encoder holds back.
+    ///
+    /// @param output The string to append the encoded audio to.
+    ///
+    /// @details
+    /// Call this after encoding the last chunk of a stream. Only `FLAC` holds
+    /// back audio, the other encodings append nothing.
+    ///
+    inline void flush(std::string& output) { if (flac) flac->flush(output); }
+};
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_AUDIO_ENCODER_HPP_
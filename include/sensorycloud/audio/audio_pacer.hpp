@@ -0,0 +1,180 @@
+// A pacer for streaming recorded audio at a multiple of real time.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_AUDIO_PACER_HPP_
+#define SENSORYCLOUD_AUDIO_AUDIO_PACER_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief A pacer that releases chunks of recorded audio on a real-time
+/// schedule.
+///
+/// @details
+/// Streaming a file as fast as the network allows does not reproduce a live
+/// microphone: voice activity detection, single-utterance mode, and partial
+/// results all depend on when audio arrives. The pacer releases each chunk
+/// when its last frame would have been captured live, scaled by a speed
+/// multiplier (e.g., 1 for real time, 2 for twice as fast, 0 for no pacing).
+///
+/// Deadlines are computed from the start of the schedule and the number of
+/// frames released so far on a monotonic clock, so oversleeping and time spent
+/// writing do not accumulate into drift. A chunk that is late is released
+/// immediately and the following chunks catch up; if the pacer falls behind
+/// by more than the maximal lag, the schedule is restarted from the current
+/// time rather than releasing a burst of audio.
+///
+/// @code
+/// AudioPacer pacer(16000, 1.0);
+/// while (...) {
+///     pacer.pace(num_frames);
+///     stream->Write(request);
+/// }
+/// @endcode
+///
+class AudioPacer {
+ public:
+    /// The monotonic clock that chunks are scheduled on.
+    typedef std::chrono::steady_clock Clock;
+
+ private:
+    /// The sample rate of the audio in Hz.
+    const uint32_t sample_rate;
+    /// The multiple of real time to release audio at, zero for no pacing.
+    const double speed;
+    /// The lateness after which the schedule restarts.
+    const Clock::duration max_lag;
+    /// Whether the schedule has started.
+    bool is_started = false;
+    /// The time at which the schedule started.
+    Clock::time_point start;
+    /// The number of frames released since the schedule started.
+    uint64_t scheduled_frames = 0;
+    /// The number of frames released since construction.
+    uint64_t num_frames = 0;
+    /// The number of chunks released since construction.
+    uint64_t num_chunks = 0;
+    /// The number of chunks that were released after their deadline.
+    uint64_t num_late_chunks = 0;
+    /// The number of times the schedule restarted because it fell behind.
+    uint64_t num_rebases = 0;
+    /// The greatest lateness of a chunk.
+    Clock::duration max_lateness = Clock::duration::zero();
+
+ public:
+    /// @brief Initialize a new audio pacer.
+    ///
+    /// @param sample_rate_ The sample rate of the audio in Hz.
+    /// @param speed_ The multiple of real time to release audio at, or zero
+    /// to release audio without waiting.
+    /// @param max_lag_ The lateness after which the schedule restarts.
+    ///
+    /// @exception std::invalid_argument If the sample rate is zero or the
+    /// speed is negative.
+    ///
+    explicit AudioPacer(const uint32_t& sample_rate_,
+        const double& speed_ = 1.0,
+        const std::chrono::milliseconds& max_lag_ = std::chrono::milliseconds(250)
+    );
+
+    /// @brief Return the sample rate of the pacer.
+    ///
+    /// @returns The sample rate of the audio in Hz.
+    ///
+    inline uint32_t get_sample_rate() const { return sample_rate; }
+
+    /// @brief Return the speed of the pacer.
+    ///
+    /// @returns The multiple of real time, zero for no pacing.
+    ///
+    inline double get_speed() const { return speed; }
+
+    /// @brief Restart the schedule from the current time.
+    ///
+    /// @details
+    /// Call this after a pause (e.g., between files) so that the pacer does
+    /// not treat the pause as lateness.
+    ///
+    void reset();
+
+    /// @brief Return the deadline of a chunk.
+    ///
+    /// @param frames The number of frames of the next chunk.
+    /// @returns The time at which the chunk is due. The schedule starts now if
+    /// it has not started yet.
+    ///
+    Clock::time_point get_deadline(const std::size_t& frames);
+
+    /// @brief Wait until a chunk is due and release it.
+    ///
+    /// @param frames The number of frames of the chunk.
+    /// @returns How late the chunk was released, zero if it was on time.
+    ///
+    Clock::duration pace(const std::size_t& frames);
+
+    /// @brief Return the number of released frames.
+    ///
+    /// @returns The number of frames released since construction.
+    ///
+    inline uint64_t get_num_frames() const { return num_frames; }
+
+    /// @brief Return the number of released chunks.
+    ///
+    /// @returns The number of chunks released since construction.
+    ///
+    inline uint64_t get_num_chunks() const { return num_chunks; }
+
+    /// @brief Return the number of late chunks.
+    ///
+    /// @returns The number of chunks released after their deadline.
+    ///
+    inline uint64_t get_num_late_chunks() const { return num_late_chunks; }
+
+    /// @brief Return the number of times the schedule restarted.
+    ///
+    /// @returns The number of times the pacer fell behind by more than the
+    /// maximal lag.
+    ///
+    inline uint64_t get_num_rebases() const { return num_rebases; }
+
+    /// @brief Return the greatest lateness of a chunk.
+    ///
+    /// @returns The greatest time a chunk was released after its deadline.
+    ///
+    inline Clock::duration get_max_lateness() const { return max_lateness; }
+};
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_AUDIO_PACER_HPP_
@@ -0,0 +1,324 @@
+// A tee for feeding captured audio to several concurrent streams.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_AUDIO_TEE_HPP_
+#define SENSORYCLOUD_AUDIO_AUDIO_TEE_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "sensorycloud/calldata/audio_chunk_request.hpp"
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+class AudioTee;
+
+/// @brief An immutable chunk of audio bytes that is shared by subscribers.
+typedef std::shared_ptr<const std::string> AudioChunk;
+
+/// @brief The policy of a subscriber that falls too far behind the tee.
+enum class TeeOverflowPolicy {
+    /// Skip the oldest unread chunks and keep reading live audio.
+    DropOldest = 0,
+    /// Stop delivering audio to the subscriber and flag it as overrun.
+    Disconnect
+};
+
+/// @brief A reader of the chunks published to an `AudioTee`.
+///
+/// @details
+/// Each subscriber owns a cursor into the chunks of the tee and a bound on
+/// how far it may lag behind the newest chunk. Publishing never waits for a
+/// subscriber; a subscriber that exceeds its bound is handled by its
+/// overflow policy so that it cannot stall the publisher or other
+/// subscribers. Destroying the subscriber detaches it from the tee, which
+/// must outlive it.
+///
+class TeeSubscriber {
+ private:
+    /// The tee that the subscriber reads from.
+    AudioTee& tee;
+    /// The maximal number of unread chunks.
+    const std::size_t max_lag;
+    /// The policy when the subscriber lags by more than `max_lag` chunks.
+    const TeeOverflowPolicy policy;
+    /// The sequence number of the next chunk to read.
+    uint64_t cursor;
+    /// Whether the subscriber was disconnected for lagging too far.
+    bool overrun = false;
+    /// The number of chunks that were read.
+    uint64_t num_chunks_read = 0;
+    /// The number of chunks that were skipped.
+    uint64_t num_dropped_chunks = 0;
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ///
+    TeeSubscriber(const TeeSubscriber& other) = delete;
+
+    /// @brief Assign to this object using the assignment operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const TeeSubscriber& other) = delete;
+
+    /// @brief Initialize a new subscriber.
+    ///
+    /// @param tee_ The tee that the subscriber reads from.
+    /// @param max_lag_ The maximal number of unread chunks.
+    /// @param policy_ The policy when the subscriber lags by more chunks.
+    /// @param cursor_ The sequence number of the first chunk to read.
+    ///
+    TeeSubscriber(AudioTee& tee_,
+        const std::size_t& max_lag_,
+        const TeeOverflowPolicy& policy_,
+        const uint64_t& cursor_
+    ) : tee(tee_), max_lag(max_lag_), policy(policy_), cursor(cursor_) { }
+
+    friend class AudioTee;
+
+ public:
+    /// @brief Detach the subscriber from the tee.
+    ~TeeSubscriber();
+
+    /// @brief Wait for and read the next chunk.
+    ///
+    /// @param chunk The chunk to assign the next chunk to.
+    /// @param timeout The maximal time to wait for a chunk.
+    /// @returns `true` if a chunk was read, `false` if the timeout expired,
+    /// the tee was closed and every chunk was read, or the subscriber was
+    /// disconnected.
+    ///
+    bool read(AudioChunk& chunk, const std::chrono::milliseconds& timeout);
+
+    /// @brief Wait for the next chunk and set it as the audio of a request.
+    ///
+    /// @tparam Request The type of request message, e.g.,
+    /// `TranscribeRequest`, `ValidateEventRequest`, or `AuthenticateRequest`.
+    /// @param request The request to set the audio content of.
+    /// @param timeout The maximal time to wait for a chunk.
+    /// @returns `true` if the audio content was set, `false` otherwise (see
+    /// `read`).
+    ///
+    template<typename Request>
+    inline bool read(Request& request, const std::chrono::milliseconds& timeout) {
+        AudioChunk chunk;
+        if (!read(chunk, timeout)) return false;
+        request.set_audiocontent(*chunk);
+        return true;
+    }
+
+    /// @brief Wait for the next chunk and set it as the audio of an audio
+    /// chunk request.
+    ///
+    /// @tparam Message The protobuf request message of the stream.
+    /// @param request The request to set the audio content of.
+    /// @param timeout The maximal time to wait for a chunk.
+    /// @returns `true` if the audio content was set, `false` otherwise (see
+    /// `read`).
+    ///
+    /// @details
+    /// The request references the chunk rather than copying it, so the
+    /// subscribers of the tee send one shared buffer.
+    ///
+    template<typename Message>
+    inline bool read(
+        ::sensory::calldata::AudioChunkRequest<Message>& request,
+        const std::chrono::milliseconds& timeout
+    ) {
+        AudioChunk chunk;
+        if (!read(chunk, timeout)) return false;
+        request.set_audio_content(chunk, chunk->data(), chunk->size());
+        return true;
+    }
+
+    /// @brief Return the number of chunks that are ready to read.
+    ///
+    /// @returns The number of published chunks after the cursor.
+    ///
+    std::size_t get_lag() const;
+
+    /// @brief Return whether the subscriber was disconnected.
+    ///
+    /// @returns `true` if the subscriber lagged too far behind the tee under
+    /// the `Disconnect` policy, `false` otherwise.
+    ///
+    bool is_overrun() const;
+
+    /// @brief Return the number of chunks that were read.
+    ///
+    /// @returns The number of chunks returned by `read`.
+    ///
+    uint64_t get_num_chunks_read() const;
+
+    /// @brief Return the number of chunks that were skipped.
+    ///
+    /// @returns The number of chunks skipped under the `DropOldest` policy.
+    ///
+    uint64_t get_num_dropped_chunks() const;
+};
+
+/// @brief A fan-out of audio chunks to several concurrent streams.
+///
+/// @details
+/// A single capture loop publishes each chunk once; the chunk is stored as
+/// an immutable, reference-counted string and shared by every subscriber,
+/// so the audio is not copied per subscriber until it is set on a request.
+/// The tee retains a chunk until every subscriber has read or skipped it.
+///
+class AudioTee {
+ private:
+    /// The mutex for guarding the chunks and subscribers.
+    mutable std::mutex mutex;
+    /// The condition for waking subscribers when chunks are published.
+    std::condition_variable published;
+    /// The chunks that have not been read by every subscriber.
+    std::deque<AudioChunk> chunks;
+    /// The sequence number of the first chunk in `chunks`.
+    uint64_t base = 0;
+    /// The subscribers of the tee.
+    std::vector<TeeSubscriber*> subscribers;
+    /// Whether the tee has been closed.
+    bool closed = false;
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ///
+    AudioTee(const AudioTee& other) = delete;
+
+    /// @brief Assign to this object using the assignment operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const AudioTee& other) = delete;
+
+    /// @brief Release the chunks that every subscriber has passed.
+    ///
+    /// @details
+    /// The mutex must be held by the caller.
+    ///
+    void trim();
+
+    /// @brief Detach a subscriber from the tee.
+    ///
+    /// @param subscriber The subscriber to detach.
+    ///
+    void unsubscribe(TeeSubscriber* subscriber);
+
+    friend class TeeSubscriber;
+
+ public:
+    /// @brief Initialize a new audio tee.
+    AudioTee() { }
+
+    /// @brief Attach a new subscriber to the tee.
+    ///
+    /// @param max_lag The maximal number of unread chunks before the overflow
+    /// policy applies.
+    /// @param policy The policy when the subscriber lags by more chunks.
+    /// @returns The subscriber, which reads from the next published chunk.
+    ///
+    /// @exception std::invalid_argument If the maximal lag is zero.
+    ///
+    std::unique_ptr<TeeSubscriber> subscribe(const std::size_t& max_lag,
+        const TeeOverflowPolicy& policy = TeeOverflowPolicy::DropOldest
+    );
+
+    /// @brief Publish a chunk to every subscriber.
+    ///
+    /// @param chunk The chunk to publish.
+    ///
+    /// @details
+    /// This function never waits for subscribers.
+    ///
+    /// @exception std::runtime_error If the tee is closed.
+    ///
+    void publish(const AudioChunk& chunk);
+
+    /// @brief Publish samples to every subscriber.
+    ///
+    /// @param samples The interleaved 16-bit samples to publish.
+    /// @param num_samples The number of samples.
+    /// @returns The chunk that holds the bytes of the samples.
+    ///
+    /// @exception std::runtime_error If the tee is closed.
+    ///
+    AudioChunk publish(const int16_t* samples, const std::size_t& num_samples);
+
+    /// @brief Close the tee to signal that no more chunks will be published.
+    ///
+    /// @details
+    /// Subscribers read the chunks that remain and then stop.
+    ///
+    void close();
+
+    /// @brief Return the number of subscribers.
+    ///
+    /// @returns The number of attached subscribers.
+    ///
+    std::size_t get_num_subscribers() const;
+
+    /// @brief Return the number of retained chunks.
+    ///
+    /// @returns The number of chunks that some subscriber has not read yet.
+    ///
+    std::size_t get_num_retained_chunks() const;
+
+    /// @brief Return the number of published chunks.
+    ///
+    /// @returns The number of chunks published since construction.
+    ///
+    uint64_t get_num_published_chunks() const;
+};
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_AUDIO_TEE_HPP_
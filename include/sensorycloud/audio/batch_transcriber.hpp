@@ -0,0 +1,458 @@
+// A batch engine for offline transcription of many audio files.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_BATCH_TRANSCRIBER_HPP_
+#define SENSORYCLOUD_AUDIO_BATCH_TRANSCRIBER_HPP_
+
+#include <grpcpp/support/status.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "sensorycloud/generated/v1/audio/audio.pb.h"
+#include "sensorycloud/audio/offline_transcribe_reactor.hpp"
+#include "sensorycloud/audio/resampler.hpp"
+#include "sensorycloud/audio/resumable_stream.hpp"
+#include "sensorycloud/audio/wav.hpp"
+#include "sensorycloud/util/executor.hpp"
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief Options for a batch transcription engine.
+struct BatchTranscribeOptions {
+    /// The number of transcription streams that run concurrently.
+    std::size_t concurrency = 8;
+    /// The maximal number of decoded files that wait for a stream.
+    std::size_t prefetch = 16;
+    /// The number of threads that decode files in the background.
+    std::size_t num_decoder_threads = 2;
+    /// The maximal number of attempts for each file.
+    std::size_t max_attempts = 3;
+    /// The delay before the first retry of a file, which grows linearly with
+    /// each attempt.
+    std::chrono::milliseconds retry_backoff = std::chrono::milliseconds(500);
+    /// The number of samples in each audio message.
+    std::size_t chunk_size = 4096;
+    /// The sample rate that the audio is converted to before streaming.
+    uint32_t sample_rate = 16000;
+    /// The language code of the audio.
+    std::string language_code = "en";
+    /// The encoding of the audio on the wire.
+    ::sensory::api::v1::audio::AudioConfig_AudioEncoding encoding =
+        ::sensory::api::v1::audio::AudioConfig_AudioEncoding_LINEAR16;
+    /// The transcription config for every stream (e.g., with the model name
+    /// and user ID). Offline mode is enabled for every stream.
+    ::sensory::api::v1::audio::TranscribeConfig transcribe_config;
+    /// The function that decodes a file to PCM audio. The function is called
+    /// on the decoder threads and signals errors by throwing exceptions.
+    std::function<PCMAudio(const std::string&)> decoder = read_wav;
+};
+
+/// @brief The result of transcribing a file in a batch.
+struct BatchTranscribeResult {
+    /// The path of the file.
+    std::string path;
+    /// The final status of the file. Files that fail to decode have the
+    /// `INVALID_ARGUMENT` status and zero attempts.
+    ::grpc::Status status;
+    /// The transcript of the file.
+    std::string transcript;
+    /// The number of streams that were opened for the file.
+    std::size_t attempts = 0;
+};
+
+/// @brief The summary of a batch.
+struct BatchTranscribeSummary {
+    /// The number of files in the batch.
+    std::size_t num_files = 0;
+    /// The number of files that were transcribed.
+    std::size_t num_succeeded = 0;
+    /// The number of files that failed.
+    std::size_t num_failed = 0;
+    /// The number of streams that were retried.
+    std::size_t num_retries = 0;
+};
+
+/// @brief Serialize a batch result as a line of JSON.
+///
+/// @param result The result to serialize.
+/// @returns A JSON object with the `path`, `ok`, `code`, `message`,
+/// `transcript`, and `attempts` of the result, without a trailing newline.
+///
+std::string to_jsonl(const BatchTranscribeResult& result);
+
+/// @brief Find the input files of a batch.
+///
+/// @param path The path of a directory of `.wav` files, of a single `.wav`
+/// file, or of a manifest with one path per line. Empty lines and lines that
+/// start with `#` are ignored in manifests.
+/// @returns The paths of the input files.
+///
+/// @exception std::runtime_error If the path cannot be read.
+///
+std::vector<std::string> find_batch_inputs(const std::string& path);
+
+/// @brief An engine that transcribes many files with bounded concurrency.
+/// @tparam Service The type of the audio service, e.g.,
+/// `AudioService<CredentialStore>`.
+///
+/// @details
+/// Files are decoded, mixed down to mono, and resampled on a small pool of
+/// decoder threads ahead of the streams, bounded by the prefetch depth.
+/// Up to `concurrency` offline `Transcribe` streams run at once on the
+/// callback API, so the number of streams in flight does not depend on the
+/// number of threads. Each stream is an `OfflineTranscribeReactor` that
+/// writes its audio from the reactions of the stream and aggregates the
+/// transcript.
+/// Streams that fail with a transient status are retried with a linear
+/// backoff. Results are reported as each file completes, in completion
+/// order.
+///
+/// @code
+/// BatchTranscribeOptions options;
+/// options.concurrency = 32;
+/// options.transcribe_config.set_modelname("speech_recognition_en");
+/// options.transcribe_config.set_userid("batch");
+/// BatchTranscriber<AudioService<FileSystemCredentialStore>> batch(cloud.audio, options);
+/// std::ofstream output("transcripts.jsonl");
+/// const auto summary = batch.run(find_batch_inputs("recordings/"), output);
+/// @endcode
+///
+template<typename Service>
+class BatchTranscriber {
+ private:
+    /// @brief A file in the batch.
+    struct Item {
+        /// The path of the file.
+        std::string path;
+        /// The decoded audio, or `nullptr` if decoding failed.
+        std::shared_ptr<const std::vector<int16_t>> audio;
+        /// The error that occurred while decoding the file.
+        std::string error;
+        /// The number of streams that were opened for the file.
+        std::size_t attempts = 0;
+        /// The earliest time that the next stream may be opened.
+        std::chrono::steady_clock::time_point ready_at;
+    };
+
+    /// @brief A transcription stream for a file.
+    class Job : public OfflineTranscribeReactor<Service> {
+     private:
+        /// The engine that owns the job.
+        BatchTranscriber* engine;
+
+     public:
+        /// The file that is being transcribed.
+        const std::shared_ptr<Item> item;
+
+        /// @brief Initialize a new job.
+        ///
+        /// @param engine_ The engine that owns the job.
+        /// @param item_ The file to transcribe.
+        /// @param audio_config The audio config of the stream.
+        ///
+        Job(BatchTranscriber* engine_,
+            const std::shared_ptr<Item>& item_,
+            ::sensory::api::v1::audio::AudioConfig* audio_config
+        ) : OfflineTranscribeReactor<Service>(item_->audio, engine_->options.chunk_size, engine_->options.encoding, audio_config),
+            engine(engine_),
+            item(item_) { }
+
+        /// @brief Hand the completed job back to the engine.
+        ///
+        /// @param status The final status of the stream.
+        ///
+        void OnDone(const ::grpc::Status& status) override {
+            OfflineTranscribeReactor<Service>::OnDone(status);
+            engine->on_done(this);
+        }
+    };
+
+    /// The audio service to open streams with.
+    const Service& service;
+    /// The options of the engine.
+    const BatchTranscribeOptions options;
+    /// A mutex for guarding access to the state of the batch.
+    std::mutex mutex;
+    /// A condition variable for waking the dispatcher.
+    std::condition_variable condition;
+    /// The number of files that are being decoded.
+    std::size_t num_decoding;
+    /// The number of streams that are in flight.
+    std::size_t num_active;
+    /// The decoded files that wait for a stream.
+    std::deque<std::shared_ptr<Item>> ready;
+    /// The files that failed to decode.
+    std::vector<std::shared_ptr<Item>> decode_failures;
+    /// The jobs whose streams have completed.
+    std::vector<std::unique_ptr<Job>> finished;
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ///
+    BatchTranscriber(const BatchTranscriber& other) = delete;
+
+    /// @brief Assign to this object using the assignment operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const BatchTranscriber& other) = delete;
+
+    /// @brief Decode, downmix, and resample a file.
+    ///
+    /// @param item The file to decode.
+    ///
+    void decode(const std::shared_ptr<Item>& item) {
+        try {
+            PCMAudio pcm = options.decoder(item->path);
+            const auto num_frames = pcm.get_num_frames();
+            downmix(pcm.samples.data(), num_frames, pcm.num_channels, pcm.samples.data());
+            auto audio = std::make_shared<std::vector<int16_t>>();
+            Resampler resampler(pcm.sample_rate, options.sample_rate);
+            resampler.process(pcm.samples.data(), num_frames, *audio);
+            resampler.flush(*audio);
+            item->audio = audio;
+        } catch (const std::exception& exception) {
+            item->error = exception.what();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        num_decoding--;
+        if (item->audio) ready.push_back(item);
+        else decode_failures.push_back(item);
+        condition.notify_one();
+    }
+
+    /// @brief Open a stream for a decoded file.
+    ///
+    /// @param item The file to transcribe.
+    ///
+    /// @details
+    /// If the service throws, the configs are freed unless the service took
+    /// ownership of them, the stream is no longer counted as in flight, and
+    /// the exception is rethrown.
+    ///
+    void start(const std::shared_ptr<Item>& item) {
+        auto audio_config = new ::sensory::api::v1::audio::AudioConfig;
+        audio_config->set_sampleratehertz(options.sample_rate);
+        audio_config->set_audiochannelcount(1);
+        audio_config->set_languagecode(options.language_code);
+        std::unique_ptr<Job> job(new Job(this, item, audio_config));
+        auto transcribe_config = new ::sensory::api::v1::audio::TranscribeConfig(options.transcribe_config);
+        transcribe_config->set_doofflinemode(true);
+        item->attempts++;
+        try {
+            service.transcribe(job.get(), audio_config, transcribe_config);
+        } catch (...) {
+            // Free the configs unless the service took ownership of them.
+            if (!job->request.has_config()) {
+                if (!transcribe_config->has_audio()) delete audio_config;
+                delete transcribe_config;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            num_active--;
+            throw;
+        }
+        // The job is released to the stream and handed back in `on_done`.
+        job.release()->StartCall();
+    }
+
+    /// @brief Respond to the completion of a stream.
+    ///
+    /// @param job The job of the stream.
+    ///
+    void on_done(Job* job) {
+        std::lock_guard<std::mutex> lock(mutex);
+        num_active--;
+        finished.emplace_back(job);
+        condition.notify_one();
+    }
+
+ public:
+    /// @brief Initialize a new batch transcription engine.
+    ///
+    /// @param service_ The audio service to open streams with.
+    /// @param options_ The options of the engine.
+    ///
+    /// @exception std::invalid_argument If the concurrency, prefetch depth,
+    /// number of decoder threads, maximal number of attempts, or chunk size
+    /// is zero.
+    ///
+    explicit BatchTranscriber(
+        const Service& service_,
+        const BatchTranscribeOptions& options_ = BatchTranscribeOptions()
+    ) : service(service_), options(options_), num_decoding(0), num_active(0) {
+        if (options.concurrency == 0 || options.prefetch == 0 ||
+            options.num_decoder_threads == 0 || options.max_attempts == 0 ||
+            options.chunk_size == 0)
+            throw std::invalid_argument("BatchTranscriber options must be positive.");
+    }
+
+    /// @brief Return the options of the engine.
+    ///
+    /// @returns The options that the engine was initialized with.
+    ///
+    inline const BatchTranscribeOptions& get_options() const { return options; }
+
+    /// @brief Transcribe a batch of files.
+    ///
+    /// @param paths The paths of the files to transcribe.
+    /// @param callback The callback for the result of each file. The callback
+    /// is executed on the calling thread.
+    /// @returns The summary of the batch.
+    ///
+    /// @details
+    /// This function blocks until every file has completed. A file whose
+    /// stream cannot be opened because the service throws fails with the
+    /// `INTERNAL` status.
+    ///
+    BatchTranscribeSummary run(
+        const std::vector<std::string>& paths,
+        const std::function<void(const BatchTranscribeResult&)>& callback
+    ) {
+        BatchTranscribeSummary summary;
+        summary.num_files = paths.size();
+        ::sensory::util::ThreadPoolExecutor decoders(options.num_decoder_threads);
+        std::size_t next_path = 0;
+        const auto report = [&](const std::shared_ptr<Item>& item, const ::grpc::Status& status, const std::string& transcript) {
+            BatchTranscribeResult result;
+            result.path = item->path;
+            result.status = status;
+            result.transcript = transcript;
+            result.attempts = item->attempts;
+            if (status.ok()) summary.num_succeeded++;
+            else summary.num_failed++;
+            callback(result);
+        };
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            // Decode files ahead of the streams, up to the prefetch depth.
+            while (next_path < paths.size() && num_decoding + ready.size() < options.prefetch) {
+                auto item = std::make_shared<Item>();
+                item->path = paths[next_path++];
+                num_decoding++;
+                decoders.execute([this, item]() { decode(item); });
+            }
+            // Take the completed jobs, the failed files, and the files that
+            // can start a stream now.
+            std::vector<std::unique_ptr<Job>> done;
+            done.swap(finished);
+            std::vector<std::shared_ptr<Item>> failures;
+            failures.swap(decode_failures);
+            std::vector<std::shared_ptr<Item>> starting;
+            const auto now = std::chrono::steady_clock::now();
+            auto retry_at = std::chrono::steady_clock::time_point::max();
+            for (auto iter = ready.begin(); iter != ready.end() && num_active < options.concurrency;) {
+                if ((*iter)->ready_at <= now) {
+                    starting.push_back(*iter);
+                    iter = ready.erase(iter);
+                    num_active++;
+                } else {
+                    retry_at = std::min(retry_at, (*iter)->ready_at);
+                    ++iter;
+                }
+            }
+            if (done.empty() && failures.empty() && starting.empty()) {
+                if (next_path == paths.size() && num_decoding == 0 && ready.empty() && num_active == 0)
+                    break;
+                if (retry_at != std::chrono::steady_clock::time_point::max())
+                    condition.wait_until(lock, retry_at);
+                else
+                    condition.wait(lock);
+                continue;
+            }
+            lock.unlock();
+            std::vector<std::shared_ptr<Item>> retries;
+            for (const auto& job : done) {
+                const auto status = job->getStatus();
+                if (!status.ok() && is_retryable(status) && job->item->attempts < options.max_attempts) {
+                    job->item->ready_at = std::chrono::steady_clock::now() +
+                        options.retry_backoff * static_cast<int>(job->item->attempts);
+                    retries.push_back(job->item);
+                    summary.num_retries++;
+                } else if (status.ok() && !job->error.empty()) {
+                    report(job->item, ::grpc::Status(::grpc::StatusCode::INTERNAL, job->error), "");
+                } else {
+                    report(job->item, status, job->aggregator.get_transcript());
+                }
+            }
+            done.clear();
+            for (const auto& item : failures)
+                report(item, ::grpc::Status(::grpc::StatusCode::INVALID_ARGUMENT, item->error), "");
+            for (const auto& item : starting) {
+                try {
+                    start(item);
+                } catch (const std::exception& exception) {
+                    // The stream never opened, so the file fails without a
+                    // job and the streams that are in flight keep running.
+                    report(item, ::grpc::Status(::grpc::StatusCode::INTERNAL, exception.what()), "");
+                }
+            }
+            lock.lock();
+            // Retries go ahead of new files so finished files release memory.
+            ready.insert(ready.begin(), retries.begin(), retries.end());
+        }
+        return summary;
+    }
+
+    /// @brief Transcribe a batch of files and write the results as JSONL.
+    ///
+    /// @param paths The paths of the files to transcribe.
+    /// @param output The stream to write one line of JSON per file to (see
+    /// `to_jsonl`). Each line is flushed as soon as its file completes.
+    /// @returns The summary of the batch.
+    ///
+    inline BatchTranscribeSummary run(const std::vector<std::string>& paths, std::ostream& output) {
+        return run(paths, [&output](const BatchTranscribeResult& result) {
+            output << to_jsonl(result) << std::endl;
+        });
+    }
+};
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_BATCH_TRANSCRIBER_HPP_
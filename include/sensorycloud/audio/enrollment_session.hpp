@@ -0,0 +1,289 @@
+// A session for enrollment streams that ends when the enrollment completes.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_ENROLLMENT_SESSION_HPP_
+#define SENSORYCLOUD_AUDIO_ENROLLMENT_SESSION_HPP_
+
+#include <grpcpp/support/status.h>
+#include <grpcpp/support/sync_stream.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include "sensorycloud/generated/v1/audio/audio.pb.h"
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief The progress of an enrollment.
+struct EnrollmentProgress {
+    /// The percentage of the enrollment that is complete.
+    int64_t percent_complete = 0;
+    /// The percentage of the current segment (utterance) that is complete.
+    int64_t percent_segment_complete = 0;
+    /// The index of the current segment.
+    std::size_t segment = 0;
+    /// Whether the current segment completed with this response.
+    bool is_segment_complete = false;
+};
+
+/// @brief An enrollment stream that stops sending audio once the server
+/// reports that the enrollment is complete.
+///
+/// @tparam Request The type of request message, i.e.,
+/// `CreateEnrollmentRequest` or `CreateEnrolledEventRequest`.
+///
+/// @details
+/// The session reads the responses of the stream on a background thread and
+/// tracks `percentComplete` and `percentSegmentComplete`. Once the
+/// enrollment is complete, `write` discards the audio, sends writes-done,
+/// and returns `false`, so the caller can stop capturing (or reading a file)
+/// without streaming the rest of the audio. The response that completed the
+/// enrollment holds the enrollment ID and, for enrollments that are not
+/// stored on the server, the enrollment token.
+///
+/// Audio is written from a single thread. The progress callback is invoked
+/// on the reading thread.
+///
+/// @code
+/// grpc::ClientContext context;
+/// CreateEnrollmentSession session(cloud.audio.create_enrollment(&context,
+///     audio_config, enrollment_config));
+/// while (session.write(samples, num_samples)) capture(samples, num_samples);
+/// auto status = session.finish();
+/// if (status.ok() && session.is_complete())
+///     std::cout << session.get_response().enrollmentid() << std::endl;
+/// @endcode
+///
+template<typename Request>
+class EnrollmentSession {
+ public:
+    /// The type of the enrollment stream.
+    typedef std::unique_ptr<::grpc::ClientReaderWriterInterface<
+        Request, ::sensory::api::v1::audio::CreateEnrollmentResponse>> Stream;
+    /// A callback for the progress of the enrollment.
+    typedef std::function<void(const EnrollmentProgress&,
+        const ::sensory::api::v1::audio::CreateEnrollmentResponse&)> ProgressCallback;
+
+ private:
+    /// The enrollment stream.
+    Stream stream;
+    /// The callback for the progress of the enrollment.
+    const ProgressCallback callback;
+    /// The thread that reads the responses of the stream.
+    std::thread reader;
+    /// The mutex for guarding the progress and response.
+    mutable std::mutex mutex;
+    /// The progress of the enrollment.
+    EnrollmentProgress progress;
+    /// The response that completed the enrollment.
+    ::sensory::api::v1::audio::CreateEnrollmentResponse response;
+    /// Whether the enrollment is complete.
+    std::atomic<bool> complete;
+    /// Whether the server has stopped sending responses.
+    std::atomic<bool> ended;
+    /// Whether writes-done was sent.
+    bool writes_done = false;
+    /// Whether the stream was finished.
+    bool finished = false;
+    /// The final status of the stream.
+    ::grpc::Status status;
+    /// The number of bytes of audio that were written.
+    uint64_t num_bytes_written = 0;
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ///
+    EnrollmentSession(const EnrollmentSession& other) = delete;
+
+    /// @brief Assign to this object using the assignment operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const EnrollmentSession& other) = delete;
+
+    /// @brief Read responses until the stream ends.
+    void read_responses() {
+        ::sensory::api::v1::audio::CreateEnrollmentResponse next;
+        while (stream->Read(&next)) {
+            EnrollmentProgress current;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                // A segment completes when its progress reaches 100%; the
+                // next response with less progress starts a new segment.
+                if (progress.percent_segment_complete >= 100 && next.percentsegmentcomplete() < 100)
+                    progress.segment++;
+                progress.is_segment_complete = next.percentsegmentcomplete() >= 100 &&
+                    progress.percent_segment_complete < 100;
+                progress.percent_complete = next.percentcomplete();
+                progress.percent_segment_complete = next.percentsegmentcomplete();
+                current = progress;
+                if (next.percentcomplete() >= 100 && !complete) {
+                    response = next;
+                    complete = true;
+                }
+            }
+            if (callback) callback(current, next);
+        }
+        ended = true;
+    }
+
+    /// @brief Send writes-done if it was not sent yet.
+    inline void send_writes_done() {
+        if (writes_done) return;
+        writes_done = true;
+        stream->WritesDone();
+    }
+
+ public:
+    /// @brief Initialize a new enrollment session.
+    ///
+    /// @param stream_ The enrollment stream, as returned by
+    /// `create_enrollment` or `create_event_enrollment`. The context of the
+    /// stream must outlive the session.
+    /// @param callback_ An optional callback for the progress of the
+    /// enrollment, invoked for every response.
+    ///
+    /// @exception std::invalid_argument If the stream is `nullptr`.
+    ///
+    explicit EnrollmentSession(Stream stream_, const ProgressCallback& callback_ = nullptr) :
+        stream(std::move(stream_)), callback(callback_), complete(false), ended(false) {
+        if (stream == nullptr)
+            throw std::invalid_argument("EnrollmentSession requires a stream.");
+        reader = std::thread(&EnrollmentSession::read_responses, this);
+    }
+
+    /// @brief Finish the stream and join the reading thread.
+    ~EnrollmentSession() { finish(); }
+
+    /// @brief Write a request to the stream unless the enrollment is over.
+    ///
+    /// @param request The request to write.
+    /// @returns `true` if the request was written, `false` if the
+    /// enrollment is complete or the stream has ended.
+    ///
+    /// @details
+    /// The first call after the enrollment completes sends writes-done.
+    ///
+    bool write(const Request& request) {
+        if (finished || writes_done) return false;
+        if (complete || ended) {
+            send_writes_done();
+            return false;
+        }
+        if (!stream->Write(request)) return false;
+        num_bytes_written += request.audiocontent().size();
+        return true;
+    }
+
+    /// @brief Write `LINEAR16` audio to the stream unless the enrollment is
+    /// over.
+    ///
+    /// @param samples The samples of audio to write.
+    /// @param num_samples The number of samples.
+    /// @returns `true` if the audio was written, `false` if the enrollment
+    /// is complete or the stream has ended.
+    ///
+    inline bool write(const int16_t* samples, const std::size_t& num_samples) {
+        Request request;
+        request.set_audiocontent(reinterpret_cast<const char*>(samples), num_samples * sizeof(int16_t));
+        return write(request);
+    }
+
+    /// @brief Finish the stream.
+    ///
+    /// @returns The final status of the stream.
+    ///
+    /// @details
+    /// Sends writes-done if it was not sent yet, waits for the last response,
+    /// and returns the status of the stream. Calling `finish` again returns
+    /// the same status.
+    ///
+    ::grpc::Status finish() {
+        if (finished) return status;
+        send_writes_done();
+        if (reader.joinable()) reader.join();
+        status = stream->Finish();
+        finished = true;
+        return status;
+    }
+
+    /// @brief Return a flag determining whether the enrollment is complete.
+    ///
+    /// @returns `true` if the server reported 100% progress.
+    ///
+    inline bool is_complete() const { return complete; }
+
+    /// @brief Return the progress of the enrollment.
+    ///
+    /// @returns The progress from the most recent response.
+    ///
+    inline EnrollmentProgress get_progress() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return progress;
+    }
+
+    /// @brief Return the response that completed the enrollment.
+    ///
+    /// @returns The response with the enrollment ID and token, or an empty
+    /// response if the enrollment is not complete.
+    ///
+    inline ::sensory::api::v1::audio::CreateEnrollmentResponse get_response() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return response;
+    }
+
+    /// @brief Return the number of bytes of audio that were written.
+    ///
+    /// @returns The number of bytes of audio content sent to the server.
+    ///
+    inline uint64_t get_num_bytes_written() const { return num_bytes_written; }
+};
+
+/// A session for `CreateEnrollment` streams.
+typedef EnrollmentSession<::sensory::api::v1::audio::CreateEnrollmentRequest> CreateEnrollmentSession;
+
+/// A session for `CreateEnrolledEvent` streams.
+typedef EnrollmentSession<::sensory::api::v1::audio::CreateEnrolledEventRequest> CreateEnrolledEventSession;
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_ENROLLMENT_SESSION_HPP_
@@ -0,0 +1,345 @@
+// A memory-mapped source of audio from WAV and raw PCM files.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_FILE_SOURCE_HPP_
+#define SENSORYCLOUD_AUDIO_FILE_SOURCE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "sensorycloud/audio/wav.hpp"
+#include "sensorycloud/calldata/audio_chunk_request.hpp"
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief A read-only memory mapping of a file.
+///
+/// @details
+/// The mapping is shared by an `AudioFileSource` and the views it hands out,
+/// so the file stays mapped until the last of them is destroyed.
+///
+class AudioFileMapping {
+ private:
+    /// The file descriptor of the file.
+    int file = -1;
+    /// The mapping of the file, or `nullptr` for an empty file.
+    void* data = nullptr;
+    /// The number of bytes of the mapping.
+    std::size_t size = 0;
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ///
+    AudioFileMapping(const AudioFileMapping& other) = delete;
+
+    /// @brief Assign to this object using the assignment operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const AudioFileMapping& other) = delete;
+
+ public:
+    /// @brief Map a file into memory.
+    ///
+    /// @param path The path of the file to map.
+    ///
+    /// @exception std::runtime_error If the file cannot be opened or mapped.
+    ///
+    explicit AudioFileMapping(const std::string& path);
+
+    /// @brief Unmap and close the file.
+    ~AudioFileMapping();
+
+    /// @brief Return the bytes of the mapping.
+    ///
+    /// @returns A pointer to the first byte, or `nullptr` for an empty file.
+    ///
+    inline const char* get_data() const { return static_cast<const char*>(data); }
+
+    /// @brief Return the size of the mapping.
+    ///
+    /// @returns The number of bytes of the file.
+    ///
+    inline std::size_t get_size() const { return size; }
+};
+
+/// @brief A view of frames that lives inside the mapping of an
+/// `AudioFileSource`.
+///
+/// @details
+/// The view holds a reference to the mapping, so it remains valid after the
+/// source it came from is destroyed. The bytes are 16-bit little-endian PCM,
+/// i.e., the `LINEAR16` wire format, so they can be set as the audio content
+/// of a request without conversion.
+///
+struct AudioFileView {
+    /// The mapping that the samples live in.
+    std::shared_ptr<const AudioFileMapping> mapping;
+    /// The first interleaved sample of the view.
+    const int16_t* samples = nullptr;
+    /// The number of frames in the view.
+    std::size_t num_frames = 0;
+    /// The number of interleaved channels in each frame.
+    uint32_t num_channels = 0;
+
+    /// @brief Return the bytes of the view.
+    ///
+    /// @returns A pointer to the first byte of the view.
+    ///
+    inline const char* data() const { return reinterpret_cast<const char*>(samples); }
+
+    /// @brief Return the size of the view.
+    ///
+    /// @returns The number of bytes in the view.
+    ///
+    inline std::size_t size() const { return num_frames * num_channels * sizeof(int16_t); }
+
+    /// @brief Return whether the view is empty.
+    ///
+    /// @returns `true` if the view holds no frames, `false` otherwise.
+    ///
+    inline bool empty() const { return num_frames == 0; }
+};
+
+/// @brief Set a view as the audio content of a request.
+///
+/// @tparam Request The type of request message, e.g., `TranscribeRequest`.
+/// @param request The request to set the audio content of.
+/// @param view The view of the audio to set.
+///
+/// @details
+/// The protobuf message copies the view into its `audioContent` field, and
+/// serialization copies it again into the buffer of the call. Use an
+/// `AudioChunkRequest` to send the view without copies.
+///
+template<typename Request>
+inline void set_audio_content(Request& request, const AudioFileView& view) {
+    request.set_audiocontent(view.data(), view.size());
+}
+
+/// @brief Set a view as the audio content of an audio chunk request.
+///
+/// @tparam Message The protobuf request message of the stream.
+/// @param request The request to set the audio content of.
+/// @param view The view of the audio to set.
+///
+/// @details
+/// The request references the samples in the mapping and shares ownership of
+/// the mapping with the view, so the audio is not copied between the file and
+/// the wire.
+///
+template<typename Message>
+inline void set_audio_content(
+    ::sensory::calldata::AudioChunkRequest<Message>& request,
+    const AudioFileView& view
+) {
+    request.set_audio_content(view.mapping, view.data(), view.size());
+}
+
+/// @brief A source of audio that memory-maps a WAV or raw PCM file.
+///
+/// @details
+/// The file is mapped read-only and its header is validated on
+/// construction. Chunks are handed out as views into the mapping rather than
+/// being read into buffers, so streaming a file that is already in the
+/// format of the model (see `is_native`) through the `AudioChunkRequest` of a
+/// reactor sends the samples straight from the mapping. Files in other
+/// formats can pass the views to a `Resampler` or `AudioEncoder`, which read
+/// the samples in place.
+///
+/// @code
+/// AudioFileSource source("audio.wav");
+/// if (!source.is_native(16000, 1)) throw std::runtime_error("...");
+/// for (auto view = source.next(4096); !view.empty(); view = source.next(4096)) {
+///     sensory::api::v1::audio::TranscribeRequest request;
+///     set_audio_content(request, view);
+///     stream->Write(request);
+/// }
+/// @endcode
+///
+class AudioFileSource {
+ private:
+    /// The path of the file.
+    std::string path;
+    /// The mapping of the file, shared with the views of the source.
+    std::shared_ptr<const AudioFileMapping> mapping;
+    /// Whether the file has a WAV header.
+    bool has_header = false;
+    /// The sample rate of the audio in Hz.
+    uint32_t sample_rate = 0;
+    /// The number of interleaved channels.
+    uint32_t num_channels = 0;
+    /// The first sample of the audio in the mapping.
+    const int16_t* samples = nullptr;
+    /// The number of frames of the audio.
+    std::size_t num_frames = 0;
+    /// The frame that `next` returns next.
+    std::size_t position = 0;
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ///
+    AudioFileSource(const AudioFileSource& other) = delete;
+
+    /// @brief Assign to this object using the assignment operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const AudioFileSource& other) = delete;
+
+ public:
+    /// @brief Map a 16-bit PCM WAV file.
+    ///
+    /// @param path_ The path of the WAV file.
+    ///
+    /// @exception std::runtime_error If the file cannot be mapped or is not a
+    /// 16-bit PCM WAV file.
+    ///
+    explicit AudioFileSource(const std::string& path_);
+
+    /// @brief Map a headerless file of 16-bit little-endian PCM.
+    ///
+    /// @param path_ The path of the raw PCM file.
+    /// @param sample_rate_ The sample rate of the audio in Hz.
+    /// @param num_channels_ The number of interleaved channels.
+    ///
+    /// @exception std::invalid_argument If the sample rate or number of
+    /// channels is zero.
+    /// @exception std::runtime_error If the file cannot be mapped.
+    ///
+    /// @details
+    /// A trailing partial frame is ignored.
+    ///
+    AudioFileSource(const std::string& path_,
+        const uint32_t& sample_rate_,
+        const uint32_t& num_channels_
+    );
+
+    /// @brief Return the path of the file.
+    ///
+    /// @returns The path the source was created with.
+    ///
+    inline const std::string& get_path() const { return path; }
+
+    /// @brief Return whether the file has a WAV header.
+    ///
+    /// @returns `true` for a WAV file, `false` for raw PCM.
+    ///
+    inline bool is_wav() const { return has_header; }
+
+    /// @brief Return the sample rate of the audio.
+    ///
+    /// @returns The sample rate in Hz.
+    ///
+    inline uint32_t get_sample_rate() const { return sample_rate; }
+
+    /// @brief Return the number of channels of the audio.
+    ///
+    /// @returns The number of interleaved channels.
+    ///
+    inline uint32_t get_num_channels() const { return num_channels; }
+
+    /// @brief Return the length of the audio.
+    ///
+    /// @returns The number of frames of the audio.
+    ///
+    inline std::size_t get_num_frames() const { return num_frames; }
+
+    /// @brief Return whether the views can be streamed without conversion.
+    ///
+    /// @param target_sample_rate The sample rate the stream expects in Hz.
+    /// @param target_num_channels The number of channels the stream expects.
+    /// @returns `true` if the audio matches the format and the samples can be
+    /// read in place on this host, `false` otherwise.
+    ///
+    bool is_native(const uint32_t& target_sample_rate = 16000,
+        const uint32_t& target_num_channels = 1
+    ) const;
+
+    /// @brief Return a view of a range of frames.
+    ///
+    /// @param start The first frame of the view.
+    /// @param count The maximal number of frames of the view.
+    /// @returns A view of the frames, clipped to the end of the audio.
+    ///
+    AudioFileView view(const std::size_t& start, const std::size_t& count) const;
+
+    /// @brief Return a view of the next chunk of frames.
+    ///
+    /// @param count The maximal number of frames of the chunk.
+    /// @returns A view of the chunk, which is empty at the end of the audio.
+    ///
+    AudioFileView next(const std::size_t& count);
+
+    /// @brief Return the position of the source.
+    ///
+    /// @returns The frame that `next` returns next.
+    ///
+    inline std::size_t get_position() const { return position; }
+
+    /// @brief Return the number of frames that `next` has not returned yet.
+    ///
+    /// @returns The number of remaining frames.
+    ///
+    inline std::size_t get_remaining() const { return num_frames - position; }
+
+    /// @brief Move the position of the source.
+    ///
+    /// @param frame The frame that `next` should return next, clipped to the
+    /// end of the audio.
+    ///
+    inline void seek(const std::size_t& frame) { position = frame < num_frames ? frame : num_frames; }
+
+    /// @brief Copy the audio into memory.
+    ///
+    /// @returns The decoded audio, independent of the byte order of the host.
+    ///
+    PCMAudio to_pcm() const;
+};
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_FILE_SOURCE_HPP_
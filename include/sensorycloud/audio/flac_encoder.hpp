@@ -0,0 +1,213 @@
+// A streaming FLAC encoder for 16-bit PCM audio.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_FLAC_ENCODER_HPP_
+#define SENSORYCLOUD_AUDIO_FLAC_ENCODER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief Compute the CRC-8 of a FLAC frame header.
+///
+/// @param data The bytes to compute the CRC of.
+/// @param size The number of bytes.
+/// @returns The CRC-8 with polynomial x^8 + x^2 + x + 1.
+///
+uint8_t flac_crc8(const uint8_t* data, const std::size_t& size);
+
+/// @brief Compute the CRC-16 of a FLAC frame.
+///
+/// @param data The bytes to compute the CRC of.
+/// @param size The number of bytes.
+/// @returns The CRC-16 with polynomial x^16 + x^15 + x^2 + 1.
+///
+uint16_t flac_crc16(const uint8_t* data, const std::size_t& size);
+
+/// The minimal number of samples per channel in a FLAC frame, except for the
+/// last frame of a stream.
+constexpr uint32_t FLAC_MIN_BLOCK_SIZE = 16;
+
+/// @brief A streaming FLAC encoder for 16-bit PCM audio.
+///
+/// @details
+/// Each call to `encode` produces whole FLAC frames, so every chunk can be
+/// sent in its own message. The first chunk is prefixed with the `fLaC`
+/// marker and the `STREAMINFO` block. Chunks are split into balanced blocks
+/// of at least `FLAC_MIN_BLOCK_SIZE` samples, the minimal block size that
+/// the stream declares. Chunks that are too short to fill a block are held
+/// back and encoded with the next chunk, so call `flush` to encode them at
+/// the end of the stream, where FLAC allows a shorter block.
+///
+/// The encoder uses the variable block size strategy, independent channels,
+/// and chooses between constant, verbatim, and fixed-predictor subframes with
+/// partitioned Rice coding of the residual. This typically halves the size of
+/// speech compared to `LINEAR16` at a fraction of the cost of a full LPC
+/// encoder, which keeps it cheap enough for embedded devices.
+///
+class FLACEncoder {
+ private:
+    /// The sample rate of the audio in Hz.
+    const uint32_t sample_rate;
+    /// The number of interleaved channels.
+    const uint32_t num_channels;
+    /// The maximal number of samples per channel in a frame.
+    const uint32_t max_block_size;
+    /// The number of samples per channel that have been encoded.
+    uint64_t num_samples;
+    /// Whether the stream header has been written.
+    bool wrote_header;
+    /// The interleaved samples held back for the next frame.
+    std::vector<int16_t> pending;
+    /// The bytes of the frame that is being encoded.
+    std::vector<uint8_t> frame;
+    /// The bit accumulator of the frame writer.
+    uint64_t bits;
+    /// The number of bits in the accumulator.
+    uint32_t num_bits;
+    /// The samples of the channel that is being encoded.
+    std::vector<int32_t> channel;
+    /// The residual of the channel that is being encoded.
+    std::vector<uint32_t> residual;
+
+    /// @brief Write bits to the frame.
+    ///
+    /// @param value The value to write, in the low bits.
+    /// @param count The number of bits to write, at most 32.
+    ///
+    void write_bits(const uint32_t& value, const uint32_t& count);
+
+    /// @brief Write zero bits up to the next byte boundary.
+    void align_to_byte();
+
+    /// @brief Write the header of a frame.
+    ///
+    /// @param block_size The number of samples per channel in the frame.
+    ///
+    void write_frame_header(const uint32_t& block_size);
+
+    /// @brief Write the subframe of a channel.
+    ///
+    /// @param block_size The number of samples in the channel.
+    ///
+    void write_subframe(const uint32_t& block_size);
+
+    /// @brief Write a fixed-predictor residual with partitioned Rice coding.
+    ///
+    /// @param block_size The number of samples in the channel.
+    /// @param order The order of the predictor.
+    ///
+    void write_residual(const uint32_t& block_size, const uint32_t& order);
+
+    /// @brief Encode a single frame.
+    ///
+    /// @param samples The interleaved samples of the frame.
+    /// @param block_size The number of samples per channel in the frame.
+    /// @param output The string to append the frame to.
+    ///
+    void encode_frame(const int16_t* samples, const uint32_t& block_size, std::string& output);
+
+ public:
+    /// @brief Initialize a new FLAC encoder.
+    ///
+    /// @param sample_rate_ The sample rate of the audio in Hz.
+    /// @param num_channels_ The number of interleaved channels, in [1, 8].
+    /// @param max_block_size_ The maximal number of samples per channel in a
+    /// frame, in [16, 65535]. Longer chunks are split into several frames.
+    ///
+    /// @exception std::invalid_argument If a parameter is out of range.
+    ///
+    FLACEncoder(
+        const uint32_t& sample_rate_,
+        const uint32_t& num_channels_ = 1,
+        const uint32_t& max_block_size_ = 4096
+    );
+
+    /// @brief Return the sample rate of the audio.
+    ///
+    /// @returns The sample rate in Hz.
+    ///
+    inline uint32_t get_sample_rate() const { return sample_rate; }
+
+    /// @brief Return the number of channels of the audio.
+    ///
+    /// @returns The number of interleaved channels.
+    ///
+    inline uint32_t get_num_channels() const { return num_channels; }
+
+    /// @brief Return the number of samples that have been encoded.
+    ///
+    /// @returns The number of samples per channel, excluding those that are
+    /// held back.
+    ///
+    inline uint64_t get_num_samples() const { return num_samples; }
+
+    /// @brief Return the stream header.
+    ///
+    /// @returns The `fLaC` marker and the `STREAMINFO` metadata block.
+    ///
+    std::string get_stream_header() const;
+
+    /// @brief Encode a chunk of audio.
+    ///
+    /// @param samples The interleaved 16-bit samples.
+    /// @param num_frames The number of samples per channel.
+    /// @param output The string to append the encoded frames to. The stream
+    /// header is prepended on the first call.
+    ///
+    /// @details
+    /// If fewer than `FLAC_MIN_BLOCK_SIZE` samples per channel are available,
+    /// including those held back from earlier calls, they are held back and
+    /// nothing but the stream header is appended.
+    ///
+    void encode(const int16_t* samples, const std::size_t& num_frames, std::string& output);
+
+    /// @brief Encode the samples that are held back at the end of a stream.
+    ///
+    /// @param output The string to append the last frame to. Nothing is
+    /// appended if no samples are held back.
+    ///
+    void flush(std::string& output);
+
+    /// @brief Return the number of samples that are held back.
+    ///
+    /// @returns The number of samples per channel that `flush` or the next
+    /// call to `encode` will encode.
+    ///
+    inline std::size_t get_num_pending_frames() const { return pending.size() / num_channels; }
+};
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_FLAC_ENCODER_HPP_
@@ -0,0 +1,331 @@
+// Audio-to-result latency measurement for the SensoryCloud C++ SDK.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_LATENCY_TRACKER_HPP_
+#define SENSORYCLOUD_AUDIO_LATENCY_TRACKER_HPP_
+
+#include <grpcpp/support/status.h>
+#include <grpcpp/support/sync_stream.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include "sensorycloud/generated/v1/audio/audio.pb.h"
+#include "sensorycloud/util/latency_histogram.hpp"
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief Options for a latency tracker.
+struct LatencyTrackerOptions {
+    /// The sample rate of the audio in Hz.
+    uint32_t sample_rate = 16000;
+    /// The number of interleaved channels of the audio.
+    uint32_t num_channels = 1;
+    /// The number of most recent writes whose send times are kept. Results
+    /// for audio from older writes are not measured. Rounded up to a power
+    /// of two.
+    std::size_t capacity = 1024;
+    /// An optional histogram that is shared by many trackers to measure
+    /// aggregate latency, which must outlive the tracker.
+    ::sensory::util::LatencyHistogram* aggregate = nullptr;
+};
+
+/// @brief A tracker that joins the send times of audio with the times of
+/// the results that cover it.
+///
+/// @details
+/// Each write of audio records the frame that it ends at and the time that
+/// it was sent in a fixed-size ring. When a result arrives that ends at a
+/// time in the audio (the `endTimeMs` of the last word of a transcript, or
+/// the `resultEndTime` of an event), the ring is searched for the write that
+/// sent the last sample of the result and the time since that write is
+/// recorded as the audio-to-result latency. Only results that cover audio
+/// past the previous result are measured, so the partial transcripts that
+/// repeat earlier words do not inflate the latency.
+///
+/// The latencies are recorded in a histogram of the tracker and, optionally,
+/// a histogram that is shared by many trackers. Writes and results may come
+/// from different threads.
+///
+class LatencyTracker {
+ public:
+    /// The clock that send and result times are measured with.
+    typedef std::chrono::steady_clock Clock;
+
+ private:
+    /// @brief The end and send time of a write.
+    struct Send {
+        /// The number of frames written up to and including this write.
+        uint64_t end_frame;
+        /// The time the write was sent.
+        Clock::time_point sent_at;
+    };
+
+    /// The options of the tracker.
+    const LatencyTrackerOptions options;
+    /// The mutex for guarding the ring and the position of the results.
+    mutable std::mutex mutex;
+    /// The ring of the most recent writes.
+    std::vector<Send> ring;
+    /// The number of writes that were recorded.
+    uint64_t num_sends = 0;
+    /// The number of frames that were written.
+    uint64_t position = 0;
+    /// The frame at which the audio of the retained writes begins.
+    uint64_t retained_position = 0;
+    /// The frame at which the latest measured result ends.
+    uint64_t result_position = 0;
+    /// The number of results for audio whose write left the ring.
+    uint64_t num_unmatched = 0;
+    /// The latencies of the results of this tracker.
+    ::sensory::util::LatencyHistogram histogram;
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ///
+    LatencyTracker(const LatencyTracker& other) = delete;
+
+    /// @brief Assign to this object using the assignment operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const LatencyTracker& other) = delete;
+
+ public:
+    /// @brief Initialize a new latency tracker.
+    ///
+    /// @param options_ The options of the tracker.
+    ///
+    /// @exception std::invalid_argument If the sample rate, number of
+    /// channels, or capacity is zero.
+    ///
+    explicit LatencyTracker(const LatencyTrackerOptions& options_ = {});
+
+    /// @brief Return the options of the tracker.
+    inline const LatencyTrackerOptions& get_options() const { return options; }
+
+    /// @brief Record that audio was sent.
+    ///
+    /// @param num_frames The number of frames in the write.
+    /// @param sent_at The time the write was sent.
+    ///
+    void on_write(const uint64_t& num_frames, const Clock::time_point& sent_at = Clock::now());
+
+    /// @brief Record that a result for the audio arrived.
+    ///
+    /// @param end_ms The time in the audio at which the result ends.
+    /// @param received_at The time the result arrived.
+    /// @returns `true` if the latency of the result was recorded, `false` if
+    /// the result does not cover new audio or the write of its audio left the
+    /// ring.
+    ///
+    bool on_result(const uint64_t& end_ms, const Clock::time_point& received_at = Clock::now());
+
+    /// @brief Record the latency of a transcription response.
+    ///
+    /// @param response The response to measure, ending at its latest word.
+    /// @param received_at The time the response arrived.
+    /// @returns `true` if the latency of the response was recorded.
+    ///
+    bool observe(const ::sensory::api::v1::audio::TranscribeResponse& response,
+        const Clock::time_point& received_at = Clock::now()
+    );
+
+    /// @brief Record the latency of an event validation response.
+    ///
+    /// @param response The response to measure, ending at its result end
+    /// time. Responses without a detected event are not measured.
+    /// @param received_at The time the response arrived.
+    /// @returns `true` if the latency of the response was recorded.
+    ///
+    bool observe(const ::sensory::api::v1::audio::ValidateEventResponse& response,
+        const Clock::time_point& received_at = Clock::now()
+    );
+
+    /// @brief Ignore a response that has no times.
+    ///
+    /// @tparam Response The type of the response.
+    /// @returns `false`.
+    ///
+    template<typename Response>
+    inline bool observe(const Response&, const Clock::time_point& = Clock::now()) { return false; }
+
+    /// @brief Return the latencies of the results of this tracker.
+    inline const ::sensory::util::LatencyHistogram& get_histogram() const { return histogram; }
+
+    /// @brief Return the count, mean, p50, p95, p99, and maximum latency of
+    /// the results of this tracker.
+    inline ::sensory::util::LatencySummary get_summary() const { return histogram.get_summary(); }
+
+    /// @brief Return the number of frames that were written.
+    uint64_t get_num_frames() const;
+
+    /// @brief Return the number of results whose audio left the ring before
+    /// the result arrived.
+    uint64_t get_num_unmatched() const;
+};
+
+/// @brief A stream that measures the audio-to-result latency of the stream
+/// it wraps.
+///
+/// @tparam Request The type of request message, e.g., `TranscribeRequest` or
+/// `ValidateEventRequest`.
+/// @tparam Response The type of response message.
+///
+/// @details
+/// The audio of each request is recorded just before it is written, and each
+/// response is observed as soon as it is read. The stream may wrap a
+/// `ResumableStream`, in which case the latency of results for replayed
+/// audio includes the time spent reconnecting.
+/// Audio must be raw `LINEAR16`, so that the size of a request determines
+/// the number of frames it sends.
+///
+/// @code
+/// util::LatencyHistogram all_streams;
+/// LatencyTrackerOptions options;
+/// options.aggregate = &all_streams;
+/// LatencyTrackingStream<TranscribeRequest, TranscribeResponse> stream(
+///     cloud.audio.transcribe(&context, audio_config, transcribe_config),
+///     options);
+/// // ... write and read as usual ...
+/// const auto summary = stream.get_tracker().get_summary();
+/// @endcode
+///
+template<typename Request, typename Response>
+class LatencyTrackingStream : public ::grpc::ClientReaderWriterInterface<Request, Response> {
+ public:
+    /// The type of the underlying stream.
+    typedef std::unique_ptr<::grpc::ClientReaderWriterInterface<Request, Response>> Stream;
+
+ private:
+    /// The underlying stream.
+    Stream stream;
+    /// The tracker of the latency of the stream.
+    LatencyTracker tracker;
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ///
+    LatencyTrackingStream(const LatencyTrackingStream& other) = delete;
+
+    /// @brief Assign to this object using the assignment operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const LatencyTrackingStream& other) = delete;
+
+ public:
+    /// @brief Wrap a stream.
+    ///
+    /// @param stream_ The stream to measure.
+    /// @param options_ The options of the tracker.
+    ///
+    /// @exception std::invalid_argument If the stream is `nullptr`, or the
+    /// options are invalid.
+    ///
+    LatencyTrackingStream(Stream stream_, const LatencyTrackerOptions& options_ = {}) :
+        stream(std::move(stream_)), tracker(options_) {
+        if (stream == nullptr)
+            throw std::invalid_argument("LatencyTrackingStream requires a stream.");
+    }
+
+    using ::grpc::internal::WriterInterface<Request>::Write;
+
+    /// @brief Wait for the initial metadata of the stream.
+    void WaitForInitialMetadata() override { stream->WaitForInitialMetadata(); }
+
+    /// @brief Return the size of the next message of the stream.
+    ///
+    /// @param size The size of the next message.
+    /// @returns `true` if a message is available.
+    ///
+    bool NextMessageSize(uint32_t* size) override { return stream->NextMessageSize(size); }
+
+    /// @brief Record the audio of a request and write it.
+    ///
+    /// @param request The request to write.
+    /// @param write_options The options of the write.
+    /// @returns `true` if the request was written.
+    ///
+    bool Write(const Request& request, ::grpc::WriteOptions write_options) override {
+        const auto num_bytes = request.audiocontent().size();
+        const auto frame_size = sizeof(int16_t) * tracker.get_options().num_channels;
+        if (num_bytes > 0) tracker.on_write(num_bytes / frame_size);
+        return stream->Write(request, write_options);
+    }
+
+    /// @brief Signal that no more requests will be written.
+    ///
+    /// @returns `true` if the signal was sent.
+    ///
+    bool WritesDone() override { return stream->WritesDone(); }
+
+    /// @brief Read a response and record its latency.
+    ///
+    /// @param response The output buffer for the response.
+    /// @returns `true` if a response was read.
+    ///
+    bool Read(Response* response) override {
+        if (!stream->Read(response)) return false;
+        tracker.observe(*response);
+        return true;
+    }
+
+    /// @brief Wait for the stream to end.
+    ///
+    /// @returns The final status of the stream.
+    ///
+    ::grpc::Status Finish() override { return stream->Finish(); }
+
+    /// @brief Return the tracker of the latency of the stream.
+    inline const LatencyTracker& get_tracker() const { return tracker; }
+};
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_LATENCY_TRACKER_HPP_
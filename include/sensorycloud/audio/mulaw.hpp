@@ -0,0 +1,81 @@
+// Vectorized G.711 mu-law encoding of 16-bit PCM audio.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_MULAW_HPP_
+#define SENSORYCLOUD_AUDIO_MULAW_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief Encode a 16-bit sample with G.711 mu-law.
+///
+/// @param sample The linear 16-bit sample.
+/// @returns The 8-bit mu-law code of the sample.
+///
+uint8_t mulaw_encode(const int16_t& sample);
+
+/// @brief Decode a G.711 mu-law code to a 16-bit sample.
+///
+/// @param code The 8-bit mu-law code.
+/// @returns The linear 16-bit sample.
+///
+int16_t mulaw_decode(const uint8_t& code);
+
+/// @brief Encode 16-bit samples with G.711 mu-law using a scalar lookup table.
+///
+/// @param samples The linear 16-bit samples.
+/// @param num_samples The number of samples to encode.
+/// @param output The buffer for the `num_samples` mu-law codes.
+///
+/// @details
+/// This is the reference implementation of `mulaw_encode` for platforms
+/// without SIMD support and for benchmarking the vectorized kernels.
+///
+void mulaw_encode_scalar(const int16_t* samples, const std::size_t& num_samples, uint8_t* output);
+
+/// @brief Encode 16-bit samples with G.711 mu-law.
+///
+/// @param samples The linear 16-bit samples.
+/// @param num_samples The number of samples to encode.
+/// @param output The buffer for the `num_samples` mu-law codes.
+///
+/// @details
+/// The samples are encoded with the widest SIMD instruction set that the SDK
+/// was compiled for (see `get_simd_instruction_set`) and the output is
+/// identical to `mulaw_encode_scalar`.
+///
+void mulaw_encode(const int16_t* samples, const std::size_t& num_samples, uint8_t* output);
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_MULAW_HPP_
@@ -0,0 +1,323 @@
+// Per-channel transcription of multi-channel audio for the SensoryCloud C++ SDK.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_MULTI_CHANNEL_TRANSCRIBER_HPP_
+#define SENSORYCLOUD_AUDIO_MULTI_CHANNEL_TRANSCRIBER_HPP_
+
+#include <grpcpp/support/status.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "sensorycloud/generated/v1/audio/audio.pb.h"
+#include "sensorycloud/audio/offline_transcribe_reactor.hpp"
+#include "sensorycloud/audio/pcm.hpp"
+#include "sensorycloud/audio/resampler.hpp"
+#include "sensorycloud/audio/wav.hpp"
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief Options for transcribing each channel of a recording.
+struct MultiChannelTranscribeOptions {
+    /// The number of samples in each audio message.
+    std::size_t chunk_size = 4096;
+    /// The sample rate that each channel is converted to before streaming.
+    uint32_t sample_rate = 16000;
+    /// The language code of the audio.
+    std::string language_code = "en";
+    /// The encoding of the audio on the wire.
+    ::sensory::api::v1::audio::AudioConfig_AudioEncoding encoding =
+        ::sensory::api::v1::audio::AudioConfig_AudioEncoding_LINEAR16;
+    /// The transcription config for every stream (e.g., with the model name
+    /// and user ID). Offline mode is enabled for every stream.
+    ::sensory::api::v1::audio::TranscribeConfig transcribe_config;
+    /// The name of the speaker on each channel, e.g., `{"agent", "customer"}`.
+    /// Channels without a name are called `channel <index>`.
+    std::vector<std::string> speakers;
+};
+
+/// @brief A word of a multi-channel transcript.
+struct SpeakerWord {
+    /// The name of the speaker of the word.
+    std::string speaker;
+    /// The index of the channel of the word.
+    uint32_t channel = 0;
+    /// The word, with times relative to the start of the recording.
+    ::sensory::api::v1::audio::TranscribeWord word;
+};
+
+/// @brief The transcript of a multi-channel recording.
+struct MultiChannelTranscript {
+    /// The final status of the stream of each channel.
+    std::vector<::grpc::Status> statuses;
+    /// The transcript of each channel.
+    std::vector<std::string> transcripts;
+    /// The words of every channel, ordered by time.
+    std::vector<SpeakerWord> words;
+
+    /// @brief Return `true` if the stream of every channel succeeded.
+    inline bool ok() const {
+        for (const auto& status : statuses)
+            if (!status.ok()) return false;
+        return true;
+    }
+
+    /// @brief Return the transcript as one line per turn of a speaker.
+    ///
+    /// @returns Lines of the form `<speaker>: <words>`.
+    ///
+    std::string to_string() const;
+};
+
+/// @brief Return the name of the speaker on a channel.
+///
+/// @param speakers The names of the speakers by channel.
+/// @param channel The index of the channel.
+/// @returns The name of the speaker, or `channel <index>` if the channel
+/// has no name.
+///
+std::string get_speaker(const std::vector<std::string>& speakers, const uint32_t& channel);
+
+/// @brief Merge the transcripts of channels into one speaker-tagged
+/// transcript.
+///
+/// @param channels The words of each channel.
+/// @param speakers The names of the speakers by channel.
+/// @returns The words of every channel, ordered by the time that they
+/// begin. Words that begin at the same time are ordered by channel, and the
+/// words of a channel keep their order.
+///
+std::vector<SpeakerWord> merge_channel_transcripts(
+    const std::vector<std::vector<::sensory::api::v1::audio::TranscribeWord>>& channels,
+    const std::vector<std::string>& speakers
+);
+
+/// @brief Format a speaker-tagged transcript as turns.
+///
+/// @param words The words of the transcript, ordered by time.
+/// @returns One line of the form `<speaker>: <words>` for each run of words
+/// by the same speaker, separated by newlines.
+///
+std::string format_speaker_transcript(const std::vector<SpeakerWord>& words);
+
+/// @brief An engine that transcribes each channel of a recording in its
+/// own stream.
+/// @tparam Service The type of the audio service, e.g.,
+/// `AudioService<CredentialStore>`.
+///
+/// @details
+/// Recordings with a speaker on each channel (e.g., a call with the agent on
+/// the left channel and the customer on the right) are transcribed more
+/// accurately one channel at a time than mixed down to mono. The recording
+/// is split into channels with the SIMD kernels of `deinterleave`, each
+/// channel is resampled, and one offline `Transcribe` stream per channel is
+/// opened at once on the callback API, so a recording takes about as long
+/// as one of its channels. When every stream has completed, the words of
+/// the channels are merged by time into a speaker-tagged transcript.
+///
+/// @code
+/// MultiChannelTranscribeOptions options;
+/// options.transcribe_config.set_modelname("speech_recognition_en");
+/// options.transcribe_config.set_userid("calls");
+/// options.speakers = {"agent", "customer"};
+/// MultiChannelTranscriber<AudioService<FileSystemCredentialStore>> transcriber(cloud.audio, options);
+/// const auto transcript = transcriber.transcribe(read_wav("call.wav"));
+/// std::cout << transcript.to_string() << std::endl;
+/// @endcode
+///
+template<typename Service>
+class MultiChannelTranscriber {
+ private:
+    /// @brief A transcription stream for a channel.
+    class Job : public OfflineTranscribeReactor<Service> {
+     public:
+        /// The index of the channel that is being transcribed.
+        const uint32_t channel;
+
+        /// @brief Initialize a new job.
+        ///
+        /// @param options The options of the engine.
+        /// @param channel_ The index of the channel to transcribe.
+        /// @param audio The audio of the channel.
+        /// @param audio_config The audio config of the stream.
+        ///
+        Job(const MultiChannelTranscribeOptions& options,
+            const uint32_t& channel_,
+            std::vector<int16_t>&& audio,
+            ::sensory::api::v1::audio::AudioConfig* audio_config
+        ) : OfflineTranscribeReactor<Service>(
+                std::make_shared<const std::vector<int16_t>>(std::move(audio)),
+                options.chunk_size,
+                options.encoding,
+                audio_config
+            ),
+            channel(channel_) { }
+    };
+
+    /// The audio service to open streams with.
+    const Service& service;
+    /// The options of the engine.
+    const MultiChannelTranscribeOptions options;
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ///
+    MultiChannelTranscriber(const MultiChannelTranscriber& other) = delete;
+
+    /// @brief Assign to this object using the assignment operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const MultiChannelTranscriber& other) = delete;
+
+ public:
+    /// @brief Initialize a new multi-channel transcription engine.
+    ///
+    /// @param service_ The audio service to open streams with.
+    /// @param options_ The options of the engine.
+    ///
+    /// @exception std::invalid_argument If the chunk size or sample rate is
+    /// zero.
+    ///
+    explicit MultiChannelTranscriber(
+        const Service& service_,
+        const MultiChannelTranscribeOptions& options_ = MultiChannelTranscribeOptions()
+    ) : service(service_), options(options_) {
+        if (options.chunk_size == 0 || options.sample_rate == 0)
+            throw std::invalid_argument("MultiChannelTranscriber options must be positive.");
+    }
+
+    /// @brief Return the options of the engine.
+    ///
+    /// @returns The options that the engine was initialized with.
+    ///
+    inline const MultiChannelTranscribeOptions& get_options() const { return options; }
+
+    /// @brief Transcribe each channel of a recording.
+    ///
+    /// @param pcm The interleaved audio of the recording.
+    /// @returns The status and transcript of each channel, and the merged
+    /// speaker-tagged transcript.
+    ///
+    /// @exception std::invalid_argument If the audio has no channels or no
+    /// sample rate.
+    ///
+    /// @details
+    /// This function blocks until the stream of every channel has completed.
+    /// If a stream fails to open, the streams that are already open are
+    /// cancelled and awaited before the error is rethrown.
+    /// The merged transcript only has the words of the channels whose
+    /// streams succeeded.
+    ///
+    MultiChannelTranscript transcribe(const PCMAudio& pcm) const {
+        if (pcm.num_channels == 0 || pcm.sample_rate == 0)
+            throw std::invalid_argument("MultiChannelTranscriber requires audio with channels and a sample rate.");
+        // Split the recording into one buffer per channel.
+        const auto num_frames = pcm.get_num_frames();
+        std::vector<std::vector<int16_t>> channels(pcm.num_channels, std::vector<int16_t>(num_frames));
+        std::vector<int16_t*> outputs;
+        for (auto& channel : channels) outputs.push_back(channel.data());
+        deinterleave(pcm.samples.data(), num_frames, pcm.num_channels, outputs.data());
+        // Prepare the audio of every channel before opening any stream, so
+        // that a failure does not leave streams running.
+        std::vector<std::unique_ptr<Job>> jobs;
+        std::vector<std::unique_ptr<::sensory::api::v1::audio::AudioConfig>> audio_configs;
+        for (uint32_t channel = 0; channel < pcm.num_channels; channel++) {
+            std::vector<int16_t> audio;
+            Resampler resampler(pcm.sample_rate, options.sample_rate);
+            resampler.process(channels[channel].data(), num_frames, audio);
+            resampler.flush(audio);
+            std::vector<int16_t>().swap(channels[channel]);
+            std::unique_ptr<::sensory::api::v1::audio::AudioConfig> audio_config(new ::sensory::api::v1::audio::AudioConfig);
+            audio_config->set_sampleratehertz(options.sample_rate);
+            audio_config->set_audiochannelcount(1);
+            audio_config->set_languagecode(options.language_code);
+            jobs.emplace_back(new Job(options, channel, std::move(audio), audio_config.get()));
+            audio_configs.push_back(std::move(audio_config));
+        }
+        // Open a stream for every channel before waiting for any of them.
+        std::size_t num_started = 0;
+        ::sensory::api::v1::audio::TranscribeConfig* transcribe_config = nullptr;
+        try {
+            for (; num_started < jobs.size(); num_started++) {
+                transcribe_config = new ::sensory::api::v1::audio::TranscribeConfig(options.transcribe_config);
+                transcribe_config->set_doofflinemode(true);
+                service.transcribe(jobs[num_started].get(), audio_configs[num_started].get(), transcribe_config);
+                // The service took ownership of the configs.
+                audio_configs[num_started].release();
+                transcribe_config = nullptr;
+                jobs[num_started]->StartCall();
+            }
+        } catch (...) {
+            // Free the configs of the stream that failed to open, unless the
+            // service took ownership of them.
+            if (transcribe_config != nullptr) {
+                const bool has_config = jobs[num_started]->request.has_config();
+                if (has_config || transcribe_config->has_audio())
+                    audio_configs[num_started].release();
+                if (!has_config) delete transcribe_config;
+            }
+            // The jobs cannot be destroyed while their streams are running.
+            for (std::size_t index = 0; index < num_started; index++) {
+                jobs[index]->tryCancel();
+                jobs[index]->await();
+            }
+            throw;
+        }
+        // Collect the transcript of each channel as its stream completes.
+        MultiChannelTranscript transcript;
+        std::vector<std::vector<::sensory::api::v1::audio::TranscribeWord>> words(jobs.size());
+        for (auto& job : jobs) {
+            auto status = job->await();
+            if (status.ok() && !job->error.empty())
+                status = ::grpc::Status(::grpc::StatusCode::INTERNAL, job->error);
+            transcript.statuses.push_back(status);
+            transcript.transcripts.push_back(status.ok() ? job->aggregator.get_transcript() : "");
+            if (status.ok()) words[job->channel] = job->aggregator.get_word_list();
+        }
+        transcript.words = merge_channel_transcripts(words, options.speakers);
+        return transcript;
+    }
+};
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_MULTI_CHANNEL_TRANSCRIBER_HPP_
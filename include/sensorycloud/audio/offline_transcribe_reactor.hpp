@@ -0,0 +1,151 @@
+// A reactor that streams buffered audio to an offline transcription.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_OFFLINE_TRANSCRIBE_REACTOR_HPP_
+#define SENSORYCLOUD_AUDIO_OFFLINE_TRANSCRIBE_REACTOR_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+#include "sensorycloud/generated/v1/audio/audio.pb.h"
+#include "sensorycloud/audio/audio_encoder.hpp"
+#include "sensorycloud/util/transcript_aggregator.hpp"
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief A `Transcribe` stream that writes a buffer of audio and
+/// aggregates the transcript.
+/// @tparam Service The type of the audio service, e.g.,
+/// `AudioService<CredentialStore>`.
+///
+/// @details
+/// The audio is written in chunks from the reactions of the stream, so no
+/// thread waits on the stream while it is in flight. The last chunk flushes
+/// the encoder and carries the `FINAL` post-processing action so the server
+/// finalizes the transcript, after which the writes are closed. Responses
+/// are aggregated with a `TranscriptAggregator` as they are read. Engines
+/// derive from this reactor to attach their own state to each stream.
+///
+template<typename Service>
+class OfflineTranscribeReactor : public Service::TranscribeBidiReactor {
+ private:
+    /// The audio to transcribe.
+    const std::shared_ptr<const std::vector<int16_t>> audio;
+    /// The number of samples in each audio message.
+    const std::size_t chunk_size;
+    /// The chunk of audio that is being written.
+    ::sensory::api::v1::audio::TranscribeRequest chunk;
+    /// The encoder of the audio content.
+    std::unique_ptr<AudioEncoder> encoder;
+    /// The number of samples that have been written.
+    std::size_t offset;
+    /// Whether the final chunk has been written.
+    bool wrote_final;
+
+ public:
+    /// The aggregator of the transcript.
+    ::sensory::util::TranscriptAggregator aggregator;
+    /// An error that occurred while aggregating the transcript.
+    std::string error;
+
+    /// @brief Initialize a new reactor.
+    ///
+    /// @param audio_ The mono audio to transcribe.
+    /// @param chunk_size_ The number of samples in each audio message.
+    /// @param encoding The encoding of the audio on the wire.
+    /// @param audio_config The audio config of the stream. Its encoding is
+    /// set to `encoding`.
+    ///
+    OfflineTranscribeReactor(
+        const std::shared_ptr<const std::vector<int16_t>>& audio_,
+        const std::size_t& chunk_size_,
+        const ::sensory::api::v1::audio::AudioConfig_AudioEncoding& encoding,
+        ::sensory::api::v1::audio::AudioConfig* audio_config
+    ) : audio(audio_),
+        chunk_size(chunk_size_),
+        encoder(new AudioEncoder(audio_config, encoding)),
+        offset(0),
+        wrote_final(false) { }
+
+    /// @brief Return the audio that the stream transcribes.
+    ///
+    /// @returns The mono audio that the reactor was initialized with.
+    ///
+    inline const std::vector<int16_t>& get_audio() const { return *audio; }
+
+    /// @brief Write the next chunk of audio after the previous write.
+    ///
+    /// @param ok Whether the previous write succeeded.
+    ///
+    void OnWriteDone(bool ok) override {
+        if (!ok) return;  // The stream broke, `OnDone` will follow.
+        if (wrote_final) {
+            this->StartWritesDone();
+            return;
+        }
+        const auto& samples = *audio;
+        const std::size_t size = std::min(chunk_size, samples.size() - offset);
+        chunk.Clear();
+        encoder->encode(samples.data() + offset, size, *chunk.mutable_audiocontent());
+        offset += size;
+        if (offset == samples.size()) {
+            encoder->flush(*chunk.mutable_audiocontent());
+            // Mark the last chunk so the server finalizes the transcript.
+            auto action = new ::sensory::api::v1::audio::AudioRequestPostProcessingAction;
+            action->set_action(::sensory::api::v1::audio::FINAL);
+            chunk.set_allocated_postprocessingaction(action);
+            wrote_final = true;
+        }
+        this->StartWrite(&chunk);
+    }
+
+    /// @brief Aggregate a response and read the next one.
+    ///
+    /// @param ok Whether the read succeeded.
+    ///
+    void OnReadDone(bool ok) override {
+        if (!ok) return;
+        try {
+            aggregator.process_response(this->response.wordlist());
+        } catch (const std::exception& exception) {
+            error = exception.what();
+        }
+        this->StartRead(&this->response);
+    }
+};
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_OFFLINE_TRANSCRIBE_REACTOR_HPP_
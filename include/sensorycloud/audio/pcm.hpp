@@ -0,0 +1,341 @@
+// Vectorized format conversion and level metering of PCM audio.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_PCM_HPP_
+#define SENSORYCLOUD_AUDIO_PCM_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief A generator of triangular (TPDF) dither noise.
+///
+/// @details
+/// The noise is the sum of two uniform variables and spans (-1, 1) least
+/// significant bits of the 16-bit output, which decorrelates the
+/// quantization error from the signal. The generator is a deterministic
+/// xorshift sequence, so conversions are reproducible for a given seed.
+///
+class TpdfDither {
+ private:
+    /// The state of the xorshift generator.
+    uint32_t state;
+
+ public:
+    /// @brief Initialize a new dither generator.
+    ///
+    /// @param seed The seed of the noise sequence.
+    ///
+    explicit TpdfDither(const uint32_t& seed = 1) : state(seed == 0 ? 1 : seed) { }
+
+    /// @brief Generate dither noise.
+    ///
+    /// @param noise The buffer for the noise in 16-bit LSBs.
+    /// @param num_samples The number of noise samples to generate.
+    ///
+    void fill(float* noise, const std::size_t& num_samples);
+};
+
+/// @brief Convert float samples in [-1, 1) to 16-bit samples using scalar
+/// code.
+///
+/// @param samples The float samples, which must be finite.
+/// @param num_samples The number of samples to convert.
+/// @param output The buffer for the `num_samples` 16-bit samples.
+/// @param dither An optional dither generator, `nullptr` to round without
+/// dither.
+/// @returns The number of samples that were clipped to the 16-bit range.
+///
+/// @details
+/// This is the reference implementation of `float_to_int16` for platforms
+/// without SIMD support and for benchmarking the vectorized kernels.
+///
+std::size_t float_to_int16_scalar(const float* samples,
+    const std::size_t& num_samples,
+    int16_t* output,
+    TpdfDither* dither = nullptr
+);
+
+/// @brief Convert float samples in [-1, 1) to 16-bit samples.
+///
+/// @param samples The float samples, which must be finite.
+/// @param num_samples The number of samples to convert.
+/// @param output The buffer for the `num_samples` 16-bit samples.
+/// @param dither An optional dither generator, `nullptr` to round without
+/// dither.
+/// @returns The number of samples that were clipped to the 16-bit range.
+///
+/// @details
+/// Samples are scaled by 32768, dithered, rounded to the nearest integer
+/// (ties to even), and saturated. The output is identical to
+/// `float_to_int16_scalar` for the same dither state.
+///
+std::size_t float_to_int16(const float* samples,
+    const std::size_t& num_samples,
+    int16_t* output,
+    TpdfDither* dither = nullptr
+);
+
+/// @brief Convert full-scale 32-bit samples to 16-bit samples using scalar
+/// code.
+///
+/// @param samples The 32-bit samples (e.g., 24-bit audio in the high bits).
+/// @param num_samples The number of samples to convert.
+/// @param output The buffer for the `num_samples` 16-bit samples.
+/// @param dither An optional dither generator, `nullptr` to round without
+/// dither.
+/// @returns The number of samples that were clipped to the 16-bit range.
+///
+/// @details
+/// This is the reference implementation of `int32_to_int16`.
+///
+std::size_t int32_to_int16_scalar(const int32_t* samples,
+    const std::size_t& num_samples,
+    int16_t* output,
+    TpdfDither* dither = nullptr
+);
+
+/// @brief Convert full-scale 32-bit samples to 16-bit samples.
+///
+/// @param samples The 32-bit samples (e.g., 24-bit audio in the high bits).
+/// @param num_samples The number of samples to convert.
+/// @param output The buffer for the `num_samples` 16-bit samples.
+/// @param dither An optional dither generator, `nullptr` to round without
+/// dither.
+/// @returns The number of samples that were clipped to the 16-bit range.
+/// Without dither, only samples above `INT16_MAX * 65536` clip.
+///
+/// @details
+/// Samples are scaled by 2^-16, dithered, rounded, and saturated. The output
+/// is identical to `int32_to_int16_scalar` for the same dither state.
+///
+std::size_t int32_to_int16(const int32_t* samples,
+    const std::size_t& num_samples,
+    int16_t* output,
+    TpdfDither* dither = nullptr
+);
+
+/// @brief Split interleaved audio into one buffer per channel using scalar
+/// code.
+///
+/// @param samples The interleaved 16-bit samples.
+/// @param num_frames The number of samples per channel.
+/// @param num_channels The number of interleaved channels.
+/// @param outputs The `num_channels` buffers for `num_frames` samples each.
+///
+/// @exception std::invalid_argument If `num_channels` is zero.
+///
+void deinterleave_scalar(const int16_t* samples,
+    const std::size_t& num_frames,
+    const uint32_t& num_channels,
+    int16_t* const* outputs
+);
+
+/// @brief Split interleaved audio into one buffer per channel.
+///
+/// @param samples The interleaved 16-bit samples.
+/// @param num_frames The number of samples per channel.
+/// @param num_channels The number of interleaved channels.
+/// @param outputs The `num_channels` buffers for `num_frames` samples each.
+///
+/// @exception std::invalid_argument If `num_channels` is zero.
+///
+/// @details
+/// Stereo audio is split with the SIMD kernels of the SDK.
+///
+void deinterleave(const int16_t* samples,
+    const std::size_t& num_frames,
+    const uint32_t& num_channels,
+    int16_t* const* outputs
+);
+
+/// @brief The level of a chunk of audio relative to full scale.
+struct AudioLevel {
+    /// The root mean square of the samples in [0, 1].
+    float rms = 0.f;
+    /// The largest absolute sample in [0, 1].
+    float peak = 0.f;
+};
+
+/// @brief Measure the level of 16-bit audio using scalar code.
+///
+/// @param samples The 16-bit samples.
+/// @param num_samples The number of samples.
+/// @returns The RMS and peak of the samples, zero for an empty buffer.
+///
+/// @details
+/// This is the reference implementation of `measure_level`.
+///
+AudioLevel measure_level_scalar(const int16_t* samples, const std::size_t& num_samples);
+
+/// @brief Measure the level of 16-bit audio.
+///
+/// @param samples The 16-bit samples.
+/// @param num_samples The number of samples.
+/// @returns The RMS and peak of the samples, zero for an empty buffer.
+///
+/// @details
+/// The sum of squares is accumulated exactly in 64-bit integers, so the
+/// output is identical to `measure_level_scalar`.
+///
+AudioLevel measure_level(const int16_t* samples, const std::size_t& num_samples);
+
+/// @brief Convert a level relative to full scale to decibels.
+///
+/// @param level The level in [0, 1].
+/// @returns The level in dBFS, or -120dB for silence.
+///
+float to_dbfs(const float& level);
+
+/// @brief A level meter that measures audio on the streaming path.
+///
+/// @details
+/// The meter measures each chunk as it is captured, before it is sent, so a
+/// user interface can display the level without waiting for the
+/// `audioEnergy` of a server response. `process` is called on the capture
+/// thread and the getters may be called from any thread.
+///
+/// @code
+/// LevelMeter meter;
+/// while (capture(samples, num_samples)) {
+///     meter.process(samples, num_samples);
+///     stream->Write(request);
+/// }
+/// // On the user interface thread.
+/// draw_meter(to_dbfs(meter.get_level().rms), to_dbfs(meter.get_peak_hold()));
+/// @endcode
+///
+class LevelMeter {
+ private:
+    /// The RMS of the last chunk.
+    std::atomic<float> rms;
+    /// The peak of the last chunk.
+    std::atomic<float> peak;
+    /// The largest peak since the peak hold was reset.
+    std::atomic<float> peak_hold;
+
+ public:
+    /// @brief Initialize a new level meter.
+    LevelMeter() : rms(0.f), peak(0.f), peak_hold(0.f) { }
+
+    /// @brief Measure a chunk of audio.
+    ///
+    /// @param samples The 16-bit samples.
+    /// @param num_samples The number of samples.
+    /// @returns The level of the chunk.
+    ///
+    AudioLevel process(const int16_t* samples, const std::size_t& num_samples);
+
+    /// @brief Return the level of the last chunk.
+    ///
+    /// @returns The RMS and peak of the last chunk.
+    ///
+    inline AudioLevel get_level() const {
+        AudioLevel level;
+        level.rms = rms.load();
+        level.peak = peak.load();
+        return level;
+    }
+
+    /// @brief Return the largest peak since the peak hold was reset.
+    ///
+    /// @returns The peak in [0, 1].
+    ///
+    inline float get_peak_hold() const { return peak_hold.load(); }
+
+    /// @brief Reset the peak hold.
+    inline void reset_peak_hold() { peak_hold = 0.f; }
+};
+
+/// @brief A stateful converter of float or 32-bit audio to 16-bit audio.
+///
+/// @details
+/// The converter keeps the state of the dither across chunks and counts the
+/// samples that were clipped, so it can sit between a capture callback that
+/// produces float or 32-bit samples and a `LINEAR16` stream.
+///
+class PcmConverter {
+ private:
+    /// The dither generator.
+    TpdfDither dither;
+    /// Whether the output is dithered.
+    const bool is_dithered;
+    /// The number of samples that were converted.
+    uint64_t num_samples = 0;
+    /// The number of samples that were clipped.
+    uint64_t num_clipped = 0;
+
+ public:
+    /// @brief Initialize a new converter.
+    ///
+    /// @param is_dithered_ Whether to dither the output.
+    /// @param seed The seed of the dither noise.
+    ///
+    explicit PcmConverter(const bool& is_dithered_ = true, const uint32_t& seed = 1) :
+        dither(seed), is_dithered(is_dithered_) { }
+
+    /// @brief Convert float samples in [-1, 1).
+    ///
+    /// @param samples The float samples.
+    /// @param num_samples_ The number of samples.
+    /// @param output The vector to replace with the 16-bit samples.
+    /// @returns The number of samples that were clipped in this chunk.
+    ///
+    std::size_t convert(const float* samples, const std::size_t& num_samples_, std::vector<int16_t>& output);
+
+    /// @brief Convert full-scale 32-bit samples.
+    ///
+    /// @param samples The 32-bit samples.
+    /// @param num_samples_ The number of samples.
+    /// @param output The vector to replace with the 16-bit samples.
+    /// @returns The number of samples that were clipped in this chunk.
+    ///
+    std::size_t convert(const int32_t* samples, const std::size_t& num_samples_, std::vector<int16_t>& output);
+
+    /// @brief Return the number of samples that were converted.
+    ///
+    /// @returns The total number of input samples.
+    ///
+    inline uint64_t get_num_samples() const { return num_samples; }
+
+    /// @brief Return the number of samples that were clipped.
+    ///
+    /// @returns The total number of samples saturated to the 16-bit range.
+    ///
+    inline uint64_t get_num_clipped() const { return num_clipped; }
+};
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_PCM_HPP_
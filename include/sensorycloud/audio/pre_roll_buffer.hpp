@@ -0,0 +1,269 @@
+// A pre-roll buffer for handing wake-word audio to a transcription stream.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_PRE_ROLL_BUFFER_HPP_
+#define SENSORYCLOUD_AUDIO_PRE_ROLL_BUFFER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include "sensorycloud/generated/v1/audio/audio.pb.h"
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief A bounded history of audio for handing off from wake-word
+/// detection to transcription.
+///
+/// @details
+/// The buffer retains the most recent audio that was streamed to a
+/// `validate_event` stream. Every frame has an absolute position that counts
+/// the frames written since construction. Readers own a cursor into that
+/// position space, so a transcription stream that is opened after a wake
+/// word fires starts its cursor at the end of the detection (see
+/// `get_handoff_position`) and reads the audio that was captured while the
+/// stream was opening, then keeps reading live audio from the same history.
+/// Each frame is read exactly once per cursor and no frame is lost as long
+/// as the reader stays within the length of the buffer. Frames that are
+/// overwritten before a reader reaches them are skipped and counted.
+///
+/// The buffer locks a mutex and signals readers, so it should be written
+/// from the thread that streams to the server (e.g., the consumer of an
+/// `AudioRingBuffer`), not from a real-time audio callback.
+///
+class PreRollBuffer {
+ private:
+    /// The sample rate of the audio in Hz.
+    const uint32_t sample_rate;
+    /// The number of interleaved channels in each frame.
+    const uint32_t num_channels;
+    /// The number of frames the buffer retains.
+    const std::size_t capacity;
+    /// The interleaved samples of the history.
+    std::unique_ptr<int16_t[]> buffer;
+    /// The mutex for guarding the positions of the buffer.
+    mutable std::mutex mutex;
+    /// The condition for waking readers when frames are written.
+    std::condition_variable written;
+    /// The position of the next frame to write.
+    uint64_t position = 0;
+    /// The position of the first frame of the current detection stream.
+    uint64_t origin = 0;
+    /// Whether the writer has closed the buffer.
+    bool closed = false;
+    /// The number of frames that readers skipped because they were
+    /// overwritten.
+    uint64_t num_lost_frames = 0;
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ///
+    PreRollBuffer(const PreRollBuffer& other) = delete;
+
+    /// @brief Assign to this object using the assignment operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const PreRollBuffer& other) = delete;
+
+    /// @brief Copy frames out of the history and advance a cursor.
+    ///
+    /// @param cursor The position of the next frame to read.
+    /// @param samples The buffer to write the interleaved samples to.
+    /// @param num_frames The maximal number of frames to read.
+    /// @returns The number of frames that were read.
+    ///
+    /// @details
+    /// The mutex must be held by the caller.
+    ///
+    std::size_t copy_out(uint64_t& cursor, int16_t* samples, const std::size_t& num_frames);
+
+ public:
+    /// @brief Initialize a new pre-roll buffer.
+    ///
+    /// @param sample_rate_ The sample rate of the audio in Hz.
+    /// @param length The duration of audio the buffer retains.
+    /// @param num_channels_ The number of interleaved channels in each frame.
+    ///
+    /// @exception std::invalid_argument If the sample rate, length, or number
+    /// of channels is zero.
+    ///
+    PreRollBuffer(const uint32_t& sample_rate_,
+        const std::chrono::milliseconds& length,
+        const uint32_t& num_channels_ = 1
+    );
+
+    /// @brief Return the sample rate of the buffer.
+    ///
+    /// @returns The sample rate of the audio in Hz.
+    ///
+    inline uint32_t get_sample_rate() const { return sample_rate; }
+
+    /// @brief Return the number of channels of the buffer.
+    ///
+    /// @returns The number of interleaved channels in each frame.
+    ///
+    inline uint32_t get_num_channels() const { return num_channels; }
+
+    /// @brief Return the capacity of the buffer.
+    ///
+    /// @returns The number of frames the buffer retains.
+    ///
+    inline std::size_t get_capacity() const { return capacity; }
+
+    /// @brief Append frames to the history.
+    ///
+    /// @param samples The interleaved samples of the frames.
+    /// @param num_frames The number of frames to write.
+    ///
+    /// @details
+    /// The oldest frames are overwritten once the buffer is full, and readers
+    /// that are waiting for frames are woken.
+    ///
+    void write(const int16_t* samples, const std::size_t& num_frames);
+
+    /// @brief Close the buffer to signal that no more frames will be written.
+    ///
+    /// @details
+    /// Readers that are waiting for frames are woken and receive the frames
+    /// that remain in the history.
+    ///
+    void close();
+
+    /// @brief Return whether the buffer is closed.
+    ///
+    /// @returns `true` if `close` has been called, `false` otherwise.
+    ///
+    bool is_closed() const;
+
+    /// @brief Return the position of the next frame to write.
+    ///
+    /// @returns The number of frames written since construction.
+    ///
+    uint64_t get_position() const;
+
+    /// @brief Return the position of the oldest frame in the history.
+    ///
+    /// @returns The position of the oldest frame that can still be read.
+    ///
+    uint64_t get_oldest() const;
+
+    /// @brief Mark the next frame to write as the start of a detection stream.
+    ///
+    /// @details
+    /// Call this immediately before writing the first frame that is sent to
+    /// a new `validate_event` stream so that the times in its responses map
+    /// onto positions in the buffer.
+    ///
+    void mark_origin();
+
+    /// @brief Return the position of the start of the detection stream.
+    ///
+    /// @returns The position that was current when `mark_origin` was called.
+    ///
+    uint64_t get_origin() const;
+
+    /// @brief Convert a time in the detection stream to a position.
+    ///
+    /// @param seconds The time since the start of the detection stream.
+    /// @returns The position of the frame at the given time.
+    ///
+    uint64_t to_position(const float& seconds) const;
+
+    /// @brief Return the position at which a transcription should start after
+    /// a wake word has been detected.
+    ///
+    /// @param response The response from the `validate_event` stream.
+    /// @param lead An amount of audio before the end of the wake word to
+    /// include in the transcription.
+    /// @returns The position of the first frame to transcribe.
+    ///
+    /// @exception std::invalid_argument If the response is not a detection.
+    ///
+    uint64_t get_handoff_position(
+        const ::sensory::api::v1::audio::ValidateEventResponse& response,
+        const std::chrono::milliseconds& lead = std::chrono::milliseconds(0)
+    ) const;
+
+    /// @brief Read up to a number of frames without waiting.
+    ///
+    /// @param cursor The position of the next frame to read, advanced past
+    /// the frames that were read.
+    /// @param samples The buffer to write the interleaved samples to.
+    /// @param num_frames The maximal number of frames to read.
+    /// @returns The number of frames that were read.
+    ///
+    /// @details
+    /// If the cursor points before the oldest frame in the history, it is
+    /// moved to the oldest frame and the skipped frames are counted as lost.
+    ///
+    std::size_t read(uint64_t& cursor, int16_t* samples, const std::size_t& num_frames);
+
+    /// @brief Wait for and read a complete chunk of frames.
+    ///
+    /// @param cursor The position of the next frame to read, advanced past
+    /// the frames that were read.
+    /// @param samples The buffer to write the interleaved samples to.
+    /// @param num_frames The number of frames in the chunk.
+    /// @param timeout The maximal time to wait for the chunk.
+    /// @returns The number of frames that were read. This is `num_frames`
+    /// when the chunk was read, zero when the timeout expired, and the
+    /// remaining frames (possibly zero) when the buffer is closed.
+    ///
+    /// @exception std::invalid_argument If the chunk is larger than the
+    /// buffer.
+    ///
+    std::size_t read_chunk(uint64_t& cursor,
+        int16_t* samples,
+        const std::size_t& num_frames,
+        const std::chrono::milliseconds& timeout
+    );
+
+    /// @brief Return the number of lost frames.
+    ///
+    /// @returns The number of frames that readers skipped because they were
+    /// overwritten before being read.
+    ///
+    uint64_t get_num_lost_frames() const;
+};
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_PRE_ROLL_BUFFER_HPP_
@@ -0,0 +1,173 @@
+// Streaming polyphase resampling and downmixing of 16-bit PCM audio.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_RESAMPLER_HPP_
+#define SENSORYCLOUD_AUDIO_RESAMPLER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief Mix interleaved multi-channel audio down to mono.
+///
+/// @param samples The interleaved 16-bit samples.
+/// @param num_frames The number of samples per channel.
+/// @param num_channels The number of interleaved channels.
+/// @param output The buffer for the `num_frames` mono samples. The buffer may
+/// alias `samples` because frames are consumed before they are overwritten.
+///
+/// @exception std::invalid_argument If `num_channels` is zero.
+///
+/// @details
+/// Each output sample is the mean of the channels of its frame rounded
+/// towards negative infinity. Stereo audio is mixed with the SIMD kernels of
+/// the SDK.
+///
+void downmix(
+    const int16_t* samples,
+    const std::size_t& num_frames,
+    const uint32_t& num_channels,
+    int16_t* output
+);
+
+/// @brief A streaming polyphase resampler for 16-bit PCM audio.
+///
+/// @details
+/// The resampler converts between any two integer sample rates with a
+/// Kaiser-windowed sinc filter that is decomposed into `L` phases for the
+/// rational ratio `L / M` of the rates. The filter state is carried across
+/// calls to `process`, so audio can be resampled chunk-by-chunk with a fixed
+/// latency of `get_delay` output frames. When the rates are equal, samples
+/// are passed through without filtering or latency.
+///
+/// @code
+/// // Convert 44.1kHz stereo capture to 16kHz mono before encoding.
+/// Resampler resampler(44100, 16000);
+/// std::vector<int16_t> mono(num_frames), resampled;
+/// downmix(samples, num_frames, 2, mono.data());
+/// resampler.process(mono.data(), num_frames, resampled);
+/// encoder.encode(resampled.data(), resampled.size(), *request.mutable_audiocontent());
+/// @endcode
+///
+class Resampler {
+ private:
+    /// The sample rate of the input audio in Hz.
+    const uint32_t input_rate;
+    /// The sample rate of the output audio in Hz.
+    const uint32_t output_rate;
+    /// The number of interleaved channels.
+    const uint32_t num_channels;
+    /// The interpolation factor of the rational ratio.
+    uint32_t interpolation;
+    /// The decimation factor of the rational ratio.
+    uint32_t decimation;
+    /// The number of taps in each phase of the filter, a multiple of 8.
+    uint32_t num_taps;
+    /// The taps of the phases, stored contiguously in reverse order.
+    std::vector<float> filter;
+    /// The input history of each channel.
+    std::vector<std::vector<float>> history;
+    /// The position of the next output in the upsampled time of the history.
+    uint64_t time;
+
+ public:
+    /// @brief Initialize a new resampler.
+    ///
+    /// @param input_rate_ The sample rate of the input audio in Hz.
+    /// @param output_rate_ The sample rate of the output audio in Hz.
+    /// @param num_channels_ The number of interleaved channels.
+    /// @param num_taps_ The length of the filter in samples of the lower of
+    /// the two rates. Longer filters have a sharper transition band and a
+    /// longer delay.
+    ///
+    /// @exception std::invalid_argument If a rate or the number of channels
+    /// is zero, if the number of taps is not in [8, 256], or if the reduced
+    /// interpolation factor of the rates exceeds 1024 (e.g., 16000 to 44100
+    /// reduces to 441 / 160 and is supported).
+    ///
+    Resampler(
+        const uint32_t& input_rate_,
+        const uint32_t& output_rate_,
+        const uint32_t& num_channels_ = 1,
+        const uint32_t& num_taps_ = 64
+    );
+
+    /// @brief Return the sample rate of the input audio.
+    ///
+    /// @returns The sample rate in Hz.
+    ///
+    inline uint32_t get_input_rate() const { return input_rate; }
+
+    /// @brief Return the sample rate of the output audio.
+    ///
+    /// @returns The sample rate in Hz.
+    ///
+    inline uint32_t get_output_rate() const { return output_rate; }
+
+    /// @brief Return the number of channels of the audio.
+    ///
+    /// @returns The number of interleaved channels.
+    ///
+    inline uint32_t get_num_channels() const { return num_channels; }
+
+    /// @brief Return the group delay of the resampler.
+    ///
+    /// @returns The delay between the input and output in output frames.
+    ///
+    uint32_t get_delay() const;
+
+    /// @brief Resample a chunk of audio.
+    ///
+    /// @param samples The interleaved 16-bit input samples.
+    /// @param num_frames The number of input samples per channel.
+    /// @param output The vector to append the interleaved output samples to.
+    ///
+    void process(const int16_t* samples, const std::size_t& num_frames, std::vector<int16_t>& output);
+
+    /// @brief Flush the delayed samples at the end of a stream.
+    ///
+    /// @param output The vector to append the interleaved output samples to.
+    ///
+    /// @details
+    /// Silence is pushed through the filter to release the last `get_delay`
+    /// frames of the stream. The resampler is reset afterwards.
+    ///
+    void flush(std::vector<int16_t>& output);
+
+    /// @brief Reset the filter state for a new stream.
+    void reset();
+};
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_RESAMPLER_HPP_
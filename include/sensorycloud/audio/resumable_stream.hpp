@@ -0,0 +1,482 @@
+// An audio stream that reconnects and replays audio after transient failures.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_RESUMABLE_STREAM_HPP_
+#define SENSORYCLOUD_AUDIO_RESUMABLE_STREAM_HPP_
+
+#include <grpcpp/client_context.h>
+#include <grpcpp/support/status.h>
+#include <grpcpp/support/sync_stream.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "sensorycloud/generated/v1/audio/audio.pb.h"
+#include "sensorycloud/util/transcript_aggregator.hpp"
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief Return a flag determining whether a failed stream may be retried.
+///
+/// @param status The final status of the stream.
+///
+/// @returns `true` for transient failures (`UNAVAILABLE`,
+/// `DEADLINE_EXCEEDED`, `RESOURCE_EXHAUSTED`, and `ABORTED`).
+///
+bool is_retryable(const ::grpc::Status& status);
+
+/// @brief Options for a resumable audio stream.
+struct ResumableStreamOptions {
+    /// The sample rate of the audio in Hz.
+    uint32_t sample_rate = 16000;
+    /// The number of interleaved channels of the audio.
+    uint32_t num_channels = 1;
+    /// The duration of the most recent audio that is kept for replay.
+    std::chrono::milliseconds replay_duration = std::chrono::milliseconds(10000);
+    /// The number of frames in each replayed audio message.
+    std::size_t replay_chunk_size = 4096;
+    /// The maximal number of attempts to reopen the stream after a failure.
+    std::size_t max_reconnects = 3;
+    /// The delay before the first attempt to reopen the stream, which grows
+    /// linearly with each attempt.
+    std::chrono::milliseconds reconnect_backoff = std::chrono::milliseconds(250);
+    /// The function that determines whether a failed stream may be reopened.
+    std::function<bool(const ::grpc::Status&)> retry_policy = is_retryable;
+};
+
+/// @brief Find the point in a transcript from which audio can be replayed.
+///
+/// @param words The transcript so far, in stream time.
+/// @param earliest_ms The time of the oldest audio that can be replayed.
+/// @param num_kept The number of words that end at or before the resume
+/// point, i.e., the index of the first word that the replay recognizes again.
+/// @returns The resume point in milliseconds. This is `earliest_ms`, or the
+/// end of the word that spans it.
+///
+uint64_t find_resume_point(const std::vector<::sensory::api::v1::audio::TranscribeWord>& words,
+    const uint64_t& earliest_ms,
+    std::size_t& num_kept
+);
+
+/// @brief Shift the times and word indexes of a transcription response.
+///
+/// @param response The response to shift.
+/// @param offset_ms The time of the start of the stream in milliseconds.
+/// @param index_offset The index of the first word of the stream.
+///
+void shift_response(::sensory::api::v1::audio::TranscribeResponse& response,
+    const uint64_t& offset_ms,
+    const uint64_t& index_offset
+);
+
+/// @brief Shift the times of an event validation response.
+///
+/// @param response The response to shift.
+/// @param offset_ms The time of the start of the stream in milliseconds.
+/// @param index_offset Unused.
+///
+void shift_response(::sensory::api::v1::audio::ValidateEventResponse& response,
+    const uint64_t& offset_ms,
+    const uint64_t& index_offset
+);
+
+/// @brief Leave a response that has no times unchanged.
+///
+/// @tparam Response The type of the response.
+///
+template<typename Response>
+inline void shift_response(Response&, const uint64_t&, const uint64_t&) { }
+
+/// @brief Track the transcript of a transcription response.
+///
+/// @param aggregator The aggregator of the transcript.
+/// @param response The response to track.
+///
+inline void track_response(::sensory::util::TranscriptAggregator& aggregator,
+    const ::sensory::api::v1::audio::TranscribeResponse& response
+) {
+    aggregator.process_response(response.wordlist());
+}
+
+/// @brief Track the transcript of a response that has no transcript.
+///
+/// @tparam Response The type of the response.
+///
+template<typename Response>
+inline void track_response(::sensory::util::TranscriptAggregator&, const Response&) { }
+
+/// @brief An audio stream that reopens itself after transient failures.
+///
+/// @tparam Request The type of request message, e.g., `TranscribeRequest` or
+/// `ValidateEventRequest`.
+/// @tparam Response The type of response message.
+///
+/// @details
+/// The stream keeps the most recent `replay_duration` of the audio that was
+/// written to it. When the stream ends with a status that the retry policy
+/// accepts, a new stream is opened with the opener (which writes the same
+/// config), the audio is replayed from a safe point, and reading continues.
+/// The safe point is the oldest retained audio, moved forward to the end of
+/// a word that spans it. Times and word indexes of the responses are shifted
+/// so that the caller sees one logical stream; a `TranscriptAggregator`
+/// replaces the words after the safe point as the new stream recognizes them
+/// again. If writes-done or a `FINAL` post-processing action were already
+/// sent, they are sent again after the replay.
+///
+/// Audio must be raw `LINEAR16`, so that it can be replayed from any frame.
+/// As with any bidirectional stream, one thread writes and another reads;
+/// reconnection happens on the reading thread while writes wait for it.
+///
+/// @code
+/// ResumableStream<TranscribeRequest, TranscribeResponse> stream(
+///     [&](grpc::ClientContext* context) {
+///         return cloud.audio.transcribe(context,
+///             new AudioConfig(audio_config),
+///             new TranscribeConfig(transcribe_config));
+///     }, options);
+/// @endcode
+///
+template<typename Request, typename Response>
+class ResumableStream : public ::grpc::ClientReaderWriterInterface<Request, Response> {
+ public:
+    /// The type of the underlying streams.
+    typedef std::unique_ptr<::grpc::ClientReaderWriterInterface<Request, Response>> Stream;
+    /// A function that opens a stream and writes its config.
+    typedef std::function<Stream(::grpc::ClientContext*)> Opener;
+
+ private:
+    /// The function that opens the underlying streams.
+    const Opener opener;
+    /// The options of the stream.
+    const ResumableStreamOptions options;
+    /// The number of frames of audio that are kept for replay.
+    const std::size_t replay_frames;
+    /// The mutex for serializing writes and reconnection.
+    std::mutex write_mutex;
+    /// The mutex for guarding the context and the state of the stream.
+    mutable std::mutex state_mutex;
+    /// The condition for waking writers after a reconnection.
+    std::condition_variable reconnected;
+    /// The context of the underlying stream.
+    std::unique_ptr<::grpc::ClientContext> context;
+    /// The underlying stream.
+    Stream stream;
+    /// The interleaved samples that are kept for replay.
+    std::deque<int16_t> replay;
+    /// The frame of the first sample in `replay`.
+    uint64_t replay_start = 0;
+    /// The number of frames written to the stream.
+    uint64_t position = 0;
+    /// The frame at which the underlying stream starts.
+    uint64_t offset = 0;
+    /// The index of the first word of the underlying stream.
+    uint64_t index_offset = 0;
+    /// The transcript so far, in logical time.
+    ::sensory::util::TranscriptAggregator aggregator;
+    /// Whether a `FINAL` post-processing action was written.
+    bool final_written = false;
+    /// Whether writes-done was sent.
+    bool writes_done = false;
+    /// The number of underlying streams that were opened after the first.
+    uint64_t generation = 0;
+    /// Whether the stream has ended for good.
+    bool is_terminal = false;
+    /// Whether the stream was cancelled.
+    bool is_cancelled = false;
+    /// The final status of the stream.
+    ::grpc::Status status;
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ///
+    ResumableStream(const ResumableStream& other) = delete;
+
+    /// @brief Assign to this object using the assignment operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const ResumableStream& other) = delete;
+
+    /// @brief Convert a number of frames to milliseconds.
+    ///
+    /// @param frames The number of frames.
+    /// @returns The duration of the frames in milliseconds.
+    ///
+    inline uint64_t to_ms(const uint64_t& frames) const {
+        return frames * 1000 / options.sample_rate;
+    }
+
+    /// @brief Wait for the reader to replace a failed stream.
+    ///
+    /// @param failed_generation The generation of the stream that failed.
+    /// @returns `true` if the stream was replaced, `false` if it ended.
+    ///
+    bool await_reconnect(const uint64_t& failed_generation) {
+        std::unique_lock<std::mutex> lock(state_mutex);
+        reconnected.wait(lock, [&]() { return generation != failed_generation || is_terminal; });
+        return !is_terminal;
+    }
+
+    /// @brief End the stream for good.
+    ///
+    /// @param final_status The final status of the stream.
+    ///
+    void terminate(const ::grpc::Status& final_status) {
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            is_terminal = true;
+            status = final_status;
+        }
+        reconnected.notify_all();
+    }
+
+    /// @brief Open a new underlying stream and replay the retained audio.
+    ///
+    /// @returns `true` if the stream was reopened, `false` otherwise.
+    ///
+    /// @details
+    /// The write mutex must be held by the caller.
+    ///
+    bool reopen() {
+        std::unique_ptr<::grpc::ClientContext> next_context(new ::grpc::ClientContext);
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            if (is_cancelled) return false;
+        }
+        Stream next;
+        try {
+            next = opener(next_context.get());
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (next == nullptr) return false;
+        // Resume at the oldest retained audio, or at the end of a word that
+        // spans it, and replay everything after that point.
+        std::size_t num_kept = 0;
+        const auto resume_ms = find_resume_point(aggregator.get_word_list(), to_ms(replay_start), num_kept);
+        const auto resume = std::min<uint64_t>(std::max<uint64_t>(
+            (resume_ms * options.sample_rate + 999) / 1000, replay_start), position);
+        const auto channels = options.num_channels;
+        std::vector<int16_t> samples(replay.begin() + (resume - replay_start) * channels, replay.end());
+        const auto num_frames = samples.size() / channels;
+        for (std::size_t frame = 0; frame < num_frames || (frame == 0 && final_written); frame += options.replay_chunk_size) {
+            const auto count = std::min(options.replay_chunk_size, num_frames - frame);
+            Request request;
+            if (count > 0)
+                request.set_audiocontent(reinterpret_cast<const char*>(&samples[frame * channels]), count * channels * sizeof(int16_t));
+            if (final_written && frame + count >= num_frames)
+                request.mutable_postprocessingaction()->set_action(::sensory::api::v1::audio::FINAL);
+            if (!next->Write(request)) return false;
+        }
+        if (writes_done && !next->WritesDone()) return false;
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            context = std::move(next_context);
+            stream = std::move(next);
+            offset = resume;
+            index_offset = num_kept;
+            generation++;
+        }
+        reconnected.notify_all();
+        return true;
+    }
+
+ public:
+    /// @brief Open a resumable stream.
+    ///
+    /// @param opener_ The function that opens a stream and writes its config.
+    /// It is called again with a fresh context for every reconnection and may
+    /// signal failure by throwing or returning `nullptr`.
+    /// @param options_ The options of the stream.
+    ///
+    /// @exception std::invalid_argument If the sample rate, number of
+    /// channels, or replay chunk size is zero.
+    /// @exception std::runtime_error If the first stream cannot be opened.
+    ///
+    ResumableStream(const Opener& opener_, const ResumableStreamOptions& options_) :
+        opener(opener_),
+        options(options_),
+        replay_frames(static_cast<std::size_t>(options_.replay_duration.count()) * options_.sample_rate / 1000),
+        context(new ::grpc::ClientContext) {
+        if (options.sample_rate == 0 || options.num_channels == 0 || options.replay_chunk_size == 0)
+            throw std::invalid_argument("ResumableStream requires a sample rate, channels, and a replay chunk size.");
+        stream = opener(context.get());
+        if (stream == nullptr)
+            throw std::runtime_error("Failed to open the first stream of a ResumableStream.");
+    }
+
+    using ::grpc::internal::WriterInterface<Request>::Write;
+
+    /// @brief Wait for the initial metadata of the current stream.
+    void WaitForInitialMetadata() override { stream->WaitForInitialMetadata(); }
+
+    /// @brief Return the size of the next message of the current stream.
+    ///
+    /// @param size The size of the next message.
+    /// @returns `true` if a message is available.
+    ///
+    bool NextMessageSize(uint32_t* size) override { return stream->NextMessageSize(size); }
+
+    /// @brief Write a request and keep its audio for replay.
+    ///
+    /// @param request The request to write.
+    /// @param write_options The options of the write.
+    /// @returns `true` if the request was written, possibly after reopening
+    /// the stream, `false` if the stream has ended.
+    ///
+    bool Write(const Request& request, ::grpc::WriteOptions write_options) override {
+        uint64_t written_generation;
+        {
+            std::lock_guard<std::mutex> lock(write_mutex);
+            {
+                std::lock_guard<std::mutex> state_lock(state_mutex);
+                if (is_terminal) return false;
+                written_generation = generation;
+            }
+            const auto& content = request.audiocontent();
+            const auto samples = reinterpret_cast<const int16_t*>(content.data());
+            replay.insert(replay.end(), samples, samples + content.size() / sizeof(int16_t));
+            position += content.size() / sizeof(int16_t) / options.num_channels;
+            if (replay.size() > replay_frames * options.num_channels) {
+                const auto excess = (replay.size() / options.num_channels - replay_frames);
+                replay.erase(replay.begin(), replay.begin() + excess * options.num_channels);
+                replay_start += excess;
+            }
+            if (request.has_postprocessingaction() &&
+                request.postprocessingaction().action() == ::sensory::api::v1::audio::FINAL)
+                final_written = true;
+            if (stream->Write(request, write_options)) return true;
+        }
+        // The audio is retained, so it is sent by the replay.
+        return await_reconnect(written_generation);
+    }
+
+    /// @brief Signal that no more requests will be written.
+    ///
+    /// @returns `true` if the signal was sent, possibly after reopening the
+    /// stream, `false` if the stream has ended.
+    ///
+    bool WritesDone() override {
+        uint64_t written_generation;
+        {
+            std::lock_guard<std::mutex> lock(write_mutex);
+            {
+                std::lock_guard<std::mutex> state_lock(state_mutex);
+                if (is_terminal) return false;
+                written_generation = generation;
+            }
+            writes_done = true;
+            if (stream->WritesDone()) return true;
+        }
+        return await_reconnect(written_generation);
+    }
+
+    /// @brief Read a response, reopening the stream after transient failures.
+    ///
+    /// @param response The response to read into, shifted into the time of
+    /// the logical stream.
+    /// @returns `true` if a response was read, `false` if the stream ended.
+    ///
+    bool Read(Response* response) override {
+        while (true) {
+            if (stream->Read(response)) {
+                shift_response(*response, to_ms(offset), index_offset);
+                track_response(aggregator, *response);
+                return true;
+            }
+            std::lock_guard<std::mutex> lock(write_mutex);
+            const auto final_status = stream->Finish();
+            bool cancelled;
+            {
+                std::lock_guard<std::mutex> state_lock(state_mutex);
+                cancelled = is_cancelled;
+            }
+            if (final_status.ok() || cancelled || !options.retry_policy(final_status)) {
+                terminate(final_status);
+                return false;
+            }
+            bool is_reopened = false;
+            for (std::size_t attempt = 1; attempt <= options.max_reconnects && !is_reopened; attempt++) {
+                std::this_thread::sleep_for(options.reconnect_backoff * attempt);
+                is_reopened = reopen();
+            }
+            if (!is_reopened) {
+                terminate(final_status);
+                return false;
+            }
+        }
+    }
+
+    /// @brief Return the final status of the stream.
+    ///
+    /// @returns The status of the last underlying stream. Call this after
+    /// `Read` has returned `false`.
+    ///
+    ::grpc::Status Finish() override {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        return status;
+    }
+
+    /// @brief Cancel the stream and prevent it from reopening.
+    void TryCancel() {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        is_cancelled = true;
+        context->TryCancel();
+    }
+
+    /// @brief Return the number of times the stream was reopened.
+    ///
+    /// @returns The number of underlying streams after the first.
+    ///
+    inline uint64_t get_num_reconnects() const {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        return generation;
+    }
+};
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_RESUMABLE_STREAM_HPP_
@@ -0,0 +1,451 @@
+// A lock-free ring buffer for handing captured audio to the network.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_RING_BUFFER_HPP_
+#define SENSORYCLOUD_AUDIO_RING_BUFFER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "sensorycloud/util/mpmc_queue.hpp"
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief A lock-free single-producer single-consumer ring of audio frames.
+///
+/// @details
+/// The ring decouples a real-time audio callback from a network thread,
+/// either a capture callback that produces audio for the thread that writes
+/// to the network, or a network thread that produces synthesized speech for
+/// a playback callback. The capacity is a power of two of frames and the
+/// read and write indices live on separate cache lines. Neither side
+/// allocates, locks, or blocks, so the network never stalls the callback.
+/// When the ring is full the newest frames are dropped and counted as an
+/// overrun; when the consumer asks for a chunk that has not been captured
+/// yet, an underrun is counted.
+///
+class AudioRingBuffer {
+ private:
+    /// The interleaved samples of the ring.
+    std::unique_ptr<int16_t[]> buffer;
+    /// The mask for mapping frame positions onto the ring.
+    const std::size_t mask;
+    /// The number of interleaved channels in each frame.
+    const uint32_t num_channels;
+    /// Padding to keep the write index on its own cache line.
+    char pad0[::sensory::util::CACHE_LINE_SIZE];
+    /// The position of the next frame to write (owned by the producer).
+    std::atomic<std::size_t> head;
+    /// The number of writes that dropped frames (owned by the producer).
+    std::atomic<uint64_t> num_overruns;
+    /// The number of frames that were dropped (owned by the producer).
+    std::atomic<uint64_t> num_dropped_frames;
+    /// Padding to keep the read index on its own cache line.
+    char pad1[::sensory::util::CACHE_LINE_SIZE - sizeof(std::atomic<std::size_t>) - 2 * sizeof(std::atomic<uint64_t>)];
+    /// The position of the next frame to read (owned by the consumer).
+    std::atomic<std::size_t> tail;
+    /// The number of chunk reads that found too few frames (owned by the
+    /// consumer).
+    std::atomic<uint64_t> num_underruns;
+    /// Padding to prevent false sharing with adjacent objects.
+    char pad2[::sensory::util::CACHE_LINE_SIZE - sizeof(std::atomic<std::size_t>) - sizeof(std::atomic<uint64_t>)];
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ///
+    AudioRingBuffer(const AudioRingBuffer& other) = delete;
+
+    /// @brief Assign to this object using the assignment operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const AudioRingBuffer& other) = delete;
+
+ public:
+    /// @brief Initialize a new ring buffer.
+    ///
+    /// @param capacity The minimal number of frames the ring can hold. The
+    /// capacity is rounded up to the nearest power of two.
+    /// @param num_channels_ The number of interleaved channels in each frame.
+    ///
+    /// @exception std::invalid_argument If the capacity or the number of
+    /// channels is zero.
+    ///
+    explicit AudioRingBuffer(const std::size_t& capacity, const uint32_t& num_channels_ = 1);
+
+    /// @brief Return the capacity of the ring.
+    ///
+    /// @returns The number of frames the ring can hold.
+    ///
+    inline std::size_t capacity() const { return mask + 1; }
+
+    /// @brief Return the number of channels of the ring.
+    ///
+    /// @returns The number of interleaved channels in each frame.
+    ///
+    inline uint32_t get_num_channels() const { return num_channels; }
+
+    /// @brief Return the number of frames that are ready to read.
+    ///
+    /// @returns The number of buffered frames. The value is exact when called
+    /// from the consumer and a lower bound when called from the producer.
+    ///
+    inline std::size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    /// @brief Return the number of frames that can be written.
+    ///
+    /// @returns The number of free frames. The value is exact when called
+    /// from the producer and a lower bound when called from the consumer.
+    ///
+    inline std::size_t space() const { return capacity() - size(); }
+
+    /// @brief Write frames to the ring.
+    ///
+    /// @param samples The interleaved samples of the frames.
+    /// @param num_frames The number of frames to write.
+    /// @returns The number of frames that were written. Frames that do not fit
+    /// are dropped and counted as an overrun.
+    ///
+    /// @details
+    /// This function may only be called from the producer thread. It never
+    /// allocates, locks, or blocks, so it is safe to call from a real-time
+    /// audio callback.
+    ///
+    std::size_t write(const int16_t* samples, const std::size_t& num_frames);
+
+    /// @brief Read up to a number of frames from the ring.
+    ///
+    /// @param samples The buffer to write the interleaved samples to.
+    /// @param num_frames The maximal number of frames to read.
+    /// @returns The number of frames that were read.
+    ///
+    /// @details
+    /// This function may only be called from the consumer thread.
+    ///
+    std::size_t read(int16_t* samples, const std::size_t& num_frames);
+
+    /// @brief Read a complete chunk of frames from the ring.
+    ///
+    /// @param samples The buffer to write the interleaved samples to.
+    /// @param num_frames The number of frames in the chunk.
+    /// @returns `true` if the chunk was read, `false` if fewer frames were
+    /// buffered, in which case nothing is read and an underrun is counted.
+    ///
+    /// @details
+    /// This function may only be called from the consumer thread.
+    ///
+    bool try_read_chunk(int16_t* samples, const std::size_t& num_frames);
+
+    /// @brief Wait for and read a complete chunk of frames from the ring.
+    ///
+    /// @param samples The buffer to write the interleaved samples to.
+    /// @param num_frames The number of frames in the chunk.
+    /// @param timeout The maximal time to wait for the chunk.
+    /// @param poll_interval The time to sleep between polls of the ring.
+    /// @returns `true` if the chunk was read, `false` if the timeout expired.
+    ///
+    /// @details
+    /// This function may only be called from the consumer thread. The
+    /// producer never signals the consumer (doing so is not real-time safe),
+    /// so the consumer polls. An underrun is counted at most once per call.
+    ///
+    bool read_chunk(int16_t* samples,
+        const std::size_t& num_frames,
+        const std::chrono::milliseconds& timeout,
+        const std::chrono::microseconds& poll_interval = std::chrono::microseconds(1000)
+    );
+
+    /// @brief Return the number of overruns.
+    ///
+    /// @returns The number of writes that dropped frames because the ring was
+    /// full.
+    ///
+    inline uint64_t get_num_overruns() const { return num_overruns.load(std::memory_order_relaxed); }
+
+    /// @brief Return the number of dropped frames.
+    ///
+    /// @returns The number of frames that were dropped by overruns.
+    ///
+    inline uint64_t get_num_dropped_frames() const { return num_dropped_frames.load(std::memory_order_relaxed); }
+
+    /// @brief Return the number of underruns.
+    ///
+    /// @returns The number of chunk reads that found too few frames.
+    ///
+    inline uint64_t get_num_underruns() const { return num_underruns.load(std::memory_order_relaxed); }
+};
+
+/// @brief An adapter that fills a ring buffer from an audio capture callback.
+///
+/// @details
+/// The static `callback` has the signature of a PortAudio stream callback
+/// for 16-bit input, so the adapter can be passed to `Pa_OpenStream` without
+/// the SDK depending on PortAudio:
+///
+/// @code
+/// AudioRingBuffer ring(SAMPLE_RATE);  // one second of audio
+/// AudioCaptureAdapter adapter(ring);
+/// Pa_OpenStream(&capture, &input_parameters, NULL, SAMPLE_RATE, CHUNK_SIZE,
+///     paClipOff, &AudioCaptureAdapter::callback<PaStreamCallbackTimeInfo>, &adapter);
+/// @endcode
+///
+class AudioCaptureAdapter {
+ private:
+    /// The ring buffer to fill.
+    AudioRingBuffer& ring;
+    /// The number of callbacks that have been handled.
+    std::atomic<uint64_t> num_callbacks;
+    /// The number of callbacks that reported an overflow of the input device.
+    std::atomic<uint64_t> num_input_overflows;
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ///
+    AudioCaptureAdapter(const AudioCaptureAdapter& other) = delete;
+
+    /// @brief Assign to this object using the assignment operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const AudioCaptureAdapter& other) = delete;
+
+ public:
+    /// The status flag of an input overflow (`paInputOverflow`).
+    static constexpr unsigned long INPUT_OVERFLOW = 0x00000002;
+
+    /// @brief Initialize a new capture adapter.
+    ///
+    /// @param ring_ The ring buffer to fill. The ring must outlive the
+    /// adapter.
+    ///
+    explicit AudioCaptureAdapter(AudioRingBuffer& ring_) :
+        ring(ring_), num_callbacks(0), num_input_overflows(0) { }
+
+    /// @brief Handle a block of captured audio.
+    ///
+    /// @param samples The interleaved samples of the block, or `nullptr` if
+    /// the device produced no input.
+    /// @param num_frames The number of frames in the block.
+    /// @param input_overflow Whether the device reported an input overflow.
+    ///
+    /// @details
+    /// This function is real-time safe.
+    ///
+    inline void capture(const int16_t* samples, const std::size_t& num_frames, const bool& input_overflow = false) {
+        num_callbacks.fetch_add(1, std::memory_order_relaxed);
+        if (input_overflow) num_input_overflows.fetch_add(1, std::memory_order_relaxed);
+        if (samples != nullptr) ring.write(samples, num_frames);
+    }
+
+    /// @brief A capture callback with the signature of `PaStreamCallback`.
+    /// @tparam TimeInfo The type of the timing information of the callback
+    /// (i.e., `PaStreamCallbackTimeInfo`).
+    ///
+    /// @param input The captured 16-bit samples.
+    /// @param num_frames The number of captured frames.
+    /// @param status_flags The status flags of the callback.
+    /// @param user_data A pointer to the `AudioCaptureAdapter`.
+    /// @returns `0` (`paContinue`) to keep the stream running.
+    ///
+    /// @details
+    /// The output buffer and the timing information of the callback are
+    /// unused.
+    ///
+    template<typename TimeInfo>
+    static int callback(const void* input,
+        void*,
+        unsigned long num_frames,
+        const TimeInfo*,
+        unsigned long status_flags,
+        void* user_data
+    ) {
+        static_cast<AudioCaptureAdapter*>(user_data)->capture(
+            static_cast<const int16_t*>(input),
+            num_frames,
+            (status_flags & INPUT_OVERFLOW) != 0
+        );
+        return 0;
+    }
+
+    /// @brief Return the ring buffer of the adapter.
+    ///
+    /// @returns The ring buffer that the adapter fills.
+    ///
+    inline AudioRingBuffer& get_ring() const { return ring; }
+
+    /// @brief Return the number of callbacks.
+    ///
+    /// @returns The number of blocks that have been captured.
+    ///
+    inline uint64_t get_num_callbacks() const { return num_callbacks.load(std::memory_order_relaxed); }
+
+    /// @brief Return the number of input overflows.
+    ///
+    /// @returns The number of callbacks that reported an overflow of the
+    /// input device, i.e., audio that was lost before reaching the ring.
+    ///
+    inline uint64_t get_num_input_overflows() const { return num_input_overflows.load(std::memory_order_relaxed); }
+};
+
+/// @brief An adapter that drains a ring buffer from an audio playback
+/// callback.
+///
+/// @details
+/// The static `callback` has the signature of a PortAudio stream callback
+/// for 16-bit output. Frames that have not arrived in the ring when the
+/// device needs them are played as silence and counted as an underflow.
+///
+/// @code
+/// AudioRingBuffer ring(SAMPLE_RATE);  // one second of audio
+/// AudioPlaybackAdapter adapter(ring);
+/// Pa_OpenStream(&playback, NULL, &output_parameters, SAMPLE_RATE, 256,
+///     paClipOff, &AudioPlaybackAdapter::callback<PaStreamCallbackTimeInfo>, &adapter);
+/// @endcode
+///
+class AudioPlaybackAdapter {
+ private:
+    /// The ring buffer to drain.
+    AudioRingBuffer& ring;
+    /// The number of callbacks that have been handled.
+    std::atomic<uint64_t> num_callbacks;
+    /// The number of callbacks that could not be filled from the ring.
+    std::atomic<uint64_t> num_underflows;
+    /// The number of frames of silence that were played for underflows.
+    std::atomic<uint64_t> num_silent_frames;
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ///
+    AudioPlaybackAdapter(const AudioPlaybackAdapter& other) = delete;
+
+    /// @brief Assign to this object using the assignment operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const AudioPlaybackAdapter& other) = delete;
+
+ public:
+    /// @brief Initialize a new playback adapter.
+    ///
+    /// @param ring_ The ring buffer to drain. The ring must outlive the
+    /// adapter.
+    ///
+    explicit AudioPlaybackAdapter(AudioRingBuffer& ring_) :
+        ring(ring_), num_callbacks(0), num_underflows(0), num_silent_frames(0) { }
+
+    /// @brief Fill a block of audio for playback.
+    ///
+    /// @param samples The buffer to write the interleaved samples to.
+    /// @param num_frames The number of frames in the block.
+    ///
+    /// @details
+    /// This function is real-time safe.
+    ///
+    void play(int16_t* samples, const std::size_t& num_frames);
+
+    /// @brief A playback callback with the signature of `PaStreamCallback`.
+    /// @tparam TimeInfo The type of the timing information of the callback
+    /// (i.e., `PaStreamCallbackTimeInfo`).
+    ///
+    /// @param output The buffer for the 16-bit samples to play.
+    /// @param num_frames The number of frames to play.
+    /// @param user_data A pointer to the `AudioPlaybackAdapter`.
+    /// @returns `0` (`paContinue`) to keep the stream running.
+    ///
+    /// @details
+    /// The input buffer, the timing information, and the status flags of the
+    /// callback are unused.
+    ///
+    template<typename TimeInfo>
+    static int callback(const void*,
+        void* output,
+        unsigned long num_frames,
+        const TimeInfo*,
+        unsigned long,
+        void* user_data
+    ) {
+        static_cast<AudioPlaybackAdapter*>(user_data)->play(static_cast<int16_t*>(output), num_frames);
+        return 0;
+    }
+
+    /// @brief Return the ring buffer of the adapter.
+    ///
+    /// @returns The ring buffer that the adapter drains.
+    ///
+    inline AudioRingBuffer& get_ring() const { return ring; }
+
+    /// @brief Return the number of callbacks.
+    ///
+    /// @returns The number of blocks that have been played.
+    ///
+    inline uint64_t get_num_callbacks() const { return num_callbacks.load(std::memory_order_relaxed); }
+
+    /// @brief Return the number of underflows.
+    ///
+    /// @returns The number of blocks that were padded with silence.
+    ///
+    inline uint64_t get_num_underflows() const { return num_underflows.load(std::memory_order_relaxed); }
+
+    /// @brief Return the number of frames of silence.
+    ///
+    /// @returns The number of frames of silence that padded underflows.
+    ///
+    inline uint64_t get_num_silent_frames() const { return num_silent_frames.load(std::memory_order_relaxed); }
+};
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_RING_BUFFER_HPP_
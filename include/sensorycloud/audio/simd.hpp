@@ -0,0 +1,62 @@
+// Compile-time selection of SIMD instruction sets for audio kernels.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_SIMD_HPP_
+#define SENSORYCLOUD_AUDIO_SIMD_HPP_
+
+// The widest instruction set that the translation unit is compiled for. The
+// audio kernels are selected at compile time, so building the SDK with
+// `-mavx2` (or `/arch:AVX2`) enables the AVX2 kernels; SSE2 is the baseline
+// of x86-64 and NEON is the baseline of AArch64.
+#if defined(__AVX2__)
+#define SENSORYCLOUD_AUDIO_AVX2 1
+#define SENSORYCLOUD_AUDIO_SSE2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SENSORYCLOUD_AUDIO_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SENSORYCLOUD_AUDIO_NEON 1
+#include <arm_neon.h>
+#endif
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief Return the name of the SIMD instruction set of the audio kernels.
+///
+/// @returns One of "AVX2", "SSE2", "NEON", or "scalar", depending on the
+/// flags that the SDK was compiled with.
+///
+const char* get_simd_instruction_set();
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_SIMD_HPP_
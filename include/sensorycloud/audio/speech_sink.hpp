@@ -0,0 +1,375 @@
+// Sinks for streaming synthesized speech to files and playback.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_SPEECH_SINK_HPP_
+#define SENSORYCLOUD_AUDIO_SPEECH_SINK_HPP_
+
+#include <grpcpp/support/status.h>
+#include <grpcpp/support/sync_stream.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "sensorycloud/generated/v1/audio/audio.pb.h"
+#include "sensorycloud/audio/ring_buffer.hpp"
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief An abstract consumer of synthesized speech as it is streamed.
+///
+/// @details
+/// A sink turns the responses of a `SynthesizeSpeech` stream into 16-bit
+/// PCM samples as they arrive, so the first audio is available after the
+/// first chunk and memory does not grow with the length of the utterance.
+/// The format is taken from the `AudioConfig` response of the stream or from
+/// a RIFF/WAVE header at the start of the audio content, whichever arrives,
+/// and falls back to the defaults of the sink. The header is not passed on
+/// to sub-classes, and samples that are split across chunks are reassembled.
+///
+/// Sub-classes implement `on_samples` and may implement `on_format` and
+/// `on_finish`. Responses are fed with `process` from a blocking reader
+/// (see `stream_speech`) or from the `OnReadDone` reaction of a
+/// `SynthesizeSpeechReadReactor`:
+///
+/// @code
+/// void OnReadDone(bool ok) override {
+///     if (!ok) return;
+///     sink.process(response);
+///     StartRead(&response);
+/// }
+/// @endcode
+///
+class SpeechSink {
+ private:
+    /// The states of the parser of the audio content.
+    enum class State {
+        /// Waiting for enough bytes to detect a RIFF/WAVE header.
+        Detect,
+        /// Reading a RIFF/WAVE header up to the start of its data.
+        Header,
+        /// Reading samples.
+        Samples
+    };
+
+    /// The state of the parser.
+    State state;
+    /// The sample rate of the audio in Hz.
+    uint32_t sample_rate;
+    /// The number of interleaved channels of the audio.
+    uint32_t num_channels;
+    /// Whether the format has been passed to `on_format`.
+    bool has_format;
+    /// Whether the stream has finished.
+    bool finished;
+    /// The bytes of the audio content before the first sample.
+    std::string header;
+    /// The bytes of an incomplete frame from the previous chunk.
+    std::string partial;
+    /// The buffer of decoded samples.
+    std::vector<int16_t> samples;
+    /// The number of frames that have been passed to `on_samples`.
+    uint64_t num_frames;
+    /// The time that the sink was created.
+    std::chrono::steady_clock::time_point start_time;
+    /// The time that the first samples were passed to `on_samples`.
+    std::chrono::steady_clock::time_point first_audio_time;
+
+    /// @brief Parse the RIFF/WAVE header at the start of the audio content.
+    ///
+    /// @returns `true` if the header is complete, `false` if more bytes are
+    /// needed.
+    ///
+    /// @exception std::runtime_error If the header is malformed or does not
+    /// describe 16-bit PCM audio.
+    ///
+    bool parse_header();
+
+    /// @brief Decode bytes of little-endian samples.
+    ///
+    /// @param data The bytes of the samples.
+    /// @param size The number of bytes.
+    ///
+    void decode(const char* data, std::size_t size);
+
+    /// @brief Pass the format to the sub-class if it is not known yet.
+    ///
+    /// @exception std::runtime_error If the format is not known.
+    ///
+    void resolve_format();
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ///
+    SpeechSink(const SpeechSink& other) = delete;
+
+    /// @brief Assign to this object using the assignment operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const SpeechSink& other) = delete;
+
+ protected:
+    /// @brief Respond to the format of the audio.
+    ///
+    /// @param sample_rate_ The sample rate of the audio in Hz.
+    /// @param num_channels_ The number of interleaved channels of the audio.
+    ///
+    /// @details
+    /// This function is called once, before the first call to `on_samples`.
+    ///
+    virtual void on_format(const uint32_t& sample_rate_, const uint32_t& num_channels_);
+
+    /// @brief Respond to samples of the audio.
+    ///
+    /// @param samples_ The interleaved samples.
+    /// @param num_frames_ The number of frames.
+    ///
+    virtual void on_samples(const int16_t* samples_, const std::size_t& num_frames_) = 0;
+
+    /// @brief Respond to the end of the audio.
+    virtual void on_finish() { }
+
+ public:
+    /// @brief Initialize a new speech sink.
+    ///
+    /// @param sample_rate_ The sample rate to assume if the stream does not
+    /// describe its format, or `0` to require a description.
+    /// @param num_channels_ The number of channels to assume if the stream
+    /// does not describe its format.
+    ///
+    explicit SpeechSink(const uint32_t& sample_rate_ = 0, const uint32_t& num_channels_ = 1);
+
+    /// @brief Destroy the speech sink.
+    virtual ~SpeechSink() = default;
+
+    /// @brief Process a response of a `SynthesizeSpeech` stream.
+    ///
+    /// @param response The response to process.
+    ///
+    /// @exception std::runtime_error If the audio is not 16-bit PCM or its
+    /// format is unknown, or if the stream has finished.
+    ///
+    void process(const ::sensory::api::v1::audio::SynthesizeSpeechResponse& response);
+
+    /// @brief Process bytes of audio content.
+    ///
+    /// @param data The bytes of the audio content.
+    /// @param size The number of bytes.
+    ///
+    /// @exception std::runtime_error If the audio is not 16-bit PCM or its
+    /// format is unknown, or if the stream has finished.
+    ///
+    void write(const char* data, const std::size_t& size);
+
+    /// @brief Finish the audio after the last response.
+    ///
+    /// @details
+    /// Calling this function more than once has no effect. An incomplete
+    /// trailing frame is discarded.
+    ///
+    void finish();
+
+    /// @brief Return a flag determining whether the audio has finished.
+    ///
+    /// @returns `true` if `finish` has been called.
+    ///
+    inline bool is_finished() const { return finished; }
+
+    /// @brief Return the sample rate of the audio.
+    ///
+    /// @returns The sample rate in Hz. Until the format of the stream is
+    /// known, this is the default of the sink.
+    ///
+    inline uint32_t get_sample_rate() const { return sample_rate; }
+
+    /// @brief Return the number of channels of the audio.
+    ///
+    /// @returns The number of interleaved channels.
+    ///
+    inline uint32_t get_num_channels() const { return num_channels; }
+
+    /// @brief Return the number of frames of audio.
+    ///
+    /// @returns The number of frames that have been consumed.
+    ///
+    inline uint64_t get_num_frames() const { return num_frames; }
+
+    /// @brief Return the time to the first audio.
+    ///
+    /// @returns The time from the creation of the sink to the first samples,
+    /// or zero if no samples have arrived.
+    ///
+    inline std::chrono::microseconds get_time_to_first_audio() const {
+        if (num_frames == 0) return std::chrono::microseconds(0);
+        return std::chrono::duration_cast<std::chrono::microseconds>(first_audio_time - start_time);
+    }
+};
+
+/// @brief A sink that writes synthesized speech to a growing WAV file.
+///
+/// @details
+/// The header is written with a size of zero as soon as the format is known
+/// and samples are appended and flushed as they arrive. `finish` rewrites the
+/// sizes in the header. A file that is not finished (e.g., if the stream broke) can
+/// still be read by `read_wav`.
+///
+class WavFileSink : public SpeechSink {
+ private:
+    /// The path of the file.
+    const std::string path;
+    /// The stream of the file.
+    std::ofstream file;
+    /// The number of bytes of samples written to the file.
+    uint64_t data_size;
+
+ protected:
+    /// @brief Create the file and write a header with a size of zero.
+    ///
+    /// @param sample_rate_ The sample rate of the audio in Hz.
+    /// @param num_channels_ The number of interleaved channels of the audio.
+    ///
+    /// @exception std::runtime_error If the file cannot be created.
+    ///
+    void on_format(const uint32_t& sample_rate_, const uint32_t& num_channels_) override;
+
+    /// @brief Append samples to the file.
+    ///
+    /// @param samples_ The interleaved samples.
+    /// @param num_frames_ The number of frames.
+    ///
+    /// @exception std::runtime_error If the file cannot be written.
+    ///
+    void on_samples(const int16_t* samples_, const std::size_t& num_frames_) override;
+
+    /// @brief Patch the sizes in the header and close the file.
+    ///
+    /// @exception std::runtime_error If the file cannot be written.
+    ///
+    void on_finish() override;
+
+ public:
+    /// @brief Initialize a new WAV file sink.
+    ///
+    /// @param path_ The path of the WAV file to write.
+    /// @param sample_rate_ The sample rate to assume if the stream does not
+    /// describe its format, or `0` to require a description.
+    ///
+    /// @details
+    /// The file is created when the format of the audio is known.
+    ///
+    explicit WavFileSink(const std::string& path_, const uint32_t& sample_rate_ = 0);
+
+    /// @brief Return the path of the file.
+    ///
+    /// @returns The path of the WAV file.
+    ///
+    inline const std::string& get_path() const { return path; }
+};
+
+/// @brief A sink that hands synthesized speech to a playback ring buffer.
+///
+/// @details
+/// Samples are written to the ring as they arrive for an
+/// `AudioPlaybackAdapter` to play. When the ring is full, the sink waits for
+/// the playback to drain it, which applies back-pressure to the stream. If
+/// the ring does not drain within the timeout, the remaining samples of the
+/// chunk are dropped and counted as an overrun of the ring.
+///
+class PlaybackSink : public SpeechSink {
+ private:
+    /// The ring buffer to write to.
+    AudioRingBuffer& ring;
+    /// The maximal time to wait for space in the ring.
+    const std::chrono::milliseconds timeout;
+
+ protected:
+    /// @brief Check the format of the audio against the ring.
+    ///
+    /// @param sample_rate_ The sample rate of the audio in Hz.
+    /// @param num_channels_ The number of interleaved channels of the audio.
+    ///
+    /// @exception std::runtime_error If the ring has a different number of
+    /// channels than the audio.
+    ///
+    void on_format(const uint32_t& sample_rate_, const uint32_t& num_channels_) override;
+
+    /// @brief Write samples to the ring, waiting for space as needed.
+    ///
+    /// @param samples_ The interleaved samples.
+    /// @param num_frames_ The number of frames.
+    ///
+    void on_samples(const int16_t* samples_, const std::size_t& num_frames_) override;
+
+ public:
+    /// @brief Initialize a new playback sink.
+    ///
+    /// @param ring_ The ring buffer to write to. The ring must outlive the
+    /// sink and have the same number of channels as the audio.
+    /// @param sample_rate_ The sample rate to assume if the stream does not
+    /// describe its format, or `0` to require a description.
+    /// @param timeout_ The maximal time to wait for space in the ring.
+    ///
+    explicit PlaybackSink(AudioRingBuffer& ring_,
+        const uint32_t& sample_rate_ = 0,
+        const std::chrono::milliseconds& timeout_ = std::chrono::milliseconds(2000)
+    );
+};
+
+/// @brief Read a `SynthesizeSpeech` stream into a sink.
+///
+/// @param reader The reader of the stream.
+/// @param sink The sink to process the responses with.
+/// @returns The final status of the stream.
+///
+/// @exception std::runtime_error If the sink fails to process a response.
+///
+/// @details
+/// The sink is finished when the stream ends, even if the stream failed, so
+/// the audio that did arrive is kept. If the sink throws, the stream is left
+/// open and should be cancelled with `ClientContext::TryCancel`.
+///
+::grpc::Status stream_speech(
+    ::grpc::ClientReaderInterface<::sensory::api::v1::audio::SynthesizeSpeechResponse>& reader,
+    SpeechSink& sink
+);
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_SPEECH_SINK_HPP_
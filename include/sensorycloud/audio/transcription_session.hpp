@@ -0,0 +1,462 @@
+// A long-running transcription session that rotates streams.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_TRANSCRIPTION_SESSION_HPP_
+#define SENSORYCLOUD_AUDIO_TRANSCRIPTION_SESSION_HPP_
+
+#include <grpcpp/client_context.h>
+#include <grpcpp/support/status.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sensorycloud/generated/v1/audio/audio.pb.h"
+#include "sensorycloud/util/transcript_aggregator.hpp"
+#include "sensorycloud/util/transcript_stitcher.hpp"
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief Options for a long-running transcription session.
+struct TranscriptionSessionOptions {
+    /// The sample rate of the audio in Hz.
+    uint32_t sample_rate = 16000;
+    /// The language code of the audio.
+    std::string language_code = "en";
+    /// The transcription config for every stream (e.g., with the model name
+    /// and user ID).
+    ::sensory::api::v1::audio::TranscribeConfig transcribe_config;
+    /// The duration of a stream after which it rotates at the next silence.
+    std::chrono::milliseconds min_segment_duration = std::chrono::minutes(4);
+    /// The duration of a stream after which it rotates regardless of voice
+    /// activity.
+    std::chrono::milliseconds max_segment_duration = std::chrono::minutes(5);
+    /// The duration of audio that consecutive streams share.
+    std::chrono::milliseconds overlap = std::chrono::milliseconds(2000);
+    /// The maximal number of consecutive streams that may fail before the
+    /// session gives up.
+    std::size_t max_restarts = 3;
+};
+
+/// @brief A transcription session that spans many streams.
+/// @tparam Service The type of the audio service, e.g.,
+/// `AudioService<CredentialStore>`.
+///
+/// @details
+/// A single `Transcribe` stream that runs for hours holds the whole
+/// transcript in memory and loses the session when it fails. The session
+/// instead rotates to a new stream once the current stream is older than
+/// `min_segment_duration` and the server reports no voice activity, or once
+/// it reaches `max_segment_duration`. The new stream starts with the last
+/// `overlap` of audio, the old stream is finalized in the background, and
+/// the word lists are stitched by timestamp with a `TranscriptStitcher`. A
+/// stream that fails is replaced in the same way, so a failure costs at
+/// most the audio since the start of the overlap. Each stream holds only
+/// its own segment of the transcript.
+///
+/// Audio is written from a single thread with `write` and is streamed as
+/// 16-bit mono `LINEAR16`. Responses are read on a thread per stream.
+///
+/// @code
+/// TranscriptionSessionOptions options;
+/// options.transcribe_config.set_modelname("speech_recognition_en");
+/// options.transcribe_config.set_userid("meeting");
+/// TranscriptionSession<AudioService<FileSystemCredentialStore>> session(cloud.audio, options);
+/// while (capturing) session.write(samples, num_samples);
+/// session.finish();
+/// std::cout << session.get_transcript() << std::endl;
+/// @endcode
+///
+template<typename Service>
+class TranscriptionSession {
+ public:
+    /// A callback for the words that are committed when a stream finishes.
+    typedef std::function<void(const std::vector<::sensory::api::v1::audio::TranscribeWord>&)> WordsCallback;
+
+ private:
+    /// @brief A stream that transcribes a segment of the session.
+    struct Segment {
+        /// The context of the stream.
+        ::grpc::ClientContext context;
+        /// The stream.
+        typename Service::TranscribeStream stream;
+        /// The thread that reads the responses of the stream.
+        std::thread reader;
+        /// The mutex for guarding the aggregator.
+        std::mutex mutex;
+        /// The aggregator of the transcript of the segment.
+        ::sensory::util::TranscriptAggregator aggregator;
+        /// The session frame of the first sample of the segment.
+        uint64_t offset = 0;
+        /// The session time at which the next segment takes over.
+        uint64_t cut_ms = ::sensory::util::TranscriptStitcher::END_OF_SESSION;
+        /// Whether the server reported voice activity in its last response.
+        std::atomic<bool> has_voice_activity;
+        /// Whether the server has sent a response.
+        std::atomic<bool> has_response;
+        /// Whether the stream has stopped delivering responses.
+        std::atomic<bool> ended;
+        /// Whether a write to the stream failed or a response could not be
+        /// processed.
+        std::atomic<bool> failed;
+        /// The error that occurred while processing a response.
+        std::string error;
+
+        /// @brief Initialize a new segment.
+        Segment() : has_voice_activity(true), has_response(false), ended(false), failed(false) { }
+    };
+
+    /// The service that opens the streams.
+    const Service& service;
+    /// The options of the session.
+    const TranscriptionSessionOptions options;
+    /// The number of frames of overlap between streams.
+    const std::size_t overlap_frames;
+    /// The stream that receives the audio.
+    std::unique_ptr<Segment> current;
+    /// The streams that were rotated out and are being finalized, oldest
+    /// first.
+    std::deque<std::unique_ptr<Segment>> closing;
+    /// The most recent audio, up to the overlap.
+    std::deque<int16_t> history;
+    /// The number of frames written to the session.
+    uint64_t position = 0;
+    /// The mutex for guarding the stitched transcript.
+    mutable std::mutex mutex;
+    /// The stitched transcript of the finalized streams.
+    ::sensory::util::TranscriptStitcher stitcher;
+    /// The callback for committed words.
+    WordsCallback on_words;
+    /// The number of streams that were opened.
+    std::size_t num_streams = 0;
+    /// The number of streams that failed.
+    std::size_t num_failures = 0;
+    /// The number of consecutive streams that failed.
+    std::size_t num_consecutive_failures = 0;
+    /// The last error status of a stream.
+    ::grpc::Status last_error;
+    /// Whether the session has been finished.
+    bool is_finished = false;
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ///
+    TranscriptionSession(const TranscriptionSession& other) = delete;
+
+    /// @brief Assign to this object using the assignment operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const TranscriptionSession& other) = delete;
+
+    /// @brief Convert a number of frames to milliseconds.
+    ///
+    /// @param frames The number of frames.
+    /// @returns The duration of the frames in milliseconds.
+    ///
+    inline uint64_t to_ms(const uint64_t& frames) const {
+        return frames * 1000 / options.sample_rate;
+    }
+
+    /// @brief Write samples to a segment.
+    ///
+    /// @param segment The segment to write to.
+    /// @param samples The samples to write.
+    /// @param num_samples The number of samples.
+    /// @param is_final Whether to request the final transcript.
+    ///
+    static void write_to(Segment& segment,
+        const int16_t* samples,
+        const std::size_t& num_samples,
+        const bool& is_final = false
+    ) {
+        if (segment.failed) return;
+        ::sensory::api::v1::audio::TranscribeRequest request;
+        if (num_samples > 0)
+            request.set_audiocontent(reinterpret_cast<const char*>(samples), num_samples * sizeof(int16_t));
+        if (is_final) {
+            auto action = new ::sensory::api::v1::audio::AudioRequestPostProcessingAction;
+            action->set_action(::sensory::api::v1::audio::FINAL);
+            request.set_allocated_postprocessingaction(action);
+        }
+        if (!segment.stream->Write(request)) segment.failed = true;
+    }
+
+    /// @brief Open a stream that starts with the audio in the history.
+    ///
+    /// @returns The new segment.
+    ///
+    /// @exception std::runtime_error If too many consecutive streams failed.
+    ///
+    std::unique_ptr<Segment> open() {
+        std::unique_ptr<Segment> segment(new Segment);
+        segment->offset = position - history.size();
+        auto audio_config = new ::sensory::api::v1::audio::AudioConfig;
+        audio_config->set_encoding(::sensory::api::v1::audio::AudioConfig_AudioEncoding_LINEAR16);
+        audio_config->set_sampleratehertz(options.sample_rate);
+        audio_config->set_audiochannelcount(1);
+        audio_config->set_languagecode(options.language_code);
+        auto transcribe_config = new ::sensory::api::v1::audio::TranscribeConfig(options.transcribe_config);
+        segment->stream = service.transcribe(&segment->context, audio_config, transcribe_config);
+        num_streams++;
+        Segment* raw = segment.get();
+        segment->reader = std::thread([raw]() {
+            ::sensory::api::v1::audio::TranscribeResponse response;
+            try {
+                while (raw->stream->Read(&response)) {
+                    {
+                        std::lock_guard<std::mutex> lock(raw->mutex);
+                        raw->aggregator.process_response(response.wordlist());
+                    }
+                    raw->has_voice_activity = response.hasvoiceactivity();
+                    raw->has_response = true;
+                }
+            } catch (const std::exception& exception) {
+                // Fail the segment so that it is replaced and cancelled.
+                std::lock_guard<std::mutex> lock(raw->mutex);
+                raw->error = exception.what();
+                raw->failed = true;
+            }
+            raw->ended = true;
+        });
+        if (!history.empty()) {
+            const std::vector<int16_t> overlap(history.begin(), history.end());
+            write_to(*segment, overlap.data(), overlap.size());
+        }
+        return segment;
+    }
+
+    /// @brief Rotate the current stream out and open a new stream.
+    ///
+    /// @details
+    /// The old stream is asked for its final transcript and finalized in the
+    /// background. A stream that failed is cancelled instead.
+    ///
+    void rotate() {
+        auto next = open();
+        // Hand over at the middle of the audio that both streams receive.
+        current->cut_ms = to_ms(next->offset + (position - next->offset) / 2);
+        if (current->failed || current->ended) {
+            current->context.TryCancel();
+        } else {
+            write_to(*current, nullptr, 0, true);
+            if (!current->failed) current->stream->WritesDone();
+        }
+        closing.push_back(std::move(current));
+        current = std::move(next);
+    }
+
+    /// @brief Finalize a stream and commit its words to the transcript.
+    ///
+    /// @param segment The stream to finalize.
+    ///
+    void finalize(Segment& segment) {
+        segment.reader.join();
+        const auto status = segment.stream->Finish();
+        const bool failed = segment.failed || !status.ok();
+        if (failed) {
+            num_failures++;
+            if (!segment.error.empty())
+                last_error = ::grpc::Status(::grpc::StatusCode::INTERNAL, segment.error);
+            else
+                last_error = status.ok() ? ::grpc::Status(::grpc::StatusCode::UNAVAILABLE, "Failed to write to Transcribe stream") : status;
+        }
+        std::vector<::sensory::api::v1::audio::TranscribeWord> words;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            const auto size = stitcher.get_word_list().size();
+            stitcher.commit(segment.aggregator.get_word_list(), to_ms(segment.offset), segment.cut_ms);
+            words.assign(stitcher.get_word_list().begin() + size, stitcher.get_word_list().end());
+        }
+        if (on_words && !words.empty()) on_words(words);
+    }
+
+    /// @brief Finalize the rotated streams that have ended, in order.
+    ///
+    /// @param wait Whether to wait for streams that have not ended yet.
+    ///
+    void drain(const bool& wait) {
+        while (!closing.empty() && (wait || closing.front()->ended)) {
+            finalize(*closing.front());
+            closing.pop_front();
+        }
+    }
+
+ public:
+    /// @brief Initialize a new transcription session.
+    ///
+    /// @param service_ The service for opening `Transcribe` streams.
+    /// @param options_ The options of the session.
+    ///
+    /// @exception std::invalid_argument If the sample rate is zero or the
+    /// segment durations are inconsistent.
+    ///
+    TranscriptionSession(const Service& service_, const TranscriptionSessionOptions& options_) :
+        service(service_),
+        options(options_),
+        overlap_frames(static_cast<std::size_t>(options_.overlap.count()) * options_.sample_rate / 1000) {
+        if (options.sample_rate == 0)
+            throw std::invalid_argument("TranscriptionSession sample rate must be positive.");
+        if (options.max_segment_duration < options.min_segment_duration)
+            throw std::invalid_argument("TranscriptionSession maximal segment duration must not be less than the minimal duration.");
+        if (options.min_segment_duration <= options.overlap)
+            throw std::invalid_argument("TranscriptionSession segments must be longer than the overlap.");
+    }
+
+    /// @brief Finish the session if it is still running.
+    ~TranscriptionSession() {
+        try { finish(); } catch (...) { }
+    }
+
+    /// @brief Set the callback for committed words.
+    ///
+    /// @param callback The function to call with the words of the session
+    /// that become final when a stream is finalized. It is called from the
+    /// thread that calls `write` or `finish`.
+    ///
+    inline void set_words_callback(const WordsCallback& callback) { on_words = callback; }
+
+    /// @brief Write audio to the session.
+    ///
+    /// @param samples The 16-bit mono samples to write.
+    /// @param num_samples The number of samples.
+    ///
+    /// @exception std::runtime_error If the session is finished or more than
+    /// `max_restarts` consecutive streams failed.
+    ///
+    void write(const int16_t* samples, const std::size_t& num_samples) {
+        if (is_finished)
+            throw std::runtime_error("Cannot write to a finished TranscriptionSession.");
+        if (!current) current = open();
+        write_to(*current, samples, num_samples);
+        history.insert(history.end(), samples, samples + num_samples);
+        if (history.size() > overlap_frames)
+            history.erase(history.begin(), history.begin() + (history.size() - overlap_frames));
+        position += num_samples;
+        drain(false);
+        // Replace a stream that failed, or rotate a stream that is due.
+        if (current->failed || current->ended) {
+            if (current->has_response) num_consecutive_failures = 0;
+            if (++num_consecutive_failures > options.max_restarts)
+                throw std::runtime_error("TranscriptionSession exceeded the maximal number of restarts.");
+            rotate();
+            return;
+        }
+        if (current->has_response) num_consecutive_failures = 0;
+        const auto duration = std::chrono::milliseconds(to_ms(position - current->offset));
+        if (duration >= options.max_segment_duration ||
+            (duration >= options.min_segment_duration && !current->has_voice_activity))
+            rotate();
+    }
+
+    /// @brief Finish the session.
+    ///
+    /// @returns The last error of a stream in the session, or `OK` if every
+    /// stream succeeded.
+    ///
+    /// @details
+    /// The final transcript of the current stream is requested and every
+    /// stream is finalized before returning. A response that could not be
+    /// processed is reported with the `INTERNAL` status.
+    ///
+    ::grpc::Status finish() {
+        if (is_finished) return last_error;
+        is_finished = true;
+        if (current) {
+            write_to(*current, nullptr, 0, true);
+            if (!current->failed) current->stream->WritesDone();
+            else current->context.TryCancel();
+            closing.push_back(std::move(current));
+        }
+        drain(true);
+        return last_error;
+    }
+
+    /// @brief Return the stitched transcript.
+    ///
+    /// @param delimiter An optional delimiter between words.
+    /// @returns The transcript of the streams that have been finalized.
+    ///
+    inline std::string get_transcript(const std::string& delimiter = " ") const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stitcher.get_transcript(delimiter);
+    }
+
+    /// @brief Return the stitched word list.
+    ///
+    /// @returns The words of the streams that have been finalized, in session
+    /// time.
+    ///
+    inline std::vector<::sensory::api::v1::audio::TranscribeWord> get_word_list() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stitcher.get_word_list();
+    }
+
+    /// @brief Return the duration of the session.
+    ///
+    /// @returns The duration of the audio written to the session.
+    ///
+    inline std::chrono::milliseconds get_duration() const {
+        return std::chrono::milliseconds(to_ms(position));
+    }
+
+    /// @brief Return the number of streams that were opened.
+    ///
+    /// @returns The number of streams, including replacements for failures.
+    ///
+    inline std::size_t get_num_streams() const { return num_streams; }
+
+    /// @brief Return the number of streams that failed.
+    ///
+    /// @returns The number of streams that failed to write, sent a response
+    /// that could not be processed, or ended with an error status.
+    ///
+    inline std::size_t get_num_failures() const { return num_failures; }
+};
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_TRANSCRIPTION_SESSION_HPP_
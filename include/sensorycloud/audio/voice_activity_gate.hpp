@@ -0,0 +1,296 @@
+// A voice activity gate for suppressing silence in audio streams.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_VOICE_ACTIVITY_GATE_HPP_
+#define SENSORYCLOUD_AUDIO_VOICE_ACTIVITY_GATE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+#include "sensorycloud/audio/audio_encoder.hpp"
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief Options for a voice activity gate.
+struct VoiceActivityGateOptions {
+    /// The sample rate of the audio in Hz, used to map server times back to
+    /// the timeline of the source.
+    uint32_t sample_rate = 16000;
+    /// The absolute energy in dBFS below which a chunk is never speech.
+    float threshold_db = -50.f;
+    /// The margin in dB above the tracked noise floor that a chunk must
+    /// exceed to be speech.
+    float margin_db = 9.f;
+    /// The zero-crossing rate (crossings per sample) above which an energetic
+    /// chunk is treated as broadband noise instead of speech.
+    float max_zero_crossing_rate = 0.45f;
+    /// The number of chunks that are still sent after the last speech chunk.
+    std::size_t hangover_chunks = 8;
+    /// The number of silent chunks that are buffered and sent ahead of the
+    /// first speech chunk, so onsets (e.g., of wake-words) are not clipped.
+    std::size_t pre_roll_chunks = 3;
+    /// The number of consecutive suppressed chunks after which a keep-alive
+    /// is emitted. Use `0` to disable keep-alives.
+    std::size_t keep_alive_chunks = 25;
+    /// The number of samples of digital silence in a keep-alive.
+    std::size_t keep_alive_samples = 160;
+};
+
+/// @brief A lightweight energy and zero-crossing voice activity gate.
+///
+/// @details
+/// The gate classifies each chunk of audio by its energy relative to an
+/// adaptive noise floor (initialized from the first chunk, so streams should
+/// start before the talker does) and by its zero-crossing rate, which is near
+/// 0.5 for white noise and far lower for voiced speech, and decides which
+/// samples are sent to the server. Speech chunks are sent along with the
+/// pre-roll buffered before them, and a hangover keeps sending the tail of
+/// each utterance. Other chunks are suppressed, except for a short chunk of
+/// digital silence that is sent every `keep_alive_chunks` suppressed chunks
+/// so the stream is kept busy.
+///
+/// Because suppressed audio is not sent, times reported by the server are
+/// relative to the sent audio, which jumps ahead of the source at every
+/// onset and keep-alive. The gate records where each contiguous run of sent
+/// audio starts in the source, and `to_source_time` maps server times back
+/// to the timeline of the source.
+///
+class VoiceActivityGate {
+ public:
+    /// @brief The decision of the gate for a chunk.
+    enum class Decision {
+        /// The chunk contains speech and is sent after any pre-roll.
+        Speech,
+        /// The chunk follows speech and is sent as part of the hangover.
+        Hangover,
+        /// The chunk is suppressed and a keep-alive is sent instead.
+        KeepAlive,
+        /// The chunk is suppressed.
+        Silence
+    };
+
+ private:
+    /// The options of the gate.
+    const VoiceActivityGateOptions options;
+    /// The number of interleaved channels.
+    const uint32_t num_channels;
+    /// The energy of the noise floor in dBFS.
+    float noise_floor_db;
+    /// Whether the noise floor has been initialized.
+    bool has_noise_floor;
+    /// The number of hangover chunks that remain to be sent.
+    std::size_t hangover;
+    /// The number of consecutive suppressed chunks.
+    std::size_t num_suppressed_chunks;
+    /// The silent chunks buffered for the pre-roll.
+    std::deque<std::vector<int16_t>> pre_roll;
+    /// The number of samples that have been received.
+    uint64_t num_samples_received;
+    /// The number of samples that have been sent.
+    uint64_t num_samples_sent;
+    /// The number of samples of keep-alive silence that have been sent.
+    uint64_t num_samples_keep_alive;
+    /// The energy of the last chunk in dBFS.
+    float energy_db;
+    /// The zero-crossing rate of the last chunk.
+    float zero_crossing_rate;
+
+    /// @brief The start of a contiguous run of sent audio.
+    struct TimelineSegment {
+        /// The first frame of the run in the sent audio.
+        uint64_t sent_frame;
+        /// The frame of the source that the run starts at.
+        uint64_t source_frame;
+    };
+
+    /// The runs of sent audio in the order they were sent.
+    std::vector<TimelineSegment> timeline;
+
+    /// @brief Record frames that are appended to the sent audio.
+    ///
+    /// @param source_frame The frame of the source the frames start at.
+    /// @param num_frames The number of frames that are sent.
+    ///
+    /// @details
+    /// A new segment is started unless the frames continue the last one.
+    ///
+    void record_sent(const uint64_t& source_frame, const uint64_t& num_frames);
+
+ public:
+    /// @brief Initialize a new voice activity gate.
+    ///
+    /// @param options_ The options of the gate.
+    /// @param num_channels_ The number of interleaved channels of the audio.
+    ///
+    /// @exception std::invalid_argument If `num_channels_` or the sample rate
+    /// of the options is zero.
+    ///
+    explicit VoiceActivityGate(
+        const VoiceActivityGateOptions& options_ = VoiceActivityGateOptions(),
+        const uint32_t& num_channels_ = 1
+    );
+
+    /// @brief Return the options of the gate.
+    ///
+    /// @returns The options that the gate was initialized with.
+    ///
+    inline const VoiceActivityGateOptions& get_options() const { return options; }
+
+    /// @brief Gate a chunk of audio.
+    ///
+    /// @param samples The interleaved 16-bit samples.
+    /// @param num_frames The number of samples per channel.
+    /// @param output The vector to append the interleaved samples to send to.
+    /// Nothing is appended when the chunk is suppressed.
+    /// @returns The decision of the gate for the chunk.
+    ///
+    Decision process(const int16_t* samples, const std::size_t& num_frames, std::vector<int16_t>& output);
+
+    /// @brief Return the energy of the last chunk.
+    ///
+    /// @returns The energy in dBFS.
+    ///
+    inline float get_energy_db() const { return energy_db; }
+
+    /// @brief Return the zero-crossing rate of the last chunk.
+    ///
+    /// @returns The number of sign changes per sample.
+    ///
+    inline float get_zero_crossing_rate() const { return zero_crossing_rate; }
+
+    /// @brief Return the tracked noise floor.
+    ///
+    /// @returns The energy of the noise floor in dBFS.
+    ///
+    inline float get_noise_floor_db() const { return noise_floor_db; }
+
+    /// @brief Return the number of samples that have been received.
+    ///
+    /// @returns The number of samples over all channels.
+    ///
+    inline uint64_t get_num_samples_received() const { return num_samples_received; }
+
+    /// @brief Return the number of samples that have been sent.
+    ///
+    /// @returns The number of samples over all channels, including the
+    /// samples of keep-alives.
+    ///
+    inline uint64_t get_num_samples_sent() const { return num_samples_sent; }
+
+    /// @brief Return the number of samples that are suppressed.
+    ///
+    /// @returns The number of received samples that have not been sent,
+    /// including those that are buffered for the pre-roll.
+    ///
+    inline uint64_t get_num_samples_suppressed() const {
+        return num_samples_received - (num_samples_sent - num_samples_keep_alive);
+    }
+
+    /// @brief Return the number of bytes saved by the gate.
+    ///
+    /// @returns The difference of the `LINEAR16` sizes of the received and
+    /// the sent audio. When the audio is compressed, the saving on the wire
+    /// scales with the compression ratio.
+    ///
+    inline int64_t get_bytes_saved() const {
+        return static_cast<int64_t>(sizeof(int16_t)) *
+            (static_cast<int64_t>(num_samples_received) - static_cast<int64_t>(num_samples_sent));
+    }
+
+    /// @brief Map a frame of the sent audio to the source.
+    ///
+    /// @param sent_frame The frame in the audio that was sent.
+    /// @returns The frame of the source that was sent at `sent_frame`. Frames
+    /// of a keep-alive map to the end of the chunk it replaced.
+    ///
+    uint64_t to_source_frame(const uint64_t& sent_frame) const;
+
+    /// @brief Map a time reported by the server to the source.
+    ///
+    /// @param time_ms The time in the audio that was sent, in milliseconds,
+    /// e.g., the `beginTimeMs` of a transcribed word.
+    /// @returns The time in the source in milliseconds.
+    ///
+    uint64_t to_source_time(const uint64_t& time_ms) const;
+
+    /// @brief Return the number of contiguous runs of sent audio.
+    ///
+    /// @returns The number of segments of the timeline, i.e., the number of
+    /// onsets and keep-alives. The timeline grows by one segment for each.
+    ///
+    inline std::size_t get_num_timeline_segments() const { return timeline.size(); }
+};
+
+/// @brief Gate, encode, and write a chunk of audio to a stream.
+///
+/// @tparam Request The type of the request message with audio content.
+/// @tparam Writer The type of the stream, e.g., the `ClientReaderWriter`
+/// returned by the `AudioService` stream helpers.
+/// @param stream The stream to write the request to.
+/// @param gate The voice activity gate of the stream.
+/// @param encoder The audio encoder of the stream.
+/// @param samples The interleaved 16-bit samples.
+/// @param num_frames The number of samples per channel.
+/// @returns `false` if the write failed, `true` otherwise (including when
+/// the chunk was suppressed and nothing was written).
+///
+/// @details
+/// @code
+/// auto stream = cloud.audio.validate_event(&context, audio_config, validate_event_config);
+/// AudioEncoder encoder(audio_config);
+/// VoiceActivityGate gate;
+/// while (capture(samples, num_frames))
+///     if (!write_gated<ValidateEventRequest>(stream.get(), gate, encoder, samples, num_frames)) break;
+/// @endcode
+///
+template<typename Request, typename Writer>
+bool write_gated(
+    Writer* stream,
+    VoiceActivityGate& gate,
+    AudioEncoder& encoder,
+    const int16_t* samples,
+    const std::size_t& num_frames
+) {
+    std::vector<int16_t> gated;
+    gate.process(samples, num_frames, gated);
+    if (gated.empty()) return true;
+    Request request;
+    encoder.encode(gated.data(), gated.size() / encoder.get_num_channels(), *request.mutable_audiocontent());
+    // The encoder may hold back a short chunk until the next one.
+    if (request.audiocontent().empty()) return true;
+    return stream->Write(request);
+}
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_VOICE_ACTIVITY_GATE_HPP_
@@ -0,0 +1,136 @@
+// Reading and writing of 16-bit PCM WAV files.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_AUDIO_WAV_HPP_
+#define SENSORYCLOUD_AUDIO_WAV_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Audio processing for streaming to the cloud.
+namespace audio {
+
+/// @brief Interleaved 16-bit PCM audio in memory.
+struct PCMAudio {
+    /// The sample rate of the audio in Hz.
+    uint32_t sample_rate = 0;
+    /// The number of interleaved channels.
+    uint32_t num_channels = 0;
+    /// The interleaved samples.
+    std::vector<int16_t> samples;
+
+    /// @brief Return the number of samples per channel.
+    ///
+    /// @returns The number of frames of the audio.
+    ///
+    inline std::size_t get_num_frames() const {
+        return num_channels == 0 ? 0 : samples.size() / num_channels;
+    }
+};
+
+/// @brief The location and format of the samples in a 16-bit PCM WAV file.
+struct WavLayout {
+    /// The sample rate of the audio in Hz.
+    uint32_t sample_rate = 0;
+    /// The number of interleaved channels.
+    uint32_t num_channels = 0;
+    /// The offset of the first sample from the start of the file in bytes.
+    std::size_t data_offset = 0;
+    /// The number of bytes of complete frames in the `data` chunk.
+    std::size_t data_size = 0;
+};
+
+/// @brief Locate the samples of a 16-bit PCM WAV file in memory.
+///
+/// @param data The bytes of the file.
+/// @param size The number of bytes of the file.
+/// @param name The name of the file for error messages.
+/// @returns The layout of the samples in the file.
+///
+/// @exception std::runtime_error If the bytes are not a RIFF/WAVE file with
+/// 16-bit PCM (or `WAVE_FORMAT_EXTENSIBLE` PCM) audio.
+///
+/// @details
+/// The same rules as `read_wav` apply to unknown, truncated, and unpatched
+/// chunks.
+///
+WavLayout parse_wav_layout(const char* data, const std::size_t& size, const std::string& name);
+
+/// @brief Read a 16-bit PCM WAV file.
+///
+/// @param path The path of the WAV file.
+/// @returns The audio of the file.
+///
+/// @exception std::runtime_error If the file cannot be read or is not a
+/// RIFF/WAVE file with 16-bit PCM (or `WAVE_FORMAT_EXTENSIBLE` PCM) audio.
+///
+/// @details
+/// Chunks other than `fmt ` and `data` are skipped. A `data` chunk that is
+/// truncated (e.g., from a recording that was interrupted) is read up to the
+/// end of the file, as is a `data` chunk with a size of zero or `0xFFFFFFFF`
+/// (e.g., from a streamed file whose header was never patched).
+///
+PCMAudio read_wav(const std::string& path);
+
+/// The number of bytes in the canonical header of a PCM WAV file.
+static constexpr std::size_t WAV_HEADER_SIZE = 44;
+
+/// @brief Write the canonical header of a 16-bit PCM WAV file.
+///
+/// @param stream The stream to write the header to.
+/// @param sample_rate The sample rate of the audio in Hz.
+/// @param num_channels The number of interleaved channels.
+/// @param data_size The number of bytes of samples that follow the header.
+///
+/// @details
+/// The header is `WAV_HEADER_SIZE` bytes. Streaming writers can write the
+/// header with a size of zero and rewrite it once the size is known.
+///
+void write_wav_header(std::ostream& stream,
+    const uint32_t& sample_rate,
+    const uint32_t& num_channels,
+    const uint32_t& data_size
+);
+
+/// @brief Write a 16-bit PCM WAV file.
+///
+/// @param path The path of the WAV file.
+/// @param audio The audio to write.
+///
+/// @exception std::runtime_error If the file cannot be written.
+///
+void write_wav(const std::string& path, const PCMAudio& audio);
+
+}  // namespace audio
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_AUDIO_WAV_HPP_
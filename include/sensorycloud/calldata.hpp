@@ -28,9 +28,13 @@
 
 #include "sensorycloud/calldata/async_reader_writer_call.hpp"
 #include "sensorycloud/calldata/async_response_reader_call.hpp"
+#include "sensorycloud/calldata/audio_chunk_request.hpp"
 #include "sensorycloud/calldata/awaitable_bidi_reactor.hpp"
 #include "sensorycloud/calldata/awaitable_read_reactor.hpp"
 #include "sensorycloud/calldata/awaitable_write_reactor.hpp"
 #include "sensorycloud/calldata/callback_data.hpp"
+#include "sensorycloud/calldata/call_future.hpp"
+#include "sensorycloud/calldata/queued_bidi_reactor.hpp"
+#include "sensorycloud/calldata/read_ahead_bidi_reactor.hpp"
 
 #endif  // SENSORYCLOUD_CALLDATA_HPP_
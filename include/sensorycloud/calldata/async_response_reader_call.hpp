@@ -106,6 +106,15 @@ struct AsyncResponseReaderCall {
     ///
     inline const ::grpc::ClientContext& getContext() const { return context; }
 
+    /// @brief Cancel the call if it has not already completed.
+    ///
+    /// @details
+    /// This wraps `::grpc::ClientContext::TryCancel`. The call completes
+    /// promptly with a `CANCELLED` status. This function may be called from
+    /// any thread and has no effect if the call already completed.
+    ///
+    inline void tryCancel() { context.TryCancel(); }
+
     /// @brief Return the status of the call.
     ///
     /// @returns The gRPC status code and message from the call.
@@ -0,0 +1,324 @@
+// A request wrapper that serializes audio content without copies.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_CALLDATA_AUDIO_CHUNK_REQUEST_HPP_
+#define SENSORYCLOUD_CALLDATA_AUDIO_CHUNK_REQUEST_HPP_
+
+#include <grpc/grpc.h>
+#include <grpcpp/channel.h>
+#include <grpcpp/client_context.h>
+#include <grpcpp/generic/generic_stub.h>
+#include <grpcpp/support/byte_buffer.h>
+#include <grpcpp/support/client_callback.h>
+#include <grpcpp/support/slice.h>
+#include <grpcpp/support/status.h>
+#include <grpcpp/impl/codegen/proto_utils.h>
+#include <grpcpp/impl/codegen/serialization_traits.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Abstractions of asynchronous call data.
+namespace calldata {
+
+/// @brief A streaming audio request that serializes audio without copies.
+/// @tparam Message The protobuf request message of the stream, e.g.,
+/// `TranscribeRequest`, `ValidateEventRequest`, `AuthenticateRequest`,
+/// `CreateEnrollmentRequest`, `CreateEnrolledEventRequest`, or
+/// `ValidateEnrolledEventRequest`.
+///
+/// @details
+/// Setting the `audioContent` field of a protobuf request copies the samples
+/// into a `std::string`, and serialization copies them again into the
+/// `::grpc::ByteBuffer` of the call. This request instead holds the audio as
+/// a `::grpc::Slice` that shares ownership of the caller's buffer. On
+/// serialization, the encoded tag and length of the `audioContent` field are
+/// written into a small header slice that is followed by the audio slice, so
+/// the samples are handed to gRPC without being copied. Requests that do not
+/// carry audio, i.e., the initial configuration, are serialized as the
+/// wrapped message.
+///
+template<typename Message>
+class AudioChunkRequest {
+ private:
+    /// The wrapped message for requests that do not carry audio.
+    Message message;
+    /// The audio content of the request.
+    ::grpc::Slice audio;
+    /// A flag determining whether the request carries audio content.
+    bool isAudio = false;
+
+    /// @brief Release a shared owner of audio content.
+    /// @tparam Owner The type of the object that owns the audio content.
+    ///
+    /// @param owner A pointer to a heap allocated `std::shared_ptr<Owner>`.
+    ///
+    template<typename Owner>
+    static void release(void* owner) {
+        delete static_cast<std::shared_ptr<Owner>*>(owner);
+    }
+
+ public:
+    /// @brief Return the wrapped message.
+    ///
+    /// @returns The message that is sent when the request carries no audio.
+    ///
+    inline Message& get_message() { return message; }
+
+    /// @brief Return the wrapped message.
+    ///
+    /// @returns The message that is sent when the request carries no audio.
+    ///
+    inline const Message& get_message() const { return message; }
+
+    /// @brief Set the configuration of the stream.
+    /// @tparam Config The type of the configuration message.
+    ///
+    /// @param config The configuration to send. _Ownership of the dynamically
+    /// allocated configuration is transferred to the request_.
+    ///
+    template<typename Config>
+    inline void set_allocated_config(Config* config) {
+        isAudio = false;
+        audio = ::grpc::Slice();
+        message.set_allocated_config(config);
+    }
+
+    /// @brief Return a flag determining whether the request carries audio.
+    ///
+    /// @returns `true` if the audio content is set, `false` otherwise.
+    ///
+    inline bool has_audio_content() const { return isAudio; }
+
+    /// @brief Return the audio content of the request.
+    ///
+    /// @returns The slice that references the audio content.
+    ///
+    inline const ::grpc::Slice& get_audio_content() const { return audio; }
+
+    /// @brief Set the audio content from a slice.
+    ///
+    /// @param slice The slice holding the audio content.
+    ///
+    inline void set_audio_content(const ::grpc::Slice& slice) {
+        isAudio = true;
+        audio = slice;
+    }
+
+    /// @brief Set the audio content by copying memory.
+    ///
+    /// @param data A pointer to the audio content.
+    /// @param size The number of bytes of audio content.
+    ///
+    /// @details
+    /// The memory is copied into the slice once. gRPC may hold on to the
+    /// slice after `OnWriteDone`, e.g., to retry the call, so borrowed memory
+    /// cannot be referenced safely. Use the overload that accepts a shared
+    /// owner to send the audio without a copy.
+    ///
+    inline void set_audio_content(const void* data, const std::size_t& size) {
+        set_audio_content(::grpc::Slice(data, size));
+    }
+
+    /// @brief Set the audio content from shared memory.
+    /// @tparam Owner The type of the object that owns the audio content.
+    ///
+    /// @param owner The object that owns the audio content, e.g., a
+    /// `std::vector<int16_t>` of samples. gRPC holds a reference to the owner
+    /// until the bytes have been sent.
+    /// @param data A pointer to the audio content inside of the owner.
+    /// @param size The number of bytes of audio content.
+    ///
+    template<typename Owner>
+    inline void set_audio_content(
+        const std::shared_ptr<Owner>& owner,
+        const void* data,
+        const std::size_t& size
+    ) {
+        set_audio_content(::grpc::Slice(
+            const_cast<void*>(data), size,
+            &AudioChunkRequest::release<Owner>,
+            new std::shared_ptr<Owner>(owner)
+        ));
+    }
+
+    /// @brief Return the size of the serialized request.
+    ///
+    /// @returns The number of bytes of the request on the wire.
+    ///
+    inline std::size_t ByteSizeLong() const {
+        if (!isAudio) return message.ByteSizeLong();
+        uint8_t header[16];
+        return encode_header(header) + audio.size();
+    }
+
+    /// @brief Encode the tag and length of the audio content field.
+    ///
+    /// @param buffer The buffer to encode the header into. Must hold at least
+    /// 11 bytes.
+    /// @returns The number of bytes of the header.
+    ///
+    inline std::size_t encode_header(uint8_t* buffer) const {
+        // The tag of a length-delimited field is (number << 3) | 2. The field
+        // numbers of `audioContent` in the SDK are small enough for a single
+        // byte tag, but the varint encoding is used for generality.
+        std::size_t size = 0;
+        uint64_t tag = (static_cast<uint64_t>(Message::kAudioContentFieldNumber) << 3) | 2;
+        while (tag >= 0x80) {
+            buffer[size++] = static_cast<uint8_t>(tag | 0x80);
+            tag >>= 7;
+        }
+        buffer[size++] = static_cast<uint8_t>(tag);
+        uint64_t length = audio.size();
+        while (length >= 0x80) {
+            buffer[size++] = static_cast<uint8_t>(length | 0x80);
+            length >>= 7;
+        }
+        buffer[size++] = static_cast<uint8_t>(length);
+        return size;
+    }
+};
+
+/// @brief A type trait determining whether a type is an `AudioChunkRequest`.
+/// @tparam T The type to check.
+template<typename T>
+struct is_audio_chunk_request : std::false_type { };
+
+/// @brief A type trait determining whether a type is an `AudioChunkRequest`.
+/// @tparam Message The protobuf request message of the stream.
+template<typename Message>
+struct is_audio_chunk_request<AudioChunkRequest<Message>> : std::true_type { };
+
+/// @brief Start a bidirectional stream on a generated stub.
+/// @tparam Async The asynchronous interface of the generated stub.
+/// @tparam Request The type of the request message.
+/// @tparam Response The type of the response message.
+///
+/// @param async The asynchronous interface of the generated stub.
+/// @param rpc The method of the asynchronous interface that starts the stream.
+/// @param context The context of the stream.
+/// @param reactor The reactor of the stream.
+///
+template<typename Async, typename Request, typename Response>
+inline void start_bidi_stream(
+    Async* async,
+    void (Async::*rpc)(::grpc::ClientContext*, ::grpc::ClientBidiReactor<Request, Response>*),
+    const std::shared_ptr<::grpc::Channel>&,
+    const char*,
+    ::grpc::ClientContext* context,
+    ::grpc::ClientBidiReactor<Request, Response>* reactor
+) {
+    (async->*rpc)(context, reactor);
+}
+
+/// @brief Start a bidirectional stream of audio chunk requests.
+/// @tparam Async The asynchronous interface of the generated stub.
+/// @tparam Request The type of the request message.
+/// @tparam Response The type of the response message.
+///
+/// @param channel The channel to start the stream on.
+/// @param method The fully qualified name of the method.
+/// @param context The context of the stream.
+/// @param reactor The reactor of the stream.
+///
+/// @details
+/// The generated stubs are bound to the protobuf message types, so streams of
+/// `AudioChunkRequest` are started on a generic stub that uses the
+/// serialization traits of the wrapper. This overload is selected when the
+/// request type of the reactor is an `AudioChunkRequest`.
+///
+template<typename Async, typename Request, typename Response>
+inline void start_bidi_stream(
+    Async*,
+    void (Async::*)(::grpc::ClientContext*, ::grpc::ClientBidiReactor<Request, Response>*),
+    const std::shared_ptr<::grpc::Channel>& channel,
+    const char* method,
+    ::grpc::ClientContext* context,
+    ::grpc::ClientBidiReactor<AudioChunkRequest<Request>, Response>* reactor
+) {
+    ::grpc::TemplatedGenericStub<AudioChunkRequest<Request>, Response>(channel)
+        .PrepareBidiStreamingCall(context, method, ::grpc::StubOptions(), reactor);
+}
+
+}  // namespace calldata
+
+}  // namespace sensory
+
+namespace grpc {
+
+/// @brief Serialization of audio chunk requests for gRPC.
+/// @tparam Message The protobuf request message of the stream.
+template<typename Message>
+class SerializationTraits<::sensory::calldata::AudioChunkRequest<Message>, void> {
+ public:
+    /// @brief Serialize a request into a byte buffer.
+    ///
+    /// @param request The request to serialize.
+    /// @param buffer The output buffer.
+    /// @param own_buffer The output flag determining whether the buffer is
+    /// owned by the call.
+    /// @returns The status of the serialization.
+    ///
+    static Status Serialize(
+        const ::sensory::calldata::AudioChunkRequest<Message>& request,
+        ByteBuffer* buffer,
+        bool* own_buffer
+    ) {
+        if (!request.has_audio_content())
+            return SerializationTraits<Message>::Serialize(request.get_message(), buffer, own_buffer);
+        uint8_t header[16];
+        const auto header_size = request.encode_header(header);
+        Slice slices[2] = {Slice(header, header_size), request.get_audio_content()};
+        ByteBuffer output(slices, 2);
+        buffer->Swap(&output);
+        *own_buffer = true;
+        return Status::OK;
+    }
+
+    /// @brief Deserialize a request from a byte buffer.
+    ///
+    /// @param buffer The buffer to deserialize.
+    /// @param request The output request.
+    /// @returns The status of the deserialization.
+    ///
+    /// @details
+    /// The request is parsed into the wrapped message, including any audio
+    /// content. This is intended for testing and server-side use.
+    ///
+    static Status Deserialize(
+        ByteBuffer* buffer,
+        ::sensory::calldata::AudioChunkRequest<Message>* request
+    ) {
+        return SerializationTraits<Message>::Deserialize(buffer, &request->get_message());
+    }
+};
+
+}  // namespace grpc
+
+#endif  // SENSORYCLOUD_CALLDATA_AUDIO_CHUNK_REQUEST_HPP_
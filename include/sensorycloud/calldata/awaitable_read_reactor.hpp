@@ -31,7 +31,9 @@
 #include <grpcpp/impl/codegen/async_unary_call.h>
 #include <grpcpp/impl/codegen/async_stream.h>
 #include <grpcpp/impl/codegen/client_callback.h>
+#include <google/protobuf/message.h>
 #include <atomic>
+#include <memory>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
@@ -60,6 +62,9 @@ class AwaitableReadReactor : public ::grpc::ClientReadReactor<Response> {
  private:
     /// The gPRC context that the call is initiated with.
     ::grpc::ClientContext context;
+    /// The request that the stream was opened with, if any. Requests of
+    /// server-streaming calls must outlive the start of the call.
+    std::unique_ptr<::google::protobuf::Message> request;
     /// The status of the RPC after the response is processed.
     ::grpc::Status status;
     /// A flag determining whether the asynchronous has terminated.
@@ -95,6 +100,15 @@ class AwaitableReadReactor : public ::grpc::ClientReadReactor<Response> {
         conditionVariable.notify_one();
     }
 
+    /// @brief Cancel the stream if it has not already completed.
+    ///
+    /// @details
+    /// This wraps `::grpc::ClientContext::TryCancel`. The stream completes
+    /// promptly with a `CANCELLED` status. This function may be called from
+    /// any thread and has no effect if the stream already completed.
+    ///
+    inline void tryCancel() { context.TryCancel(); }
+
     /// @brief Return the status of the stream.
     ///
     /// @returns The gRPC status of the stream after completion.
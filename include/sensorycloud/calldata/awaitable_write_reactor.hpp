@@ -95,6 +95,15 @@ class AwaitableWriteReactor : public ::grpc::ClientWriteReactor<Request> {
         conditionVariable.notify_one();
     }
 
+    /// @brief Cancel the stream if it has not already completed.
+    ///
+    /// @details
+    /// This wraps `::grpc::ClientContext::TryCancel`. The stream completes
+    /// promptly with a `CANCELLED` status. This function may be called from
+    /// any thread and has no effect if the stream already completed.
+    ///
+    inline void tryCancel() { context.TryCancel(); }
+
     /// @brief Return the status of the stream.
     ///
     /// @returns The gRPC status of the stream after completion.
@@ -0,0 +1,241 @@
+// Futures over the callback interface of asynchronous unary calls.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_CALLDATA_CALL_FUTURE_HPP_
+#define SENSORYCLOUD_CALLDATA_CALL_FUTURE_HPP_
+
+#include <grpc/grpc.h>
+#include <grpcpp/support/status.h>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include "sensorycloud/util/future.hpp"
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Abstractions of asynchronous call data.
+namespace calldata {
+
+/// @brief The result of an asynchronous unary call.
+/// @tparam Response The type of the response message.
+template<typename Response>
+struct CallResult {
+    /// The status of the RPC.
+    ::grpc::Status status;
+    /// The response of the RPC.
+    Response response;
+};
+
+/// @brief A callback for asynchronous unary calls that fulfills a future.
+/// @tparam Response The type of the response message.
+///
+/// @details
+/// Instances may be passed to any callback overload of the services, e.g.,
+///
+/// ```
+/// FutureCallback<GetEnrollmentsResponse> callback;
+/// auto future = callback.get_future();
+/// service.get_enrollments(user_id, callback);
+/// // ... do other work ...
+/// const auto& result = future.get();
+/// ```
+///
+/// Copies of the callback share the same promise.
+///
+template<typename Response>
+class FutureCallback {
+ private:
+    /// The promise to fulfill when the call completes. Services invoke
+    /// callbacks through a constant copy, and the promise is a handle to
+    /// state that is shared among the copies of this callback.
+    mutable ::sensory::util::Promise<CallResult<Response>> promise;
+    /// An optional function to run after the promise is fulfilled.
+    std::function<void()> onComplete;
+
+ public:
+    /// @brief Initialize a new callback.
+    ///
+    /// @param onComplete_ An optional function to run after the promise is
+    /// fulfilled.
+    ///
+    explicit FutureCallback(const std::function<void()>& onComplete_ = nullptr) :
+        onComplete(onComplete_) { }
+
+    /// @brief Return the future that is fulfilled by the callback.
+    ///
+    /// @returns A future of the result of the call.
+    ///
+    inline ::sensory::util::Future<CallResult<Response>> get_future() const {
+        return promise.get_future();
+    }
+
+    /// @brief Fulfill the promise with the result of a call.
+    /// @tparam CallData The type of the call data of the service.
+    ///
+    /// @param call The call that completed.
+    ///
+    template<typename CallData>
+    void operator()(const CallData* call) const {
+        CallResult<Response> result;
+        result.status = call->getStatus();
+        result.response = call->getResponse();
+        promise.set_value(std::move(result));
+        if (onComplete) onComplete();
+    }
+};
+
+/// @brief A limiter for the number of asynchronous calls in flight.
+///
+/// @details
+/// Bulk operations, e.g., deleting many enrollments, run much faster with
+/// several calls in flight, but unbounded fan-out overwhelms the server and
+/// the connection. `submit` blocks the calling thread while the limit is
+/// reached and releases the slot of a call when its callback runs, e.g.,
+///
+/// ```
+/// ConcurrencyLimiter limiter(16);
+/// std::vector<Future<CallResult<DeleteEnrollmentResponse>>> futures;
+/// for (const auto& id : enrollment_ids)
+///     futures.push_back(limiter.submit<DeleteEnrollmentResponse>(
+///         [&](const FutureCallback<DeleteEnrollmentResponse>& callback) {
+///             service.delete_enrollment(id, callback);
+///         }));
+/// const auto all = when_all(futures);
+/// const auto& results = all.get();
+/// ```
+///
+class ConcurrencyLimiter {
+ private:
+    /// The state shared with the callbacks of calls in flight.
+    struct State {
+        /// The maximal number of calls in flight.
+        const std::size_t limit;
+        /// The number of calls in flight.
+        std::size_t inFlight;
+        /// A mutex for guarding access to the number of calls in flight.
+        std::mutex mutex;
+        /// A condition variable for signalling that a slot was released.
+        std::condition_variable slotAvailable;
+
+        /// @brief Initialize the state.
+        ///
+        /// @param limit_ The maximal number of calls in flight.
+        ///
+        explicit State(const std::size_t& limit_) : limit(limit_), inFlight(0) { }
+
+        /// @brief Block until a slot is available and take it.
+        inline void acquire() {
+            std::unique_lock<std::mutex> lock(mutex);
+            slotAvailable.wait(lock, [this] { return inFlight < limit; });
+            inFlight++;
+        }
+
+        /// @brief Release a slot.
+        inline void release() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                inFlight--;
+            }
+            slotAvailable.notify_all();
+        }
+
+        /// @brief Block until no calls are in flight.
+        inline void drain() {
+            std::unique_lock<std::mutex> lock(mutex);
+            slotAvailable.wait(lock, [this] { return inFlight == 0; });
+        }
+    };
+
+    /// The state shared with the callbacks of calls in flight.
+    std::shared_ptr<State> state;
+
+ public:
+    /// @brief Initialize a new concurrency limiter.
+    ///
+    /// @param limit The maximal number of calls in flight.
+    ///
+    /// @exception std::invalid_argument If the limit is zero.
+    ///
+    explicit ConcurrencyLimiter(const std::size_t& limit) {
+        if (limit == 0)
+            throw std::invalid_argument("ConcurrencyLimiter limit must be at least 1.");
+        state = std::make_shared<State>(limit);
+    }
+
+    /// @brief Return the maximal number of calls in flight.
+    ///
+    /// @returns The limit of the concurrency limiter.
+    ///
+    inline std::size_t get_limit() const { return state->limit; }
+
+    /// @brief Return the number of calls in flight.
+    ///
+    /// @returns The number of calls that have not completed.
+    ///
+    inline std::size_t get_in_flight() const {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        return state->inFlight;
+    }
+
+    /// @brief Start a call when a slot is available.
+    /// @tparam Response The type of the response message.
+    /// @tparam Launch The type of the function that starts the call.
+    ///
+    /// @param launch A function that starts an asynchronous call with the
+    /// given `FutureCallback`.
+    /// @returns A future of the result of the call.
+    ///
+    /// @details
+    /// The calling thread blocks while the limit is reached. If `launch`
+    /// throws, the slot is released and the exception is propagated.
+    ///
+    template<typename Response, typename Launch>
+    ::sensory::util::Future<CallResult<Response>> submit(const Launch& launch) {
+        state->acquire();
+        auto state_ = state;
+        FutureCallback<Response> callback([state_]() { state_->release(); });
+        try {
+            launch(callback);
+        } catch (...) {
+            state->release();
+            throw;
+        }
+        return callback.get_future();
+    }
+
+    /// @brief Block until all calls in flight have completed.
+    inline void wait() { state->drain(); }
+};
+
+}  // namespace calldata
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_CALLDATA_CALL_FUTURE_HPP_
@@ -32,10 +32,13 @@
 #include <grpcpp/impl/codegen/async_stream.h>
 #include <grpcpp/impl/codegen/client_callback.h>
 #include <atomic>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
 #include <utility>
+#include "sensorycloud/util/executor.hpp"
 
 /// @brief The SensoryCloud SDK.
 namespace sensory {
@@ -109,12 +112,52 @@ struct CallbackData {
     /// @brief Initialize a new call.
     CallbackData() { }
 
+    /// @brief Create the completion handler of a call.
+    ///
+    /// @tparam Callback The type of the callback function. The callback
+    /// should accept a single pointer of type `CallbackData*`.
+    /// @param call The call to complete.
+    /// @param callback The callback to execute when the response arrives.
+    /// @param executor The executor to run the callback on. The handler
+    /// holds a reference so in-flight calls keep the executor alive.
+    /// @returns A handler that stores the status of the call and hands the
+    /// callback to the executor, keeping application code off of the gRPC
+    /// threads. The call is marked as done after the callback returns.
+    ///
+    template<typename Callback>
+    static std::function<void(::grpc::Status)> dispatch(
+        const std::shared_ptr<CallbackData>& call,
+        const Callback& callback,
+        const std::shared_ptr<::sensory::util::Executor>& executor
+    ) {
+        return [call, callback, executor](::grpc::Status status) {
+            // Copy the status to the call.
+            call->status = std::move(status);
+            executor->execute([call, callback]() {
+                // Call the callback function with a raw pointer because
+                // ownership is not being transferred.
+                callback(call.get());
+                // Mark the call as done for any awaiting process.
+                call->setIsDone();
+            });
+        };
+    }
+
     /// @brief Return the context that the call was created with.
     ///
     /// @returns The gRPC context associated with the call.
     ///
     inline const ::grpc::ClientContext& getContext() const { return context; }
 
+    /// @brief Cancel the call if it has not already completed.
+    ///
+    /// @details
+    /// This wraps `::grpc::ClientContext::TryCancel`. The call completes
+    /// promptly with a `CANCELLED` status. This function may be called from
+    /// any thread and has no effect if the call already completed.
+    ///
+    inline void tryCancel() { context.TryCancel(); }
+
     /// @brief Return the status of the call.
     ///
     /// @returns The gRPC status code and message from the call.
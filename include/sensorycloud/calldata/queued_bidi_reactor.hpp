@@ -0,0 +1,461 @@
+// A reactor for bi-directional streams with a bounded write queue.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_CALLDATA_QUEUED_BIDI_REACTOR_HPP_
+#define SENSORYCLOUD_CALLDATA_QUEUED_BIDI_REACTOR_HPP_
+
+#include <grpc/grpc.h>
+#include <grpcpp/client_context.h>
+#include <grpcpp/impl/codegen/client_callback.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include "sensorycloud/calldata/awaitable_bidi_reactor.hpp"
+#include "sensorycloud/util/mpmc_queue.hpp"
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Abstractions of asynchronous call data.
+namespace calldata {
+
+/// @brief Policies for producers that enqueue writes into a full queue.
+enum class QueueFullPolicy {
+    /// Block the producer until space is available in the queue.
+    Block = 0,
+    /// Discard the oldest queued message to make room for the new one.
+    DropOldest,
+    /// Reject the new message and return immediately.
+    Fail
+};
+
+/// @brief Options for configuring the write queue of a `QueuedBidiReactor`.
+struct WriteQueueOptions {
+    /// The maximal number of messages that may be waiting in the queue.
+    std::size_t capacity = 32;
+    /// The queue depth at which the high watermark callback fires.
+    std::size_t high_watermark = 24;
+    /// The queue depth at which the low watermark callback fires after the
+    /// high watermark has been crossed.
+    std::size_t low_watermark = 8;
+    /// The behavior of `enqueueWrite` when the queue is full.
+    QueueFullPolicy policy = QueueFullPolicy::Block;
+    /// Messages smaller than this many bytes are written with a buffer hint
+    /// when more messages are queued behind them, allowing gRPC to coalesce
+    /// them into a single transport write. Use `0` to disable coalescing.
+    std::size_t coalesce_bytes = 4096;
+};
+
+/// @brief A reactor for bi-directional streams with a bounded write queue.
+/// @tparam Factory The factory class that will manage the scope of the stream.
+/// @tparam Request The type of the request message.
+/// @tparam Response The type of the response message.
+///
+/// @details
+/// `::grpc::ClientBidiReactor` permits a single outstanding `StartWrite` at
+/// any time. This reactor lifts that restriction by buffering messages in a
+/// bounded lock-free queue that any number of threads may write into with
+/// `enqueueWrite`. Writes are chained from `OnWriteDone` so the next queued
+/// message goes out as soon as the previous one completes, without the
+/// producing thread (e.g., an audio capture loop) ever waiting on the network.
+///
+/// The stream is expected to be opened through one of the reactor overloads
+/// of the services, which write the initial configuration message in the
+/// `request` buffer before any queued message. Because writes are started
+/// outside of the reactions, the reactor holds the stream open until
+/// `enqueueWritesDone` is called or a write fails; call `enqueueWritesDone`
+/// when the stream should end (e.g., from `OnReadDone(false)` when the server
+/// closes the stream first). Sub-classes that override `OnWriteDone` or
+/// `OnDone` must call the implementation of this class.
+///
+template<typename Factory, typename Request, typename Response>
+class QueuedBidiReactor : public AwaitableBidiReactor<Factory, Request, Response> {
+ public:
+    /// A type for callbacks that respond to watermark crossings.
+    typedef std::function<void()> WatermarkCallback;
+    /// A type for callbacks that respond to completed writes with the latency
+    /// of the write and the number of messages waiting in the queue.
+    typedef std::function<void(const std::chrono::microseconds&, const std::size_t&)> WriteDoneCallback;
+
+ private:
+    /// The options for the write queue.
+    const WriteQueueOptions options;
+    /// The queue of messages waiting to be written.
+    ::sensory::util::MPMCQueue<Request> queue;
+    /// The number of slots in the queue reserved by producers.
+    std::atomic<std::size_t> pending;
+    /// The number of messages in the queue that are ready to be written.
+    std::atomic<std::size_t> ready;
+    /// The number of messages that were dropped or rejected by the queue.
+    std::atomic<std::size_t> dropped;
+    /// A flag determining whether a write is in flight on the stream.
+    std::atomic<bool> isWriting;
+    /// A flag determining whether the producers have finished writing.
+    std::atomic<bool> isClosed;
+    /// A flag determining whether `StartWritesDone` has been called.
+    std::atomic<bool> isWritesDone;
+    /// A flag determining whether the stream can no longer be written to.
+    std::atomic<bool> isBroken;
+    /// A flag determining whether the queue is above the high watermark.
+    std::atomic<bool> isAboveHighWatermark;
+    /// A flag determining whether the reactor holds the stream open for
+    /// writes started outside of the reactions.
+    std::atomic<bool> hasWriteHold;
+    /// The message currently being written to the stream.
+    Request inFlight;
+    /// A mutex for blocking producers while the queue is full.
+    std::mutex spaceMutex;
+    /// A condition variable for signalling blocked producers.
+    std::condition_variable spaceAvailable;
+    /// The callback to fire when the queue rises to the high watermark.
+    WatermarkCallback onHighWatermark;
+    /// The callback to fire when the queue drains to the low watermark.
+    WatermarkCallback onLowWatermark;
+    /// The callback to fire when a queued write completes.
+    WriteDoneCallback onWriteDone;
+    /// The time at which the write in flight was started.
+    std::chrono::steady_clock::time_point writeStartTime;
+
+    /// @brief Wake any producers that are blocked on a full queue.
+    inline void notifyProducers() {
+        std::lock_guard<std::mutex> lock(spaceMutex);
+        spaceAvailable.notify_all();
+    }
+
+    /// @brief Reserve a slot in the queue for a new message.
+    ///
+    /// @param policy The policy to apply if the queue is full.
+    /// @returns `true` if a slot was reserved, `false` otherwise.
+    ///
+    bool reserve(const QueueFullPolicy& policy) {
+        while (!isClosed.load() && !isBroken.load()) {
+            auto count = pending.load();
+            if (count < options.capacity) {
+                if (pending.compare_exchange_weak(count, count + 1)) return true;
+                continue;
+            }
+            switch (policy) {
+            case QueueFullPolicy::Fail:
+                return false;
+            case QueueFullPolicy::DropOldest: {
+                // Take over the slot of the oldest message. If the writer
+                // raced us to it, try again from the top.
+                Request oldest;
+                if (queue.try_pop(oldest)) {
+                    ready--;
+                    dropped++;
+                    return true;
+                }
+                std::this_thread::yield();
+                break;
+            }
+            case QueueFullPolicy::Block: {
+                std::unique_lock<std::mutex> lock(spaceMutex);
+                spaceAvailable.wait(lock, [this] {
+                    return pending.load() < options.capacity || isClosed.load() || isBroken.load();
+                });
+                break;
+            }
+            }
+        }
+        return false;
+    }
+
+    /// @brief Release the hold on the stream for the write flow.
+    ///
+    /// @details
+    /// Releasing the hold may trigger `OnDone` synchronously, after which the
+    /// reactor may be destroyed. This must be the last action of the caller.
+    ///
+    inline void releaseWriteHold() {
+        if (hasWriteHold.exchange(false)) this->RemoveHold();
+    }
+
+    /// @brief Start the next write if no write is currently in flight.
+    inline void tryStartNextWrite() {
+        bool expected = false;
+        if (isWriting.compare_exchange_strong(expected, true))
+            startNextWrite();
+    }
+
+    /// @brief Start the next queued write on the stream.
+    ///
+    /// @details
+    /// The caller must own the `isWriting` flag.
+    ///
+    void startNextWrite() {
+        if (!isBroken.load() && queue.try_pop(inFlight)) {
+            ready--;
+            const auto remaining = --pending;
+            notifyProducers();
+            if (remaining <= options.low_watermark && isAboveHighWatermark.exchange(false) && onLowWatermark)
+                onLowWatermark();
+            // Hint to gRPC that small messages may be buffered when another
+            // message is queued to flush them right behind.
+            ::grpc::WriteOptions write_options;
+            if (ready.load() > 0 && inFlight.ByteSizeLong() < options.coalesce_bytes)
+                write_options.set_buffer_hint();
+            if (onWriteDone) writeStartTime = std::chrono::steady_clock::now();
+            this->StartWrite(&inFlight, write_options);
+            return;
+        }
+        if (isClosed.load() && !isBroken.load() && !isWritesDone.exchange(true)) {
+            // Keep ownership of the `isWriting` flag, the stream is finished.
+            this->StartWritesDone();
+            releaseWriteHold();
+            return;
+        }
+        isWriting.store(false);
+        // A producer may have enqueued a message after the failed pop but
+        // before the flag was released, in which case its own attempt to start
+        // the write lost the race against this thread.
+        if (!isBroken.load() && (ready.load() > 0 || (isClosed.load() && !isWritesDone.load())))
+            tryStartNextWrite();
+    }
+
+ public:
+    /// @brief Create a new bidirectional reactor with a write queue.
+    ///
+    /// @param options_ The options for the write queue.
+    ///
+    /// @exception std::invalid_argument If the capacity is zero or the
+    /// watermarks are not ordered as `low_watermark < high_watermark`.
+    ///
+    explicit QueuedBidiReactor(const WriteQueueOptions& options_ = WriteQueueOptions()) :
+        AwaitableBidiReactor<Factory, Request, Response>(),
+        options(options_),
+        queue(options_.capacity),
+        pending(0),
+        ready(0),
+        dropped(0),
+        // The initial configuration message is written by the service when
+        // the stream is opened, so the reactor starts with a write in flight.
+        isWriting(true),
+        isClosed(false),
+        isWritesDone(false),
+        isBroken(false),
+        isAboveHighWatermark(false),
+        hasWriteHold(false) {
+        if (options.low_watermark >= options.high_watermark)
+            throw std::invalid_argument("low_watermark must be less than high_watermark.");
+    }
+
+    /// @brief Start the call on the stream.
+    ///
+    /// @details
+    /// Queued messages are written from the threads of the producers, i.e.,
+    /// outside of the reactions of the stream. This adds a hold on the stream
+    /// before starting the call to keep it alive until the writes are done,
+    /// the stream breaks, or a write fails. This function hides the
+    /// non-virtual `::grpc::ClientBidiReactor::StartCall` and must be called
+    /// through the type of this reactor (or a sub-class).
+    ///
+    inline void StartCall() {
+        hasWriteHold.store(true);
+        this->AddHold();
+        ::grpc::ClientBidiReactor<Request, Response>::StartCall();
+    }
+
+    /// @brief Set the callback to fire when the queue reaches the high
+    /// watermark.
+    ///
+    /// @param callback The callback to execute. The callback is executed on the
+    /// thread of the producer that filled the queue and must not block.
+    ///
+    /// @details
+    /// This function is not thread-safe and should be called before the stream
+    /// is started.
+    ///
+    inline void setHighWatermarkCallback(const WatermarkCallback& callback) {
+        onHighWatermark = callback;
+    }
+
+    /// @brief Set the callback to fire when the queue drains to the low
+    /// watermark after having reached the high watermark.
+    ///
+    /// @param callback The callback to execute. The callback is executed on a
+    /// gRPC thread and must not block.
+    ///
+    /// @details
+    /// This function is not thread-safe and should be called before the stream
+    /// is started.
+    ///
+    inline void setLowWatermarkCallback(const WatermarkCallback& callback) {
+        onLowWatermark = callback;
+    }
+
+    /// @brief Set the callback to fire when a queued write completes.
+    ///
+    /// @param callback The callback to execute with the time from the start
+    /// of the write to its completion and the number of messages waiting in
+    /// the queue. The callback is executed on a gRPC thread and must not
+    /// block.
+    ///
+    /// @details
+    /// The latency grows when the network or the server falls behind the
+    /// producer, which makes the callback suitable for adapting the size of
+    /// the messages (e.g., with `audio::AdaptiveChunkSizer`). This function is
+    /// not thread-safe and should be called before the stream is started.
+    ///
+    inline void setWriteDoneCallback(const WriteDoneCallback& callback) {
+        onWriteDone = callback;
+    }
+
+    /// @brief Enqueue a message to write to the stream.
+    ///
+    /// @param message The message to write. The message is moved into the
+    /// queue on success.
+    /// @param policy The policy to apply if the queue is full.
+    /// @returns `true` if the message was enqueued, `false` if it was rejected
+    /// because the queue is full (`QueueFullPolicy::Fail`), the writes have
+    /// been closed, or the stream is broken.
+    ///
+    /// @details
+    /// This function is thread-safe and may be called from any number of
+    /// threads concurrently.
+    ///
+    bool enqueueWrite(Request&& message, const QueueFullPolicy& policy) {
+        if (!reserve(policy)) {
+            if (!isClosed.load() && !isBroken.load()) dropped++;
+            return false;
+        }
+        // The reservation guarantees space in the ring, but a consumer that is
+        // mid-way through releasing a cell may briefly hold it.
+        while (!queue.try_push(std::move(message))) std::this_thread::yield();
+        ready++;
+        if (pending.load() >= options.high_watermark && !isAboveHighWatermark.exchange(true) && onHighWatermark)
+            onHighWatermark();
+        tryStartNextWrite();
+        return true;
+    }
+
+    /// @brief Enqueue a message to write to the stream.
+    ///
+    /// @param message The message to write. The message is moved into the
+    /// queue on success.
+    /// @returns `true` if the message was enqueued, `false` otherwise.
+    ///
+    /// @details
+    /// The queue full policy from the options of the reactor is applied.
+    ///
+    inline bool enqueueWrite(Request&& message) {
+        return enqueueWrite(std::move(message), options.policy);
+    }
+
+    /// @brief Enqueue a message to write to the stream.
+    ///
+    /// @param message The message to copy into the queue.
+    /// @param policy The policy to apply if the queue is full.
+    /// @returns `true` if the message was enqueued, `false` otherwise.
+    ///
+    inline bool enqueueWrite(const Request& message, const QueueFullPolicy& policy) {
+        Request copy(message);
+        return enqueueWrite(std::move(copy), policy);
+    }
+
+    /// @brief Enqueue a message to write to the stream.
+    ///
+    /// @param message The message to copy into the queue.
+    /// @returns `true` if the message was enqueued, `false` otherwise.
+    ///
+    inline bool enqueueWrite(const Request& message) {
+        return enqueueWrite(message, options.policy);
+    }
+
+    /// @brief Close the queue and finish writing to the stream.
+    ///
+    /// @details
+    /// Messages that are already in the queue are written before the stream
+    /// is half-closed with `StartWritesDone`. Subsequent calls to
+    /// `enqueueWrite` are rejected and blocked producers are released.
+    ///
+    inline void enqueueWritesDone() {
+        isClosed.store(true);
+        notifyProducers();
+        tryStartNextWrite();
+    }
+
+    /// @brief Return the number of messages waiting in the queue.
+    ///
+    /// @returns The depth of the write queue.
+    ///
+    inline std::size_t getQueueSize() const { return pending.load(); }
+
+    /// @brief Return the number of messages dropped or rejected by the queue.
+    ///
+    /// @returns The number of messages that never made it onto the stream
+    /// because the queue was full.
+    ///
+    inline std::size_t getDroppedCount() const { return dropped.load(); }
+
+    /// @brief Return the options of the write queue.
+    ///
+    /// @returns The options the reactor was created with.
+    ///
+    inline const WriteQueueOptions& getWriteQueueOptions() const { return options; }
+
+    /// @brief Respond to the completion of a write.
+    ///
+    /// @param ok Whether the write succeeded.
+    ///
+    void OnWriteDone(bool ok) override {
+        if (!ok) {  // The stream is broken, nothing else can be written.
+            isBroken.store(true);
+            notifyProducers();
+            releaseWriteHold();
+            return;
+        }
+        // The initial configuration message is written by the service, so
+        // only writes started by the queue have a start time.
+        if (onWriteDone && writeStartTime != std::chrono::steady_clock::time_point())
+            onWriteDone(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - writeStartTime), pending.load());
+        startNextWrite();
+    }
+
+    /// @brief Respond to the completion of the stream.
+    ///
+    /// @param status_ The completion status of the stream.
+    ///
+    void OnDone(const ::grpc::Status& status_) override {
+        // Release any blocked producers before signalling the awaiting thread,
+        // which may destroy the reactor as soon as `await` returns.
+        isBroken.store(true);
+        notifyProducers();
+        AwaitableBidiReactor<Factory, Request, Response>::OnDone(status_);
+    }
+};
+
+}  // namespace calldata
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_CALLDATA_QUEUED_BIDI_REACTOR_HPP_
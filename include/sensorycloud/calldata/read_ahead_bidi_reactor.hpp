@@ -0,0 +1,236 @@
+// A reactor for bi-directional streams that reads ahead of the consumer.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_CALLDATA_READ_AHEAD_BIDI_REACTOR_HPP_
+#define SENSORYCLOUD_CALLDATA_READ_AHEAD_BIDI_REACTOR_HPP_
+
+#include <grpc/grpc.h>
+#include <grpcpp/client_context.h>
+#include <grpcpp/impl/codegen/client_callback.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <utility>
+#include "sensorycloud/calldata/queued_bidi_reactor.hpp"
+#include "sensorycloud/util/spsc_queue.hpp"
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Abstractions of asynchronous call data.
+namespace calldata {
+
+/// @brief A reactor for bi-directional streams that reads ahead of the
+/// consumer.
+/// @tparam Factory The factory class that will manage the scope of the stream.
+/// @tparam Request The type of the request message.
+/// @tparam Response The type of the response message.
+///
+/// @details
+/// Responses of a reactor are delivered in `OnReadDone` on the internal
+/// threads of gRPC, and the next read is not started until `OnReadDone`
+/// returns. This reactor re-arms the read immediately and hands each response
+/// to a consumer thread through a pre-allocated single-producer
+/// single-consumer ring, so application processing of responses never delays
+/// network reads or holds up the threads of gRPC. Responses are moved through
+/// the ring, recycling the storage of the messages once it has warmed up.
+///
+/// Exactly one thread may consume responses with `tryPopResponse` or
+/// `popResponse`. When the ring is full, reads are paused (applying flow
+/// control to the server) until the consumer frees a slot. Writes are queued
+/// as described by `QueuedBidiReactor`. Sub-classes must not override
+/// `OnReadDone`.
+///
+template<typename Factory, typename Request, typename Response>
+class ReadAheadBidiReactor : public QueuedBidiReactor<Factory, Request, Response> {
+ private:
+    /// The ring of responses waiting for the consumer.
+    ::sensory::util::SPSCQueue<Response> responses;
+    /// A flag determining whether reads are paused on a full ring.
+    std::atomic<bool> isReadPaused;
+    /// A flag determining whether the stream has no more responses.
+    std::atomic<bool> isReadDone;
+    /// A flag determining whether the reactor holds the stream open for
+    /// reads started outside of the reactions.
+    std::atomic<bool> hasReadHold;
+    /// A mutex for blocking the consumer while the ring is empty.
+    std::mutex readMutex;
+    /// A condition variable for signalling the consumer.
+    std::condition_variable readAvailable;
+
+    /// @brief Wake the consumer if it is waiting on a response.
+    inline void notifyConsumer() {
+        std::lock_guard<std::mutex> lock(readMutex);
+        readAvailable.notify_one();
+    }
+
+    /// @brief Resume reads that were paused on a full ring.
+    ///
+    /// @details
+    /// This function is called by the consumer after it frees a slot in the
+    /// ring. The paused flag transfers ownership of the `response` buffer
+    /// from the reaction to the consumer, so exactly one of them moves the
+    /// held response into the ring and re-arms the read.
+    ///
+    inline void resumeReads() {
+        if (!isReadPaused.exchange(false)) return;
+        responses.try_push(std::move(this->response));
+        this->StartRead(&this->response);
+    }
+
+    /// @brief Release the hold on the stream for the read flow.
+    inline void releaseReadHold() {
+        if (hasReadHold.exchange(false)) this->RemoveHold();
+    }
+
+ public:
+    /// @brief Create a new bidirectional reactor that reads ahead.
+    ///
+    /// @param capacity The number of responses to buffer ahead of the
+    /// consumer. The capacity is rounded up to the nearest power of two.
+    /// @param options The options for the write queue.
+    ///
+    explicit ReadAheadBidiReactor(
+        const std::size_t& capacity = 16,
+        const WriteQueueOptions& options = WriteQueueOptions()
+    ) :
+        QueuedBidiReactor<Factory, Request, Response>(options),
+        responses(capacity),
+        isReadPaused(false),
+        isReadDone(false),
+        hasReadHold(false) { }
+
+    /// @brief Start the call on the stream.
+    ///
+    /// @details
+    /// Paused reads are resumed from the consumer thread, i.e., outside of
+    /// the reactions of the stream. This adds a hold on the stream for the
+    /// read flow in addition to the hold for the write flow.
+    ///
+    inline void StartCall() {
+        hasReadHold.store(true);
+        this->AddHold();
+        QueuedBidiReactor<Factory, Request, Response>::StartCall();
+    }
+
+    /// @brief Respond to the completion of a read.
+    ///
+    /// @param ok Whether the read succeeded.
+    ///
+    void OnReadDone(bool ok) final {
+        if (!ok) {  // The server has no more responses.
+            isReadDone.store(true);
+            notifyConsumer();
+            releaseReadHold();
+            return;
+        }
+        if (responses.try_push(std::move(this->response)))
+            this->StartRead(&this->response);
+        else  // Hold the response until the consumer frees a slot.
+            isReadPaused.store(true);
+        notifyConsumer();
+    }
+
+    /// @brief Respond to the completion of the stream.
+    ///
+    /// @param status_ The completion status of the stream.
+    ///
+    void OnDone(const ::grpc::Status& status_) override {
+        isReadDone.store(true);
+        notifyConsumer();
+        QueuedBidiReactor<Factory, Request, Response>::OnDone(status_);
+    }
+
+    /// @brief Return the number of responses waiting for the consumer.
+    ///
+    /// @returns The number of buffered responses.
+    ///
+    inline std::size_t getResponseCount() const { return responses.size(); }
+
+    /// @brief Attempt to pop the next response without blocking.
+    ///
+    /// @param response_ The output buffer to move the response into.
+    /// @returns `true` if a response was popped, `false` if none was ready.
+    ///
+    bool tryPopResponse(Response& response_) {
+        if (responses.try_pop(response_)) {
+            resumeReads();
+            return true;
+        }
+        // The ring may have filled and emptied before the reaction flagged
+        // the pause, in which case the held response is the next one.
+        resumeReads();
+        return responses.try_pop(response_);
+    }
+
+    /// @brief Pop the next response, blocking until one is available.
+    ///
+    /// @param response_ The output buffer to move the response into.
+    /// @returns `true` if a response was popped, `false` if the stream has no
+    /// more responses.
+    ///
+    bool popResponse(Response& response_) {
+        while (true) {
+            if (tryPopResponse(response_)) return true;
+            std::unique_lock<std::mutex> lock(readMutex);
+            readAvailable.wait(lock, [this] {
+                return !responses.empty() || isReadPaused.load() || isReadDone.load();
+            });
+            if (responses.empty() && !isReadPaused.load() && isReadDone.load())
+                return false;
+        }
+    }
+
+    /// @brief Pop the next response, blocking until one is available or the
+    /// timeout expires.
+    ///
+    /// @param response_ The output buffer to move the response into.
+    /// @param timeout The maximal amount of time to wait for a response.
+    /// @returns `true` if a response was popped, `false` if the stream has no
+    /// more responses or the timeout expired.
+    ///
+    template<typename Rep, typename Period>
+    bool popResponse(Response& response_, const std::chrono::duration<Rep, Period>& timeout) {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (true) {
+            if (tryPopResponse(response_)) return true;
+            std::unique_lock<std::mutex> lock(readMutex);
+            const auto isReady = readAvailable.wait_until(lock, deadline, [this] {
+                return !responses.empty() || isReadPaused.load() || isReadDone.load();
+            });
+            if (!isReady) return false;
+            if (responses.empty() && !isReadPaused.load() && isReadDone.load())
+                return false;
+        }
+    }
+};
+
+}  // namespace calldata
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_CALLDATA_READ_AHEAD_BIDI_REACTOR_HPP_
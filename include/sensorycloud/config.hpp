@@ -38,7 +38,9 @@
 #include <limits>
 #include <string>
 #include <sstream>
+#include <stdexcept>
 #include "sensorycloud/error/config_error.hpp"
+#include "sensorycloud/util/executor.hpp"
 
 /// @brief The SensoryCloud SDK.
 namespace sensory {
@@ -58,6 +60,9 @@ class Config {
     uint32_t timeout = 10 * 1000;
     /// the gRPC channel associated with this config.
     std::shared_ptr<::grpc::Channel> channel = nullptr;
+    /// the executor for invoking the callbacks of asynchronous calls.
+    std::shared_ptr<::sensory::util::Executor> executor =
+        std::make_shared<::sensory::util::InlineExecutor>();
 
  public:
     /// @brief Initialize a new configuration object.
@@ -162,6 +167,34 @@ class Config {
     ///
     inline const uint32_t& get_timeout() const { return timeout; }
 
+    /// @brief Set the executor for invoking the callbacks of asynchronous calls.
+    ///
+    /// @param executor The executor to invoke callbacks on, e.g., a
+    /// `ThreadPoolExecutor` to keep callbacks off of the gRPC threads.
+    ///
+    /// @exception std::invalid_argument If the executor is null.
+    ///
+    /// @details
+    /// Services read the executor when an asynchronous call is started, so
+    /// the executor should be set before calls are made. Calls that are
+    /// already in flight keep the executor alive until their callback runs.
+    ///
+    inline void set_executor(const std::shared_ptr<::sensory::util::Executor>& executor) {
+        if (executor == nullptr)
+            throw std::invalid_argument("executor must not be null");
+        this->executor = executor;
+    }
+
+    /// @brief Return the executor for invoking the callbacks of asynchronous
+    /// calls.
+    ///
+    /// @returns The executor that callbacks are invoked on. Defaults to an
+    /// `InlineExecutor` that invokes callbacks on the gRPC threads.
+    ///
+    inline const std::shared_ptr<::sensory::util::Executor>& get_executor() const {
+        return executor;
+    }
+
     /// @brief Create a new deadline from the current time and RPC timeout.
     ///
     /// @returns A new deadline for an RPC call.
@@ -27,6 +27,7 @@
 #define SENSORYCLOUD_IO_PATH_HPP_
 
 #include <string>
+#include <vector>
 
 /// @brief The SensoryCloud SDK.
 namespace sensory {
@@ -49,6 +50,19 @@ std::string normalize_uri(const std::string& uri);
 /// @returns True if the path points to a file, false otherwise.
 bool is_file(const char* path);
 
+/// @brief Return a flag determining whether the given path references a directory.
+/// @param path The path on the OS to verify the directory-ness of.
+/// @returns True if the path points to a directory, false otherwise.
+bool is_directory(const char* path);
+
+/// @brief List the regular files in a directory.
+/// @param directory The path of the directory to list.
+/// @param extension An optional extension (e.g., ".wav") that the names of
+/// the files must end with, compared case-insensitively.
+/// @returns The sorted paths of the files, prefixed with the directory.
+/// @exception std::runtime_error If the directory cannot be opened.
+std::vector<std::string> list_files(const std::string& directory, const std::string& extension = "");
+
 }  // namespace path
 
 }  // namespace io
@@ -34,14 +34,37 @@
 #include "sensorycloud/services/audio_service.hpp"
 #include "sensorycloud/services/video_service.hpp"
 #include "sensorycloud/services/assistant_service.hpp"
+#include "sensorycloud/audio/adaptive_chunk_sizer.hpp"
+#include "sensorycloud/audio/audio_encoder.hpp"
+#include "sensorycloud/audio/audio_pacer.hpp"
+#include "sensorycloud/audio/audio_tee.hpp"
+#include "sensorycloud/audio/batch_transcriber.hpp"
+#include "sensorycloud/audio/enrollment_session.hpp"
+#include "sensorycloud/audio/file_source.hpp"
+#include "sensorycloud/audio/latency_tracker.hpp"
+#include "sensorycloud/audio/multi_channel_transcriber.hpp"
+#include "sensorycloud/audio/offline_transcribe_reactor.hpp"
+#include "sensorycloud/audio/pcm.hpp"
+#include "sensorycloud/audio/pre_roll_buffer.hpp"
+#include "sensorycloud/audio/resampler.hpp"
+#include "sensorycloud/audio/resumable_stream.hpp"
+#include "sensorycloud/audio/ring_buffer.hpp"
+#include "sensorycloud/audio/speech_sink.hpp"
+#include "sensorycloud/audio/transcription_session.hpp"
+#include "sensorycloud/audio/voice_activity_gate.hpp"
+#include "sensorycloud/audio/wav.hpp"
 #include "sensorycloud/token_manager/token_manager.hpp"
 #include "sensorycloud/token_manager/in_memory_credential_store.hpp"
 #include "sensorycloud/token_manager/file_system_credential_store.hpp"
+#include "sensorycloud/token_manager/enrollment_token_cache.hpp"
 #include "sensorycloud/io/ini.hpp"
 #include "sensorycloud/io/path.hpp"
 #include "sensorycloud/util/string_extensions.hpp"
+#include "sensorycloud/util/aead.hpp"
 #include "sensorycloud/util/jwt.h"
+#include "sensorycloud/util/latency_histogram.hpp"
 #include "sensorycloud/util/transcript_aggregator.hpp"
+#include "sensorycloud/util/transcript_stitcher.hpp"
 #include "sensorycloud/sys/env.hpp"
 
 /// @brief The SensoryCloud SDK.
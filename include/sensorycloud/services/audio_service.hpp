@@ -222,15 +222,7 @@ class AudioService {
             &call->context,
             &call->request,
             &call->response,
-            [call, callback](::grpc::Status status) {
-                // Copy the status to the call.
-                call->status = std::move(status);
-                // Call the callback function with a raw pointer because
-                // ownership is not being transferred.
-                callback(call.get());
-                // Mark the call as done for any awaiting process.
-                call->setIsDone();
-            });
+            GetModelsCallbackData::dispatch(call, callback, config.get_executor()));
         return call;
     }
 
@@ -352,6 +344,30 @@ class AudioService {
         ::sensory::api::v1::audio::CreateEnrollmentResponse
     > CreateEnrollmentBidiReactor;
 
+    /// @brief A type for encapsulating data for asynchronous
+    /// `CreateEnrollment` calls that read responses ahead of the consumer.
+    typedef ::sensory::calldata::ReadAheadBidiReactor<
+        AudioService<CredentialStore>,
+        ::sensory::api::v1::audio::CreateEnrollmentRequest,
+        ::sensory::api::v1::audio::CreateEnrollmentResponse
+    > CreateEnrollmentReadAheadBidiReactor;
+
+    /// @brief A type for encapsulating data for asynchronous
+    /// `CreateEnrollment` calls with a bounded write queue.
+    typedef ::sensory::calldata::QueuedBidiReactor<
+        AudioService<CredentialStore>,
+        ::sensory::api::v1::audio::CreateEnrollmentRequest,
+        ::sensory::api::v1::audio::CreateEnrollmentResponse
+    > CreateEnrollmentQueuedBidiReactor;
+
+    /// @brief A type for encapsulating data for asynchronous
+    /// `CreateEnrollment` calls that send audio without copies.
+    typedef ::sensory::calldata::AwaitableBidiReactor<
+        AudioService<CredentialStore>,
+        ::sensory::calldata::AudioChunkRequest<::sensory::api::v1::audio::CreateEnrollmentRequest>,
+        ::sensory::api::v1::audio::CreateEnrollmentResponse
+    > CreateEnrollmentAudioChunkBidiReactor;
+
     /// @brief Open a bidirectional stream to the server for the purpose of
     /// creating an audio enrollment.
     ///
@@ -382,7 +398,14 @@ class AudioService {
         enrollment_config->set_deviceid(config.get_device_id());
         reactor->request.set_allocated_config(enrollment_config);
         // Create the stream and write the initial configuration request.
-        biometric_stub->async()->CreateEnrollment(&reactor->context, reactor);
+        ::sensory::calldata::start_bidi_stream(
+            biometric_stub->async(),
+            &::sensory::api::v1::audio::AudioBiometrics::StubInterface::async_interface::CreateEnrollment,
+            config.get_channel(),
+            "/sensory.api.v1.audio.AudioBiometrics/CreateEnrollment",
+            &reactor->context,
+            reactor
+        );
         reactor->StartWrite(&reactor->request);
         reactor->StartRead(&reactor->response);
     }
@@ -502,6 +525,30 @@ class AudioService {
         ::sensory::api::v1::audio::AuthenticateResponse
     > AuthenticateBidiReactor;
 
+    /// @brief A type for encapsulating data for asynchronous
+    /// `Authenticate` calls that read responses ahead of the consumer.
+    typedef ::sensory::calldata::ReadAheadBidiReactor<
+        AudioService<CredentialStore>,
+        ::sensory::api::v1::audio::AuthenticateRequest,
+        ::sensory::api::v1::audio::AuthenticateResponse
+    > AuthenticateReadAheadBidiReactor;
+
+    /// @brief A type for encapsulating data for asynchronous
+    /// `Authenticate` calls with a bounded write queue.
+    typedef ::sensory::calldata::QueuedBidiReactor<
+        AudioService<CredentialStore>,
+        ::sensory::api::v1::audio::AuthenticateRequest,
+        ::sensory::api::v1::audio::AuthenticateResponse
+    > AuthenticateQueuedBidiReactor;
+
+    /// @brief A type for encapsulating data for asynchronous
+    /// `Authenticate` calls that send audio without copies.
+    typedef ::sensory::calldata::AwaitableBidiReactor<
+        AudioService<CredentialStore>,
+        ::sensory::calldata::AudioChunkRequest<::sensory::api::v1::audio::AuthenticateRequest>,
+        ::sensory::api::v1::audio::AuthenticateResponse
+    > AuthenticateAudioChunkBidiReactor;
+
     /// @brief Open a bidirectional stream to the server for the purpose of
     /// enrollment authentication.
     ///
@@ -531,7 +578,14 @@ class AudioService {
         authenticate_config->set_allocated_audio(audio_config);
         reactor->request.set_allocated_config(authenticate_config);
         // Create the stream and write the initial configuration request.
-        biometric_stub->async()->Authenticate(&reactor->context, reactor);
+        ::sensory::calldata::start_bidi_stream(
+            biometric_stub->async(),
+            &::sensory::api::v1::audio::AudioBiometrics::StubInterface::async_interface::Authenticate,
+            config.get_channel(),
+            "/sensory.api.v1.audio.AudioBiometrics/Authenticate",
+            &reactor->context,
+            reactor
+        );
         reactor->StartWrite(&reactor->request);
         reactor->StartRead(&reactor->response);
     }
@@ -651,6 +705,30 @@ class AudioService {
         ::sensory::api::v1::audio::ValidateEventResponse
     > ValidateEventBidiReactor;
 
+    /// @brief A type for encapsulating data for asynchronous
+    /// `ValidateEvent` calls that read responses ahead of the consumer.
+    typedef ::sensory::calldata::ReadAheadBidiReactor<
+        AudioService<CredentialStore>,
+        ::sensory::api::v1::audio::ValidateEventRequest,
+        ::sensory::api::v1::audio::ValidateEventResponse
+    > ValidateEventReadAheadBidiReactor;
+
+    /// @brief A type for encapsulating data for asynchronous
+    /// `ValidateEvent` calls with a bounded write queue.
+    typedef ::sensory::calldata::QueuedBidiReactor<
+        AudioService<CredentialStore>,
+        ::sensory::api::v1::audio::ValidateEventRequest,
+        ::sensory::api::v1::audio::ValidateEventResponse
+    > ValidateEventQueuedBidiReactor;
+
+    /// @brief A type for encapsulating data for asynchronous
+    /// `ValidateEvent` calls that send audio without copies.
+    typedef ::sensory::calldata::AwaitableBidiReactor<
+        AudioService<CredentialStore>,
+        ::sensory::calldata::AudioChunkRequest<::sensory::api::v1::audio::ValidateEventRequest>,
+        ::sensory::api::v1::audio::ValidateEventResponse
+    > ValidateEventAudioChunkBidiReactor;
+
     /// @brief Open a bidirectional stream to the server for the purpose of
     /// audio event validation.
     ///
@@ -680,7 +758,14 @@ class AudioService {
         validate_event_config->set_allocated_audio(audio_config);
         reactor->request.set_allocated_config(validate_event_config);
         // Create the stream and write the initial configuration request.
-        events_stub->async()->ValidateEvent(&reactor->context, reactor);
+        ::sensory::calldata::start_bidi_stream(
+            events_stub->async(),
+            &::sensory::api::v1::audio::AudioEvents::StubInterface::async_interface::ValidateEvent,
+            config.get_channel(),
+            "/sensory.api.v1.audio.AudioEvents/ValidateEvent",
+            &reactor->context,
+            reactor
+        );
         reactor->StartWrite(&reactor->request);
         reactor->StartRead(&reactor->response);
     }
@@ -803,6 +888,30 @@ class AudioService {
         ::sensory::api::v1::audio::CreateEnrollmentResponse
     > CreateEnrolledEventBidiReactor;
 
+    /// @brief A type for encapsulating data for asynchronous
+    /// `CreateEnrolledEvent` calls that read responses ahead of the consumer.
+    typedef ::sensory::calldata::ReadAheadBidiReactor<
+        AudioService<CredentialStore>,
+        ::sensory::api::v1::audio::CreateEnrolledEventRequest,
+        ::sensory::api::v1::audio::CreateEnrollmentResponse
+    > CreateEnrolledEventReadAheadBidiReactor;
+
+    /// @brief A type for encapsulating data for asynchronous
+    /// `CreateEnrolledEvent` calls with a bounded write queue.
+    typedef ::sensory::calldata::QueuedBidiReactor<
+        AudioService<CredentialStore>,
+        ::sensory::api::v1::audio::CreateEnrolledEventRequest,
+        ::sensory::api::v1::audio::CreateEnrollmentResponse
+    > CreateEnrolledEventQueuedBidiReactor;
+
+    /// @brief A type for encapsulating data for asynchronous
+    /// `CreateEnrolledEvent` calls that send audio without copies.
+    typedef ::sensory::calldata::AwaitableBidiReactor<
+        AudioService<CredentialStore>,
+        ::sensory::calldata::AudioChunkRequest<::sensory::api::v1::audio::CreateEnrolledEventRequest>,
+        ::sensory::api::v1::audio::CreateEnrollmentResponse
+    > CreateEnrolledEventAudioChunkBidiReactor;
+
     /// @brief Open a bidirectional stream to the server for the purpose of
     /// creating an audio enrollment.
     ///
@@ -833,7 +942,14 @@ class AudioService {
         enrollment_config->set_allocated_audio(audio_config);
         reactor->request.set_allocated_config(enrollment_config);
         // Create the stream and write the initial configuration request.
-        events_stub->async()->CreateEnrolledEvent(&reactor->context, reactor);
+        ::sensory::calldata::start_bidi_stream(
+            events_stub->async(),
+            &::sensory::api::v1::audio::AudioEvents::StubInterface::async_interface::CreateEnrolledEvent,
+            config.get_channel(),
+            "/sensory.api.v1.audio.AudioEvents/CreateEnrolledEvent",
+            &reactor->context,
+            reactor
+        );
         reactor->StartWrite(&reactor->request);
         reactor->StartRead(&reactor->response);
     }
@@ -953,6 +1069,30 @@ class AudioService {
         ::sensory::api::v1::audio::ValidateEnrolledEventResponse
     > ValidateEnrolledEventBidiReactor;
 
+    /// @brief A type for encapsulating data for asynchronous
+    /// `ValidateEnrolledEvent` calls that read responses ahead of the consumer.
+    typedef ::sensory::calldata::ReadAheadBidiReactor<
+        AudioService<CredentialStore>,
+        ::sensory::api::v1::audio::ValidateEnrolledEventRequest,
+        ::sensory::api::v1::audio::ValidateEnrolledEventResponse
+    > ValidateEnrolledEventReadAheadBidiReactor;
+
+    /// @brief A type for encapsulating data for asynchronous
+    /// `ValidateEnrolledEvent` calls with a bounded write queue.
+    typedef ::sensory::calldata::QueuedBidiReactor<
+        AudioService<CredentialStore>,
+        ::sensory::api::v1::audio::ValidateEnrolledEventRequest,
+        ::sensory::api::v1::audio::ValidateEnrolledEventResponse
+    > ValidateEnrolledEventQueuedBidiReactor;
+
+    /// @brief A type for encapsulating data for asynchronous
+    /// `ValidateEnrolledEvent` calls that send audio without copies.
+    typedef ::sensory::calldata::AwaitableBidiReactor<
+        AudioService<CredentialStore>,
+        ::sensory::calldata::AudioChunkRequest<::sensory::api::v1::audio::ValidateEnrolledEventRequest>,
+        ::sensory::api::v1::audio::ValidateEnrolledEventResponse
+    > ValidateEnrolledEventAudioChunkBidiReactor;
+
     /// @brief Open a bidirectional stream to the server for the purpose of
     /// event enrollment validation.
     ///
@@ -982,7 +1122,14 @@ class AudioService {
         validate_config->set_allocated_audio(audio_config);
         reactor->request.set_allocated_config(validate_config);
         // Create the stream and write the initial configuration request.
-        events_stub->async()->ValidateEnrolledEvent(&reactor->context, reactor);
+        ::sensory::calldata::start_bidi_stream(
+            events_stub->async(),
+            &::sensory::api::v1::audio::AudioEvents::StubInterface::async_interface::ValidateEnrolledEvent,
+            config.get_channel(),
+            "/sensory.api.v1.audio.AudioEvents/ValidateEnrolledEvent",
+            &reactor->context,
+            reactor
+        );
         reactor->StartWrite(&reactor->request);
         reactor->StartRead(&reactor->response);
     }
@@ -1102,6 +1249,30 @@ class AudioService {
         ::sensory::api::v1::audio::TranscribeResponse
     > TranscribeBidiReactor;
 
+    /// @brief A type for encapsulating data for asynchronous
+    /// `Transcribe` calls that read responses ahead of the consumer.
+    typedef ::sensory::calldata::ReadAheadBidiReactor<
+        AudioService<CredentialStore>,
+        ::sensory::api::v1::audio::TranscribeRequest,
+        ::sensory::api::v1::audio::TranscribeResponse
+    > TranscribeReadAheadBidiReactor;
+
+    /// @brief A type for encapsulating data for asynchronous
+    /// `Transcribe` calls with a bounded write queue.
+    typedef ::sensory::calldata::QueuedBidiReactor<
+        AudioService<CredentialStore>,
+        ::sensory::api::v1::audio::TranscribeRequest,
+        ::sensory::api::v1::audio::TranscribeResponse
+    > TranscribeQueuedBidiReactor;
+
+    /// @brief A type for encapsulating data for asynchronous
+    /// `Transcribe` calls that send audio without copies.
+    typedef ::sensory::calldata::AwaitableBidiReactor<
+        AudioService<CredentialStore>,
+        ::sensory::calldata::AudioChunkRequest<::sensory::api::v1::audio::TranscribeRequest>,
+        ::sensory::api::v1::audio::TranscribeResponse
+    > TranscribeAudioChunkBidiReactor;
+
     /// @brief Open a bidirectional stream to the server that provides a
     /// transcription of the provided audio data.
     ///
@@ -1131,7 +1302,14 @@ class AudioService {
         transcribe_config->set_allocated_audio(audio_config);
         reactor->request.set_allocated_config(transcribe_config);
         // Create the stream and write the initial configuration request.
-        transcriptions_stub->async()->Transcribe(&reactor->context, reactor);
+        ::sensory::calldata::start_bidi_stream(
+            transcriptions_stub->async(),
+            &::sensory::api::v1::audio::AudioTranscriptions::StubInterface::async_interface::Transcribe,
+            config.get_channel(),
+            "/sensory.api.v1.audio.AudioTranscriptions/Transcribe",
+            &reactor->context,
+            reactor
+        );
         reactor->StartWrite(&reactor->request);
         reactor->StartRead(&reactor->response);
     }
@@ -1283,9 +1461,14 @@ class AudioService {
         auto synthesis_config = new ::sensory::api::v1::audio::VoiceSynthesisConfig;
         synthesis_config->set_modelname(model_name);
         synthesis_config->set_sampleratehertz(sample_rate);
-        reactor->request.set_allocated_config(synthesis_config);
-        // Create the stream and write the initial configuration request.
-        synthesis_stub->async()->SynthesizeSpeech(&reactor->context, reactor);
+        // Create the request, which the reactor owns because it must outlive
+        // the start of the call.
+        auto request = new ::sensory::api::v1::audio::SynthesizeSpeechRequest;
+        request->set_allocated_config(synthesis_config);
+        request->set_phrase(phrase);
+        reactor->request.reset(request);
+        // Create the stream with the request and start reading the audio.
+        synthesis_stub->async()->SynthesizeSpeech(&reactor->context, request, reactor);
         reactor->StartRead(&reactor->response);
     }
 };
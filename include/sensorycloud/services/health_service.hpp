@@ -170,15 +170,7 @@ class HealthService {
             &call->context,
             &call->request,
             &call->response,
-            [call, callback](::grpc::Status status) {
-                // Copy the status to the call.
-                call->status = std::move(status);
-                // Call the callback function with a raw pointer because
-                // ownership is not being transferred.
-                callback(call.get());
-                // Mark the call as done for any awaiting process.
-                call->setIsDone();
-            });
+            GetHealthCallbackData::dispatch(call, callback, config.get_executor()));
         return call;
     }
 };
@@ -202,15 +202,7 @@ class ManagementService {
             &call->context,
             &call->request,
             &call->response,
-            [call, callback](::grpc::Status status) {
-                // Copy the status to the call.
-                call->status = std::move(status);
-                // Call the callback function with a raw pointer because
-                // ownership is not being transferred.
-                callback(call.get());
-                // Mark the call as done for any awaiting process.
-                call->setIsDone();
-            });
+            GetEnrollmentsCallbackData::dispatch(call, callback, config.get_executor()));
         return call;
     }
 
@@ -319,15 +311,7 @@ class ManagementService {
             &call->context,
             &call->request,
             &call->response,
-            [call, callback](::grpc::Status status) {
-                // Copy the status to the call.
-                call->status = std::move(status);
-                // Call the callback function with a raw pointer because
-                // ownership is not being transferred.
-                callback(call.get());
-                // Mark the call as done for any awaiting process.
-                call->setIsDone();
-            });
+            DeleteEnrollmentCallbackData::dispatch(call, callback, config.get_executor()));
         return call;
     }
 
@@ -433,15 +417,7 @@ class ManagementService {
             &call->context,
             &call->request,
             &call->response,
-            [call, callback](::grpc::Status status) {
-                // Copy the status to the call.
-                call->status = std::move(status);
-                // Call the callback function with a raw pointer because
-                // ownership is not being transferred.
-                callback(call.get());
-                // Mark the call as done for any awaiting process.
-                call->setIsDone();
-            });
+            GetEnrollmentGroupsCallbackData::dispatch(call, callback, config.get_executor()));
         return call;
     }
 
@@ -610,15 +586,7 @@ class ManagementService {
             &call->context,
             &call->request,
             &call->response,
-            [call, callback](::grpc::Status status) {
-                // Copy the status to the call.
-                call->status = std::move(status);
-                // Call the callback function with a raw pointer because
-                // ownership is not being transferred.
-                callback(call.get());
-                // Mark the call as done for any awaiting process.
-                call->setIsDone();
-            });
+            CreateEnrollmentGroupCallbackData::dispatch(call, callback, config.get_executor()));
         return call;
     }
 
@@ -728,15 +696,7 @@ class ManagementService {
             &call->context,
             &call->request,
             &call->response,
-            [call, callback](::grpc::Status status) {
-                // Copy the status to the call.
-                call->status = std::move(status);
-                // Call the callback function with a raw pointer because
-                // ownership is not being transferred.
-                callback(call.get());
-                // Mark the call as done for any awaiting process.
-                call->setIsDone();
-            });
+            UpdateEnrollmentGroupCallbackData::dispatch(call, callback, config.get_executor()));
         return call;
     }
 
@@ -854,15 +814,7 @@ class ManagementService {
             &call->context,
             &call->request,
             &call->response,
-            [call, callback](::grpc::Status status) {
-                // Copy the status to the call.
-                call->status = std::move(status);
-                // Call the callback function with a raw pointer because
-                // ownership is not being transferred.
-                callback(call.get());
-                // Mark the call as done for any awaiting process.
-                call->setIsDone();
-            });
+            AppendEnrollmentGroupCallbackData::dispatch(call, callback, config.get_executor()));
         return call;
     }
 
@@ -977,15 +929,7 @@ class ManagementService {
             &call->context,
             &call->request,
             &call->response,
-            [call, callback](::grpc::Status status) {
-                // Copy the status to the call.
-                call->status = std::move(status);
-                // Call the callback function with a raw pointer because
-                // ownership is not being transferred.
-                callback(call.get());
-                // Mark the call as done for any awaiting process.
-                call->setIsDone();
-            });
+            RemoveEnrollmentsFromGroupCallbackData::dispatch(call, callback, config.get_executor()));
         return call;
     }
 
@@ -1088,15 +1032,7 @@ class ManagementService {
             &call->context,
             &call->request,
             &call->response,
-            [call, callback](::grpc::Status status) {
-                // Copy the status to the call.
-                call->status = std::move(status);
-                // Call the callback function with a raw pointer because
-                // ownership is not being transferred.
-                callback(call.get());
-                // Mark the call as done for any awaiting process.
-                call->setIsDone();
-            });
+            DeleteEnrollmentGroupCallbackData::dispatch(call, callback, config.get_executor()));
         return call;
     }
 };
@@ -261,15 +261,7 @@ class OAuthService {
             &call->context,
             &call->request,
             &call->response,
-            [call, callback](::grpc::Status status) {
-                // Copy the status to the call.
-                call->status = std::move(status);
-                // Call the callback function with a raw pointer because
-                // ownership is not being transferred.
-                callback(call.get());
-                // Mark the call as done for any awaiting process.
-                call->setIsDone();
-            });
+            RegisterDeviceCallbackData::dispatch(call, callback, config.get_executor()));
         return call;
     }
 
@@ -413,15 +405,7 @@ class OAuthService {
             &call->context,
             &call->request,
             &call->response,
-            [call, callback](::grpc::Status status) {
-                // Copy the status to the call.
-                call->status = std::move(status);
-                // Call the callback function with a raw pointer because
-                // ownership is not being transferred.
-                callback(call.get());
-                // Mark the call as done for any awaiting process.
-                call->setIsDone();
-            });
+            RenewCredentialCallbackData::dispatch(call, callback, config.get_executor()));
         return call;
     }
 
@@ -530,15 +514,7 @@ class OAuthService {
             &call->context,
             &call->request,
             &call->response,
-            [call, callback](::grpc::Status status) {
-                // Copy the status to the call.
-                call->status = std::move(status);
-                // Call the callback function with a raw pointer because
-                // ownership is not being transferred.
-                callback(call.get());
-                // Mark the call as done for any awaiting process.
-                call->setIsDone();
-            });
+            GetTokenCallbackData::dispatch(call, callback, config.get_executor()));
         return call;
     }
 
@@ -208,15 +208,7 @@ class VideoService {
             &call->context,
             &call->request,
             &call->response,
-            [call, callback](::grpc::Status status) {
-                // Copy the status to the call.
-                call->status = std::move(status);
-                // Call the callback function with a raw pointer because
-                // ownership is not being transferred.
-                callback(call.get());
-                // Mark the call as done for any awaiting process.
-                call->setIsDone();
-            });
+            GetModelsCallbackData::dispatch(call, callback, config.get_executor()));
         return call;
     }
 
@@ -331,6 +323,22 @@ class VideoService {
         ::sensory::api::v1::video::CreateEnrollmentResponse
     > CreateEnrollmentBidiReactor;
 
+    /// @brief A type for encapsulating data for asynchronous
+    /// `CreateEnrollment` calls that read responses ahead of the consumer.
+    typedef ::sensory::calldata::ReadAheadBidiReactor<
+        VideoService<CredentialStore>,
+        ::sensory::api::v1::video::CreateEnrollmentRequest,
+        ::sensory::api::v1::video::CreateEnrollmentResponse
+    > CreateEnrollmentReadAheadBidiReactor;
+
+    /// @brief A type for encapsulating data for asynchronous
+    /// `CreateEnrollment` calls with a bounded write queue.
+    typedef ::sensory::calldata::QueuedBidiReactor<
+        VideoService<CredentialStore>,
+        ::sensory::api::v1::video::CreateEnrollmentRequest,
+        ::sensory::api::v1::video::CreateEnrollmentResponse
+    > CreateEnrollmentQueuedBidiReactor;
+
     /// @brief Open a bidirectional stream to the server for the purpose of
     /// creating a video enrollment.
     ///
@@ -472,6 +480,22 @@ class VideoService {
         ::sensory::api::v1::video::AuthenticateResponse
     > AuthenticateBidiReactor;
 
+    /// @brief A type for encapsulating data for asynchronous
+    /// `Authenticate` calls that read responses ahead of the consumer.
+    typedef ::sensory::calldata::ReadAheadBidiReactor<
+        VideoService<CredentialStore>,
+        ::sensory::api::v1::video::AuthenticateRequest,
+        ::sensory::api::v1::video::AuthenticateResponse
+    > AuthenticateReadAheadBidiReactor;
+
+    /// @brief A type for encapsulating data for asynchronous
+    /// `Authenticate` calls with a bounded write queue.
+    typedef ::sensory::calldata::QueuedBidiReactor<
+        VideoService<CredentialStore>,
+        ::sensory::api::v1::video::AuthenticateRequest,
+        ::sensory::api::v1::video::AuthenticateResponse
+    > AuthenticateQueuedBidiReactor;
+
     /// @brief Open a bidirectional stream to the server for the purpose of
     /// video authentication.
     ///
@@ -612,6 +636,22 @@ class VideoService {
         ::sensory::api::v1::video::LivenessRecognitionResponse
     > ValidateLivenessBidiReactor;
 
+    /// @brief A type for encapsulating data for asynchronous
+    /// `ValidateLiveness` calls that read responses ahead of the consumer.
+    typedef ::sensory::calldata::ReadAheadBidiReactor<
+        VideoService<CredentialStore>,
+        ::sensory::api::v1::video::ValidateRecognitionRequest,
+        ::sensory::api::v1::video::LivenessRecognitionResponse
+    > ValidateLivenessReadAheadBidiReactor;
+
+    /// @brief A type for encapsulating data for asynchronous
+    /// `ValidateLiveness` calls with a bounded write queue.
+    typedef ::sensory::calldata::QueuedBidiReactor<
+        VideoService<CredentialStore>,
+        ::sensory::api::v1::video::ValidateRecognitionRequest,
+        ::sensory::api::v1::video::LivenessRecognitionResponse
+    > ValidateLivenessQueuedBidiReactor;
+
     /// @brief Open a bidirectional stream to the server for the purpose of
     /// validating the liveness of an image stream.
     ///
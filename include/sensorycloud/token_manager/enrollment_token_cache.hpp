@@ -0,0 +1,540 @@
+// An encrypted cache of enrollment tokens for the SensoryCloud C++ SDK.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_TOKEN_MANAGER_ENROLLMENT_TOKEN_CACHE_HPP_
+#define SENSORYCLOUD_TOKEN_MANAGER_ENROLLMENT_TOKEN_CACHE_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include "sensorycloud/generated/common/common.pb.h"
+#include "sensorycloud/util/aead.hpp"
+#include "sensorycloud/util/base.h"
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Modules for generating and storing secure credentials.
+namespace token_manager {
+
+/// @brief Options for an `EnrollmentTokenCache`.
+struct EnrollmentTokenCacheOptions {
+    /// The maximal number of decrypted tokens to keep in memory.
+    std::size_t max_memory_entries = 64;
+    /// The maximal number of encrypted tokens to keep in the credential store.
+    std::size_t max_stored_entries = 1024;
+    /// The maximal total size of the encrypted tokens in the credential
+    /// store in bytes.
+    std::size_t max_stored_bytes = 4 * 1024 * 1024;
+    /// The prefix of the keys the cache writes to the credential store.
+    std::string key_prefix = "enrollmentToken";
+    /// The `util::AEAD_KEY_SIZE` byte key to encrypt the tokens with. When
+    /// empty, a random key is generated on first use and kept in the
+    /// credential store next to the tokens.
+    std::string encryption_key = "";
+};
+
+/// @brief An encrypted, size-bounded cache of enrollment tokens.
+/// @tparam CredentialStore A key-value store for storing and fetching
+/// credentials and tokens.
+///
+/// @details
+/// Enrollments created with `disableServerEnrollmentTemplateStorage` are only
+/// usable by presenting the enrollment token that the server returned when
+/// the enrollment was created. This cache keeps those tokens on the device,
+/// keyed by enrollment ID, such that authentication requests can have their
+/// token attached automatically (see the `enroll` and `authenticate` file
+/// examples):
+///
+/// @code
+/// token_manager::InMemoryCredentialStore keychain;
+/// token_manager::EnrollmentTokenCache<token_manager::InMemoryCredentialStore> cache(keychain);
+/// // After the enrollment stream finishes:
+/// cache.put(response);  // a `CreateEnrollmentResponse`
+/// // Before opening an authentication stream:
+/// cache.attach(*request.mutable_config());  // an `AuthenticateConfig`
+/// @endcode
+///
+/// Tokens are kept in two tiers. Up to `max_memory_entries` decrypted tokens
+/// are held in memory in least-recently-used order. Every token is also
+/// written to the credential store, encrypted with AES-256-GCM and bound to
+/// its enrollment ID, and the store is bounded by `max_stored_entries` and
+/// `max_stored_bytes`, evicting the least-recently-stored-or-used token
+/// first. The recency of every hit is persisted with the index, so the
+/// eviction order survives restarts.
+///
+/// Unless an `encryption_key` is provided, the key is generated on first use
+/// and kept in the credential store. The tokens are then only as secure as
+/// the store itself, e.g., the OS keychain for a `SecureCredentialStore`.
+/// Tokens that fail to decrypt (because they were tampered with, or the key
+/// changed) are treated as misses and removed from the store.
+///
+/// This class is thread safe.
+///
+template<typename CredentialStore>
+class EnrollmentTokenCache {
+ private:
+    /// @brief Metadata about a token in the credential store.
+    struct Record {
+        /// The size of the encoded token in the store in bytes.
+        std::size_t size;
+        /// The UNIX time the token expires at in milliseconds, 0 for never.
+        int64_t expires_at;
+        /// The logical time the token was last stored or used at.
+        uint64_t last_used;
+    };
+
+    /// @brief A decrypted token in the memory tier.
+    struct Entry {
+        /// The enrollment ID the token belongs to.
+        std::string enrollment_id;
+        /// The decrypted enrollment token.
+        std::string token;
+        /// The UNIX time the token expires at in milliseconds, 0 for never.
+        int64_t expires_at;
+    };
+
+    /// The key-value store to persist encrypted tokens to.
+    CredentialStore& credential_store;
+    /// The options for the cache.
+    const EnrollmentTokenCacheOptions options;
+    /// The key to encrypt tokens with.
+    std::string encryption_key;
+    /// A mutex for synchronizing access to the cache.
+    mutable std::mutex mutex;
+    /// The decrypted tokens ordered from most to least recently used.
+    std::list<Entry> memory;
+    /// The decrypted tokens indexed by enrollment ID.
+    std::unordered_map<std::string, typename std::list<Entry>::iterator> memory_index;
+    /// The metadata of the tokens in the credential store.
+    std::unordered_map<std::string, Record> stored_index;
+    /// The total size of the tokens in the credential store in bytes.
+    std::size_t stored_bytes = 0;
+    /// The logical clock for least-recently-used ordering in the store.
+    uint64_t clock = 0;
+    /// The number of calls to `get` that found a token.
+    uint64_t num_hits = 0;
+    /// The number of calls to `get` that did not find a token.
+    uint64_t num_misses = 0;
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object.
+    ///
+    EnrollmentTokenCache(const EnrollmentTokenCache& other) = delete;
+
+    /// @brief Assign to this object using the `=` operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const EnrollmentTokenCache& other) = delete;
+
+    /// @brief Encode a binary string as lower-case hexadecimal.
+    static std::string to_hex(const std::string& binary) {
+        static const char DIGITS[] = "0123456789abcdef";
+        std::string hex;
+        hex.reserve(2 * binary.size());
+        for (const auto& byte : binary) {
+            hex.push_back(DIGITS[static_cast<uint8_t>(byte) >> 4]);
+            hex.push_back(DIGITS[static_cast<uint8_t>(byte) & 0xF]);
+        }
+        return hex;
+    }
+
+    /// @brief Decode a hexadecimal string, returning `false` if malformed.
+    static bool from_hex(const std::string& hex, std::string& binary) {
+        if (hex.size() % 2 != 0) return false;
+        auto nibble = [](char digit) -> int {
+            if (digit >= '0' && digit <= '9') return digit - '0';
+            if (digit >= 'a' && digit <= 'f') return digit - 'a' + 10;
+            if (digit >= 'A' && digit <= 'F') return digit - 'A' + 10;
+            return -1;
+        };
+        std::string output(hex.size() / 2, '\0');
+        for (std::size_t i = 0; i < output.size(); i++) {
+            const auto high = nibble(hex[2 * i]);
+            const auto low = nibble(hex[2 * i + 1]);
+            if (high < 0 || low < 0) return false;
+            output[i] = static_cast<char>((high << 4) | low);
+        }
+        binary = std::move(output);
+        return true;
+    }
+
+    /// @brief Decode a base64 value from the store, empty if malformed.
+    static std::string decode(const std::string& value) {
+        try {
+            return jwt::base::decode<jwt::alphabet::base64>(value);
+        } catch (const std::runtime_error&) {
+            return "";
+        }
+    }
+
+    /// @brief Return the current UNIX time in milliseconds.
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    /// @brief Return `true` if a token with given expiration has expired.
+    static bool is_expired(int64_t expires_at) {
+        return expires_at > 0 && expires_at <= now();
+    }
+
+    /// @brief Return the key of the encryption key in the credential store.
+    inline std::string get_encryption_key_key() const {
+        return options.key_prefix + ".key";
+    }
+
+    /// @brief Return the key of the token index in the credential store.
+    inline std::string get_index_key() const {
+        return options.key_prefix + ".index";
+    }
+
+    /// @brief Return the key of an enrollment's token in the credential store.
+    inline std::string get_token_key(const std::string& enrollment_id) const {
+        // Enrollment IDs are hex encoded so that the keys are safe to use as
+        // file names and keychain item names.
+        return options.key_prefix + "." + to_hex(enrollment_id);
+    }
+
+    /// @brief Load the token index from the credential store.
+    ///
+    /// @details
+    /// The index is stored as a single line of `;` separated records of the
+    /// form `<hex ID>,<size>,<expires at>,<last used>`. Malformed records are
+    /// skipped.
+    ///
+    void load_index() {
+        if (!credential_store.contains(get_index_key())) return;
+        std::istringstream stream(credential_store.at(get_index_key()));
+        std::string line;
+        while (std::getline(stream, line, ';')) {
+            std::istringstream fields(line);
+            std::string hex_id;
+            std::string enrollment_id;
+            Record record;
+            char comma1 = 0, comma2 = 0;
+            if (!std::getline(fields, hex_id, ',') ||
+                !from_hex(hex_id, enrollment_id) ||
+                !(fields >> record.size >> comma1 >> record.expires_at >> comma2 >> record.last_used) ||
+                comma1 != ',' || comma2 != ',')
+                continue;
+            stored_index[enrollment_id] = record;
+            stored_bytes += record.size;
+            if (record.last_used > clock) clock = record.last_used;
+        }
+    }
+
+    /// @brief Save the token index to the credential store.
+    void save_index() {
+        std::ostringstream stream;
+        for (const auto& item : stored_index) {
+            if (stream.tellp() > 0) stream << ';';
+            stream << to_hex(item.first) << ','
+                << item.second.size << ','
+                << item.second.expires_at << ','
+                << item.second.last_used;
+        }
+        credential_store.emplace(get_index_key(), stream.str());
+    }
+
+    /// @brief Insert a decrypted token into the memory tier.
+    void remember(const std::string& enrollment_id, const std::string& token, int64_t expires_at) {
+        if (options.max_memory_entries == 0) return;
+        auto iter = memory_index.find(enrollment_id);
+        if (iter != memory_index.end()) {
+            memory.erase(iter->second);
+            memory_index.erase(iter);
+        }
+        memory.push_front({enrollment_id, token, expires_at});
+        memory_index[enrollment_id] = memory.begin();
+        while (memory.size() > options.max_memory_entries) {
+            memory_index.erase(memory.back().enrollment_id);
+            memory.pop_back();
+        }
+    }
+
+    /// @brief Remove a token from both tiers without saving the index.
+    void forget(const std::string& enrollment_id) {
+        auto iter = memory_index.find(enrollment_id);
+        if (iter != memory_index.end()) {
+            memory.erase(iter->second);
+            memory_index.erase(iter);
+        }
+        auto record = stored_index.find(enrollment_id);
+        if (record != stored_index.end()) {
+            stored_bytes -= record->second.size;
+            stored_index.erase(record);
+        }
+        const auto key = get_token_key(enrollment_id);
+        if (credential_store.contains(key)) credential_store.erase(key);
+    }
+
+    /// @brief Evict least recently used tokens until the store is in bounds.
+    void evict() {
+        while (!stored_index.empty() && (
+            stored_index.size() > options.max_stored_entries ||
+            stored_bytes > options.max_stored_bytes
+        )) {
+            auto oldest = stored_index.begin();
+            for (auto iter = stored_index.begin(); iter != stored_index.end(); ++iter)
+                if (iter->second.last_used < oldest->second.last_used) oldest = iter;
+            // Copy the ID because `forget` invalidates the iterator.
+            const std::string enrollment_id = oldest->first;
+            forget(enrollment_id);
+        }
+    }
+
+ public:
+    /// @brief Initialize a new enrollment token cache.
+    ///
+    /// @param credential_store_ The credential store to persist tokens to.
+    /// @param options_ The options for the cache.
+    /// @exception `std::invalid_argument` if an `encryption_key` is provided
+    /// that is not `util::AEAD_KEY_SIZE` bytes.
+    ///
+    /// @details
+    /// Tokens that were persisted to the credential store by a previous
+    /// instance with the same `key_prefix` are available from this instance.
+    /// If the encryption key kept in the credential store is corrupt, a new
+    /// key is generated and the previously stored tokens are discarded.
+    ///
+    explicit EnrollmentTokenCache(
+        CredentialStore& credential_store_,
+        const EnrollmentTokenCacheOptions& options_ = {}
+    ) : credential_store(credential_store_), options(options_), encryption_key(options_.encryption_key) {
+        if (!encryption_key.empty()) {
+            if (encryption_key.size() != ::sensory::util::AEAD_KEY_SIZE)
+                throw std::invalid_argument("encryption_key must be 32 bytes");
+            load_index();
+            return;
+        }
+        const auto key = get_encryption_key_key();
+        if (credential_store.contains(key) &&
+            from_hex(credential_store.at(key), encryption_key) &&
+            encryption_key.size() == ::sensory::util::AEAD_KEY_SIZE) {
+            load_index();
+            return;
+        }
+        // There is no usable key; any stored tokens are unreadable.
+        encryption_key = ::sensory::util::aead_generate_key();
+        credential_store.emplace(key, to_hex(encryption_key));
+        load_index();
+        clear();
+    }
+
+    /// @brief Insert (or replace) the token for an enrollment.
+    ///
+    /// @param enrollment_id The ID of the enrollment the token belongs to.
+    /// @param token The enrollment token from the server.
+    /// @param expiration The number of seconds until the token expires, or
+    /// a non-positive number if the token does not expire.
+    ///
+    /// @details
+    /// A token whose encrypted size alone exceeds `max_stored_bytes` is
+    /// evicted immediately and is not cached.
+    ///
+    void put(const std::string& enrollment_id, const std::string& token, int64_t expiration = 0) {
+        const int64_t expires_at = expiration > 0 ? now() + 1000 * expiration : 0;
+        const auto value = jwt::base::encode<jwt::alphabet::base64>(
+            ::sensory::util::aead_seal(encryption_key, token, enrollment_id));
+        std::lock_guard<std::mutex> lock(mutex);
+        forget(enrollment_id);
+        credential_store.emplace(get_token_key(enrollment_id), value);
+        stored_index[enrollment_id] = {value.size(), expires_at, ++clock};
+        stored_bytes += value.size();
+        remember(enrollment_id, token, expires_at);
+        evict();
+        save_index();
+    }
+
+    /// @brief Insert (or replace) the token for an enrollment.
+    ///
+    /// @param enrollment_id The ID of the enrollment the token belongs to.
+    /// @param token The enrollment token from the server.
+    ///
+    inline void put(const std::string& enrollment_id, const ::sensory::api::common::EnrollmentToken& token) {
+        put(enrollment_id, token.token(), token.expiration());
+    }
+
+    /// @brief Insert the token from an enrollment creation response.
+    ///
+    /// @tparam Response The type of the response, e.g.,
+    /// `CreateEnrollmentResponse` from the audio or video service.
+    /// @param response The response to cache the token of.
+    /// @returns `true` if the response had a token to cache, `false` otherwise.
+    ///
+    template<typename Response>
+    inline bool put(const Response& response) {
+        if (response.enrollmentid().empty() || !response.has_enrollmenttoken())
+            return false;
+        put(response.enrollmentid(), response.enrollmenttoken());
+        return true;
+    }
+
+    /// @brief Look up the token for an enrollment.
+    ///
+    /// @param enrollment_id The ID of the enrollment to find the token of.
+    /// @param token The output buffer for the token.
+    /// @returns `true` if a valid token was found, `false` if no token is
+    /// cached, the token has expired, or the token failed to decrypt.
+    ///
+    bool get(const std::string& enrollment_id, std::string& token) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto record = stored_index.find(enrollment_id);
+        auto entry = memory_index.find(enrollment_id);
+        if (entry != memory_index.end() && !is_expired(entry->second->expires_at)) {
+            memory.splice(memory.begin(), memory, entry->second);
+            if (record != stored_index.end()) {
+                record->second.last_used = ++clock;
+                save_index();
+            }
+            token = memory.front().token;
+            num_hits++;
+            return true;
+        }
+        if (record == stored_index.end()) {
+            num_misses++;
+            return false;
+        }
+        std::string plaintext;
+        const auto key = get_token_key(enrollment_id);
+        if (is_expired(record->second.expires_at) ||
+            !credential_store.contains(key) ||
+            !::sensory::util::aead_open(encryption_key, decode(credential_store.at(key)), enrollment_id, plaintext)) {
+            forget(enrollment_id);
+            save_index();
+            num_misses++;
+            return false;
+        }
+        record->second.last_used = ++clock;
+        save_index();
+        remember(enrollment_id, plaintext, record->second.expires_at);
+        token = std::move(plaintext);
+        num_hits++;
+        return true;
+    }
+
+    /// @brief Attach the cached token to an authentication config.
+    ///
+    /// @tparam Config The type of the config, e.g., `AuthenticateConfig` from
+    /// the audio or video service, or `ValidateEnrolledEventConfig`.
+    /// @param config The config to set the `enrollmentToken` of. The config's
+    /// `enrollmentId` determines the token to attach.
+    /// @returns `true` if a token was attached, `false` otherwise.
+    ///
+    template<typename Config>
+    inline bool attach(Config& config) {
+        std::string token;
+        if (config.enrollmentid().empty() || !get(config.enrollmentid(), token))
+            return false;
+        config.set_enrollmenttoken(std::move(token));
+        return true;
+    }
+
+    /// @brief Return `true` if an unexpired token is cached for an enrollment.
+    ///
+    /// @param enrollment_id The ID of the enrollment to check for.
+    ///
+    inline bool contains(const std::string& enrollment_id) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto record = stored_index.find(enrollment_id);
+        return record != stored_index.end() && !is_expired(record->second.expires_at);
+    }
+
+    /// @brief Remove the token for an enrollment, e.g., after the enrollment
+    /// is deleted from the server.
+    ///
+    /// @param enrollment_id The ID of the enrollment to remove the token of.
+    ///
+    inline void erase(const std::string& enrollment_id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        forget(enrollment_id);
+        save_index();
+    }
+
+    /// @brief Remove all tokens from the cache and the credential store.
+    ///
+    /// @details
+    /// The encryption key is kept in the credential store.
+    ///
+    inline void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (!stored_index.empty()) {
+            const std::string enrollment_id = stored_index.begin()->first;
+            forget(enrollment_id);
+        }
+        memory.clear();
+        memory_index.clear();
+        save_index();
+    }
+
+    /// @brief Return the number of calls to `get` that found a token.
+    inline uint64_t get_num_hits() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return num_hits;
+    }
+
+    /// @brief Return the number of calls to `get` that did not find a token.
+    inline uint64_t get_num_misses() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return num_misses;
+    }
+
+    /// @brief Return the number of decrypted tokens held in memory.
+    inline std::size_t get_num_memory_entries() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return memory.size();
+    }
+
+    /// @brief Return the number of encrypted tokens in the credential store.
+    inline std::size_t get_num_stored_entries() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stored_index.size();
+    }
+
+    /// @brief Return the total size of the encrypted tokens in the
+    /// credential store in bytes.
+    inline std::size_t get_num_stored_bytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stored_bytes;
+    }
+};
+
+}  // namespace token_manager
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_TOKEN_MANAGER_ENROLLMENT_TOKEN_CACHE_HPP_
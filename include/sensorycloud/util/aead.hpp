@@ -0,0 +1,98 @@
+// Authenticated encryption for the SensoryCloud C++ SDK.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_UTIL_AEAD_HPP_
+#define SENSORYCLOUD_UTIL_AEAD_HPP_
+
+#include <string>
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Utility functions.
+namespace util {
+
+/// @brief The size of an AES-256-GCM key in bytes.
+constexpr std::size_t AEAD_KEY_SIZE = 32;
+
+/// @brief The size of the random nonce that prefixes a sealed message.
+constexpr std::size_t AEAD_NONCE_SIZE = 12;
+
+/// @brief The size of the authentication tag that suffixes a sealed message.
+constexpr std::size_t AEAD_TAG_SIZE = 16;
+
+/// @brief Generate a random key for `aead_seal` and `aead_open`.
+///
+/// @returns A string of `AEAD_KEY_SIZE` cryptographically secure random bytes.
+/// @exception `std::runtime_error` if the random number generator fails.
+///
+std::string aead_generate_key();
+
+/// @brief Encrypt and authenticate a message using AES-256-GCM.
+///
+/// @param key The `AEAD_KEY_SIZE` byte key to encrypt the message with.
+/// @param plaintext The message to encrypt.
+/// @param associated_data Data that is authenticated, but not encrypted.
+/// @returns The sealed message as the random nonce, followed by the
+/// ciphertext, followed by the authentication tag.
+/// @exception `std::invalid_argument` if the key is not `AEAD_KEY_SIZE` bytes.
+/// @exception `std::runtime_error` if the encryption fails.
+///
+/// @details
+/// A fresh random nonce is generated for each message, so sealing the same
+/// plaintext twice produces two different outputs. The
+/// `associated_data` binds the message to a context (e.g., the name of the
+/// record it is stored under) such that the sealed message cannot be moved
+/// to another context without failing to open.
+///
+std::string aead_seal(
+    const std::string& key,
+    const std::string& plaintext,
+    const std::string& associated_data = ""
+);
+
+/// @brief Decrypt and verify a message sealed by `aead_seal`.
+///
+/// @param key The `AEAD_KEY_SIZE` byte key the message was sealed with.
+/// @param sealed The sealed message from `aead_seal`.
+/// @param associated_data The associated data the message was sealed with.
+/// @param plaintext The output buffer for the decrypted message.
+/// @returns `true` if the message was authentic and was decrypted into
+/// `plaintext`, `false` if the message was truncated, tampered with, sealed
+/// with another key, or sealed with other associated data.
+/// @exception `std::invalid_argument` if the key is not `AEAD_KEY_SIZE` bytes.
+///
+bool aead_open(
+    const std::string& key,
+    const std::string& sealed,
+    const std::string& associated_data,
+    std::string& plaintext
+);
+
+}  // namespace util
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_UTIL_AEAD_HPP_
@@ -0,0 +1,335 @@
+// Cooperative cancellation of asynchronous calls and streams.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_UTIL_CANCELLATION_HPP_
+#define SENSORYCLOUD_UTIL_CANCELLATION_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Utility functions.
+namespace util {
+
+/// @brief The state shared between a `CancellationSource` and its tokens.
+class CancellationState {
+ private:
+    /// A registered cancellation callback.
+    struct Entry {
+        /// The function to run on cancellation.
+        std::function<void()> callback;
+        /// An optional predicate determining whether the entry is still
+        /// needed. Entries that are no longer needed are pruned.
+        std::function<bool()> isAlive;
+    };
+
+    /// A mutex for guarding access to the state.
+    std::mutex mutex;
+    /// A condition variable for signalling that a callback finished.
+    std::condition_variable callbackFinished;
+    /// A flag determining whether cancellation was requested.
+    bool isCancelled = false;
+    /// The registered callbacks, keyed by registration ID.
+    std::map<std::size_t, Entry> entries;
+    /// The ID of the next registration.
+    std::size_t nextID = 1;
+    /// The number of entries at which dead entries are next pruned.
+    std::size_t pruneThreshold = 64;
+    /// The ID of the callback that is currently running, or 0 if none.
+    std::size_t runningID = 0;
+    /// The thread running the current callback.
+    std::thread::id runningThread;
+
+    /// @brief Remove entries that are no longer needed.
+    ///
+    /// @details
+    /// This function must be called while holding the mutex.
+    ///
+    void prune();
+
+ public:
+    /// @brief Return a flag determining whether cancellation was requested.
+    ///
+    /// @returns `true` if cancellation was requested, `false` otherwise.
+    ///
+    bool is_cancelled();
+
+    /// @brief Request cancellation and run the registered callbacks.
+    ///
+    /// @details
+    /// Callbacks run on the calling thread in order of registration. Only the
+    /// first call has an effect.
+    ///
+    void cancel();
+
+    /// @brief Register a callback to run on cancellation.
+    ///
+    /// @param callback The function to run on cancellation.
+    /// @param isAlive An optional predicate determining whether the
+    /// registration is still needed.
+    /// @returns The ID of the registration, or 0 if cancellation was already
+    /// requested, in which case the callback ran on the calling thread.
+    ///
+    std::size_t add(std::function<void()> callback, std::function<bool()> isAlive = nullptr);
+
+    /// @brief Remove a registration.
+    ///
+    /// @param id The ID of the registration to remove.
+    ///
+    /// @details
+    /// If the callback is running on another thread, this function blocks
+    /// until it finishes, so objects referenced by the callback may be safely
+    /// destroyed once this returns.
+    ///
+    void remove(const std::size_t& id);
+
+    /// @brief Return the number of registrations.
+    ///
+    /// @returns The number of callbacks waiting for cancellation.
+    ///
+    std::size_t size();
+};
+
+/// @brief A handle for observing a request for cancellation.
+///
+/// @details
+/// Tokens are cheap to copy and may be shared among any number of calls and
+/// threads. A default constructed token can never be cancelled.
+///
+class CancellationToken {
+ private:
+    /// The state shared with the source.
+    std::shared_ptr<CancellationState> state;
+
+ public:
+    /// @brief Initialize a token that can never be cancelled.
+    CancellationToken() { }
+
+    /// @brief Initialize a token bound to a shared state.
+    ///
+    /// @param state_ The state shared with the source.
+    ///
+    explicit CancellationToken(const std::shared_ptr<CancellationState>& state_) :
+        state(state_) { }
+
+    /// @brief Return a flag determining whether the token can be cancelled.
+    ///
+    /// @returns `true` if the token is bound to a source, `false` otherwise.
+    ///
+    inline bool can_be_cancelled() const { return state != nullptr; }
+
+    /// @brief Return a flag determining whether cancellation was requested.
+    ///
+    /// @returns `true` if cancellation was requested, `false` otherwise.
+    ///
+    inline bool is_cancelled() const { return state && state->is_cancelled(); }
+
+    /// @brief Return the shared state of the token.
+    ///
+    /// @returns The state shared with the source, or `nullptr`.
+    ///
+    inline const std::shared_ptr<CancellationState>& get_state() const { return state; }
+};
+
+/// @brief A registration of a callback on a `CancellationToken`.
+///
+/// @details
+/// The callback is unregistered when the registration is destroyed. Once the
+/// destructor returns, the callback is guaranteed not to be running, so the
+/// registration may be declared next to the objects it references.
+///
+class CancellationRegistration {
+ private:
+    /// The state that the callback is registered with.
+    std::shared_ptr<CancellationState> state;
+    /// The ID of the registration.
+    std::size_t id;
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other the other instance to copy data from
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    CancellationRegistration(const CancellationRegistration& other) = delete;
+
+    /// @brief Assign to this object using the `=` operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const CancellationRegistration& other) = delete;
+
+ public:
+    /// @brief Initialize an empty registration.
+    CancellationRegistration() : id(0) { }
+
+    /// @brief Register a callback on a token.
+    ///
+    /// @param token The token to observe.
+    /// @param callback The function to run on cancellation. If cancellation
+    /// was already requested, the callback runs immediately.
+    ///
+    CancellationRegistration(const CancellationToken& token, std::function<void()> callback) :
+        state(token.get_state()), id(0) {
+        if (state) id = state->add(std::move(callback));
+    }
+
+    /// @brief Move a registration.
+    ///
+    /// @param other The registration to take ownership of.
+    ///
+    CancellationRegistration(CancellationRegistration&& other) :
+        state(std::move(other.state)), id(other.id) { other.id = 0; }
+
+    /// @brief Unregister the callback.
+    ~CancellationRegistration() { reset(); }
+
+    /// @brief Unregister the callback.
+    inline void reset() {
+        if (state && id != 0) state->remove(id);
+        state = nullptr;
+        id = 0;
+    }
+};
+
+/// @brief An object that requests cancellation of its tokens.
+///
+/// @details
+/// Sources may be linked to a parent token to cancel groups of calls
+/// together, e.g., a source per session whose parent is a source for the
+/// entire process that is cancelled on shutdown.
+///
+class CancellationSource {
+ private:
+    /// The state shared with the tokens.
+    std::shared_ptr<CancellationState> state;
+    /// The registration on the parent token.
+    CancellationRegistration parent;
+
+    /// @brief Create a callback that cancels a child state.
+    ///
+    /// @param child The state of the child source.
+    /// @returns A callback holding a weak reference to the child, so the
+    /// parent does not keep the child alive after its source is destroyed.
+    ///
+    static std::function<void()> link(const std::shared_ptr<CancellationState>& child) {
+        std::weak_ptr<CancellationState> weak = child;
+        return [weak]() { if (auto state = weak.lock()) state->cancel(); };
+    }
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other the other instance to copy data from
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    CancellationSource(const CancellationSource& other) = delete;
+
+    /// @brief Assign to this object using the `=` operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const CancellationSource& other) = delete;
+
+ public:
+    /// @brief Initialize a new source.
+    CancellationSource() : state(std::make_shared<CancellationState>()) { }
+
+    /// @brief Initialize a new source that is cancelled with a parent.
+    ///
+    /// @param parent_ The token of the parent source.
+    ///
+    explicit CancellationSource(const CancellationToken& parent_) :
+        state(std::make_shared<CancellationState>()),
+        parent(parent_, link(state)) { }
+
+    /// @brief Return a token that observes this source.
+    ///
+    /// @returns A token for observing requests for cancellation.
+    ///
+    inline CancellationToken get_token() const { return CancellationToken(state); }
+
+    /// @brief Request cancellation of every token of this source.
+    inline void cancel() { state->cancel(); }
+
+    /// @brief Return a flag determining whether cancellation was requested.
+    ///
+    /// @returns `true` if cancellation was requested, `false` otherwise.
+    ///
+    inline bool is_cancelled() const { return state->is_cancelled(); }
+};
+
+/// @brief Cancel a shared call when cancellation is requested.
+/// @tparam Call The type of the call, e.g., the call data returned by the
+/// callback overloads of the services.
+///
+/// @param token The token to observe.
+/// @param call The call to cancel. Only a weak reference is held, and the
+/// registration is pruned after the call is released.
+///
+template<typename Call>
+void cancel_on(const CancellationToken& token, const std::shared_ptr<Call>& call) {
+    if (!token.can_be_cancelled()) return;
+    std::weak_ptr<Call> weak = call;
+    token.get_state()->add([weak]() {
+        if (auto call = weak.lock()) call->tryCancel();
+    }, [weak]() { return !weak.expired(); });
+}
+
+/// @brief Cancel a call or stream when cancellation is requested.
+/// @tparam Call The type of the call, e.g., a reactor.
+///
+/// @param token The token to observe.
+/// @param call The call to cancel.
+/// @returns A registration that must not outlive the call.
+///
+/// @details
+/// Use this overload for calls that are not owned by a `std::shared_ptr`,
+/// e.g., reactors, and destroy the registration before the call.
+///
+template<typename Call>
+CancellationRegistration scoped_cancel_on(const CancellationToken& token, Call& call) {
+    Call* pointer = &call;
+    return CancellationRegistration(token, [pointer]() { pointer->tryCancel(); });
+}
+
+}  // namespace util
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_UTIL_CANCELLATION_HPP_
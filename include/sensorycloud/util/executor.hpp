@@ -0,0 +1,175 @@
+// Executors for running user callbacks off of the gRPC threads.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_UTIL_EXECUTOR_HPP_
+#define SENSORYCLOUD_UTIL_EXECUTOR_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Utility functions.
+namespace util {
+
+/// @brief An interface for objects that execute tasks.
+///
+/// @details
+/// The callback overloads of the services invoke user callbacks through the
+/// executor of the `Config`. Callbacks on the default `InlineExecutor` run
+/// directly on the internal threads of gRPC, where a slow callback delays
+/// every other call in the process. A `ThreadPoolExecutor` or user-defined
+/// executor moves that work off of the gRPC threads. Executors must be safe
+/// to call from any thread.
+///
+class Executor {
+ public:
+    /// @brief Destroy the executor.
+    virtual ~Executor() { }
+
+    /// @brief Execute a task.
+    ///
+    /// @param task The task to execute. The task must be run exactly once.
+    ///
+    virtual void execute(std::function<void()> task) = 0;
+};
+
+/// @brief An executor that runs tasks immediately on the calling thread.
+class InlineExecutor : public Executor {
+ public:
+    /// @brief Execute a task on the calling thread.
+    ///
+    /// @param task The task to execute.
+    ///
+    void execute(std::function<void()> task) override { task(); }
+};
+
+/// @brief An executor that runs tasks on a fixed-size pool of threads.
+///
+/// @details
+/// Tasks are executed in first-in-first-out order. When the executor is
+/// destroyed, tasks that are already queued are executed before the threads
+/// are joined, so callbacks of in-flight calls are never dropped. The
+/// executor must not be destroyed from one of its own tasks.
+///
+class ThreadPoolExecutor : public Executor {
+ private:
+    /// The threads that execute tasks.
+    std::vector<std::thread> threads;
+    /// The queue of tasks waiting to execute.
+    std::deque<std::function<void()>> tasks;
+    /// A mutex for guarding access to the queue of tasks.
+    std::mutex mutex;
+    /// A condition variable for waking threads when tasks arrive.
+    std::condition_variable taskAvailable;
+    /// A flag determining whether the executor is shutting down.
+    bool isStopping;
+
+    /// @brief Execute tasks from the queue until the executor shuts down.
+    void work();
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other the other instance to copy data from
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ThreadPoolExecutor(const ThreadPoolExecutor& other) = delete;
+
+    /// @brief Assign to this object using the `=` operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const ThreadPoolExecutor& other) = delete;
+
+ public:
+    /// @brief Initialize a new thread pool executor.
+    ///
+    /// @param num_threads The number of threads in the pool.
+    ///
+    /// @exception std::invalid_argument If the number of threads is zero.
+    ///
+    explicit ThreadPoolExecutor(const std::size_t& num_threads = 1);
+
+    /// @brief Execute the remaining tasks and join the threads of the pool.
+    ~ThreadPoolExecutor();
+
+    /// @brief Queue a task for execution on the pool.
+    ///
+    /// @param task The task to execute.
+    ///
+    void execute(std::function<void()> task) override;
+
+    /// @brief Return the number of threads in the pool.
+    ///
+    /// @returns The number of threads that execute tasks.
+    ///
+    inline std::size_t get_num_threads() const { return threads.size(); }
+};
+
+/// @brief An executor that forwards tasks to a user-provided function.
+///
+/// @details
+/// This adapter allows integration with an existing event loop or task
+/// system without defining a sub-class of `Executor`, e.g., by posting the
+/// tasks to the main loop of a GUI framework.
+///
+class FunctionExecutor : public Executor {
+ public:
+    /// The type of the function that schedules tasks.
+    typedef std::function<void(std::function<void()>)> Function;
+
+ private:
+    /// The function that schedules tasks.
+    const Function function;
+
+ public:
+    /// @brief Initialize a new function executor.
+    ///
+    /// @param function_ The function that schedules tasks.
+    ///
+    explicit FunctionExecutor(const Function& function_) : function(function_) { }
+
+    /// @brief Forward a task to the user-provided function.
+    ///
+    /// @param task The task to execute.
+    ///
+    void execute(std::function<void()> task) override { function(std::move(task)); }
+};
+
+}  // namespace util
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_UTIL_EXECUTOR_HPP_
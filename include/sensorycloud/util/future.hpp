@@ -0,0 +1,245 @@
+// Lightweight futures with non-blocking combinators.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_UTIL_FUTURE_HPP_
+#define SENSORYCLOUD_UTIL_FUTURE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Utility functions.
+namespace util {
+
+/// @brief The state shared between a `Promise` and its `Future` objects.
+/// @tparam T The type of the value.
+template<typename T>
+struct FutureState {
+    /// A mutex for guarding access to the state.
+    std::mutex mutex;
+    /// A condition variable for signalling waiting threads.
+    std::condition_variable conditionVariable;
+    /// A flag determining whether the value has been set.
+    bool isReady = false;
+    /// The value of the future.
+    T value;
+    /// The continuations to run when the value is set.
+    std::vector<std::function<void()>> continuations;
+};
+
+/// @brief The consumer side of an asynchronous value.
+/// @tparam T The type of the value.
+///
+/// @details
+/// Unlike `std::future`, a `Future` may be copied and observed by any number
+/// of threads, and supports continuations that are run by the thread that
+/// sets the value. This allows `when_all` and `when_any` to combine futures
+/// without blocking or spawning threads.
+///
+template<typename T>
+class Future {
+ private:
+    /// The state shared with the promise.
+    std::shared_ptr<FutureState<T>> state;
+
+ public:
+    /// @brief Initialize an invalid future that is not bound to a promise.
+    Future() { }
+
+    /// @brief Initialize a future bound to a shared state.
+    ///
+    /// @param state_ The state shared with the promise.
+    ///
+    explicit Future(const std::shared_ptr<FutureState<T>>& state_) : state(state_) { }
+
+    /// @brief Return a flag determining whether the future is bound to a
+    /// promise.
+    ///
+    /// @returns `true` if the future is valid, `false` otherwise.
+    ///
+    inline bool valid() const { return state != nullptr; }
+
+    /// @brief Return a flag determining whether the value is available.
+    ///
+    /// @returns `true` if the value has been set, `false` otherwise.
+    ///
+    inline bool is_ready() const {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        return state->isReady;
+    }
+
+    /// @brief Block until the value is available.
+    inline void wait() const {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->conditionVariable.wait(lock, [this] { return state->isReady; });
+    }
+
+    /// @brief Block until the value is available or the timeout expires.
+    ///
+    /// @param timeout The maximal amount of time to wait.
+    /// @returns `true` if the value is available, `false` if the timeout
+    /// expired.
+    ///
+    template<typename Rep, typename Period>
+    inline bool wait_for(const std::chrono::duration<Rep, Period>& timeout) const {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        return state->conditionVariable.wait_for(lock, timeout, [this] { return state->isReady; });
+    }
+
+    /// @brief Block until the value is available and return it.
+    ///
+    /// @returns A reference to the value, valid while any future of the
+    /// promise exists. Do not call `get` on a temporary future.
+    ///
+    inline const T& get() const {
+        wait();
+        return state->value;
+    }
+
+    /// @brief Run a function when the value is available.
+    ///
+    /// @param continuation The function to run. It runs immediately on the
+    /// calling thread if the value is already available, and on the thread
+    /// that sets the value otherwise.
+    ///
+    void on_ready(std::function<void()> continuation) const {
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (!state->isReady) {
+                state->continuations.push_back(std::move(continuation));
+                return;
+            }
+        }
+        continuation();
+    }
+};
+
+/// @brief The producer side of an asynchronous value.
+/// @tparam T The type of the value.
+template<typename T>
+class Promise {
+ private:
+    /// The state shared with the futures.
+    std::shared_ptr<FutureState<T>> state;
+
+ public:
+    /// @brief Initialize a new promise.
+    Promise() : state(std::make_shared<FutureState<T>>()) { }
+
+    /// @brief Return a future bound to this promise.
+    ///
+    /// @returns A future that becomes ready when the value is set.
+    ///
+    inline Future<T> get_future() const { return Future<T>(state); }
+
+    /// @brief Set the value and run the continuations of the futures.
+    ///
+    /// @param value The value to move into the shared state.
+    ///
+    /// @exception std::logic_error If the value has already been set.
+    ///
+    void set_value(T value) {
+        std::vector<std::function<void()>> continuations;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->isReady)
+                throw std::logic_error("Promise value has already been set.");
+            state->value = std::move(value);
+            state->isReady = true;
+            continuations.swap(state->continuations);
+        }
+        state->conditionVariable.notify_all();
+        for (auto& continuation : continuations) continuation();
+    }
+};
+
+/// @brief Combine futures into a future that is ready when all are ready.
+/// @tparam T The type of the values.
+///
+/// @param futures The futures to combine.
+/// @returns A future of the values in the order of the input futures.
+///
+template<typename T>
+Future<std::vector<T>> when_all(const std::vector<Future<T>>& futures) {
+    Promise<std::vector<T>> promise;
+    auto future = promise.get_future();
+    if (futures.empty()) {
+        promise.set_value(std::vector<T>());
+        return future;
+    }
+    // Share one copy of the inputs between the continuations.
+    auto inputs = std::make_shared<std::vector<Future<T>>>(futures);
+    auto remaining = std::make_shared<std::atomic<std::size_t>>(futures.size());
+    for (const auto& input : futures) {
+        input.on_ready([promise, inputs, remaining]() mutable {
+            // The last future to resolve gathers the values.
+            if (remaining->fetch_sub(1) != 1) return;
+            std::vector<T> values;
+            values.reserve(inputs->size());
+            for (const auto& ready : *inputs) values.push_back(ready.get());
+            promise.set_value(std::move(values));
+        });
+    }
+    return future;
+}
+
+/// @brief Combine futures into a future that is ready when any is ready.
+/// @tparam T The type of the values.
+///
+/// @param futures The futures to combine.
+/// @returns A future of the index of the first future that became ready.
+///
+/// @exception std::invalid_argument If no futures are provided.
+///
+template<typename T>
+Future<std::size_t> when_any(const std::vector<Future<T>>& futures) {
+    if (futures.empty())
+        throw std::invalid_argument("when_any requires at least one future.");
+    Promise<std::size_t> promise;
+    auto future = promise.get_future();
+    auto isResolved = std::make_shared<std::atomic<bool>>(false);
+    for (std::size_t index = 0; index < futures.size(); index++) {
+        futures[index].on_ready([promise, isResolved, index]() mutable {
+            if (!isResolved->exchange(true)) promise.set_value(index);
+        });
+    }
+    return future;
+}
+
+}  // namespace util
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_UTIL_FUTURE_HPP_
@@ -0,0 +1,184 @@
+// A concurrent latency histogram for the SensoryCloud C++ SDK.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_UTIL_LATENCY_HISTOGRAM_HPP_
+#define SENSORYCLOUD_UTIL_LATENCY_HISTOGRAM_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Utility functions.
+namespace util {
+
+/// @brief A summary of the latencies in a `LatencyHistogram`.
+struct LatencySummary {
+    /// The number of recorded latencies.
+    uint64_t count = 0;
+    /// The mean latency.
+    std::chrono::microseconds mean{0};
+    /// The median latency.
+    std::chrono::microseconds p50{0};
+    /// The 95th percentile latency.
+    std::chrono::microseconds p95{0};
+    /// The 99th percentile latency.
+    std::chrono::microseconds p99{0};
+    /// The greatest latency.
+    std::chrono::microseconds max{0};
+};
+
+/// @brief A histogram of latencies with bounded relative error.
+///
+/// @details
+/// Latencies are counted in log-linear buckets: each power of two of
+/// microseconds is split into 16 buckets, so a percentile is reported within
+/// about 3% of the true value for latencies from 1 microsecond to 25 days.
+/// The histogram has a fixed size and recording is lock-free, so many
+/// streams can record into one histogram to measure aggregate latency while
+/// each keeps a histogram of its own.
+///
+class LatencyHistogram {
+ public:
+    /// The number of buckets in each power of two.
+    static constexpr std::size_t SUB_BUCKETS = 16;
+    /// The total number of buckets.
+    static constexpr std::size_t NUM_BUCKETS = 38 * SUB_BUCKETS;
+
+ private:
+    /// The number of latencies in each bucket.
+    std::atomic<uint64_t> buckets[NUM_BUCKETS];
+    /// The number of recorded latencies.
+    std::atomic<uint64_t> count;
+    /// The sum of the recorded latencies in microseconds.
+    std::atomic<uint64_t> sum;
+    /// The least recorded latency in microseconds.
+    std::atomic<uint64_t> min;
+    /// The greatest recorded latency in microseconds.
+    std::atomic<uint64_t> max;
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    ///
+    LatencyHistogram(const LatencyHistogram& other) = delete;
+
+    /// @brief Assign to this object using the assignment operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const LatencyHistogram& other) = delete;
+
+    /// @brief Record a number of latencies of the same value.
+    ///
+    /// @param value The latency in microseconds.
+    /// @param num_values The number of latencies to record.
+    ///
+    void record(const uint64_t& value, const uint64_t& num_values);
+
+ public:
+    /// @brief Return the bucket that counts a latency.
+    ///
+    /// @param value The latency in microseconds.
+    /// @returns The index of the bucket.
+    ///
+    static std::size_t get_bucket(const uint64_t& value);
+
+    /// @brief Return the least latency that a bucket counts.
+    ///
+    /// @param bucket The index of the bucket.
+    /// @returns The latency in microseconds.
+    ///
+    static uint64_t get_bucket_start(const std::size_t& bucket);
+
+    /// @brief Return the range of latencies that a bucket counts.
+    ///
+    /// @param bucket The index of the bucket.
+    /// @returns The width of the bucket in microseconds.
+    ///
+    static uint64_t get_bucket_width(const std::size_t& bucket);
+
+    /// @brief Initialize an empty histogram.
+    LatencyHistogram();
+
+    /// @brief Record a latency.
+    ///
+    /// @param latency The latency to record. Negative latencies are recorded
+    /// as zero.
+    ///
+    void record(const std::chrono::microseconds& latency);
+
+    /// @brief Add the latencies of another histogram to this one.
+    ///
+    /// @param other The histogram to add the latencies of.
+    ///
+    void merge(const LatencyHistogram& other);
+
+    /// @brief Remove all latencies from the histogram.
+    ///
+    /// @details
+    /// Latencies that are recorded concurrently may or may not be removed.
+    ///
+    void reset();
+
+    /// @brief Return the number of recorded latencies.
+    inline uint64_t get_count() const { return count.load(std::memory_order_relaxed); }
+
+    /// @brief Return the least recorded latency, zero if empty.
+    std::chrono::microseconds get_min() const;
+
+    /// @brief Return the greatest recorded latency, zero if empty.
+    std::chrono::microseconds get_max() const;
+
+    /// @brief Return the mean of the recorded latencies, zero if empty.
+    std::chrono::microseconds get_mean() const;
+
+    /// @brief Return a percentile of the recorded latencies.
+    ///
+    /// @param percentile The percentile in [0, 100], e.g., 99 for the p99.
+    /// @returns The least latency that at least `percentile` percent of the
+    /// recorded latencies are less than or equal to, within the precision
+    /// of the buckets, or zero if the histogram is empty.
+    ///
+    std::chrono::microseconds get_percentile(const double& percentile) const;
+
+    /// @brief Return the count, mean, p50, p95, p99, and maximum latency.
+    LatencySummary get_summary() const;
+};
+
+}  // namespace util
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_UTIL_LATENCY_HISTOGRAM_HPP_
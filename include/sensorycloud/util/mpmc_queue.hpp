@@ -0,0 +1,227 @@
+// A bounded lock-free multi-producer multi-consumer queue.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_UTIL_MPMC_QUEUE_HPP_
+#define SENSORYCLOUD_UTIL_MPMC_QUEUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Utility functions.
+namespace util {
+
+/// @brief The assumed size of a cache line in bytes.
+static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+/// @brief Round a value up to the nearest power of two.
+///
+/// @param value The value to round up.
+/// @returns The smallest power of two that is greater than or equal to
+/// `value`. Zero is rounded up to one.
+///
+inline std::size_t next_power_of_two(std::size_t value) {
+    std::size_t power = 1;
+    while (power < value) power <<= 1;
+    return power;
+}
+
+/// @brief A bounded lock-free multi-producer multi-consumer queue.
+/// @tparam T The type of the elements in the queue.
+///
+/// @details
+/// This is an implementation of Dmitry Vyukov's bounded MPMC queue. Every
+/// cell in the ring carries a sequence number that encodes whether the cell
+/// is ready to be written or read on the current lap of the ring, so
+/// producers and consumers only contend on a single atomic index each. The
+/// capacity is rounded up to the nearest power of two so that positions can
+/// be mapped onto the ring with a mask. Storage is allocated once at
+/// construction and elements are moved in and out of the pre-constructed
+/// cells, i.e., `T` must be default constructible and move assignable.
+///
+template<typename T>
+class MPMCQueue {
+ private:
+    /// @brief A single slot in the ring buffer.
+    struct Cell {
+        /// The sequence number of the cell for the current lap.
+        std::atomic<std::size_t> sequence;
+        /// The element stored in the cell.
+        T data;
+    };
+
+    /// The ring buffer of cells.
+    std::unique_ptr<Cell[]> buffer;
+    /// The mask for mapping positions onto the ring buffer.
+    const std::size_t mask;
+    /// Padding to keep the enqueue index on its own cache line.
+    char pad0[CACHE_LINE_SIZE];
+    /// The position of the next element to enqueue.
+    std::atomic<std::size_t> enqueue_position;
+    /// Padding to keep the dequeue index on its own cache line.
+    char pad1[CACHE_LINE_SIZE - sizeof(std::atomic<std::size_t>)];
+    /// The position of the next element to dequeue.
+    std::atomic<std::size_t> dequeue_position;
+    /// Padding to prevent false sharing with adjacent objects.
+    char pad2[CACHE_LINE_SIZE - sizeof(std::atomic<std::size_t>)];
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other the other instance to copy data from
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    MPMCQueue(const MPMCQueue& other) = delete;
+
+    /// @brief Assign to this object using the `=` operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const MPMCQueue& other) = delete;
+
+ public:
+    /// @brief Initialize a new queue.
+    ///
+    /// @param capacity The minimal number of elements the queue can hold. The
+    /// capacity is rounded up to the nearest power of two.
+    ///
+    /// @exception std::invalid_argument If the capacity is zero.
+    ///
+    explicit MPMCQueue(const std::size_t& capacity) :
+        buffer(new Cell[next_power_of_two(capacity)]),
+        mask(next_power_of_two(capacity) - 1),
+        enqueue_position(0),
+        dequeue_position(0) {
+        if (capacity == 0)
+            throw std::invalid_argument("MPMCQueue capacity must be at least 1.");
+        for (std::size_t i = 0; i <= mask; i++)
+            buffer[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    /// @brief Return the capacity of the queue.
+    ///
+    /// @returns The number of elements the queue can hold.
+    ///
+    inline std::size_t capacity() const { return mask + 1; }
+
+    /// @brief Return the approximate number of elements in the queue.
+    ///
+    /// @returns The number of elements in the queue at some point during the
+    /// call. The value may be stale by the time it is returned when there are
+    /// concurrent producers or consumers.
+    ///
+    inline std::size_t size() const {
+        const auto tail = dequeue_position.load(std::memory_order_acquire);
+        const auto head = enqueue_position.load(std::memory_order_acquire);
+        return head > tail ? head - tail : 0;
+    }
+
+    /// @brief Return a flag determining whether the queue is empty.
+    ///
+    /// @returns `true` if the queue had no elements at some point during the
+    /// call, `false` otherwise.
+    ///
+    inline bool empty() const { return size() == 0; }
+
+    /// @brief Attempt to push an element onto the back of the queue.
+    ///
+    /// @param value The value to move into the queue.
+    /// @returns `true` if the element was enqueued, `false` if the queue was
+    /// full. `value` is left untouched when the queue is full.
+    ///
+    bool try_push(T&& value) {
+        Cell* cell;
+        auto position = enqueue_position.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &buffer[position & mask];
+            const auto sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (difference == 0) {  // The cell is free on this lap, claim it.
+                if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            } else if (difference < 0) {  // The cell has not been consumed.
+                return false;
+            } else {  // Another producer claimed the cell, reload the head.
+                position = enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(value);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Attempt to push an element onto the back of the queue.
+    ///
+    /// @param value The value to copy into the queue.
+    /// @returns `true` if the element was enqueued, `false` if the queue was
+    /// full.
+    ///
+    inline bool try_push(const T& value) {
+        T copy(value);
+        return try_push(std::move(copy));
+    }
+
+    /// @brief Attempt to pop an element from the front of the queue.
+    ///
+    /// @param value The output value to move the front element into.
+    /// @returns `true` if an element was dequeued, `false` if the queue was
+    /// empty.
+    ///
+    bool try_pop(T& value) {
+        Cell* cell;
+        auto position = dequeue_position.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &buffer[position & mask];
+            const auto sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+            if (difference == 0) {  // The cell is filled on this lap, claim it.
+                if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            } else if (difference < 0) {  // The cell has not been produced.
+                return false;
+            } else {  // Another consumer claimed the cell, reload the tail.
+                position = dequeue_position.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->data);
+        // Release the cell for the producer on the next lap of the ring.
+        cell->sequence.store(position + mask + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+}  // namespace util
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_UTIL_MPMC_QUEUE_HPP_
@@ -0,0 +1,196 @@
+// A bounded lock-free single-producer single-consumer queue.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_UTIL_SPSC_QUEUE_HPP_
+#define SENSORYCLOUD_UTIL_SPSC_QUEUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include "sensorycloud/util/mpmc_queue.hpp"
+
+/// @brief The SensoryCloud SDK.
+namespace sensory {
+
+/// @brief Utility functions.
+namespace util {
+
+/// @brief A bounded lock-free single-producer single-consumer queue.
+/// @tparam T The type of the elements in the queue.
+///
+/// @details
+/// The queue is a pre-allocated power-of-two ring with the head and tail
+/// indices on separate cache lines. Exactly one thread may push and exactly
+/// one (possibly different) thread may pop at any given time. Elements are
+/// moved in and out of pre-constructed slots, so types that recycle their
+/// internal storage on move assignment (e.g., protobuf messages, strings, and
+/// vectors) are handed off without allocation once the ring has warmed up.
+///
+template<typename T>
+class SPSCQueue {
+ private:
+    /// The ring buffer of elements.
+    std::unique_ptr<T[]> buffer;
+    /// The mask for mapping positions onto the ring buffer.
+    const std::size_t mask;
+    /// Padding to keep the write index on its own cache line.
+    char pad0[CACHE_LINE_SIZE];
+    /// The position of the next element to write (owned by the producer).
+    std::atomic<std::size_t> head;
+    /// Padding to keep the read index on its own cache line.
+    char pad1[CACHE_LINE_SIZE - sizeof(std::atomic<std::size_t>)];
+    /// The position of the next element to read (owned by the consumer).
+    std::atomic<std::size_t> tail;
+    /// Padding to prevent false sharing with adjacent objects.
+    char pad2[CACHE_LINE_SIZE - sizeof(std::atomic<std::size_t>)];
+
+    /// @brief Create a copy of this object.
+    ///
+    /// @param other the other instance to copy data from
+    ///
+    /// @details
+    /// This copy constructor is private to prevent the copying of this object
+    SPSCQueue(const SPSCQueue& other) = delete;
+
+    /// @brief Assign to this object using the `=` operator.
+    ///
+    /// @param other The other instance to copy data from.
+    ///
+    /// @details
+    /// This assignment operator is private to prevent copying of this object.
+    ///
+    void operator=(const SPSCQueue& other) = delete;
+
+ public:
+    /// @brief Initialize a new queue.
+    ///
+    /// @param capacity The minimal number of elements the queue can hold. The
+    /// capacity is rounded up to the nearest power of two.
+    ///
+    /// @exception std::invalid_argument If the capacity is zero.
+    ///
+    explicit SPSCQueue(const std::size_t& capacity) :
+        buffer(new T[next_power_of_two(capacity)]),
+        mask(next_power_of_two(capacity) - 1),
+        head(0),
+        tail(0) {
+        if (capacity == 0)
+            throw std::invalid_argument("SPSCQueue capacity must be at least 1.");
+    }
+
+    /// @brief Return the capacity of the queue.
+    ///
+    /// @returns The number of elements the queue can hold.
+    ///
+    inline std::size_t capacity() const { return mask + 1; }
+
+    /// @brief Return the number of elements in the queue.
+    ///
+    /// @returns The number of elements in the queue. The value is exact when
+    /// called from the producer or consumer and approximate otherwise.
+    ///
+    inline std::size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    /// @brief Return a flag determining whether the queue is empty.
+    ///
+    /// @returns `true` if the queue is empty, `false` otherwise.
+    ///
+    inline bool empty() const { return size() == 0; }
+
+    /// @brief Return a flag determining whether the queue is full.
+    ///
+    /// @returns `true` if the queue is full, `false` otherwise.
+    ///
+    inline bool full() const { return size() > mask; }
+
+    /// @brief Attempt to push an element onto the back of the queue.
+    ///
+    /// @param value The value to move into the queue.
+    /// @returns `true` if the element was enqueued, `false` if the queue was
+    /// full. `value` is left untouched when the queue is full.
+    ///
+    /// @details
+    /// This function may only be called from the producer thread.
+    ///
+    inline bool try_push(T&& value) {
+        const auto position = head.load(std::memory_order_relaxed);
+        if (position - tail.load(std::memory_order_acquire) > mask) return false;
+        buffer[position & mask] = std::move(value);
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Attempt to pop an element from the front of the queue.
+    ///
+    /// @param value The output value to move the front element into.
+    /// @returns `true` if an element was dequeued, `false` if the queue was
+    /// empty.
+    ///
+    /// @details
+    /// This function may only be called from the consumer thread.
+    ///
+    inline bool try_pop(T& value) {
+        const auto position = tail.load(std::memory_order_relaxed);
+        if (position == head.load(std::memory_order_acquire)) return false;
+        value = std::move(buffer[position & mask]);
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Return a pointer to the element at the front of the queue.
+    ///
+    /// @returns A pointer to the front element, or `nullptr` if the queue is
+    /// empty. The pointer remains valid until the next call to `pop`.
+    ///
+    /// @details
+    /// This function may only be called from the consumer thread. Together
+    /// with `pop`, it allows the consumer to process elements in place.
+    ///
+    inline T* front() {
+        const auto position = tail.load(std::memory_order_relaxed);
+        if (position == head.load(std::memory_order_acquire)) return nullptr;
+        return &buffer[position & mask];
+    }
+
+    /// @brief Release the element at the front of the queue.
+    ///
+    /// @details
+    /// This function may only be called from the consumer thread after
+    /// `front` returned a non-null pointer.
+    ///
+    inline void pop() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+};
+
+}  // namespace util
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_UTIL_SPSC_QUEUE_HPP_
@@ -0,0 +1,116 @@
+// A structure for stitching the transcripts of consecutive streams.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_UTIL_TRANSCRIPT_STITCHER_HPP_
+#define SENSORYCLOUD_UTIL_TRANSCRIPT_STITCHER_HPP_
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include "sensorycloud/generated/v1/audio/audio.pb.h"
+
+namespace sensory {
+
+namespace util {
+
+/// @brief A structure for stitching the transcripts of consecutive streams
+/// into one continuous transcript.
+///
+/// @details
+/// A long session is transcribed by a sequence of streams (segments) whose
+/// audio overlaps slightly. Each segment is committed with the offset of its
+/// first sample in the session and a cut time in the overlap with the next
+/// segment. Word times are shifted into session time and a word is kept from
+/// the segment whose range contains the midpoint of the word, so words in
+/// the overlap are neither dropped nor duplicated. Words are re-indexed
+/// from the start of the session.
+///
+class TranscriptStitcher {
+ private:
+    /// The words of the session.
+    std::vector<::sensory::api::v1::audio::TranscribeWord> word_list;
+    /// The cut time of the last segment in milliseconds.
+    uint64_t cut_ms = 0;
+    /// The number of segments that have been committed.
+    uint64_t num_segments = 0;
+
+ public:
+    /// The cut time of a segment that is not followed by another.
+    static constexpr uint64_t END_OF_SESSION = std::numeric_limits<uint64_t>::max();
+
+    /// @brief Return a constant reference to the stitched transcript.
+    ///
+    /// @returns A vector with the words of the session in session time.
+    ///
+    inline const std::vector<::sensory::api::v1::audio::TranscribeWord>& get_word_list() const {
+        return word_list;
+    }
+
+    /// @brief Return the number of committed segments.
+    ///
+    /// @returns The number of calls to `commit`.
+    ///
+    inline uint64_t get_num_segments() const { return num_segments; }
+
+    /// @brief Return the cut time of the last committed segment.
+    ///
+    /// @returns The session time in milliseconds before which the transcript
+    /// is final.
+    ///
+    inline uint64_t get_cut_ms() const { return cut_ms; }
+
+    /// @brief Commit the final word list of a segment.
+    ///
+    /// @param words The final word list of the segment, with times relative
+    /// to the start of the segment.
+    /// @param offset_ms The session time of the first sample of the segment in
+    /// milliseconds.
+    /// @param segment_cut_ms The session time in milliseconds at which the next
+    /// segment takes over, or `END_OF_SESSION`.
+    /// @returns The number of words that were appended to the transcript.
+    ///
+    /// @exception std::invalid_argument If the cut time precedes the cut time
+    /// of the previous segment.
+    ///
+    std::size_t commit(const std::vector<::sensory::api::v1::audio::TranscribeWord>& words,
+        const uint64_t& offset_ms,
+        const uint64_t& segment_cut_ms = END_OF_SESSION
+    );
+
+    /// @brief Return the full transcript as computed from the word list.
+    ///
+    /// @param delimiter An optional delimiter for controlling the separation
+    /// of individual words in the transcript.
+    /// @returns An imploded string representation of the stitched word list.
+    ///
+    std::string get_transcript(const std::string& delimiter=" ") const;
+};
+
+}  // namespace util
+
+}  // namespace sensory
+
+#endif  // SENSORYCLOUD_UTIL_TRANSCRIPT_STITCHER_HPP_
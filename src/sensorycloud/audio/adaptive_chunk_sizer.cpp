@@ -0,0 +1,131 @@
+// A chunk size controller for audio streams driven by write latency.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sensorycloud/audio/adaptive_chunk_sizer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace sensory {
+
+namespace audio {
+
+AdaptiveChunkSizer::AdaptiveChunkSizer(const AdaptiveChunkOptions& options_) :
+    options(options_),
+    min_chunk_size(to_frames(options_.min_chunk_duration)),
+    max_chunk_size(to_frames(options_.max_chunk_duration)),
+    step_size(std::max<std::size_t>(to_frames(options_.step_duration), 1)),
+    chunk_size(0),
+    smoothed_latency(0),
+    num_writes(0),
+    writes_since_resize(0),
+    num_grows(0),
+    num_shrinks(0) {
+    if (options.sample_rate == 0)
+        throw std::invalid_argument("AdaptiveChunkSizer sample rate must be positive.");
+    if (options.min_chunk_duration.count() <= 0 || options.step_duration.count() <= 0)
+        throw std::invalid_argument("AdaptiveChunkSizer durations must be positive.");
+    if (options.min_chunk_duration > options.initial_chunk_duration ||
+        options.initial_chunk_duration > options.max_chunk_duration)
+        throw std::invalid_argument("AdaptiveChunkSizer durations must be ordered as min <= initial <= max.");
+    if (options.smoothing <= 0.f || options.smoothing > 1.f)
+        throw std::invalid_argument("AdaptiveChunkSizer smoothing must be in (0, 1].");
+    if (options.shrink_threshold >= options.grow_threshold)
+        throw std::invalid_argument("AdaptiveChunkSizer shrink threshold must be less than the grow threshold.");
+    if (options.shrink_factor <= 0.f || options.shrink_factor >= 1.f || options.grow_factor <= 1.f)
+        throw std::invalid_argument("AdaptiveChunkSizer factors must shrink and grow the chunk size.");
+    chunk_size = quantize(static_cast<double>(to_frames(options.initial_chunk_duration)));
+}
+
+std::size_t AdaptiveChunkSizer::to_frames(const std::chrono::milliseconds& duration) const {
+    return static_cast<std::size_t>(static_cast<uint64_t>(duration.count()) * options.sample_rate / 1000);
+}
+
+std::size_t AdaptiveChunkSizer::quantize(const double& size) const {
+    const auto steps = static_cast<std::size_t>(std::lround(size / step_size));
+    return std::min(max_chunk_size, std::max(min_chunk_size, std::max<std::size_t>(steps, 1) * step_size));
+}
+
+std::size_t AdaptiveChunkSizer::get_chunk_size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return chunk_size;
+}
+
+std::size_t AdaptiveChunkSizer::record_write(const std::chrono::microseconds& latency, const std::size_t& backlog) {
+    std::size_t old_size, new_size;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        histogram[chunk_size]++;
+        smoothed_latency = num_writes++ == 0 ? latency.count() :
+            options.smoothing * latency.count() + (1 - options.smoothing) * smoothed_latency;
+        old_size = new_size = chunk_size;
+        if (++writes_since_resize >= options.cooldown_writes) {
+            const double duration = 1e6 * chunk_size / options.sample_rate;
+            const double load = smoothed_latency / duration;
+            if (backlog > options.max_backlog || load > options.grow_threshold)
+                new_size = quantize(std::ceil(chunk_size * options.grow_factor));
+            else if (backlog == 0 && load < options.shrink_threshold)
+                new_size = quantize(std::floor(chunk_size * options.shrink_factor));
+            if (new_size != old_size) {
+                if (new_size > old_size) num_grows++;
+                else num_shrinks++;
+                chunk_size = new_size;
+                writes_since_resize = 0;
+            }
+        }
+    }
+    // Notify outside of the lock so the callback may query the sizer.
+    if (new_size != old_size && on_resize) on_resize(old_size, new_size);
+    return new_size;
+}
+
+std::chrono::microseconds AdaptiveChunkSizer::get_smoothed_latency() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::chrono::microseconds(static_cast<int64_t>(std::llround(smoothed_latency)));
+}
+
+uint64_t AdaptiveChunkSizer::get_num_writes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return num_writes;
+}
+
+uint64_t AdaptiveChunkSizer::get_num_grows() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return num_grows;
+}
+
+uint64_t AdaptiveChunkSizer::get_num_shrinks() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return num_shrinks;
+}
+
+std::map<std::size_t, uint64_t> AdaptiveChunkSizer::get_size_histogram() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return histogram;
+}
+
+}  // namespace audio
+
+}  // namespace sensory
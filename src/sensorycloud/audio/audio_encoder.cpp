@@ -0,0 +1,84 @@
+// An encoder stage for the audio content of streams.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sensorycloud/audio/audio_encoder.hpp"
+#include <stdexcept>
+#include "sensorycloud/audio/mulaw.hpp"
+
+namespace sensory {
+
+namespace audio {
+
+using ::sensory::api::v1::audio::AudioConfig;
+using ::sensory::api::v1::audio::AudioConfig_AudioEncoding;
+using ::sensory::api::v1::audio::AudioConfig_AudioEncoding_LINEAR16;
+using ::sensory::api::v1::audio::AudioConfig_AudioEncoding_FLAC;
+using ::sensory::api::v1::audio::AudioConfig_AudioEncoding_MULAW;
+
+AudioEncoder::AudioEncoder(AudioConfig* config, const AudioConfig_AudioEncoding& encoding_) :
+    encoding(encoding_),
+    num_channels(config == nullptr ? 0 : static_cast<uint32_t>(config->audiochannelcount())) {
+    if (config == nullptr)
+        throw std::invalid_argument("AudioEncoder requires an audio config.");
+    if (num_channels == 0)
+        throw std::invalid_argument("AudioEncoder requires a positive audio channel count.");
+    switch (encoding) {
+    case AudioConfig_AudioEncoding_LINEAR16:
+    case AudioConfig_AudioEncoding_MULAW:
+        break;
+    case AudioConfig_AudioEncoding_FLAC:
+        if (config->sampleratehertz() <= 0)
+            throw std::invalid_argument("AudioEncoder requires a positive sample rate for FLAC.");
+        flac.reset(new FLACEncoder(config->sampleratehertz(), num_channels));
+        break;
+    default:
+        throw std::invalid_argument("AudioEncoder does not support the requested encoding.");
+    }
+    config->set_encoding(encoding);
+}
+
+void AudioEncoder::encode(const int16_t* samples, const std::size_t& num_frames, std::string& output) {
+    if (flac) {
+        flac->encode(samples, num_frames, output);
+        return;
+    }
+    if (encoding == AudioConfig_AudioEncoding_MULAW) {
+        const auto offset = output.size();
+        output.resize(offset + num_channels * num_frames);
+        mulaw_encode(samples, num_channels * num_frames, reinterpret_cast<uint8_t*>(&output[offset]));
+        return;
+    }
+    // LINEAR16 is the little-endian byte representation of the samples.
+    output.reserve(output.size() + sizeof(int16_t) * num_channels * num_frames);
+    for (std::size_t i = 0; i < num_channels * num_frames; i++) {
+        const auto sample = static_cast<uint16_t>(samples[i]);
+        output.push_back(static_cast<char>(sample & 0xFF));
+        output.push_back(static_cast<char>(sample >> 8));
+    }
+}
+
+}  // namespace audio
+
+}  // namespace sensory
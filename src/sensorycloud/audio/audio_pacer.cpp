@@ -0,0 +1,81 @@
+// A pacer for streaming recorded audio at a multiple of real time.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sensorycloud/audio/audio_pacer.hpp"
+#include <stdexcept>
+#include <thread>
+
+namespace sensory {
+
+namespace audio {
+
+AudioPacer::AudioPacer(const uint32_t& sample_rate_,
+    const double& speed_,
+    const std::chrono::milliseconds& max_lag_
+) : sample_rate(sample_rate_), speed(speed_), max_lag(max_lag_) {
+    if (sample_rate == 0)
+        throw std::invalid_argument("AudioPacer sample rate must be positive.");
+    if (!(speed >= 0))
+        throw std::invalid_argument("AudioPacer speed must not be negative.");
+}
+
+void AudioPacer::reset() {
+    is_started = true;
+    start = Clock::now();
+    scheduled_frames = 0;
+}
+
+AudioPacer::Clock::time_point AudioPacer::get_deadline(const std::size_t& frames) {
+    if (!is_started) reset();
+    if (speed == 0) return Clock::now();
+    const std::chrono::duration<double> offset((scheduled_frames + frames) / (sample_rate * speed));
+    return start + std::chrono::duration_cast<Clock::duration>(offset);
+}
+
+AudioPacer::Clock::duration AudioPacer::pace(const std::size_t& frames) {
+    num_frames += frames;
+    num_chunks++;
+    if (speed == 0) return Clock::duration::zero();
+    const auto deadline = get_deadline(frames);
+    const auto now = Clock::now();
+    scheduled_frames += frames;
+    if (now <= deadline) {
+        std::this_thread::sleep_until(deadline);
+        return Clock::duration::zero();
+    }
+    const auto lateness = now - deadline;
+    num_late_chunks++;
+    if (lateness > max_lateness) max_lateness = lateness;
+    if (lateness > max_lag) {  // Restart the schedule instead of bursting.
+        num_rebases++;
+        start = now;
+        scheduled_frames = 0;
+    }
+    return lateness;
+}
+
+}  // namespace audio
+
+}  // namespace sensory
@@ -0,0 +1,157 @@
+// A tee for feeding captured audio to several concurrent streams.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sensorycloud/audio/audio_tee.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace sensory {
+
+namespace audio {
+
+// ----- TeeSubscriber --------------------------------------------------------
+
+TeeSubscriber::~TeeSubscriber() { tee.unsubscribe(this); }
+
+bool TeeSubscriber::read(AudioChunk& chunk, const std::chrono::milliseconds& timeout) {
+    std::unique_lock<std::mutex> lock(tee.mutex);
+    const auto ready = [&]() {
+        return overrun || tee.closed || cursor < tee.base + tee.chunks.size();
+    };
+    if (!tee.published.wait_for(lock, timeout, ready)) return false;
+    if (overrun || cursor >= tee.base + tee.chunks.size()) return false;
+    chunk = tee.chunks[cursor - tee.base];
+    cursor++;
+    num_chunks_read++;
+    tee.trim();
+    return true;
+}
+
+std::size_t TeeSubscriber::get_lag() const {
+    std::lock_guard<std::mutex> lock(tee.mutex);
+    if (overrun) return 0;
+    return tee.base + tee.chunks.size() - cursor;
+}
+
+bool TeeSubscriber::is_overrun() const {
+    std::lock_guard<std::mutex> lock(tee.mutex);
+    return overrun;
+}
+
+uint64_t TeeSubscriber::get_num_chunks_read() const {
+    std::lock_guard<std::mutex> lock(tee.mutex);
+    return num_chunks_read;
+}
+
+uint64_t TeeSubscriber::get_num_dropped_chunks() const {
+    std::lock_guard<std::mutex> lock(tee.mutex);
+    return num_dropped_chunks;
+}
+
+// ----- AudioTee -------------------------------------------------------------
+
+void AudioTee::trim() {
+    auto oldest = base + chunks.size();
+    for (const auto& subscriber : subscribers)
+        if (!subscriber->overrun) oldest = std::min(oldest, subscriber->cursor);
+    while (base < oldest) {
+        chunks.pop_front();
+        base++;
+    }
+}
+
+void AudioTee::unsubscribe(TeeSubscriber* subscriber) {
+    std::lock_guard<std::mutex> lock(mutex);
+    subscribers.erase(std::remove(subscribers.begin(), subscribers.end(), subscriber), subscribers.end());
+    trim();
+}
+
+std::unique_ptr<TeeSubscriber> AudioTee::subscribe(const std::size_t& max_lag,
+    const TeeOverflowPolicy& policy
+) {
+    if (max_lag == 0)
+        throw std::invalid_argument("TeeSubscriber maximal lag must be at least 1.");
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<TeeSubscriber> subscriber(new TeeSubscriber(*this, max_lag, policy, base + chunks.size()));
+    subscribers.push_back(subscriber.get());
+    return subscriber;
+}
+
+void AudioTee::publish(const AudioChunk& chunk) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (closed)
+            throw std::runtime_error("Cannot publish to a closed AudioTee.");
+        chunks.push_back(chunk);
+        const auto end = base + chunks.size();
+        for (auto& subscriber : subscribers) {
+            if (subscriber->overrun) continue;
+            const auto lag = end - subscriber->cursor;
+            if (lag <= subscriber->max_lag) continue;
+            if (subscriber->policy == TeeOverflowPolicy::DropOldest) {
+                subscriber->num_dropped_chunks += lag - subscriber->max_lag;
+                subscriber->cursor = end - subscriber->max_lag;
+            } else {  // TeeOverflowPolicy::Disconnect
+                subscriber->overrun = true;
+            }
+        }
+        trim();
+    }
+    published.notify_all();
+}
+
+AudioChunk AudioTee::publish(const int16_t* samples, const std::size_t& num_samples) {
+    AudioChunk chunk = std::make_shared<const std::string>(
+        reinterpret_cast<const char*>(samples), num_samples * sizeof(int16_t));
+    publish(chunk);
+    return chunk;
+}
+
+void AudioTee::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+    }
+    published.notify_all();
+}
+
+std::size_t AudioTee::get_num_subscribers() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return subscribers.size();
+}
+
+std::size_t AudioTee::get_num_retained_chunks() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return chunks.size();
+}
+
+uint64_t AudioTee::get_num_published_chunks() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return base + chunks.size();
+}
+
+}  // namespace audio
+
+}  // namespace sensory
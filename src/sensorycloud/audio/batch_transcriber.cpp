@@ -0,0 +1,86 @@
+// A batch engine for offline transcription of many audio files.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sensorycloud/audio/batch_transcriber.hpp"
+#ifndef PICOJSON_USE_INT64
+#define PICOJSON_USE_INT64
+#endif
+#include <cctype>
+#include <fstream>
+#include <stdexcept>
+#include "sensorycloud/io/path.hpp"
+#include "sensorycloud/util/picojson.h"
+#include "sensorycloud/util/string_extensions.hpp"
+
+namespace sensory {
+
+namespace audio {
+
+std::string to_jsonl(const BatchTranscribeResult& result) {
+    picojson::object object;
+    object["path"] = picojson::value(result.path);
+    object["ok"] = picojson::value(result.status.ok());
+    object["code"] = picojson::value(static_cast<int64_t>(result.status.error_code()));
+    object["message"] = picojson::value(result.status.error_message());
+    object["transcript"] = picojson::value(result.transcript);
+    object["attempts"] = picojson::value(static_cast<int64_t>(result.attempts));
+    return picojson::value(object).serialize();
+}
+
+/// @brief Return a flag determining whether a path has a `.wav` extension.
+///
+/// @param path The path to check.
+/// @returns `true` if the path ends with `.wav` in any case.
+///
+static bool is_wav(const std::string& path) {
+    static const std::string EXTENSION = ".wav";
+    if (path.size() < EXTENSION.size()) return false;
+    const auto offset = path.size() - EXTENSION.size();
+    for (std::size_t i = 0; i < EXTENSION.size(); i++)
+        if (std::tolower(static_cast<unsigned char>(path[offset + i])) != EXTENSION[i])
+            return false;
+    return true;
+}
+
+std::vector<std::string> find_batch_inputs(const std::string& path) {
+    if (::sensory::io::path::is_directory(path.c_str()))
+        return ::sensory::io::path::list_files(path, ".wav");
+    if (is_wav(path)) return {path};
+    std::ifstream manifest(path);
+    if (!manifest.is_open())
+        throw std::runtime_error("Failed to open batch manifest \"" + path + "\"");
+    std::vector<std::string> paths;
+    std::string line;
+    while (std::getline(manifest, line)) {
+        line = ::sensory::util::strip(line);
+        if (line.empty() || line[0] == '#') continue;
+        paths.push_back(line);
+    }
+    return paths;
+}
+
+}  // namespace audio
+
+}  // namespace sensory
@@ -0,0 +1,138 @@
+// A memory-mapped source of audio from WAV and raw PCM files.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sensorycloud/audio/file_source.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace sensory {
+
+namespace audio {
+
+/// @brief Return whether the host stores integers in little-endian order.
+///
+/// @returns `true` if the samples of a mapping can be read in place.
+///
+static inline bool is_little_endian() {
+    const uint16_t probe = 1;
+    return *reinterpret_cast<const uint8_t*>(&probe) == 1;
+}
+
+AudioFileMapping::AudioFileMapping(const std::string& path) {
+    file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        throw std::runtime_error("Failed to open audio file " + path + ": " + std::strerror(errno));
+    struct stat info;
+    if (::fstat(file, &info) != 0) {
+        const std::string error = std::strerror(errno);
+        ::close(file);
+        throw std::runtime_error("Failed to stat audio file " + path + ": " + error);
+    }
+    size = static_cast<std::size_t>(info.st_size);
+    // An empty file cannot be mapped and has no audio to read.
+    if (size == 0) return;
+    data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    if (data == MAP_FAILED) {
+        const std::string error = std::strerror(errno);
+        data = nullptr;
+        ::close(file);
+        throw std::runtime_error("Failed to map audio file " + path + ": " + error);
+    }
+    // Chunks are read front to back, so let the kernel read ahead.
+    ::posix_madvise(data, size, POSIX_MADV_SEQUENTIAL);
+}
+
+AudioFileMapping::~AudioFileMapping() {
+    if (data != nullptr) ::munmap(data, size);
+    if (file >= 0) ::close(file);
+}
+
+AudioFileSource::AudioFileSource(const std::string& path_) :
+    path(path_), mapping(std::make_shared<AudioFileMapping>(path_)), has_header(true) {
+    const auto layout = parse_wav_layout(mapping->get_data(), mapping->get_size(), path);
+    sample_rate = layout.sample_rate;
+    num_channels = layout.num_channels;
+    // RIFF chunks are aligned to two bytes, so the samples are aligned.
+    samples = reinterpret_cast<const int16_t*>(mapping->get_data() + layout.data_offset);
+    num_frames = layout.data_size / (num_channels * sizeof(int16_t));
+}
+
+AudioFileSource::AudioFileSource(const std::string& path_,
+    const uint32_t& sample_rate_,
+    const uint32_t& num_channels_
+) : path(path_), sample_rate(sample_rate_), num_channels(num_channels_) {
+    if (sample_rate == 0)
+        throw std::invalid_argument("AudioFileSource sample rate must be positive.");
+    if (num_channels == 0)
+        throw std::invalid_argument("AudioFileSource requires at least one channel.");
+    mapping = std::make_shared<AudioFileMapping>(path);
+    samples = reinterpret_cast<const int16_t*>(mapping->get_data());
+    num_frames = mapping->get_size() / (num_channels * sizeof(int16_t));
+}
+
+bool AudioFileSource::is_native(const uint32_t& target_sample_rate,
+    const uint32_t& target_num_channels
+) const {
+    return sample_rate == target_sample_rate &&
+        num_channels == target_num_channels &&
+        is_little_endian();
+}
+
+AudioFileView AudioFileSource::view(const std::size_t& start, const std::size_t& count) const {
+    AudioFileView view;
+    view.mapping = mapping;
+    view.num_channels = num_channels;
+    if (start >= num_frames) return view;
+    view.samples = samples + start * num_channels;
+    view.num_frames = std::min(count, num_frames - start);
+    return view;
+}
+
+AudioFileView AudioFileSource::next(const std::size_t& count) {
+    const auto chunk = view(position, count);
+    position += chunk.num_frames;
+    return chunk;
+}
+
+PCMAudio AudioFileSource::to_pcm() const {
+    PCMAudio audio;
+    audio.sample_rate = sample_rate;
+    audio.num_channels = num_channels;
+    audio.samples.resize(num_frames * num_channels);
+    const auto bytes = reinterpret_cast<const uint8_t*>(samples);
+    for (std::size_t i = 0; i < audio.samples.size(); i++)
+        audio.samples[i] = static_cast<int16_t>(bytes[2 * i] | (bytes[2 * i + 1] << 8));
+    return audio;
+}
+
+}  // namespace audio
+
+}  // namespace sensory
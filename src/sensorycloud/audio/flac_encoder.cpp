@@ -0,0 +1,374 @@
+// A streaming FLAC encoder for 16-bit PCM audio.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sensorycloud/audio/flac_encoder.hpp"
+#include <stdexcept>
+#include <algorithm>
+
+namespace sensory {
+
+namespace audio {
+
+uint8_t flac_crc8(const uint8_t* data, const std::size_t& size) {
+    uint8_t crc = 0;
+    for (std::size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+    }
+    return crc;
+}
+
+uint16_t flac_crc16(const uint8_t* data, const std::size_t& size) {
+    uint16_t crc = 0;
+    for (std::size_t i = 0; i < size; i++) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x8005) : static_cast<uint16_t>(crc << 1);
+    }
+    return crc;
+}
+
+/// The maximal order of the fixed predictors.
+static constexpr uint32_t MAX_FIXED_ORDER = 4;
+/// The maximal order of the partitions of the residual.
+static constexpr uint32_t MAX_PARTITION_ORDER = 8;
+/// The maximal Rice parameter of the 4-bit Rice coding method.
+static constexpr uint32_t MAX_RICE_PARAMETER = 14;
+
+/// @brief Compute the residual of a fixed predictor at an index.
+///
+/// @param x The samples of the channel.
+/// @param i The index of the sample, at least `order`.
+/// @param order The order of the predictor.
+/// @returns The prediction error of the sample.
+///
+static inline int32_t fixed_residual(const int32_t* x, const std::size_t& i, const uint32_t& order) {
+    switch (order) {
+    case 0: return x[i];
+    case 1: return x[i] - x[i - 1];
+    case 2: return x[i] - 2 * x[i - 1] + x[i - 2];
+    case 3: return x[i] - 3 * x[i - 1] + 3 * x[i - 2] - x[i - 3];
+    default: return x[i] - 4 * x[i - 1] + 6 * x[i - 2] - 4 * x[i - 3] + x[i - 4];
+    }
+}
+
+/// @brief Estimate the Rice parameter and cost of a partition.
+///
+/// @param sum The sum of the folded residuals in the partition.
+/// @param count The number of residuals in the partition.
+/// @param parameter The output Rice parameter.
+/// @returns The estimated number of bits of the partition.
+///
+static inline uint64_t rice_cost(const uint64_t& sum, const uint64_t& count, uint32_t& parameter) {
+    uint32_t k = 0;
+    while (k < MAX_RICE_PARAMETER && (count << (k + 1)) < sum) k++;
+    // Each residual costs a stop bit, k low bits, and its quotient in unary.
+    uint64_t best = count * (k + 1) + (sum >> k);
+    parameter = k;
+    if (k > 0) {
+        const uint64_t lower = count * k + (sum >> (k - 1));
+        if (lower < best) {
+            best = lower;
+            parameter = k - 1;
+        }
+    }
+    return 4 + best;
+}
+
+FLACEncoder::FLACEncoder(
+    const uint32_t& sample_rate_,
+    const uint32_t& num_channels_,
+    const uint32_t& max_block_size_
+) :
+    sample_rate(sample_rate_),
+    num_channels(num_channels_),
+    max_block_size(max_block_size_),
+    num_samples(0),
+    wrote_header(false),
+    bits(0),
+    num_bits(0) {
+    if (sample_rate == 0 || sample_rate >= (1 << 20))
+        throw std::invalid_argument("FLACEncoder sample rate must be in [1, 1048575] Hz.");
+    if (num_channels == 0 || num_channels > 8)
+        throw std::invalid_argument("FLACEncoder number of channels must be in [1, 8].");
+    if (max_block_size < FLAC_MIN_BLOCK_SIZE || max_block_size > 65535)
+        throw std::invalid_argument("FLACEncoder max block size must be in [16, 65535].");
+    channel.reserve(max_block_size);
+    residual.reserve(max_block_size);
+}
+
+std::string FLACEncoder::get_stream_header() const {
+    std::string header("fLaC", 4);
+    // The metadata block header: last block, STREAMINFO, 34 bytes.
+    header.push_back(static_cast<char>(0x80));
+    header.push_back(0);
+    header.push_back(0);
+    header.push_back(34);
+    // The minimal and maximal block sizes. Chunks are encoded with variable
+    // block sizes, so the minimum is the smallest size allowed by the format.
+    header.push_back(0);
+    header.push_back(FLAC_MIN_BLOCK_SIZE);
+    header.push_back(static_cast<char>(max_block_size >> 8));
+    header.push_back(static_cast<char>(max_block_size & 0xFF));
+    // The minimal and maximal frame sizes are unknown for live streams.
+    header.append(6, 0);
+    // The sample rate (20 bits), the number of channels minus one (3 bits),
+    // the bits per sample minus one (5 bits), and the total number of
+    // samples (36 bits, unknown for live streams).
+    const uint64_t info = (static_cast<uint64_t>(sample_rate) << 44) |
+        (static_cast<uint64_t>(num_channels - 1) << 41) |
+        (static_cast<uint64_t>(16 - 1) << 36);
+    for (int shift = 56; shift >= 0; shift -= 8)
+        header.push_back(static_cast<char>((info >> shift) & 0xFF));
+    // The MD5 signature of the audio is unknown for live streams.
+    header.append(16, 0);
+    return header;
+}
+
+void FLACEncoder::write_bits(const uint32_t& value, const uint32_t& count) {
+    if (count == 0) return;
+    const uint64_t mask = count == 32 ? 0xFFFFFFFFull : ((1ull << count) - 1);
+    bits = (bits << count) | (value & mask);
+    num_bits += count;
+    while (num_bits >= 8) {
+        num_bits -= 8;
+        frame.push_back(static_cast<uint8_t>(bits >> num_bits));
+    }
+    bits &= (1ull << num_bits) - 1;
+}
+
+void FLACEncoder::align_to_byte() {
+    if (num_bits > 0) write_bits(0, 8 - num_bits);
+}
+
+void FLACEncoder::write_frame_header(const uint32_t& block_size) {
+    // The sync code, a reserved bit, and the variable block size strategy.
+    write_bits(0xFFF9, 16);
+    // The block size code.
+    uint32_t block_size_code = 0;
+    if (block_size == 192) {
+        block_size_code = 1;
+    } else if (block_size >= 576 && block_size <= 4608 && block_size % 576 == 0 &&
+        ((block_size / 576) & (block_size / 576 - 1)) == 0) {
+        block_size_code = 2;
+        for (uint32_t size = 576; size < block_size; size <<= 1) block_size_code++;
+    } else if (block_size >= 256 && block_size <= 32768 && (block_size & (block_size - 1)) == 0) {
+        block_size_code = 8;
+        for (uint32_t size = 256; size < block_size; size <<= 1) block_size_code++;
+    } else {
+        block_size_code = block_size <= 256 ? 6 : 7;
+    }
+    write_bits(block_size_code, 4);
+    // The sample rate is taken from the STREAMINFO block.
+    write_bits(0, 4);
+    // Independent channels, 16 bits per sample, and a reserved bit.
+    write_bits(num_channels - 1, 4);
+    write_bits(4, 3);
+    write_bits(0, 1);
+    // The number of the first sample of the frame in UTF-8 style coding.
+    const uint64_t number = num_samples;
+    if (number < 0x80) {
+        write_bits(static_cast<uint32_t>(number), 8);
+    } else {
+        // The number of continuation bytes with six bits each.
+        uint32_t continuations = 1;
+        while (continuations < 6 && number >= (1ull << (5 * continuations + 6))) continuations++;
+        const uint32_t lead = continuations < 6 ?
+            ((0xFF00u >> (continuations + 1)) & 0xFF) |
+                static_cast<uint32_t>(number >> (6 * continuations)) :
+            0xFE;
+        write_bits(lead, 8);
+        for (int shift = 6 * (static_cast<int>(continuations) - 1); shift >= 0; shift -= 6)
+            write_bits(0x80 | static_cast<uint32_t>((number >> shift) & 0x3F), 8);
+    }
+    if (block_size_code == 6) write_bits(block_size - 1, 8);
+    else if (block_size_code == 7) write_bits(block_size - 1, 16);
+    // The header is byte aligned, so its CRC covers every byte so far.
+    write_bits(flac_crc8(frame.data(), frame.size()), 8);
+}
+
+void FLACEncoder::write_subframe(const uint32_t& block_size) {
+    const int32_t* x = channel.data();
+    // Use a constant subframe for digital silence and DC.
+    if (std::all_of(channel.begin(), channel.end(), [x](const int32_t& sample) { return sample == x[0]; })) {
+        write_bits(0x00, 8);
+        write_bits(static_cast<uint32_t>(x[0]) & 0xFFFF, 16);
+        return;
+    }
+    // Choose the order of the fixed predictor with the smallest residual.
+    const uint32_t max_order = std::min(MAX_FIXED_ORDER, block_size - 1);
+    uint64_t sums[MAX_FIXED_ORDER + 1] = {0, 0, 0, 0, 0};
+    for (std::size_t i = max_order; i < block_size; i++)
+        for (uint32_t order = 0; order <= max_order; order++)
+            sums[order] += static_cast<uint64_t>(std::abs(fixed_residual(x, i, order)));
+    uint32_t order = 0;
+    for (uint32_t candidate = 1; candidate <= max_order; candidate++)
+        if (sums[candidate] < sums[order]) order = candidate;
+    // Fold the residual of the predictor into unsigned values.
+    residual.clear();
+    for (std::size_t i = order; i < block_size; i++) {
+        const int32_t error = fixed_residual(x, i, order);
+        residual.push_back(error >= 0 ?
+            static_cast<uint32_t>(error) << 1 :
+            (static_cast<uint32_t>(-(error + 1)) << 1) | 1);
+    }
+    // Fall back to a verbatim subframe if prediction does not pay off.
+    uint64_t sum = 0;
+    for (const auto& value : residual) sum += value;
+    uint32_t parameter = 0;
+    const uint64_t fixed_cost = 8 + 16 * order + 6 + rice_cost(sum, residual.size(), parameter);
+    if (fixed_cost >= 8 + 16ull * block_size) {
+        write_bits(0x02, 8);
+        for (uint32_t i = 0; i < block_size; i++)
+            write_bits(static_cast<uint32_t>(x[i]) & 0xFFFF, 16);
+        return;
+    }
+    write_bits(0x10 | (order << 1), 8);
+    for (uint32_t i = 0; i < order; i++)
+        write_bits(static_cast<uint32_t>(x[i]) & 0xFFFF, 16);
+    write_residual(block_size, order);
+}
+
+void FLACEncoder::write_residual(const uint32_t& block_size, const uint32_t& order) {
+    // Find the partition order with the smallest estimated cost. Partitions
+    // must evenly divide the block and hold more samples than the warm-up.
+    uint32_t best_order = 0;
+    uint64_t best_cost = UINT64_MAX;
+    for (uint32_t partition_order = 0; partition_order <= MAX_PARTITION_ORDER; partition_order++) {
+        const uint32_t partition_size = block_size >> partition_order;
+        if (partition_order > 0 &&
+            ((block_size & ((1u << partition_order) - 1)) != 0 || partition_size <= order))
+            break;
+        uint64_t cost = 0;
+        std::size_t index = 0;
+        for (uint32_t partition = 0; partition < (1u << partition_order); partition++) {
+            const uint32_t count = partition_size - (partition == 0 ? order : 0);
+            uint64_t sum = 0;
+            for (uint32_t i = 0; i < count; i++) sum += residual[index++];
+            uint32_t parameter = 0;
+            cost += rice_cost(sum, count, parameter);
+        }
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_order = partition_order;
+        }
+    }
+    // Write the residual with the 4-bit Rice parameter coding method.
+    write_bits(0, 2);
+    write_bits(best_order, 4);
+    const uint32_t partition_size = block_size >> best_order;
+    std::size_t index = 0;
+    for (uint32_t partition = 0; partition < (1u << best_order); partition++) {
+        const uint32_t count = partition_size - (partition == 0 ? order : 0);
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < count; i++) sum += residual[index + i];
+        uint32_t parameter = 0;
+        rice_cost(sum, count, parameter);
+        write_bits(parameter, 4);
+        for (uint32_t i = 0; i < count; i++, index++) {
+            const uint32_t value = residual[index];
+            // Write the quotient in unary, followed by a stop bit.
+            uint32_t quotient = value >> parameter;
+            while (quotient >= 32) {
+                write_bits(0, 32);
+                quotient -= 32;
+            }
+            write_bits(1, quotient + 1);
+            write_bits(value, parameter);
+        }
+    }
+}
+
+void FLACEncoder::encode_frame(const int16_t* samples, const uint32_t& block_size, std::string& output) {
+    frame.clear();
+    bits = 0;
+    num_bits = 0;
+    write_frame_header(block_size);
+    for (uint32_t c = 0; c < num_channels; c++) {
+        channel.clear();
+        for (uint32_t i = 0; i < block_size; i++)
+            channel.push_back(samples[i * num_channels + c]);
+        write_subframe(block_size);
+    }
+    align_to_byte();
+    const uint16_t crc = flac_crc16(frame.data(), frame.size());
+    write_bits(crc, 16);
+    output.append(reinterpret_cast<const char*>(frame.data()), frame.size());
+    num_samples += block_size;
+}
+
+void FLACEncoder::encode(const int16_t* samples, const std::size_t& num_frames, std::string& output) {
+    if (!wrote_header) {
+        output += get_stream_header();
+        wrote_header = true;
+    }
+    // Encode the samples held back from the last call ahead of the chunk.
+    std::size_t total = num_frames;
+    if (!pending.empty()) {
+        pending.insert(pending.end(), samples, samples + num_frames * num_channels);
+        samples = pending.data();
+        total = pending.size() / num_channels;
+    }
+    if (total < FLAC_MIN_BLOCK_SIZE) {
+        if (pending.empty()) pending.assign(samples, samples + num_frames * num_channels);
+        return;
+    }
+    // Balance the blocks so that none is shorter than the minimal block size.
+    // That fails only for maximal block sizes below twice the minimum, in
+    // which case whole blocks are encoded and a short remainder is held back.
+    std::size_t num_blocks = (total + max_block_size - 1) / max_block_size;
+    std::size_t num_encoded = total;
+    if (total / num_blocks < FLAC_MIN_BLOCK_SIZE) {
+        num_blocks = total / max_block_size;
+        num_encoded = num_blocks * max_block_size;
+        if (total - num_encoded >= FLAC_MIN_BLOCK_SIZE) {
+            num_blocks++;
+            num_encoded = total;
+        }
+    }
+    std::size_t offset = 0;
+    for (std::size_t block = 0; block < num_blocks; block++) {
+        const auto block_size = static_cast<uint32_t>((num_encoded - offset) / (num_blocks - block));
+        encode_frame(samples + offset * num_channels, block_size, output);
+        offset += block_size;
+    }
+    std::vector<int16_t> remainder(samples + num_encoded * num_channels, samples + total * num_channels);
+    pending.swap(remainder);
+}
+
+void FLACEncoder::flush(std::string& output) {
+    if (pending.empty()) return;
+    if (!wrote_header) {
+        output += get_stream_header();
+        wrote_header = true;
+    }
+    encode_frame(pending.data(), static_cast<uint32_t>(pending.size() / num_channels), output);
+    pending.clear();
+}
+
+}  // namespace audio
+
+}  // namespace sensory
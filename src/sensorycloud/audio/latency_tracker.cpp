@@ -0,0 +1,119 @@
+// Audio-to-result latency measurement for the SensoryCloud C++ SDK.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sensorycloud/audio/latency_tracker.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "sensorycloud/util/mpmc_queue.hpp"
+
+namespace sensory {
+
+namespace audio {
+
+LatencyTracker::LatencyTracker(const LatencyTrackerOptions& options_) :
+    options(options_),
+    ring(::sensory::util::next_power_of_two(options_.capacity)) {
+    if (options.sample_rate == 0 || options.num_channels == 0 || options.capacity == 0)
+        throw std::invalid_argument("LatencyTracker requires a sample rate, channels, and a capacity.");
+}
+
+void LatencyTracker::on_write(const uint64_t& num_frames, const Clock::time_point& sent_at) {
+    if (num_frames == 0) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& send = ring[num_sends & (ring.size() - 1)];
+    // The write that is overwritten ends where the retained audio begins.
+    if (num_sends >= ring.size()) retained_position = send.end_frame;
+    position += num_frames;
+    send = {position, sent_at};
+    num_sends++;
+}
+
+bool LatencyTracker::on_result(const uint64_t& end_ms, const Clock::time_point& received_at) {
+    Clock::time_point sent_at;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Find the frame after the last sample of the result. The server
+        // rounds times, so the result may appear to end after the audio that
+        // was sent.
+        const auto end_frame = std::min<uint64_t>(end_ms * options.sample_rate / 1000, position);
+        if (end_frame <= result_position) return false;
+        result_position = end_frame;
+        // The last sample of the result was sent by a write that left the
+        // ring.
+        if (end_frame <= retained_position) {
+            num_unmatched++;
+            return false;
+        }
+        // Binary search the retained writes for the first that ends at or
+        // after the frame, i.e., the write that sent the last sample.
+        auto low = num_sends > ring.size() ? num_sends - ring.size() : 0;
+        auto high = num_sends;
+        while (low < high) {
+            const auto middle = low + (high - low) / 2;
+            if (ring[middle & (ring.size() - 1)].end_frame < end_frame)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        sent_at = ring[low & (ring.size() - 1)].sent_at;
+    }
+    const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(received_at - sent_at);
+    histogram.record(latency);
+    if (options.aggregate != nullptr) options.aggregate->record(latency);
+    return true;
+}
+
+bool LatencyTracker::observe(const ::sensory::api::v1::audio::TranscribeResponse& response,
+    const Clock::time_point& received_at
+) {
+    if (!response.has_wordlist()) return false;
+    uint64_t end_ms = 0;
+    for (const auto& word : response.wordlist().words())
+        end_ms = std::max<uint64_t>(end_ms, word.endtimems());
+    if (end_ms == 0) return false;
+    return on_result(end_ms, received_at);
+}
+
+bool LatencyTracker::observe(const ::sensory::api::v1::audio::ValidateEventResponse& response,
+    const Clock::time_point& received_at
+) {
+    if (!response.success() || response.resultendtime() <= 0) return false;
+    return on_result(static_cast<uint64_t>(std::lround(response.resultendtime() * 1000)), received_at);
+}
+
+uint64_t LatencyTracker::get_num_frames() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return position;
+}
+
+uint64_t LatencyTracker::get_num_unmatched() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return num_unmatched;
+}
+
+}  // namespace audio
+
+}  // namespace sensory
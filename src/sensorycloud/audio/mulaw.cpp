@@ -0,0 +1,193 @@
+// Vectorized G.711 mu-law encoding of 16-bit PCM audio.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sensorycloud/audio/mulaw.hpp"
+#include "sensorycloud/audio/simd.hpp"
+
+namespace sensory {
+
+namespace audio {
+
+/// The bias that is added to the magnitude of a sample before encoding.
+static constexpr int16_t MULAW_BIAS = 0x84;
+/// The largest magnitude that can be encoded after adding the bias.
+static constexpr int16_t MULAW_CLIP = 32635;
+
+/// The segment (exponent) of a biased magnitude indexed by its bits 7-14.
+static const uint8_t MULAW_EXPONENT[256] = {
+    0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+};
+
+uint8_t mulaw_encode(const int16_t& sample) {
+    int32_t value = sample;
+    const uint8_t sign = value < 0 ? 0x80 : 0x00;
+    if (sign) value = -value;
+    if (value > MULAW_CLIP) value = MULAW_CLIP;
+    value += MULAW_BIAS;
+    const uint8_t exponent = MULAW_EXPONENT[(value >> 7) & 0xFF];
+    const uint8_t mantissa = (value >> (exponent + 3)) & 0x0F;
+    return static_cast<uint8_t>(~(sign | (exponent << 4) | mantissa));
+}
+
+int16_t mulaw_decode(const uint8_t& code) {
+    const uint8_t value = ~code;
+    const int32_t exponent = (value >> 4) & 0x07;
+    const int32_t mantissa = value & 0x0F;
+    const int32_t magnitude = (((mantissa << 3) + MULAW_BIAS) << exponent) - MULAW_BIAS;
+    return static_cast<int16_t>((value & 0x80) ? -magnitude : magnitude);
+}
+
+void mulaw_encode_scalar(const int16_t* samples, const std::size_t& num_samples, uint8_t* output) {
+    for (std::size_t i = 0; i < num_samples; i++) output[i] = mulaw_encode(samples[i]);
+}
+
+#if defined(SENSORYCLOUD_AUDIO_AVX2)
+
+/// @brief Encode sixteen samples with mu-law.
+///
+/// @param x The linear 16-bit samples.
+/// @returns The mu-law codes in the low bytes of the 16-bit lanes.
+///
+static inline __m256i mulaw_encode_avx2(const __m256i& x) {
+    const __m256i sign = _mm256_srai_epi16(x, 15);
+    // The saturating subtraction maps -32768 to 32767 instead of overflowing.
+    __m256i value = _mm256_subs_epi16(_mm256_xor_si256(x, sign), sign);
+    value = _mm256_min_epi16(value, _mm256_set1_epi16(MULAW_CLIP));
+    value = _mm256_add_epi16(value, _mm256_set1_epi16(MULAW_BIAS));
+    // Count the segment thresholds that the value reaches. Each threshold
+    // also halves the multiplier so that the high half of the product is the
+    // value shifted right by exponent + 3, which AVX2 cannot do per lane.
+    __m256i exponent = _mm256_setzero_si256();
+    __m256i multiplier = _mm256_set1_epi16(1 << 13);
+    for (int bit = 8; bit <= 14; bit++) {
+        const __m256i mask = _mm256_cmpgt_epi16(value, _mm256_set1_epi16((1 << bit) - 1));
+        exponent = _mm256_sub_epi16(exponent, mask);
+        multiplier = _mm256_sub_epi16(multiplier, _mm256_and_si256(mask, _mm256_srli_epi16(multiplier, 1)));
+    }
+    const __m256i mantissa = _mm256_and_si256(_mm256_mulhi_epu16(value, multiplier), _mm256_set1_epi16(0x0F));
+    const __m256i code = _mm256_or_si256(
+        _mm256_and_si256(sign, _mm256_set1_epi16(0x80)),
+        _mm256_or_si256(_mm256_slli_epi16(exponent, 4), mantissa)
+    );
+    return _mm256_xor_si256(code, _mm256_set1_epi16(0xFF));
+}
+
+#endif  // SENSORYCLOUD_AUDIO_AVX2
+
+#if defined(SENSORYCLOUD_AUDIO_SSE2)
+
+/// @brief Encode eight samples with mu-law.
+///
+/// @param x The linear 16-bit samples.
+/// @returns The mu-law codes in the low bytes of the 16-bit lanes.
+///
+static inline __m128i mulaw_encode_sse2(const __m128i& x) {
+    const __m128i sign = _mm_srai_epi16(x, 15);
+    // The saturating subtraction maps -32768 to 32767 instead of overflowing.
+    __m128i value = _mm_subs_epi16(_mm_xor_si128(x, sign), sign);
+    value = _mm_min_epi16(value, _mm_set1_epi16(MULAW_CLIP));
+    value = _mm_add_epi16(value, _mm_set1_epi16(MULAW_BIAS));
+    // Count the segment thresholds that the value reaches. Each threshold
+    // also halves the multiplier so that the high half of the product is the
+    // value shifted right by exponent + 3, which SSE2 cannot do per lane.
+    __m128i exponent = _mm_setzero_si128();
+    __m128i multiplier = _mm_set1_epi16(1 << 13);
+    for (int bit = 8; bit <= 14; bit++) {
+        const __m128i mask = _mm_cmpgt_epi16(value, _mm_set1_epi16((1 << bit) - 1));
+        exponent = _mm_sub_epi16(exponent, mask);
+        multiplier = _mm_sub_epi16(multiplier, _mm_and_si128(mask, _mm_srli_epi16(multiplier, 1)));
+    }
+    const __m128i mantissa = _mm_and_si128(_mm_mulhi_epu16(value, multiplier), _mm_set1_epi16(0x0F));
+    const __m128i code = _mm_or_si128(
+        _mm_and_si128(sign, _mm_set1_epi16(0x80)),
+        _mm_or_si128(_mm_slli_epi16(exponent, 4), mantissa)
+    );
+    return _mm_xor_si128(code, _mm_set1_epi16(0xFF));
+}
+
+#endif  // SENSORYCLOUD_AUDIO_SSE2
+
+#if defined(SENSORYCLOUD_AUDIO_NEON)
+
+/// @brief Encode eight samples with mu-law.
+///
+/// @param x The linear 16-bit samples.
+/// @returns The mu-law codes.
+///
+static inline uint8x8_t mulaw_encode_neon(const int16x8_t& x) {
+    const uint16x8_t sign = vreinterpretq_u16_s16(vshrq_n_s16(x, 15));
+    // The saturating absolute value maps -32768 to 32767.
+    const int16x8_t magnitude = vminq_s16(vqabsq_s16(x), vdupq_n_s16(MULAW_CLIP));
+    const uint16x8_t value = vreinterpretq_u16_s16(vaddq_s16(magnitude, vdupq_n_s16(MULAW_BIAS)));
+    // The biased value is in [2^7, 2^15), so the exponent is 8 - clz(value).
+    const uint16x8_t exponent = vsubq_u16(vdupq_n_u16(8), vclzq_u16(value));
+    const int16x8_t shift = vnegq_s16(vreinterpretq_s16_u16(vaddq_u16(exponent, vdupq_n_u16(3))));
+    const uint16x8_t mantissa = vandq_u16(vshlq_u16(value, shift), vdupq_n_u16(0x0F));
+    const uint16x8_t code = vorrq_u16(
+        vandq_u16(sign, vdupq_n_u16(0x80)),
+        vorrq_u16(vshlq_n_u16(exponent, 4), mantissa)
+    );
+    return vmovn_u16(veorq_u16(code, vdupq_n_u16(0xFF)));
+}
+
+#endif  // SENSORYCLOUD_AUDIO_NEON
+
+void mulaw_encode(const int16_t* samples, const std::size_t& num_samples, uint8_t* output) {
+    std::size_t i = 0;
+#if defined(SENSORYCLOUD_AUDIO_AVX2)
+    for (; i + 32 <= num_samples; i += 32) {
+        const __m256i low = mulaw_encode_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i)));
+        const __m256i high = mulaw_encode_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i + 16)));
+        // The pack interleaves the 128-bit lanes, so restore the sample order.
+        const __m256i codes = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), codes);
+    }
+#endif
+#if defined(SENSORYCLOUD_AUDIO_SSE2)
+    for (; i + 16 <= num_samples; i += 16) {
+        const __m128i low = mulaw_encode_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i)));
+        const __m128i high = mulaw_encode_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i + 8)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_packus_epi16(low, high));
+    }
+#elif defined(SENSORYCLOUD_AUDIO_NEON)
+    for (; i + 16 <= num_samples; i += 16) {
+        const uint8x8_t low = mulaw_encode_neon(vld1q_s16(samples + i));
+        const uint8x8_t high = mulaw_encode_neon(vld1q_s16(samples + i + 8));
+        vst1q_u8(output + i, vcombine_u8(low, high));
+    }
+#endif
+    for (; i < num_samples; i++) output[i] = mulaw_encode(samples[i]);
+}
+
+}  // namespace audio
+
+}  // namespace sensory
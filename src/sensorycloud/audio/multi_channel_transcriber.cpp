@@ -0,0 +1,84 @@
+// Per-channel transcription of multi-channel audio for the SensoryCloud C++ SDK.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <algorithm>
+#include <sstream>
+#include "sensorycloud/audio/multi_channel_transcriber.hpp"
+
+namespace sensory {
+
+namespace audio {
+
+std::string MultiChannelTranscript::to_string() const {
+    return format_speaker_transcript(words);
+}
+
+std::string get_speaker(const std::vector<std::string>& speakers, const uint32_t& channel) {
+    if (channel < speakers.size() && !speakers[channel].empty())
+        return speakers[channel];
+    return "channel " + std::to_string(channel);
+}
+
+std::vector<SpeakerWord> merge_channel_transcripts(
+    const std::vector<std::vector<::sensory::api::v1::audio::TranscribeWord>>& channels,
+    const std::vector<std::string>& speakers
+) {
+    std::vector<SpeakerWord> words;
+    std::size_t num_words = 0;
+    for (const auto& channel : channels) num_words += channel.size();
+    words.reserve(num_words);
+    for (uint32_t channel = 0; channel < channels.size(); channel++) {
+        const auto speaker = get_speaker(speakers, channel);
+        for (const auto& word : channels[channel]) {
+            SpeakerWord speaker_word;
+            speaker_word.speaker = speaker;
+            speaker_word.channel = channel;
+            speaker_word.word = word;
+            words.push_back(std::move(speaker_word));
+        }
+    }
+    // The words are grouped by channel, so a stable sort by time keeps the
+    // order of each channel and breaks ties by channel.
+    std::stable_sort(words.begin(), words.end(), [](const SpeakerWord& a, const SpeakerWord& b) {
+        return a.word.begintimems() < b.word.begintimems();
+    });
+    return words;
+}
+
+std::string format_speaker_transcript(const std::vector<SpeakerWord>& words) {
+    std::ostringstream stream;
+    for (std::size_t i = 0; i < words.size(); i++) {
+        if (i == 0 || words[i].channel != words[i - 1].channel) {
+            if (i > 0) stream << '\n';
+            stream << words[i].speaker << ':';
+        }
+        stream << ' ' << words[i].word.word();
+    }
+    return stream.str();
+}
+
+}  // namespace audio
+
+}  // namespace sensory
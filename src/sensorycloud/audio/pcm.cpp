@@ -0,0 +1,535 @@
+// Vectorized format conversion and level metering of PCM audio.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sensorycloud/audio/pcm.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include "sensorycloud/audio/simd.hpp"
+
+namespace sensory {
+
+namespace audio {
+
+/// The number of samples that are converted with each block of dither noise.
+static constexpr std::size_t BLOCK_SIZE = 256;
+/// The largest 16-bit sample as a float.
+static constexpr float INT16_HIGH = 32767.f;
+/// The smallest 16-bit sample as a float.
+static constexpr float INT16_LOW = -32768.f;
+/// The scale of float samples to 16-bit samples.
+static constexpr float FLOAT_SCALE = 32768.f;
+/// The scale of 32-bit samples to 16-bit samples.
+static constexpr float INT32_SCALE = 1.f / 65536.f;
+/// The level in dBFS that is reported for digital silence.
+static constexpr float SILENCE_DB = -120.f;
+
+// ----- Dither ---------------------------------------------------------------
+
+void TpdfDither::fill(float* noise, const std::size_t& num_samples) {
+    // The two uniform variables are the halves of one xorshift32 output,
+    // which is never zero, so the noise is strictly greater than -1.
+    static constexpr float UNIT = 1.f / 65536.f;
+    for (std::size_t i = 0; i < num_samples; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        noise[i] = static_cast<float>((state >> 16) + (state & 0xFFFF)) * UNIT - 1.f;
+    }
+}
+
+// ----- Conversion -----------------------------------------------------------
+
+/// @brief Round a scaled sample to 16 bits with saturation.
+///
+/// @param value The scaled sample.
+/// @param num_clipped The counter of clipped samples to increment.
+/// @returns The nearest 16-bit sample (ties to even).
+///
+static inline int16_t quantize(const float& value, std::size_t& num_clipped) {
+    if (value > INT16_HIGH) {
+        num_clipped++;
+        return INT16_MAX;
+    }
+    if (value < INT16_LOW) {
+        num_clipped++;
+        return INT16_MIN;
+    }
+    return static_cast<int16_t>(std::lrint(value));
+}
+
+/// @brief Convert a block of samples to 16 bits with scalar code.
+///
+/// @tparam T The type of the input samples.
+/// @param samples The input samples.
+/// @param num_samples The number of samples.
+/// @param scale The scale of the input to 16-bit samples.
+/// @param noise The dither noise for the block, or `nullptr`.
+/// @param output The buffer for the 16-bit samples.
+/// @returns The number of clipped samples.
+///
+template<typename T>
+static inline std::size_t convert_block_scalar(const T* samples,
+    const std::size_t& num_samples,
+    const float& scale,
+    const float* noise,
+    int16_t* output
+) {
+    std::size_t num_clipped = 0;
+    for (std::size_t i = 0; i < num_samples; i++) {
+        float value = static_cast<float>(samples[i]) * scale;
+        if (noise) value += noise[i];
+        output[i] = quantize(value, num_clipped);
+    }
+    return num_clipped;
+}
+
+#if defined(SENSORYCLOUD_AUDIO_AVX2)
+
+/// @brief Load eight float samples.
+static inline __m256 load_avx2(const float* samples) { return _mm256_loadu_ps(samples); }
+
+/// @brief Load eight 32-bit samples as floats.
+static inline __m256 load_avx2(const int32_t* samples) {
+    return _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples)));
+}
+
+#endif  // SENSORYCLOUD_AUDIO_AVX2
+
+#if defined(SENSORYCLOUD_AUDIO_SSE2)
+
+/// @brief Load four float samples.
+static inline __m128 load_sse2(const float* samples) { return _mm_loadu_ps(samples); }
+
+/// @brief Load four 32-bit samples as floats.
+static inline __m128 load_sse2(const int32_t* samples) {
+    return _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples)));
+}
+
+#elif defined(SENSORYCLOUD_AUDIO_NEON) && defined(__aarch64__)
+
+/// @brief Load four float samples.
+static inline float32x4_t load_neon(const float* samples) { return vld1q_f32(samples); }
+
+/// @brief Load four 32-bit samples as floats.
+static inline float32x4_t load_neon(const int32_t* samples) { return vcvtq_f32_s32(vld1q_s32(samples)); }
+
+#endif  // SENSORYCLOUD_AUDIO_SSE2
+
+/// @brief Convert a block of samples to 16 bits.
+///
+/// @tparam T The type of the input samples.
+/// @param samples The input samples.
+/// @param num_samples The number of samples.
+/// @param scale The scale of the input to 16-bit samples.
+/// @param noise The dither noise for the block, or `nullptr`.
+/// @param output The buffer for the 16-bit samples.
+/// @returns The number of clipped samples.
+///
+/// @details
+/// The kernels round with the default rounding mode (to nearest, ties to
+/// even) like `std::lrint`, and the scales are powers of two, so the output
+/// matches the scalar code exactly.
+///
+template<typename T>
+static inline std::size_t convert_block(const T* samples,
+    const std::size_t& num_samples,
+    const float& scale,
+    const float* noise,
+    int16_t* output
+) {
+    std::size_t i = 0;
+    std::size_t num_clipped = 0;
+#if defined(SENSORYCLOUD_AUDIO_AVX2)
+    {
+        const __m256 scale8 = _mm256_set1_ps(scale);
+        const __m256 high = _mm256_set1_ps(INT16_HIGH);
+        const __m256 low = _mm256_set1_ps(INT16_LOW);
+        __m256i clipped = _mm256_setzero_si256();
+        for (; i + 16 <= num_samples; i += 16) {
+            __m256 a = _mm256_mul_ps(load_avx2(samples + i), scale8);
+            __m256 b = _mm256_mul_ps(load_avx2(samples + i + 8), scale8);
+            if (noise) {
+                a = _mm256_add_ps(a, _mm256_loadu_ps(noise + i));
+                b = _mm256_add_ps(b, _mm256_loadu_ps(noise + i + 8));
+            }
+            // The comparison masks are -1 in clipped lanes.
+            clipped = _mm256_sub_epi32(clipped, _mm256_castps_si256(_mm256_or_ps(
+                _mm256_cmp_ps(a, high, _CMP_GT_OQ), _mm256_cmp_ps(a, low, _CMP_LT_OQ))));
+            clipped = _mm256_sub_epi32(clipped, _mm256_castps_si256(_mm256_or_ps(
+                _mm256_cmp_ps(b, high, _CMP_GT_OQ), _mm256_cmp_ps(b, low, _CMP_LT_OQ))));
+            a = _mm256_min_ps(_mm256_max_ps(a, low), high);
+            b = _mm256_min_ps(_mm256_max_ps(b, low), high);
+            const __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+            // The pack interleaves the 128-bit lanes, so restore the sample order.
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), _mm256_permute4x64_epi64(packed, 0xD8));
+        }
+        int32_t counts[8];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(counts), clipped);
+        for (const auto& count : counts) num_clipped += count;
+    }
+#endif
+#if defined(SENSORYCLOUD_AUDIO_SSE2)
+    {
+        const __m128 scale4 = _mm_set1_ps(scale);
+        const __m128 high = _mm_set1_ps(INT16_HIGH);
+        const __m128 low = _mm_set1_ps(INT16_LOW);
+        __m128i clipped = _mm_setzero_si128();
+        for (; i + 8 <= num_samples; i += 8) {
+            __m128 a = _mm_mul_ps(load_sse2(samples + i), scale4);
+            __m128 b = _mm_mul_ps(load_sse2(samples + i + 4), scale4);
+            if (noise) {
+                a = _mm_add_ps(a, _mm_loadu_ps(noise + i));
+                b = _mm_add_ps(b, _mm_loadu_ps(noise + i + 4));
+            }
+            // The comparison masks are -1 in clipped lanes.
+            clipped = _mm_sub_epi32(clipped, _mm_castps_si128(_mm_or_ps(_mm_cmpgt_ps(a, high), _mm_cmplt_ps(a, low))));
+            clipped = _mm_sub_epi32(clipped, _mm_castps_si128(_mm_or_ps(_mm_cmpgt_ps(b, high), _mm_cmplt_ps(b, low))));
+            a = _mm_min_ps(_mm_max_ps(a, low), high);
+            b = _mm_min_ps(_mm_max_ps(b, low), high);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i),
+                _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+        }
+        int32_t counts[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(counts), clipped);
+        for (const auto& count : counts) num_clipped += count;
+    }
+#elif defined(SENSORYCLOUD_AUDIO_NEON) && defined(__aarch64__)
+    {
+        const float32x4_t high = vdupq_n_f32(INT16_HIGH);
+        const float32x4_t low = vdupq_n_f32(INT16_LOW);
+        uint32x4_t clipped = vdupq_n_u32(0);
+        for (; i + 8 <= num_samples; i += 8) {
+            float32x4_t a = vmulq_n_f32(load_neon(samples + i), scale);
+            float32x4_t b = vmulq_n_f32(load_neon(samples + i + 4), scale);
+            if (noise) {
+                a = vaddq_f32(a, vld1q_f32(noise + i));
+                b = vaddq_f32(b, vld1q_f32(noise + i + 4));
+            }
+            // The comparison masks are all ones (-1) in clipped lanes.
+            clipped = vsubq_u32(clipped, vorrq_u32(vcgtq_f32(a, high), vcltq_f32(a, low)));
+            clipped = vsubq_u32(clipped, vorrq_u32(vcgtq_f32(b, high), vcltq_f32(b, low)));
+            a = vminq_f32(vmaxq_f32(a, low), high);
+            b = vminq_f32(vmaxq_f32(b, low), high);
+            vst1q_s16(output + i, vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)), vqmovn_s32(vcvtnq_s32_f32(b))));
+        }
+        num_clipped += vaddvq_u32(clipped);
+    }
+#endif
+    if (i < num_samples)
+        num_clipped += convert_block_scalar(samples + i, num_samples - i, scale, noise ? noise + i : nullptr, output + i);
+    return num_clipped;
+}
+
+/// @brief Convert samples to 16 bits in blocks of dither noise.
+///
+/// @tparam T The type of the input samples.
+/// @param samples The input samples.
+/// @param num_samples The number of samples.
+/// @param scale The scale of the input to 16-bit samples.
+/// @param dither The dither generator, or `nullptr`.
+/// @param output The buffer for the 16-bit samples.
+/// @param is_vectorized Whether to use the SIMD kernels.
+/// @returns The number of clipped samples.
+///
+template<typename T>
+static std::size_t convert(const T* samples,
+    const std::size_t& num_samples,
+    const float& scale,
+    TpdfDither* dither,
+    int16_t* output,
+    const bool& is_vectorized
+) {
+    std::size_t num_clipped = 0;
+    float noise[BLOCK_SIZE];
+    for (std::size_t start = 0; start < num_samples; start += BLOCK_SIZE) {
+        const auto length = std::min(BLOCK_SIZE, num_samples - start);
+        if (dither) dither->fill(noise, length);
+        const float* block_noise = dither ? noise : nullptr;
+        num_clipped += is_vectorized ?
+            convert_block(samples + start, length, scale, block_noise, output + start) :
+            convert_block_scalar(samples + start, length, scale, block_noise, output + start);
+    }
+    return num_clipped;
+}
+
+std::size_t float_to_int16_scalar(const float* samples,
+    const std::size_t& num_samples,
+    int16_t* output,
+    TpdfDither* dither
+) {
+    return convert(samples, num_samples, FLOAT_SCALE, dither, output, false);
+}
+
+std::size_t float_to_int16(const float* samples,
+    const std::size_t& num_samples,
+    int16_t* output,
+    TpdfDither* dither
+) {
+    return convert(samples, num_samples, FLOAT_SCALE, dither, output, true);
+}
+
+std::size_t int32_to_int16_scalar(const int32_t* samples,
+    const std::size_t& num_samples,
+    int16_t* output,
+    TpdfDither* dither
+) {
+    return convert(samples, num_samples, INT32_SCALE, dither, output, false);
+}
+
+std::size_t int32_to_int16(const int32_t* samples,
+    const std::size_t& num_samples,
+    int16_t* output,
+    TpdfDither* dither
+) {
+    return convert(samples, num_samples, INT32_SCALE, dither, output, true);
+}
+
+// ----- Deinterleave ---------------------------------------------------------
+
+void deinterleave_scalar(const int16_t* samples,
+    const std::size_t& num_frames,
+    const uint32_t& num_channels,
+    int16_t* const* outputs
+) {
+    if (num_channels == 0)
+        throw std::invalid_argument("deinterleave requires at least one channel.");
+    for (std::size_t i = 0; i < num_frames; i++)
+        for (uint32_t c = 0; c < num_channels; c++)
+            outputs[c][i] = samples[i * num_channels + c];
+}
+
+void deinterleave(const int16_t* samples,
+    const std::size_t& num_frames,
+    const uint32_t& num_channels,
+    int16_t* const* outputs
+) {
+    if (num_channels == 0)
+        throw std::invalid_argument("deinterleave requires at least one channel.");
+    if (num_channels == 1) {
+        std::memcpy(outputs[0], samples, num_frames * sizeof(int16_t));
+        return;
+    }
+    if (num_channels != 2) {
+        deinterleave_scalar(samples, num_frames, num_channels, outputs);
+        return;
+    }
+    int16_t* left = outputs[0];
+    int16_t* right = outputs[1];
+    std::size_t i = 0;
+#if defined(SENSORYCLOUD_AUDIO_AVX2)
+    for (; i + 16 <= num_frames; i += 16) {
+        const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + 2 * i));
+        const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + 2 * i + 16));
+        // Sign-extend the even (left) and odd (right) samples to 32 bits and
+        // pack them back, which is exact because they are 16-bit values.
+        const __m256i even = _mm256_packs_epi32(
+            _mm256_srai_epi32(_mm256_slli_epi32(low, 16), 16),
+            _mm256_srai_epi32(_mm256_slli_epi32(high, 16), 16));
+        const __m256i odd = _mm256_packs_epi32(_mm256_srai_epi32(low, 16), _mm256_srai_epi32(high, 16));
+        // The pack interleaves the 128-bit lanes, so restore the frame order.
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(left + i), _mm256_permute4x64_epi64(even, 0xD8));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(right + i), _mm256_permute4x64_epi64(odd, 0xD8));
+    }
+#endif
+#if defined(SENSORYCLOUD_AUDIO_SSE2)
+    for (; i + 8 <= num_frames; i += 8) {
+        const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + 2 * i));
+        const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + 2 * i + 8));
+        // Sign-extend the even (left) and odd (right) samples to 32 bits and
+        // pack them back, which is exact because they are 16-bit values.
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(left + i), _mm_packs_epi32(
+            _mm_srai_epi32(_mm_slli_epi32(low, 16), 16),
+            _mm_srai_epi32(_mm_slli_epi32(high, 16), 16)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(right + i),
+            _mm_packs_epi32(_mm_srai_epi32(low, 16), _mm_srai_epi32(high, 16)));
+    }
+#elif defined(SENSORYCLOUD_AUDIO_NEON)
+    for (; i + 8 <= num_frames; i += 8) {
+        const int16x8x2_t frames = vld2q_s16(samples + 2 * i);
+        vst1q_s16(left + i, frames.val[0]);
+        vst1q_s16(right + i, frames.val[1]);
+    }
+#endif
+    for (; i < num_frames; i++) {
+        left[i] = samples[2 * i];
+        right[i] = samples[2 * i + 1];
+    }
+}
+
+// ----- Level ----------------------------------------------------------------
+
+/// @brief Create a level from the sum of squares and the peak of samples.
+///
+/// @param sum_of_squares The sum of the squared samples.
+/// @param peak The largest absolute sample.
+/// @param num_samples The number of samples.
+/// @returns The level relative to full scale.
+///
+static inline AudioLevel to_level(const uint64_t& sum_of_squares, const int32_t& peak, const std::size_t& num_samples) {
+    AudioLevel level;
+    if (num_samples == 0) return level;
+    level.rms = static_cast<float>(std::sqrt(static_cast<double>(sum_of_squares) / num_samples) / FLOAT_SCALE);
+    level.peak = static_cast<float>(peak) / FLOAT_SCALE;
+    return level;
+}
+
+AudioLevel measure_level_scalar(const int16_t* samples, const std::size_t& num_samples) {
+    uint64_t sum_of_squares = 0;
+    int32_t peak = 0;
+    for (std::size_t i = 0; i < num_samples; i++) {
+        const int32_t sample = samples[i];
+        sum_of_squares += static_cast<uint64_t>(sample * sample);
+        peak = std::max(peak, sample < 0 ? -sample : sample);
+    }
+    return to_level(sum_of_squares, peak, num_samples);
+}
+
+AudioLevel measure_level(const int16_t* samples, const std::size_t& num_samples) {
+    std::size_t i = 0;
+    uint64_t sum_of_squares = 0;
+    int32_t maximum = 0;
+    int32_t minimum = 0;
+    // The pairwise sums of squares are at most 2^31, so they are accumulated
+    // as unsigned 32-bit values widened to 64 bits.
+#if defined(SENSORYCLOUD_AUDIO_AVX2)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i sums = _mm256_setzero_si256();
+        __m256i max16 = _mm256_setzero_si256();
+        __m256i min16 = _mm256_setzero_si256();
+        for (; i + 16 <= num_samples; i += 16) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i));
+            const __m256i squares = _mm256_madd_epi16(x, x);
+            sums = _mm256_add_epi64(sums, _mm256_unpacklo_epi32(squares, zero));
+            sums = _mm256_add_epi64(sums, _mm256_unpackhi_epi32(squares, zero));
+            max16 = _mm256_max_epi16(max16, x);
+            min16 = _mm256_min_epi16(min16, x);
+        }
+        uint64_t lanes[4];
+        int16_t maxima[16];
+        int16_t minima[16];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sums);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(maxima), max16);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(minima), min16);
+        for (const auto& lane : lanes) sum_of_squares += lane;
+        for (const auto& value : maxima) maximum = std::max<int32_t>(maximum, value);
+        for (const auto& value : minima) minimum = std::min<int32_t>(minimum, value);
+    }
+#endif
+#if defined(SENSORYCLOUD_AUDIO_SSE2)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i sums = _mm_setzero_si128();
+        __m128i max16 = _mm_setzero_si128();
+        __m128i min16 = _mm_setzero_si128();
+        for (; i + 8 <= num_samples; i += 8) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+            const __m128i squares = _mm_madd_epi16(x, x);
+            sums = _mm_add_epi64(sums, _mm_unpacklo_epi32(squares, zero));
+            sums = _mm_add_epi64(sums, _mm_unpackhi_epi32(squares, zero));
+            max16 = _mm_max_epi16(max16, x);
+            min16 = _mm_min_epi16(min16, x);
+        }
+        uint64_t lanes[2];
+        int16_t maxima[8];
+        int16_t minima[8];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sums);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(maxima), max16);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(minima), min16);
+        for (const auto& lane : lanes) sum_of_squares += lane;
+        for (const auto& value : maxima) maximum = std::max<int32_t>(maximum, value);
+        for (const auto& value : minima) minimum = std::min<int32_t>(minimum, value);
+    }
+#elif defined(SENSORYCLOUD_AUDIO_NEON)
+    {
+        int64x2_t sums = vdupq_n_s64(0);
+        int16x8_t max16 = vdupq_n_s16(0);
+        int16x8_t min16 = vdupq_n_s16(0);
+        for (; i + 8 <= num_samples; i += 8) {
+            const int16x8_t x = vld1q_s16(samples + i);
+            // The squares are at most 2^30 and their pairwise sums fit in 64 bits.
+            sums = vpadalq_s32(sums, vmull_s16(vget_low_s16(x), vget_low_s16(x)));
+            sums = vpadalq_s32(sums, vmull_s16(vget_high_s16(x), vget_high_s16(x)));
+            max16 = vmaxq_s16(max16, x);
+            min16 = vminq_s16(min16, x);
+        }
+        int64_t lanes[2];
+        int16_t maxima[8];
+        int16_t minima[8];
+        vst1q_s64(lanes, sums);
+        vst1q_s16(maxima, max16);
+        vst1q_s16(minima, min16);
+        for (const auto& lane : lanes) sum_of_squares += static_cast<uint64_t>(lane);
+        for (const auto& value : maxima) maximum = std::max<int32_t>(maximum, value);
+        for (const auto& value : minima) minimum = std::min<int32_t>(minimum, value);
+    }
+#endif
+    for (; i < num_samples; i++) {
+        const int32_t sample = samples[i];
+        sum_of_squares += static_cast<uint64_t>(sample * sample);
+        maximum = std::max(maximum, sample);
+        minimum = std::min(minimum, sample);
+    }
+    return to_level(sum_of_squares, std::max(maximum, -minimum), num_samples);
+}
+
+float to_dbfs(const float& level) {
+    return level > 0.f ? 20.f * std::log10(level) : SILENCE_DB;
+}
+
+// ----- LevelMeter -----------------------------------------------------------
+
+AudioLevel LevelMeter::process(const int16_t* samples, const std::size_t& num_samples) {
+    const auto level = measure_level(samples, num_samples);
+    rms = level.rms;
+    peak = level.peak;
+    float held = peak_hold.load();
+    while (level.peak > held && !peak_hold.compare_exchange_weak(held, level.peak)) continue;
+    return level;
+}
+
+// ----- PcmConverter ---------------------------------------------------------
+
+std::size_t PcmConverter::convert(const float* samples, const std::size_t& num_samples_, std::vector<int16_t>& output) {
+    output.resize(num_samples_);
+    const auto clipped = float_to_int16(samples, num_samples_, output.data(), is_dithered ? &dither : nullptr);
+    num_samples += num_samples_;
+    num_clipped += clipped;
+    return clipped;
+}
+
+std::size_t PcmConverter::convert(const int32_t* samples, const std::size_t& num_samples_, std::vector<int16_t>& output) {
+    output.resize(num_samples_);
+    const auto clipped = int32_to_int16(samples, num_samples_, output.data(), is_dithered ? &dither : nullptr);
+    num_samples += num_samples_;
+    num_clipped += clipped;
+    return clipped;
+}
+
+}  // namespace audio
+
+}  // namespace sensory
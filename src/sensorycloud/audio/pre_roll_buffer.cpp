@@ -0,0 +1,165 @@
+// A pre-roll buffer for handing wake-word audio to a transcription stream.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sensorycloud/audio/pre_roll_buffer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace sensory {
+
+namespace audio {
+
+PreRollBuffer::PreRollBuffer(const uint32_t& sample_rate_,
+    const std::chrono::milliseconds& length,
+    const uint32_t& num_channels_
+) :
+    sample_rate(sample_rate_),
+    num_channels(num_channels_),
+    capacity(static_cast<std::size_t>(std::max<int64_t>(length.count(), 0)) * sample_rate_ / 1000) {
+    if (sample_rate == 0)
+        throw std::invalid_argument("PreRollBuffer sample rate must be positive.");
+    if (num_channels == 0)
+        throw std::invalid_argument("PreRollBuffer requires at least one channel.");
+    if (capacity == 0)
+        throw std::invalid_argument("PreRollBuffer length must hold at least one frame.");
+    buffer.reset(new int16_t[capacity * num_channels]);
+}
+
+void PreRollBuffer::write(const int16_t* samples, const std::size_t& num_frames) {
+    if (num_frames == 0) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Only the newest frames of an oversized write survive.
+        const auto skip = num_frames > capacity ? num_frames - capacity : 0;
+        const auto count = num_frames - skip;
+        const auto start = position + skip;
+        const auto offset = static_cast<std::size_t>(start % capacity);
+        const auto first = std::min(count, capacity - offset);
+        samples += skip * num_channels;
+        std::memcpy(&buffer[offset * num_channels], samples, first * num_channels * sizeof(int16_t));
+        std::memcpy(&buffer[0], samples + first * num_channels, (count - first) * num_channels * sizeof(int16_t));
+        position += num_frames;
+    }
+    written.notify_all();
+}
+
+void PreRollBuffer::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+    }
+    written.notify_all();
+}
+
+bool PreRollBuffer::is_closed() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return closed;
+}
+
+uint64_t PreRollBuffer::get_position() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return position;
+}
+
+uint64_t PreRollBuffer::get_oldest() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return position > capacity ? position - capacity : 0;
+}
+
+void PreRollBuffer::mark_origin() {
+    std::lock_guard<std::mutex> lock(mutex);
+    origin = position;
+}
+
+uint64_t PreRollBuffer::get_origin() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return origin;
+}
+
+uint64_t PreRollBuffer::to_position(const float& seconds) const {
+    const auto offset = std::llround(std::max(seconds, 0.f) * static_cast<double>(sample_rate));
+    return get_origin() + static_cast<uint64_t>(offset);
+}
+
+uint64_t PreRollBuffer::get_handoff_position(
+    const ::sensory::api::v1::audio::ValidateEventResponse& response,
+    const std::chrono::milliseconds& lead
+) const {
+    if (!response.success())
+        throw std::invalid_argument("ValidateEventResponse is not a detection.");
+    const auto end = to_position(response.resultendtime());
+    const auto lead_frames = static_cast<uint64_t>(std::max<int64_t>(lead.count(), 0)) * sample_rate / 1000;
+    // Never hand off audio from before the start of the detection stream.
+    return std::max(end > lead_frames ? end - lead_frames : 0, get_origin());
+}
+
+std::size_t PreRollBuffer::copy_out(uint64_t& cursor, int16_t* samples, const std::size_t& num_frames) {
+    const auto oldest = position > capacity ? position - capacity : 0;
+    if (cursor < oldest) {
+        num_lost_frames += oldest - cursor;
+        cursor = oldest;
+    }
+    if (cursor >= position) return 0;
+    const auto count = static_cast<std::size_t>(std::min<uint64_t>(num_frames, position - cursor));
+    const auto offset = static_cast<std::size_t>(cursor % capacity);
+    const auto first = std::min(count, capacity - offset);
+    std::memcpy(samples, &buffer[offset * num_channels], first * num_channels * sizeof(int16_t));
+    std::memcpy(samples + first * num_channels, &buffer[0], (count - first) * num_channels * sizeof(int16_t));
+    cursor += count;
+    return count;
+}
+
+std::size_t PreRollBuffer::read(uint64_t& cursor, int16_t* samples, const std::size_t& num_frames) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return copy_out(cursor, samples, num_frames);
+}
+
+std::size_t PreRollBuffer::read_chunk(uint64_t& cursor,
+    int16_t* samples,
+    const std::size_t& num_frames,
+    const std::chrono::milliseconds& timeout
+) {
+    if (num_frames > capacity)
+        throw std::invalid_argument("PreRollBuffer chunk is larger than the buffer.");
+    std::unique_lock<std::mutex> lock(mutex);
+    // A cursor behind the history is satisfied as soon as the history holds
+    // a full chunk because it will be moved to the oldest frame.
+    const auto ready = [&]() {
+        return closed || position >= std::max(cursor, position > capacity ? position - capacity : 0) + num_frames;
+    };
+    if (!written.wait_for(lock, timeout, ready)) return 0;
+    return copy_out(cursor, samples, num_frames);
+}
+
+uint64_t PreRollBuffer::get_num_lost_frames() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return num_lost_frames;
+}
+
+}  // namespace audio
+
+}  // namespace sensory
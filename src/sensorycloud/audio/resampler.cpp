@@ -0,0 +1,282 @@
+// Streaming polyphase resampling and downmixing of 16-bit PCM audio.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sensorycloud/audio/resampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include "sensorycloud/audio/simd.hpp"
+
+namespace sensory {
+
+namespace audio {
+
+void downmix(
+    const int16_t* samples,
+    const std::size_t& num_frames,
+    const uint32_t& num_channels,
+    int16_t* output
+) {
+    if (num_channels == 0)
+        throw std::invalid_argument("downmix requires at least one channel.");
+    if (num_channels == 1) {
+        if (output != samples) std::memmove(output, samples, num_frames * sizeof(int16_t));
+        return;
+    }
+    std::size_t i = 0;
+    if (num_channels == 2) {
+#if defined(SENSORYCLOUD_AUDIO_AVX2)
+        const __m256i ones256 = _mm256_set1_epi16(1);
+        for (; i + 16 <= num_frames; i += 16) {
+            const __m256i low = _mm256_madd_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + 2 * i)), ones256);
+            const __m256i high = _mm256_madd_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + 2 * i + 16)), ones256);
+            const __m256i mixed = _mm256_packs_epi32(_mm256_srai_epi32(low, 1), _mm256_srai_epi32(high, 1));
+            // The pack interleaves the 128-bit lanes, so restore the frame order.
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), _mm256_permute4x64_epi64(mixed, 0xD8));
+        }
+#endif
+#if defined(SENSORYCLOUD_AUDIO_SSE2)
+        const __m128i ones = _mm_set1_epi16(1);
+        for (; i + 8 <= num_frames; i += 8) {
+            const __m128i low = _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + 2 * i)), ones);
+            const __m128i high = _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + 2 * i + 8)), ones);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i),
+                _mm_packs_epi32(_mm_srai_epi32(low, 1), _mm_srai_epi32(high, 1)));
+        }
+#elif defined(SENSORYCLOUD_AUDIO_NEON)
+        for (; i + 8 <= num_frames; i += 8) {
+            const int16x8x2_t frames = vld2q_s16(samples + 2 * i);
+            vst1q_s16(output + i, vhaddq_s16(frames.val[0], frames.val[1]));
+        }
+#endif
+        for (; i < num_frames; i++)
+            output[i] = static_cast<int16_t>((samples[2 * i] + samples[2 * i + 1]) >> 1);
+        return;
+    }
+    const auto channels = static_cast<int32_t>(num_channels);
+    for (; i < num_frames; i++) {
+        int32_t sum = 0;
+        for (int32_t c = 0; c < channels; c++) sum += samples[i * num_channels + c];
+        output[i] = static_cast<int16_t>(sum >= 0 ? sum / channels : -((-sum + channels - 1) / channels));
+    }
+}
+
+/// The maximal interpolation factor, which bounds the size of the filter.
+static constexpr uint32_t MAX_INTERPOLATION = 1024;
+/// The cutoff of the filter relative to the lower of the Nyquist rates.
+static constexpr double ROLLOFF = 0.9;
+/// The shape parameter of the Kaiser window (about 80dB of attenuation).
+static constexpr double KAISER_BETA = 8.0;
+/// The ratio of the circumference of a circle to its diameter.
+static constexpr double PI = 3.14159265358979323846;
+
+/// @brief Evaluate the zeroth-order modified Bessel function of the first kind.
+///
+/// @param x The argument of the function.
+/// @returns The value of I0(x).
+///
+static double bessel_i0(const double& x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 64 && term > 1e-12 * sum; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+/// @brief Compute the dot product of a filter phase and the input history.
+///
+/// @param taps The taps of the phase in reverse order.
+/// @param x The oldest input sample under the filter.
+/// @param num_taps The number of taps, a multiple of 8.
+/// @returns The filtered sample.
+///
+static inline float dot(const float* taps, const float* x, const uint32_t& num_taps) {
+#if defined(SENSORYCLOUD_AUDIO_AVX2)
+    __m256 sum = _mm256_setzero_ps();
+    for (uint32_t k = 0; k < num_taps; k += 8)
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(taps + k), _mm256_loadu_ps(x + k)));
+    __m128 total = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+    total = _mm_add_ps(total, _mm_movehl_ps(total, total));
+    total = _mm_add_ss(total, _mm_shuffle_ps(total, total, 1));
+    return _mm_cvtss_f32(total);
+#elif defined(SENSORYCLOUD_AUDIO_SSE2)
+    __m128 low = _mm_setzero_ps();
+    __m128 high = _mm_setzero_ps();
+    for (uint32_t k = 0; k < num_taps; k += 8) {
+        low = _mm_add_ps(low, _mm_mul_ps(_mm_loadu_ps(taps + k), _mm_loadu_ps(x + k)));
+        high = _mm_add_ps(high, _mm_mul_ps(_mm_loadu_ps(taps + k + 4), _mm_loadu_ps(x + k + 4)));
+    }
+    __m128 total = _mm_add_ps(low, high);
+    total = _mm_add_ps(total, _mm_movehl_ps(total, total));
+    total = _mm_add_ss(total, _mm_shuffle_ps(total, total, 1));
+    return _mm_cvtss_f32(total);
+#elif defined(SENSORYCLOUD_AUDIO_NEON)
+    float32x4_t low = vdupq_n_f32(0);
+    float32x4_t high = vdupq_n_f32(0);
+    for (uint32_t k = 0; k < num_taps; k += 8) {
+        low = vmlaq_f32(low, vld1q_f32(taps + k), vld1q_f32(x + k));
+        high = vmlaq_f32(high, vld1q_f32(taps + k + 4), vld1q_f32(x + k + 4));
+    }
+    const float32x4_t total = vaddq_f32(low, high);
+    float32x2_t pair = vadd_f32(vget_low_f32(total), vget_high_f32(total));
+    pair = vpadd_f32(pair, pair);
+    return vget_lane_f32(pair, 0);
+#else
+    float sum = 0;
+    for (uint32_t k = 0; k < num_taps; k++) sum += taps[k] * x[k];
+    return sum;
+#endif
+}
+
+/// @brief Round a filtered sample to 16 bits with saturation.
+///
+/// @param value The filtered sample.
+/// @returns The nearest 16-bit sample.
+///
+static inline int16_t to_int16(const float& value) {
+    if (value >= 32767.f) return INT16_MAX;
+    if (value <= -32768.f) return INT16_MIN;
+    return static_cast<int16_t>(value >= 0 ? value + 0.5f : value - 0.5f);
+}
+
+Resampler::Resampler(
+    const uint32_t& input_rate_,
+    const uint32_t& output_rate_,
+    const uint32_t& num_channels_,
+    const uint32_t& num_taps_
+) :
+    input_rate(input_rate_),
+    output_rate(output_rate_),
+    num_channels(num_channels_),
+    interpolation(1),
+    decimation(1),
+    num_taps(0),
+    time(0) {
+    if (input_rate == 0 || output_rate == 0)
+        throw std::invalid_argument("Resampler sample rates must be positive.");
+    if (num_channels == 0)
+        throw std::invalid_argument("Resampler requires at least one channel.");
+    if (num_taps_ < 8 || num_taps_ > 256)
+        throw std::invalid_argument("Resampler number of taps must be in [8, 256].");
+    // Reduce the ratio of the rates to the number of phases and the stride.
+    uint32_t a = input_rate, b = output_rate;
+    while (b != 0) {
+        const uint32_t r = a % b;
+        a = b;
+        b = r;
+    }
+    interpolation = output_rate / a;
+    decimation = input_rate / a;
+    if (interpolation > MAX_INTERPOLATION)
+        throw std::invalid_argument("Resampler interpolation factor of the rates must not exceed 1024.");
+    history.resize(num_channels);
+    if (interpolation == decimation) return;  // pass-through
+    // The filter spans `num_taps_` samples at the lower rate, rounded up to a
+    // multiple of the vector width of the dot product.
+    const uint32_t factor = std::max(interpolation, decimation);
+    num_taps = static_cast<uint32_t>((static_cast<uint64_t>(num_taps_) * factor + interpolation - 1) / interpolation);
+    num_taps = (num_taps + 7) / 8 * 8;
+    // Design the prototype low-pass filter at the upsampled rate.
+    const uint32_t length = num_taps * interpolation;
+    const double cutoff = 0.5 * ROLLOFF / factor;
+    const double center = (length - 1) / 2.0;
+    const double normalizer = bessel_i0(KAISER_BETA);
+    std::vector<double> prototype(length);
+    double sum = 0;
+    for (uint32_t n = 0; n < length; n++) {
+        const double x = n - center;
+        const double sinc = x == 0 ? 2 * cutoff : std::sin(2 * PI * cutoff * x) / (PI * x);
+        const double ratio = 2.0 * n / (length - 1) - 1.0;
+        const double window = bessel_i0(KAISER_BETA * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / normalizer;
+        prototype[n] = sinc * window;
+        sum += prototype[n];
+    }
+    // Decompose the filter into phases with a DC gain of one each.
+    filter.resize(length);
+    for (uint32_t phase = 0; phase < interpolation; phase++)
+        for (uint32_t k = 0; k < num_taps; k++)
+            filter[phase * num_taps + k] = static_cast<float>(
+                prototype[(num_taps - 1 - k) * interpolation + phase] * interpolation / sum);
+    reset();
+}
+
+uint32_t Resampler::get_delay() const {
+    if (num_taps == 0) return 0;
+    const double delay = (static_cast<double>(num_taps) * interpolation - 1) / (2.0 * decimation);
+    return static_cast<uint32_t>(delay + 0.5);
+}
+
+void Resampler::process(const int16_t* samples, const std::size_t& num_frames, std::vector<int16_t>& output) {
+    if (num_taps == 0) {
+        output.insert(output.end(), samples, samples + num_frames * num_channels);
+        return;
+    }
+    for (uint32_t c = 0; c < num_channels; c++)
+        for (std::size_t i = 0; i < num_frames; i++)
+            history[c].push_back(samples[i * num_channels + c]);
+    const std::size_t size = history[0].size();
+    // Produce every output whose filter window is covered by the history.
+    output.reserve(output.size() + num_channels * (num_frames * interpolation / decimation + 1));
+    while (time / interpolation + num_taps <= size) {
+        const auto start = static_cast<std::size_t>(time / interpolation);
+        const float* taps = &filter[(time % interpolation) * num_taps];
+        for (uint32_t c = 0; c < num_channels; c++)
+            output.push_back(to_int16(dot(taps, &history[c][start], num_taps)));
+        time += decimation;
+    }
+    // Drop the input samples that no future output depends on.
+    const auto consumed = static_cast<std::size_t>(time / interpolation);
+    for (auto& channel : history)
+        channel.erase(channel.begin(), channel.begin() + consumed);
+    time -= static_cast<uint64_t>(consumed) * interpolation;
+}
+
+void Resampler::flush(std::vector<int16_t>& output) {
+    if (num_taps > 0) {
+        const std::size_t delay = get_delay();
+        const std::size_t frames = (delay + 1) * decimation / interpolation + 1;
+        const std::vector<int16_t> silence(frames * num_channels, 0);
+        std::vector<int16_t> tail;
+        process(silence.data(), frames, tail);
+        tail.resize(std::min(tail.size(), delay * num_channels));
+        output.insert(output.end(), tail.begin(), tail.end());
+    }
+    reset();
+}
+
+void Resampler::reset() {
+    // Prime the history with silence so the first output is the first input
+    // sample delayed by the group delay of the filter.
+    for (auto& channel : history)
+        channel.assign(num_taps > 0 ? num_taps - 1 : 0, 0.f);
+    time = 0;
+}
+
+}  // namespace audio
+
+}  // namespace sensory
@@ -0,0 +1,92 @@
+// An audio stream that reconnects and replays audio after transient failures.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sensorycloud/audio/resumable_stream.hpp"
+
+namespace sensory {
+
+namespace audio {
+
+bool is_retryable(const ::grpc::Status& status) {
+    switch (status.error_code()) {
+    case ::grpc::StatusCode::UNAVAILABLE:
+    case ::grpc::StatusCode::DEADLINE_EXCEEDED:
+    case ::grpc::StatusCode::RESOURCE_EXHAUSTED:
+    case ::grpc::StatusCode::ABORTED:
+        return true;
+    default:
+        return false;
+    }
+}
+
+uint64_t find_resume_point(const std::vector<::sensory::api::v1::audio::TranscribeWord>& words,
+    const uint64_t& earliest_ms,
+    std::size_t& num_kept
+) {
+    uint64_t resume_ms = earliest_ms;
+    // Move the resume point past a word that spans it, so that the replay
+    // does not recognize a fragment of that word.
+    for (const auto& word : words) {
+        if (word.begintimems() < resume_ms && word.endtimems() > resume_ms) {
+            resume_ms = word.endtimems();
+            break;
+        }
+    }
+    // Keep the words that end before the resume point; the replay
+    // recognizes the remaining words again.
+    num_kept = 0;
+    while (num_kept < words.size() && words[num_kept].endtimems() <= resume_ms)
+        num_kept++;
+    return resume_ms;
+}
+
+void shift_response(::sensory::api::v1::audio::TranscribeResponse& response,
+    const uint64_t& offset_ms,
+    const uint64_t& index_offset
+) {
+    if (!response.has_wordlist() || response.wordlist().words().empty()) return;
+    auto& word_list = *response.mutable_wordlist();
+    for (auto& word : *word_list.mutable_words()) {
+        word.set_begintimems(word.begintimems() + offset_ms);
+        word.set_endtimems(word.endtimems() + offset_ms);
+        word.set_wordindex(word.wordindex() + index_offset);
+    }
+    word_list.set_firstwordindex(word_list.firstwordindex() + index_offset);
+    word_list.set_lastwordindex(word_list.lastwordindex() + index_offset);
+}
+
+void shift_response(::sensory::api::v1::audio::ValidateEventResponse& response,
+    const uint64_t& offset_ms,
+    const uint64_t&
+) {
+    if (!response.success()) return;
+    const float offset = offset_ms / 1000.f;
+    response.set_resultstarttime(response.resultstarttime() + offset);
+    response.set_resultendtime(response.resultendtime() + offset);
+}
+
+}  // namespace audio
+
+}  // namespace sensory
@@ -0,0 +1,117 @@
+// A lock-free ring buffer for handing captured audio to the network.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sensorycloud/audio/ring_buffer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace sensory {
+
+namespace audio {
+
+constexpr unsigned long AudioCaptureAdapter::INPUT_OVERFLOW;
+
+AudioRingBuffer::AudioRingBuffer(const std::size_t& capacity, const uint32_t& num_channels_) :
+    buffer(new int16_t[::sensory::util::next_power_of_two(capacity) * std::max<uint32_t>(num_channels_, 1)]),
+    mask(::sensory::util::next_power_of_two(capacity) - 1),
+    num_channels(num_channels_),
+    head(0),
+    num_overruns(0),
+    num_dropped_frames(0),
+    tail(0),
+    num_underruns(0) {
+    if (capacity == 0)
+        throw std::invalid_argument("AudioRingBuffer capacity must be at least 1.");
+    if (num_channels == 0)
+        throw std::invalid_argument("AudioRingBuffer requires at least one channel.");
+}
+
+std::size_t AudioRingBuffer::write(const int16_t* samples, const std::size_t& num_frames) {
+    const auto position = head.load(std::memory_order_relaxed);
+    const auto free = capacity() - (position - tail.load(std::memory_order_acquire));
+    const auto count = std::min(num_frames, free);
+    if (count < num_frames) {
+        num_overruns.fetch_add(1, std::memory_order_relaxed);
+        num_dropped_frames.fetch_add(num_frames - count, std::memory_order_relaxed);
+    }
+    // Copy the frames in at most two spans around the end of the ring.
+    const auto offset = position & mask;
+    const auto first = std::min(count, capacity() - offset);
+    std::memcpy(&buffer[offset * num_channels], samples, first * num_channels * sizeof(int16_t));
+    std::memcpy(&buffer[0], samples + first * num_channels, (count - first) * num_channels * sizeof(int16_t));
+    head.store(position + count, std::memory_order_release);
+    return count;
+}
+
+std::size_t AudioRingBuffer::read(int16_t* samples, const std::size_t& num_frames) {
+    const auto position = tail.load(std::memory_order_relaxed);
+    const auto count = std::min(num_frames, head.load(std::memory_order_acquire) - position);
+    const auto offset = position & mask;
+    const auto first = std::min(count, capacity() - offset);
+    std::memcpy(samples, &buffer[offset * num_channels], first * num_channels * sizeof(int16_t));
+    std::memcpy(samples + first * num_channels, &buffer[0], (count - first) * num_channels * sizeof(int16_t));
+    tail.store(position + count, std::memory_order_release);
+    return count;
+}
+
+bool AudioRingBuffer::try_read_chunk(int16_t* samples, const std::size_t& num_frames) {
+    if (size() < num_frames) {
+        num_underruns.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    read(samples, num_frames);
+    return true;
+}
+
+bool AudioRingBuffer::read_chunk(int16_t* samples,
+    const std::size_t& num_frames,
+    const std::chrono::milliseconds& timeout,
+    const std::chrono::microseconds& poll_interval
+) {
+    if (try_read_chunk(samples, num_frames)) return true;
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (size() < num_frames) {
+        if (std::chrono::steady_clock::now() >= deadline) return false;
+        std::this_thread::sleep_for(poll_interval);
+    }
+    read(samples, num_frames);
+    return true;
+}
+
+void AudioPlaybackAdapter::play(int16_t* samples, const std::size_t& num_frames) {
+    num_callbacks.fetch_add(1, std::memory_order_relaxed);
+    const auto count = ring.read(samples, num_frames);
+    if (count == num_frames) return;
+    num_underflows.fetch_add(1, std::memory_order_relaxed);
+    num_silent_frames.fetch_add(num_frames - count, std::memory_order_relaxed);
+    const auto offset = count * ring.get_num_channels();
+    std::fill(samples + offset, samples + num_frames * ring.get_num_channels(), 0);
+}
+
+}  // namespace audio
+
+}  // namespace sensory
@@ -0,0 +1,281 @@
+// Sinks for streaming synthesized speech to files and playback.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sensorycloud/audio/speech_sink.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include "sensorycloud/audio/wav.hpp"
+
+namespace sensory {
+
+namespace audio {
+
+/// The maximal number of bytes of a RIFF/WAVE header before its data.
+static constexpr std::size_t MAX_HEADER_SIZE = 1 << 16;
+
+/// @brief Decode a little-endian integer.
+///
+/// @param data The bytes of the integer.
+/// @param size The number of bytes, at most 4.
+/// @returns The decoded integer.
+///
+static inline uint32_t read_le(const char* data, const std::size_t& size) {
+    uint32_t value = 0;
+    for (std::size_t i = 0; i < size; i++)
+        value |= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+    return value;
+}
+
+// ----- SpeechSink -----------------------------------------------------------
+
+SpeechSink::SpeechSink(const uint32_t& sample_rate_, const uint32_t& num_channels_) :
+    state(State::Detect),
+    sample_rate(sample_rate_),
+    num_channels(num_channels_),
+    has_format(false),
+    finished(false),
+    num_frames(0),
+    start_time(std::chrono::steady_clock::now()) { }
+
+void SpeechSink::process(const ::sensory::api::v1::audio::SynthesizeSpeechResponse& response) {
+    if (finished)
+        throw std::runtime_error("SpeechSink received a response after it finished.");
+    if (response.has_config()) {
+        const auto& config = response.config();
+        if (config.encoding() != ::sensory::api::v1::audio::AudioConfig_AudioEncoding_LINEAR16)
+            throw std::runtime_error("SpeechSink only supports LINEAR16 audio.");
+        if (!has_format) {
+            if (config.sampleratehertz() > 0) sample_rate = config.sampleratehertz();
+            if (config.audiochannelcount() > 0) num_channels = config.audiochannelcount();
+        }
+    } else if (response.has_audiocontent()) {
+        write(response.audiocontent().data(), response.audiocontent().size());
+    }
+}
+
+void SpeechSink::write(const char* data, const std::size_t& size) {
+    if (finished)
+        throw std::runtime_error("SpeechSink received audio after it finished.");
+    if (state == State::Samples) {
+        decode(data, size);
+        return;
+    }
+    // Buffer the leading bytes until the presence of a header is known and,
+    // if there is one, until it has been parsed.
+    header.append(data, size);
+    if (state == State::Detect) {
+        const auto length = std::min<std::size_t>(header.size(), 4);
+        if (header.compare(0, length, "RIFF", length) != 0) state = State::Samples;
+        else if (header.size() >= 4) state = State::Header;
+        else return;
+    }
+    if (state == State::Header && !parse_header()) return;
+    state = State::Samples;
+    std::string bytes;
+    bytes.swap(header);
+    decode(bytes.data(), bytes.size());
+}
+
+bool SpeechSink::parse_header() {
+    if (header.size() > MAX_HEADER_SIZE)
+        throw std::runtime_error("SpeechSink received a WAV header that is too large.");
+    if (header.size() < 12) return false;
+    if (header.compare(8, 4, "WAVE") != 0)
+        throw std::runtime_error("SpeechSink received a RIFF stream that is not WAVE audio.");
+    bool has_fmt = false;
+    std::size_t position = 12;
+    while (position + 8 <= header.size()) {
+        const std::string id = header.substr(position, 4);
+        const uint32_t size = read_le(&header[position + 4], 4);
+        if (id == "data") {
+            if (!has_fmt)
+                throw std::runtime_error("SpeechSink received a WAV header without a fmt chunk.");
+            // The size of the data is ignored, streamed files commonly leave
+            // it at zero or at the maximal value.
+            header.erase(0, position + 8);
+            return true;
+        }
+        if (id == "fmt ") {
+            if (size < 16)
+                throw std::runtime_error("SpeechSink received a malformed fmt chunk.");
+            if (position + 8 + size > header.size()) return false;
+            const char* format = &header[position + 8];
+            uint32_t tag = read_le(format, 2);
+            if (tag == 0xFFFE && size >= 26) tag = read_le(format + 24, 2);
+            if (tag != 1 || read_le(format + 14, 2) != 16 || read_le(format + 2, 2) == 0)
+                throw std::runtime_error("SpeechSink only supports 16-bit PCM WAV audio.");
+            if (!has_format) {
+                num_channels = read_le(format + 2, 2);
+                sample_rate = read_le(format + 4, 4);
+            }
+            has_fmt = true;
+        }
+        position += 8 + size + (size & 1);
+    }
+    return false;
+}
+
+void SpeechSink::on_format(const uint32_t&, const uint32_t&) { }
+
+void SpeechSink::resolve_format() {
+    if (has_format) return;
+    if (sample_rate == 0 || num_channels == 0)
+        throw std::runtime_error("SpeechSink received audio of an unknown format.");
+    has_format = true;
+    on_format(sample_rate, num_channels);
+}
+
+void SpeechSink::decode(const char* data, std::size_t size) {
+    if (size == 0) return;
+    resolve_format();
+    const std::size_t frame_size = sizeof(int16_t) * num_channels;
+    // Complete the frame that was split across the previous chunk.
+    if (!partial.empty()) {
+        const auto count = std::min(frame_size - partial.size(), size);
+        partial.append(data, count);
+        data += count;
+        size -= count;
+        if (partial.size() < frame_size) return;
+    }
+    const std::size_t frames = size / frame_size + (partial.empty() ? 0 : 1);
+    samples.resize(frames * num_channels);
+    std::size_t index = 0;
+    if (!partial.empty()) {
+        for (uint32_t c = 0; c < num_channels; c++)
+            samples[index++] = static_cast<int16_t>(read_le(&partial[2 * c], 2));
+        partial.clear();
+    }
+    const std::size_t num_bytes = size / frame_size * frame_size;
+    for (std::size_t i = 0; i < num_bytes; i += 2)
+        samples[index++] = static_cast<int16_t>(read_le(data + i, 2));
+    partial.assign(data + num_bytes, size - num_bytes);
+    if (frames == 0) return;
+    if (num_frames == 0) first_audio_time = std::chrono::steady_clock::now();
+    num_frames += frames;
+    on_samples(samples.data(), frames);
+}
+
+void SpeechSink::finish() {
+    if (finished) return;
+    finished = true;
+    // Content too short to be a header is audio.
+    if (state == State::Detect) {
+        std::string bytes;
+        bytes.swap(header);
+        decode(bytes.data(), bytes.size());
+    }
+    if (!has_format && sample_rate != 0 && num_channels != 0) resolve_format();
+    partial.clear();
+    on_finish();
+}
+
+// ----- WavFileSink ----------------------------------------------------------
+
+WavFileSink::WavFileSink(const std::string& path_, const uint32_t& sample_rate_) :
+    SpeechSink(sample_rate_), path(path_), data_size(0) { }
+
+void WavFileSink::on_format(const uint32_t& sample_rate_, const uint32_t& num_channels_) {
+    file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file)
+        throw std::runtime_error("Failed to open WAV file " + path);
+    write_wav_header(file, sample_rate_, num_channels_, 0);
+}
+
+void WavFileSink::on_samples(const int16_t* samples_, const std::size_t& num_frames_) {
+    const std::size_t count = num_frames_ * get_num_channels();
+    std::string bytes(2 * count, '\0');
+    for (std::size_t i = 0; i < count; i++) {
+        const auto sample = static_cast<uint16_t>(samples_[i]);
+        bytes[2 * i] = static_cast<char>(sample & 0xFF);
+        bytes[2 * i + 1] = static_cast<char>(sample >> 8);
+    }
+    // Flush each chunk so the growing file can be read while it streams.
+    file.write(bytes.data(), bytes.size());
+    file.flush();
+    data_size += bytes.size();
+    if (!file)
+        throw std::runtime_error("Failed to write WAV file " + path);
+}
+
+void WavFileSink::on_finish() {
+    if (!file.is_open()) return;
+    // Patch the sizes in the header now that the length is known.
+    const uint64_t max_size = std::numeric_limits<uint32_t>::max() - WAV_HEADER_SIZE;
+    file.seekp(0);
+    write_wav_header(file, get_sample_rate(), get_num_channels(), static_cast<uint32_t>(std::min(data_size, max_size)));
+    file.close();
+    if (!file)
+        throw std::runtime_error("Failed to write WAV file " + path);
+}
+
+// ----- PlaybackSink ---------------------------------------------------------
+
+PlaybackSink::PlaybackSink(AudioRingBuffer& ring_,
+    const uint32_t& sample_rate_,
+    const std::chrono::milliseconds& timeout_
+) : SpeechSink(sample_rate_, ring_.get_num_channels()), ring(ring_), timeout(timeout_) { }
+
+void PlaybackSink::on_format(const uint32_t&, const uint32_t& num_channels_) {
+    if (num_channels_ != ring.get_num_channels())
+        throw std::runtime_error("PlaybackSink ring has a different number of channels than the audio.");
+}
+
+void PlaybackSink::on_samples(const int16_t* samples_, const std::size_t& num_frames_) {
+    const auto channels = ring.get_num_channels();
+    std::size_t offset = 0;
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (offset < num_frames_) {
+        const auto count = std::min(num_frames_ - offset, ring.space());
+        if (count > 0) {
+            offset += ring.write(samples_ + offset * channels, count);
+            deadline = std::chrono::steady_clock::now() + timeout;
+            continue;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            // Playback has stalled, drop the rest as an overrun of the ring.
+            ring.write(samples_ + offset * channels, num_frames_ - offset);
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// ----- stream_speech --------------------------------------------------------
+
+::grpc::Status stream_speech(
+    ::grpc::ClientReaderInterface<::sensory::api::v1::audio::SynthesizeSpeechResponse>& reader,
+    SpeechSink& sink
+) {
+    ::sensory::api::v1::audio::SynthesizeSpeechResponse response;
+    while (reader.Read(&response)) sink.process(response);
+    sink.finish();
+    return reader.Finish();
+}
+
+}  // namespace audio
+
+}  // namespace sensory
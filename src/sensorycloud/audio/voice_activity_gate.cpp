@@ -0,0 +1,158 @@
+// A voice activity gate for suppressing silence in audio streams.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sensorycloud/audio/voice_activity_gate.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace sensory {
+
+namespace audio {
+
+/// The energy in dBFS that is reported for digital silence.
+static constexpr float SILENCE_DB = -120.f;
+/// The rate at which the noise floor rises towards the energy of non-speech.
+static constexpr float NOISE_FLOOR_RISE = 0.05f;
+
+VoiceActivityGate::VoiceActivityGate(
+    const VoiceActivityGateOptions& options_,
+    const uint32_t& num_channels_
+) :
+    options(options_),
+    num_channels(num_channels_),
+    noise_floor_db(SILENCE_DB),
+    has_noise_floor(false),
+    hangover(0),
+    num_suppressed_chunks(0),
+    num_samples_received(0),
+    num_samples_sent(0),
+    num_samples_keep_alive(0),
+    energy_db(SILENCE_DB),
+    zero_crossing_rate(0) {
+    if (num_channels == 0)
+        throw std::invalid_argument("VoiceActivityGate requires at least one channel.");
+    if (options.sample_rate == 0)
+        throw std::invalid_argument("VoiceActivityGate sample rate must be positive.");
+}
+
+void VoiceActivityGate::record_sent(const uint64_t& source_frame, const uint64_t& num_frames) {
+    if (num_frames == 0) return;
+    const uint64_t sent_frame = num_samples_sent / num_channels;
+    if (!timeline.empty() &&
+        timeline.back().source_frame + (sent_frame - timeline.back().sent_frame) == source_frame) return;
+    timeline.push_back({sent_frame, source_frame});
+}
+
+uint64_t VoiceActivityGate::to_source_frame(const uint64_t& sent_frame) const {
+    // Find the last segment that starts at or before the frame.
+    auto segment = std::upper_bound(timeline.begin(), timeline.end(), sent_frame,
+        [](const uint64_t& frame, const TimelineSegment& other) { return frame < other.sent_frame; });
+    if (segment == timeline.begin()) return sent_frame;
+    --segment;
+    return segment->source_frame + (sent_frame - segment->sent_frame);
+}
+
+uint64_t VoiceActivityGate::to_source_time(const uint64_t& time_ms) const {
+    const uint64_t sent_frame = time_ms * options.sample_rate / 1000;
+    const uint64_t source_frame = to_source_frame(sent_frame);
+    // Shift the time by the offset of its segment to keep sub-frame precision.
+    return time_ms + (source_frame - sent_frame) * 1000 / options.sample_rate;
+}
+
+VoiceActivityGate::Decision VoiceActivityGate::process(
+    const int16_t* samples,
+    const std::size_t& num_frames,
+    std::vector<int16_t>& output
+) {
+    const std::size_t num_samples = num_frames * num_channels;
+    num_samples_received += num_samples;
+    // Measure the energy and the zero-crossing rate of the chunk.
+    double energy = 0;
+    std::size_t crossings = 0;
+    for (std::size_t i = 0; i < num_samples; i++) {
+        energy += static_cast<double>(samples[i]) * samples[i];
+        if (i >= num_channels && ((samples[i] < 0) != (samples[i - num_channels] < 0))) crossings++;
+    }
+    energy_db = energy > 0 ?
+        static_cast<float>(10 * std::log10(energy / num_samples / (32768.0 * 32768.0))) :
+        SILENCE_DB;
+    zero_crossing_rate = num_samples > num_channels ?
+        static_cast<float>(crossings) / (num_samples - num_channels) : 0.f;
+    if (!has_noise_floor && num_samples > 0) {
+        noise_floor_db = energy_db;
+        has_noise_floor = true;
+    }
+    const bool is_speech = energy_db > options.threshold_db &&
+        energy_db > noise_floor_db + options.margin_db &&
+        zero_crossing_rate <= options.max_zero_crossing_rate;
+    // Track the noise floor on non-speech: fall instantly, rise slowly.
+    if (!is_speech) {
+        if (energy_db < noise_floor_db) noise_floor_db = energy_db;
+        else noise_floor_db += NOISE_FLOOR_RISE * (energy_db - noise_floor_db);
+    }
+    // The first frame of the chunk in the source.
+    const uint64_t chunk_frame = (num_samples_received - num_samples) / num_channels;
+    if (is_speech || hangover > 0) {
+        // Send the pre-roll ahead of the first chunk of an utterance. It is
+        // the audio immediately before the chunk in the source.
+        std::size_t pre_roll_frames = 0;
+        for (const auto& chunk : pre_roll) pre_roll_frames += chunk.size() / num_channels;
+        record_sent(chunk_frame - pre_roll_frames, pre_roll_frames + num_frames);
+        for (const auto& chunk : pre_roll) {
+            output.insert(output.end(), chunk.begin(), chunk.end());
+            num_samples_sent += chunk.size();
+        }
+        pre_roll.clear();
+        output.insert(output.end(), samples, samples + num_samples);
+        num_samples_sent += num_samples;
+        num_suppressed_chunks = 0;
+        if (is_speech) {
+            hangover = options.hangover_chunks;
+            return Decision::Speech;
+        }
+        hangover--;
+        return Decision::Hangover;
+    }
+    // Buffer the chunk for the pre-roll of the next utterance.
+    if (options.pre_roll_chunks > 0) {
+        if (pre_roll.size() == options.pre_roll_chunks) pre_roll.pop_front();
+        pre_roll.emplace_back(samples, samples + num_samples);
+    }
+    num_suppressed_chunks++;
+    if (options.keep_alive_chunks > 0 && num_suppressed_chunks % options.keep_alive_chunks == 0) {
+        const std::size_t keep_alive = options.keep_alive_samples * num_channels;
+        record_sent(chunk_frame + num_frames, options.keep_alive_samples);
+        output.insert(output.end(), keep_alive, 0);
+        num_samples_sent += keep_alive;
+        num_samples_keep_alive += keep_alive;
+        return Decision::KeepAlive;
+    }
+    return Decision::Silence;
+}
+
+}  // namespace audio
+
+}  // namespace sensory
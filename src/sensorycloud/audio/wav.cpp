@@ -0,0 +1,162 @@
+// Reading and writing of 16-bit PCM WAV files.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sensorycloud/audio/wav.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace sensory {
+
+namespace audio {
+
+/// The format tag of integer PCM audio.
+static constexpr uint16_t WAVE_FORMAT_PCM = 0x0001;
+/// The format tag of audio described by a sub-format GUID.
+static constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+/// @brief Decode a little-endian integer.
+///
+/// @param data The bytes of the integer.
+/// @param size The number of bytes, at most 4.
+/// @returns The decoded integer.
+///
+static inline uint32_t read_le(const char* data, const std::size_t& size) {
+    uint32_t value = 0;
+    for (std::size_t i = 0; i < size; i++)
+        value |= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+    return value;
+}
+
+/// @brief Encode a little-endian integer.
+///
+/// @param stream The stream to write the integer to.
+/// @param value The integer to encode.
+/// @param size The number of bytes, at most 4.
+///
+static inline void write_le(std::ostream& stream, const uint32_t& value, const std::size_t& size) {
+    for (std::size_t i = 0; i < size; i++)
+        stream.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+WavLayout parse_wav_layout(const char* data, const std::size_t& size, const std::string& name) {
+    if (size < 12 || std::string(data, 4) != "RIFF" || std::string(data + 8, 4) != "WAVE")
+        throw std::runtime_error("Not a RIFF/WAVE file " + name);
+    WavLayout layout;
+    bool has_format = false;
+    std::size_t offset = 12;
+    while (size - offset >= 8) {
+        const std::string id(data + offset, 4);
+        const uint32_t chunk_size = read_le(data + offset + 4, 4);
+        offset += 8;
+        const std::size_t remaining = size - offset;
+        if (id == "fmt ") {
+            if (chunk_size < 16)
+                throw std::runtime_error("Malformed fmt chunk in WAV file " + name);
+            if (chunk_size > remaining)
+                throw std::runtime_error("Truncated fmt chunk in WAV file " + name);
+            const char* format = data + offset;
+            uint16_t tag = read_le(format, 2);
+            if (tag == WAVE_FORMAT_EXTENSIBLE && chunk_size >= 26) tag = read_le(format + 24, 2);
+            layout.num_channels = read_le(format + 2, 2);
+            layout.sample_rate = read_le(format + 4, 4);
+            const uint32_t bits_per_sample = read_le(format + 14, 2);
+            if (tag != WAVE_FORMAT_PCM || bits_per_sample != 16 || layout.num_channels == 0)
+                throw std::runtime_error("Only 16-bit PCM WAV files are supported, " + name);
+            has_format = true;
+        } else if (id == "data") {
+            if (!has_format)
+                throw std::runtime_error("Missing fmt chunk before data in WAV file " + name);
+            // Clamp the size to the end of the file for truncated recordings
+            // and for streamed files that never had their sizes patched. A
+            // size of zero or of the maximal value marks a stream whose
+            // length was unknown when the header was written.
+            const bool is_unbounded = chunk_size == 0 || chunk_size == 0xFFFFFFFF;
+            const std::size_t bytes = is_unbounded ? remaining : std::min<std::size_t>(chunk_size, remaining);
+            const std::size_t frame_size = sizeof(int16_t) * layout.num_channels;
+            layout.data_offset = offset;
+            layout.data_size = bytes / frame_size * frame_size;
+            return layout;
+        }
+        // Skip the chunk and its pad byte, chunks are aligned to two bytes.
+        const std::size_t skip = static_cast<std::size_t>(chunk_size) + (chunk_size & 1);
+        if (skip >= remaining) break;
+        offset += skip;
+    }
+    throw std::runtime_error("Missing data chunk in WAV file " + name);
+}
+
+PCMAudio read_wav(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("Failed to open WAV file " + path);
+    const std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const auto layout = parse_wav_layout(bytes.data(), bytes.size(), path);
+    PCMAudio audio;
+    audio.sample_rate = layout.sample_rate;
+    audio.num_channels = layout.num_channels;
+    audio.samples.resize(layout.data_size / sizeof(int16_t));
+    const char* data = bytes.data() + layout.data_offset;
+    for (std::size_t i = 0; i < audio.samples.size(); i++)
+        audio.samples[i] = static_cast<int16_t>(read_le(data + 2 * i, 2));
+    return audio;
+}
+
+void write_wav_header(std::ostream& stream,
+    const uint32_t& sample_rate,
+    const uint32_t& num_channels,
+    const uint32_t& data_size
+) {
+    const uint32_t block_align = num_channels * sizeof(int16_t);
+    stream.write("RIFF", 4);
+    write_le(stream, WAV_HEADER_SIZE - 8 + data_size, 4);
+    stream.write("WAVEfmt ", 8);
+    write_le(stream, 16, 4);
+    write_le(stream, WAVE_FORMAT_PCM, 2);
+    write_le(stream, num_channels, 2);
+    write_le(stream, sample_rate, 4);
+    write_le(stream, sample_rate * block_align, 4);
+    write_le(stream, block_align, 2);
+    write_le(stream, 16, 2);
+    stream.write("data", 4);
+    write_le(stream, data_size, 4);
+}
+
+void write_wav(const std::string& path, const PCMAudio& audio) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("Failed to open WAV file " + path);
+    const uint32_t data_size = static_cast<uint32_t>(audio.samples.size() * sizeof(int16_t));
+    write_wav_header(file, audio.sample_rate, audio.num_channels, data_size);
+    for (const auto& sample : audio.samples)
+        write_le(file, static_cast<uint16_t>(sample), 2);
+    if (!file)
+        throw std::runtime_error("Failed to write WAV file " + path);
+}
+
+}  // namespace audio
+
+}  // namespace sensory
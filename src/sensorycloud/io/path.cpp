@@ -25,7 +25,11 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <dirent.h>
 #include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
 #include "sensorycloud/io/path.hpp"
 
 namespace sensory {
@@ -48,6 +52,37 @@ bool is_file(const char* path) {
 
 }
 
+bool is_directory(const char* path) {
+    struct stat path_stat;
+    if (stat(path, &path_stat) != 0) return false;
+    return S_ISDIR(path_stat.st_mode);
+}
+
+std::vector<std::string> list_files(const std::string& directory, const std::string& extension) {
+    DIR* handle = opendir(directory.c_str());
+    if (handle == nullptr)
+        throw std::runtime_error("Failed to open directory " + directory);
+    const auto lower = [](std::string value) {
+        std::transform(value.begin(), value.end(), value.begin(),
+            [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return value;
+    };
+    const std::string suffix = lower(extension);
+    const std::string prefix = (directory.empty() || directory.back() == '/') ? directory : directory + "/";
+    std::vector<std::string> files;
+    while (struct dirent* entry = readdir(handle)) {
+        const std::string name = entry->d_name;
+        if (name.size() < suffix.size() ||
+            lower(name.substr(name.size() - suffix.size())) != suffix)
+            continue;
+        const std::string path = prefix + name;
+        if (is_file(path.c_str())) files.push_back(path);
+    }
+    closedir(handle);
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
 }  // namespace path
 
 }  // namespace io
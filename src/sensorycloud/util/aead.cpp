@@ -0,0 +1,113 @@
+// Authenticated encryption for the SensoryCloud C++ SDK.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include "sensorycloud/util/aead.hpp"
+
+namespace sensory {
+
+namespace util {
+
+/// @brief A smart pointer that frees an OpenSSL cipher context.
+typedef std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)> CipherContext;
+
+/// @brief Return the bytes of a string as the unsigned buffer OpenSSL expects.
+static inline const uint8_t* bytes(const std::string& buffer) {
+    return reinterpret_cast<const uint8_t*>(buffer.data());
+}
+
+std::string aead_generate_key() {
+    std::string key(AEAD_KEY_SIZE, '\0');
+    if (RAND_bytes(reinterpret_cast<uint8_t*>(&key[0]), key.size()) != 1)
+        throw std::runtime_error("Failed to generate an encryption key");
+    return key;
+}
+
+std::string aead_seal(
+    const std::string& key,
+    const std::string& plaintext,
+    const std::string& associated_data
+) {
+    if (key.size() != AEAD_KEY_SIZE)
+        throw std::invalid_argument("AES-256-GCM requires a 32 byte key");
+    // The output is laid out as nonce | ciphertext | tag. GCM is a stream
+    // mode, so the ciphertext is exactly as long as the plaintext.
+    std::string sealed(AEAD_NONCE_SIZE + plaintext.size() + AEAD_TAG_SIZE, '\0');
+    auto nonce = reinterpret_cast<uint8_t*>(&sealed[0]);
+    auto ciphertext = nonce + AEAD_NONCE_SIZE;
+    auto tag = ciphertext + plaintext.size();
+    if (RAND_bytes(nonce, AEAD_NONCE_SIZE) != 1)
+        throw std::runtime_error("Failed to generate an encryption nonce");
+    CipherContext context(EVP_CIPHER_CTX_new(), EVP_CIPHER_CTX_free);
+    int length = 0;
+    if (context == nullptr ||
+        EVP_EncryptInit_ex(context.get(), EVP_aes_256_gcm(), nullptr, bytes(key), nonce) != 1 ||
+        EVP_EncryptUpdate(context.get(), nullptr, &length, bytes(associated_data), associated_data.size()) != 1 ||
+        EVP_EncryptUpdate(context.get(), ciphertext, &length, bytes(plaintext), plaintext.size()) != 1 ||
+        EVP_EncryptFinal_ex(context.get(), ciphertext + length, &length) != 1 ||
+        EVP_CIPHER_CTX_ctrl(context.get(), EVP_CTRL_GCM_GET_TAG, AEAD_TAG_SIZE, tag) != 1)
+        throw std::runtime_error("Failed to encrypt message with AES-256-GCM");
+    return sealed;
+}
+
+bool aead_open(
+    const std::string& key,
+    const std::string& sealed,
+    const std::string& associated_data,
+    std::string& plaintext
+) {
+    if (key.size() != AEAD_KEY_SIZE)
+        throw std::invalid_argument("AES-256-GCM requires a 32 byte key");
+    if (sealed.size() < AEAD_NONCE_SIZE + AEAD_TAG_SIZE) return false;
+    const auto nonce = bytes(sealed);
+    const auto ciphertext = nonce + AEAD_NONCE_SIZE;
+    const auto ciphertext_size = sealed.size() - AEAD_NONCE_SIZE - AEAD_TAG_SIZE;
+    // OpenSSL takes the expected tag through a non-const pointer.
+    uint8_t tag[AEAD_TAG_SIZE];
+    std::copy(ciphertext + ciphertext_size, ciphertext + ciphertext_size + AEAD_TAG_SIZE, tag);
+    // Decrypt into a local buffer so the output is untouched on failure.
+    std::string buffer(ciphertext_size, '\0');
+    auto output = reinterpret_cast<uint8_t*>(&buffer[0]);
+    CipherContext context(EVP_CIPHER_CTX_new(), EVP_CIPHER_CTX_free);
+    int length = 0;
+    if (context == nullptr ||
+        EVP_DecryptInit_ex(context.get(), EVP_aes_256_gcm(), nullptr, bytes(key), nonce) != 1 ||
+        EVP_DecryptUpdate(context.get(), nullptr, &length, bytes(associated_data), associated_data.size()) != 1 ||
+        EVP_DecryptUpdate(context.get(), output, &length, ciphertext, ciphertext_size) != 1 ||
+        EVP_CIPHER_CTX_ctrl(context.get(), EVP_CTRL_GCM_SET_TAG, AEAD_TAG_SIZE, tag) != 1 ||
+        EVP_DecryptFinal_ex(context.get(), output + length, &length) != 1)
+        return false;
+    plaintext = std::move(buffer);
+    return true;
+}
+
+}  // namespace util
+
+}  // namespace sensory
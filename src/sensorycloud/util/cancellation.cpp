@@ -0,0 +1,102 @@
+// Cooperative cancellation of asynchronous calls and streams.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sensorycloud/util/cancellation.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace sensory {
+
+namespace util {
+
+void CancellationState::prune() {
+    for (auto iter = entries.begin(); iter != entries.end();) {
+        if (iter->second.isAlive && !iter->second.isAlive())
+            iter = entries.erase(iter);
+        else
+            ++iter;
+    }
+    // Grow the threshold with the live entries to keep pruning amortized.
+    pruneThreshold = std::max<std::size_t>(64, 2 * entries.size());
+}
+
+bool CancellationState::is_cancelled() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return isCancelled;
+}
+
+void CancellationState::cancel() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (isCancelled) return;
+    isCancelled = true;
+    // Run the callbacks one at a time without holding the lock so that they
+    // may register or remove callbacks. `remove` waits on a running callback.
+    while (!entries.empty()) {
+        auto callback = std::move(entries.begin()->second.callback);
+        runningID = entries.begin()->first;
+        runningThread = std::this_thread::get_id();
+        entries.erase(entries.begin());
+        lock.unlock();
+        callback();
+        lock.lock();
+        runningID = 0;
+        callbackFinished.notify_all();
+    }
+}
+
+std::size_t CancellationState::add(std::function<void()> callback, std::function<bool()> isAlive) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!isCancelled) {
+            if (entries.size() >= pruneThreshold) prune();
+            const auto id = nextID++;
+            Entry entry;
+            entry.callback = std::move(callback);
+            entry.isAlive = std::move(isAlive);
+            entries.insert(std::make_pair(id, std::move(entry)));
+            return id;
+        }
+    }
+    callback();
+    return 0;
+}
+
+void CancellationState::remove(const std::size_t& id) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (entries.erase(id) > 0) return;
+    // A callback may not wait on itself, e.g., when it removes its own
+    // registration.
+    if (runningID == id && runningThread == std::this_thread::get_id()) return;
+    callbackFinished.wait(lock, [this, &id] { return runningID != id; });
+}
+
+std::size_t CancellationState::size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+}  // namespace util
+
+}  // namespace sensory
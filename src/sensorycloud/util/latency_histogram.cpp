@@ -0,0 +1,164 @@
+// A concurrent latency histogram for the SensoryCloud C++ SDK.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "sensorycloud/util/latency_histogram.hpp"
+
+namespace sensory {
+
+namespace util {
+
+constexpr std::size_t LatencyHistogram::SUB_BUCKETS;
+constexpr std::size_t LatencyHistogram::NUM_BUCKETS;
+
+/// @brief Lower an atomic to a value if the value is less.
+static inline void store_min(std::atomic<uint64_t>& target, const uint64_t& value) {
+    auto current = target.load(std::memory_order_relaxed);
+    while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) { }
+}
+
+/// @brief Raise an atomic to a value if the value is greater.
+static inline void store_max(std::atomic<uint64_t>& target, const uint64_t& value) {
+    auto current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) { }
+}
+
+std::size_t LatencyHistogram::get_bucket(const uint64_t& value) {
+    // Latencies below the number of sub-buckets have a bucket each.
+    if (value < SUB_BUCKETS) return static_cast<std::size_t>(value);
+    // Otherwise, the power of two selects a group of buckets and the four
+    // bits after the leading one select the bucket in the group.
+    std::size_t exponent = 4;
+    while (exponent < 63 && (value >> (exponent + 1)) != 0) exponent++;
+    const auto sub_bucket = static_cast<std::size_t>(value >> (exponent - 4)) & (SUB_BUCKETS - 1);
+    return std::min((exponent - 3) * SUB_BUCKETS + sub_bucket, NUM_BUCKETS - 1);
+}
+
+uint64_t LatencyHistogram::get_bucket_start(const std::size_t& bucket) {
+    if (bucket < SUB_BUCKETS) return bucket;
+    const auto exponent = bucket / SUB_BUCKETS + 3;
+    return static_cast<uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << (exponent - 4);
+}
+
+uint64_t LatencyHistogram::get_bucket_width(const std::size_t& bucket) {
+    if (bucket < SUB_BUCKETS) return 1;
+    return uint64_t(1) << (bucket / SUB_BUCKETS - 1);
+}
+
+LatencyHistogram::LatencyHistogram() : count(0), sum(0), min(std::numeric_limits<uint64_t>::max()), max(0) {
+    for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::record(const uint64_t& value, const uint64_t& num_values) {
+    buckets[get_bucket(value)].fetch_add(num_values, std::memory_order_relaxed);
+    sum.fetch_add(value * num_values, std::memory_order_relaxed);
+    store_min(min, value);
+    store_max(max, value);
+    // The count is incremented last so that a reader that sees it also sees
+    // the bucket it counts.
+    count.fetch_add(num_values, std::memory_order_release);
+}
+
+void LatencyHistogram::record(const std::chrono::microseconds& latency) {
+    record(static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0)), 1);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.get_count() == 0) return;
+    for (std::size_t bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+        const auto num_values = other.buckets[bucket].load(std::memory_order_relaxed);
+        if (num_values > 0) buckets[bucket].fetch_add(num_values, std::memory_order_relaxed);
+    }
+    sum.fetch_add(other.sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    store_min(min, other.min.load(std::memory_order_relaxed));
+    store_max(max, other.max.load(std::memory_order_relaxed));
+    count.fetch_add(other.count.load(std::memory_order_relaxed), std::memory_order_release);
+}
+
+void LatencyHistogram::reset() {
+    count.store(0, std::memory_order_relaxed);
+    for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+std::chrono::microseconds LatencyHistogram::get_min() const {
+    if (get_count() == 0) return std::chrono::microseconds(0);
+    return std::chrono::microseconds(min.load(std::memory_order_relaxed));
+}
+
+std::chrono::microseconds LatencyHistogram::get_max() const {
+    if (get_count() == 0) return std::chrono::microseconds(0);
+    return std::chrono::microseconds(max.load(std::memory_order_relaxed));
+}
+
+std::chrono::microseconds LatencyHistogram::get_mean() const {
+    const auto num_values = get_count();
+    if (num_values == 0) return std::chrono::microseconds(0);
+    return std::chrono::microseconds(sum.load(std::memory_order_relaxed) / num_values);
+}
+
+std::chrono::microseconds LatencyHistogram::get_percentile(const double& percentile) const {
+    // Sum the buckets rather than trusting the count, which may lag behind
+    // the buckets while latencies are being recorded.
+    uint64_t total = 0;
+    for (const auto& bucket : buckets) total += bucket.load(std::memory_order_relaxed);
+    if (total == 0) return std::chrono::microseconds(0);
+    // Find the bucket of the value with the rank of the percentile.
+    const auto fraction = std::min(std::max(percentile, 0.0), 100.0) / 100.0;
+    const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * total)));
+    const auto low = min.load(std::memory_order_relaxed);
+    const auto high = max.load(std::memory_order_relaxed);
+    // The least and greatest latencies are known exactly.
+    if (rank == 1 && low <= high) return std::chrono::microseconds(low);
+    if (rank >= total) return std::chrono::microseconds(high);
+    uint64_t seen = 0;
+    std::size_t bucket = 0;
+    for (; bucket < NUM_BUCKETS - 1; bucket++) {
+        seen += buckets[bucket].load(std::memory_order_relaxed);
+        if (seen >= rank) break;
+    }
+    // Report the middle of the bucket, clamped to the observed range.
+    const auto value = get_bucket_start(bucket) + get_bucket_width(bucket) / 2;
+    return std::chrono::microseconds(std::max(std::min(value, high), std::min(low, high)));
+}
+
+LatencySummary LatencyHistogram::get_summary() const {
+    LatencySummary summary;
+    summary.count = get_count();
+    summary.mean = get_mean();
+    summary.p50 = get_percentile(50);
+    summary.p95 = get_percentile(95);
+    summary.p99 = get_percentile(99);
+    summary.max = get_max();
+    return summary;
+}
+
+}  // namespace util
+
+}  // namespace sensory
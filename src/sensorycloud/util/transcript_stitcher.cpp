@@ -0,0 +1,71 @@
+// A structure for stitching the transcripts of consecutive streams.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sensorycloud/util/transcript_stitcher.hpp"
+#include <stdexcept>
+
+namespace sensory {
+
+namespace util {
+
+constexpr uint64_t TranscriptStitcher::END_OF_SESSION;
+
+std::size_t TranscriptStitcher::commit(const std::vector<::sensory::api::v1::audio::TranscribeWord>& words,
+    const uint64_t& offset_ms,
+    const uint64_t& segment_cut_ms
+) {
+    if (segment_cut_ms < cut_ms)
+        throw std::invalid_argument(
+            "Segment cut at " + std::to_string(segment_cut_ms) +
+            "ms precedes the previous cut at " + std::to_string(cut_ms) + "ms"
+        );
+    const auto size = word_list.size();
+    for (const auto& word : words) {
+        // Assign the word to the segment that contains its midpoint.
+        const auto midpoint = offset_ms + (word.begintimems() + word.endtimems()) / 2;
+        if (midpoint < cut_ms || midpoint >= segment_cut_ms) continue;
+        word_list.push_back(word);
+        auto& stitched = word_list.back();
+        stitched.set_begintimems(offset_ms + word.begintimems());
+        stitched.set_endtimems(offset_ms + word.endtimems());
+        stitched.set_wordindex(word_list.size() - 1);
+    }
+    cut_ms = segment_cut_ms;
+    num_segments++;
+    return word_list.size() - size;
+}
+
+std::string TranscriptStitcher::get_transcript(const std::string& delimiter) const {
+    std::string transcript;
+    for (const auto& word : word_list) {
+        if (!transcript.empty()) transcript += delimiter;
+        transcript += word.word();
+    }
+    return transcript;
+}
+
+}  // namespace util
+
+}  // namespace sensory
@@ -0,0 +1,160 @@
+// Test cases for the AdaptiveChunkSizer structure.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "sensorycloud/audio/adaptive_chunk_sizer.hpp"
+
+using ::sensory::audio::AdaptiveChunkOptions;
+using ::sensory::audio::AdaptiveChunkSizer;
+
+/// @brief Record a number of writes with a fixed latency and backlog.
+///
+/// @param sizer The sizer to record the writes with.
+/// @param count The number of writes to record.
+/// @param latency The latency of each write.
+/// @param backlog The number of chunks waiting behind each write.
+///
+void record_writes(AdaptiveChunkSizer& sizer,
+    const std::size_t& count,
+    const std::chrono::microseconds& latency,
+    const std::size_t& backlog = 0
+) {
+    for (std::size_t i = 0; i < count; i++) sizer.record_write(latency, backlog);
+}
+
+SCENARIO("A user wants to adapt the chunk size of an audio stream") {
+    GIVEN("a sizer with the default options") {
+        AdaptiveChunkSizer sizer;
+        THEN("the first chunk has the initial duration") {
+            REQUIRE(4000 == sizer.get_chunk_size());
+            REQUIRE(0 == sizer.get_num_writes());
+        }
+        WHEN("writes complete quickly without a backlog") {
+            REQUIRE(4000 == sizer.record_write(std::chrono::milliseconds(1)));
+            record_writes(sizer, 200, std::chrono::milliseconds(1));
+            THEN("chunks shrink to the minimal duration") {
+                REQUIRE(800 == sizer.get_chunk_size());
+                REQUIRE(0 < sizer.get_num_shrinks());
+                REQUIRE(0 == sizer.get_num_grows());
+            }
+            THEN("chunk sizes are multiples of the step duration") {
+                for (const auto& entry : sizer.get_size_histogram())
+                    REQUIRE(0 == entry.first % 160);
+            }
+        }
+        WHEN("writes take nearly as long as the audio in the chunk") {
+            record_writes(sizer, 20, std::chrono::milliseconds(240));
+            THEN("chunks grow to the maximal duration") {
+                REQUIRE(8000 == sizer.get_chunk_size());
+                REQUIRE(1 == sizer.get_num_grows());
+            }
+        }
+        WHEN("writes are fast but chunks are waiting behind them") {
+            record_writes(sizer, 4, std::chrono::milliseconds(1), 3);
+            THEN("chunks grow") {
+                REQUIRE(8000 == sizer.get_chunk_size());
+            }
+        }
+        WHEN("the link keeps up with moderate latency") {
+            record_writes(sizer, 50, std::chrono::milliseconds(125));
+            THEN("the chunk size is stable") {
+                REQUIRE(4000 == sizer.get_chunk_size());
+                REQUIRE(0 == sizer.get_num_grows());
+                REQUIRE(0 == sizer.get_num_shrinks());
+            }
+        }
+        WHEN("a number of writes are recorded") {
+            record_writes(sizer, 37, std::chrono::milliseconds(1));
+            THEN("the histogram of chosen sizes accounts for every write") {
+                uint64_t total = 0;
+                for (const auto& entry : sizer.get_size_histogram()) total += entry.second;
+                REQUIRE(37 == total);
+                REQUIRE(37 == sizer.get_num_writes());
+                REQUIRE(std::chrono::microseconds(1000) == sizer.get_smoothed_latency());
+            }
+        }
+    }
+    GIVEN("a sizer with a resize callback") {
+        AdaptiveChunkOptions options;
+        options.cooldown_writes = 1;
+        AdaptiveChunkSizer sizer(options);
+        std::vector<std::pair<std::size_t, std::size_t>> resizes;
+        sizer.set_resize_callback([&](const std::size_t& old_size, const std::size_t& new_size) {
+            REQUIRE(new_size == sizer.get_chunk_size());
+            resizes.push_back({old_size, new_size});
+        });
+        WHEN("the chunk size changes") {
+            sizer.record_write(std::chrono::milliseconds(1));
+            sizer.record_write(std::chrono::milliseconds(300), 2);
+            THEN("the callback is fired with the old and new sizes") {
+                REQUIRE(2 == resizes.size());
+                REQUIRE(std::make_pair<std::size_t, std::size_t>(4000, 3040) == resizes[0]);
+                REQUIRE(std::make_pair<std::size_t, std::size_t>(3040, 6080) == resizes[1]);
+            }
+        }
+    }
+    GIVEN("a link with a fixed overhead per message and limited bandwidth") {
+        AdaptiveChunkOptions options;
+        AdaptiveChunkSizer sizer(options);
+        WHEN("writes are simulated on the link") {
+            // 30ms per message plus 10ms per second of audio.
+            for (int i = 0; i < 500; i++) {
+                const auto size = sizer.get_chunk_size();
+                sizer.record_write(std::chrono::microseconds(30000 + 10000 * size / 16000));
+            }
+            THEN("the chunk size settles where the overhead is amortized") {
+                const auto duration_ms = 1000 * sizer.get_chunk_size() / 16000;
+                const auto latency_ms = 30 + 10 * duration_ms / 1000;
+                REQUIRE(latency_ms <= 0.75 * duration_ms);
+                REQUIRE(sizer.get_chunk_size() < 4000);
+            }
+        }
+    }
+    GIVEN("invalid options") {
+        THEN("errors are thrown") {
+            AdaptiveChunkOptions options;
+            options.sample_rate = 0;
+            REQUIRE_THROWS_AS(AdaptiveChunkSizer(options), std::invalid_argument);
+            options = AdaptiveChunkOptions();
+            options.initial_chunk_duration = std::chrono::milliseconds(1000);
+            REQUIRE_THROWS_AS(AdaptiveChunkSizer(options), std::invalid_argument);
+            options = AdaptiveChunkOptions();
+            options.shrink_threshold = 0.9f;
+            REQUIRE_THROWS_AS(AdaptiveChunkSizer(options), std::invalid_argument);
+            options = AdaptiveChunkOptions();
+            options.grow_factor = 1.f;
+            REQUIRE_THROWS_AS(AdaptiveChunkSizer(options), std::invalid_argument);
+            options = AdaptiveChunkOptions();
+            options.smoothing = 0.f;
+            REQUIRE_THROWS_AS(AdaptiveChunkSizer(options), std::invalid_argument);
+        }
+    }
+}
@@ -0,0 +1,141 @@
+// Test cases for the AudioEncoder structure.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "sensorycloud/audio/audio_encoder.hpp"
+#include "sensorycloud/audio/mulaw.hpp"
+
+using ::sensory::audio::AudioEncoder;
+using ::sensory::audio::FLACEncoder;
+using ::sensory::audio::mulaw_encode;
+using ::sensory::api::v1::audio::AudioConfig;
+using ::sensory::api::v1::audio::AudioConfig_AudioEncoding_LINEAR16;
+using ::sensory::api::v1::audio::AudioConfig_AudioEncoding_FLAC;
+using ::sensory::api::v1::audio::AudioConfig_AudioEncoding_MULAW;
+
+SCENARIO("a user wants to encode LINEAR16 audio with an AudioEncoder") {
+    GIVEN("an audio config with a non-default encoding") {
+        AudioConfig config;
+        config.set_encoding(AudioConfig_AudioEncoding_FLAC);
+        config.set_sampleratehertz(16000);
+        config.set_audiochannelcount(1);
+        WHEN("a LINEAR16 encoder is initialized") {
+            AudioEncoder encoder(&config);
+            THEN("the encoding of the config is updated") {
+                REQUIRE(AudioConfig_AudioEncoding_LINEAR16 == encoder.get_encoding());
+                REQUIRE(AudioConfig_AudioEncoding_LINEAR16 == config.encoding());
+            }
+            THEN("samples are encoded as little-endian bytes") {
+                const std::vector<int16_t> samples = {1, -2, 0x1234};
+                REQUIRE(std::string("\x01\x00\xFE\xFF\x34\x12", 6) == encoder.encode(samples.data(), 3));
+            }
+        }
+    }
+}
+
+SCENARIO("a user wants to encode FLAC audio with an AudioEncoder") {
+    GIVEN("an audio config for 16kHz mono audio") {
+        AudioConfig config;
+        config.set_sampleratehertz(16000);
+        config.set_audiochannelcount(1);
+        WHEN("a FLAC encoder is initialized") {
+            AudioEncoder encoder(&config, AudioConfig_AudioEncoding_FLAC);
+            THEN("the encoding of the config is updated") {
+                REQUIRE(AudioConfig_AudioEncoding_FLAC == encoder.get_encoding());
+                REQUIRE(AudioConfig_AudioEncoding_FLAC == config.encoding());
+            }
+            THEN("the chunks are FLAC frames that continue the stream") {
+                const std::vector<int16_t> samples(320, 7);
+                FLACEncoder reference(16000, 1);
+                std::string expected;
+                reference.encode(samples.data(), 160, expected);
+                const auto first = expected;
+                reference.encode(samples.data() + 160, 160, expected);
+                REQUIRE(first == encoder.encode(samples.data(), 160));
+                REQUIRE(expected.substr(first.size()) == encoder.encode(samples.data() + 160, 160));
+            }
+        }
+    }
+    GIVEN("an audio config without a sample rate") {
+        AudioConfig config;
+        config.set_audiochannelcount(1);
+        THEN("an invalid argument is thrown") {
+            REQUIRE_THROWS_AS(AudioEncoder(&config, AudioConfig_AudioEncoding_FLAC), std::invalid_argument);
+        }
+    }
+}
+
+SCENARIO("a user wants to encode MULAW audio with an AudioEncoder") {
+    GIVEN("an audio config for 8kHz stereo audio") {
+        AudioConfig config;
+        config.set_sampleratehertz(8000);
+        config.set_audiochannelcount(2);
+        WHEN("a MULAW encoder is initialized") {
+            AudioEncoder encoder(&config, AudioConfig_AudioEncoding_MULAW);
+            THEN("the encoding of the config is updated") {
+                REQUIRE(AudioConfig_AudioEncoding_MULAW == encoder.get_encoding());
+                REQUIRE(AudioConfig_AudioEncoding_MULAW == config.encoding());
+            }
+            THEN("every sample of every channel is encoded to one byte") {
+                const std::vector<int16_t> samples = {0, -1, 1000, -1000, 32767, -32768};
+                std::string output = "prefix";
+                encoder.encode(samples.data(), 3, output);
+                REQUIRE(6 + 6 == output.size());
+                for (std::size_t i = 0; i < samples.size(); i++)
+                    REQUIRE(mulaw_encode(samples[i]) == static_cast<uint8_t>(output[6 + i]));
+            }
+        }
+    }
+}
+
+SCENARIO("a user wants to initialize an AudioEncoder with invalid arguments") {
+    GIVEN("a null audio config") {
+        THEN("an invalid argument is thrown") {
+            REQUIRE_THROWS_AS(AudioEncoder(nullptr), std::invalid_argument);
+        }
+    }
+    GIVEN("an audio config without a channel count") {
+        AudioConfig config;
+        config.set_sampleratehertz(16000);
+        THEN("an invalid argument is thrown") {
+            REQUIRE_THROWS_AS(AudioEncoder(&config), std::invalid_argument);
+        }
+    }
+    GIVEN("an unsupported encoding") {
+        AudioConfig config;
+        config.set_sampleratehertz(16000);
+        config.set_audiochannelcount(1);
+        THEN("an invalid argument is thrown and the config is unchanged") {
+            const auto encoding = static_cast<::sensory::api::v1::audio::AudioConfig_AudioEncoding>(42);
+            REQUIRE_THROWS_AS(AudioEncoder(&config, encoding), std::invalid_argument);
+            REQUIRE(AudioConfig_AudioEncoding_LINEAR16 == config.encoding());
+        }
+    }
+}
@@ -0,0 +1,108 @@
+// Test cases for the AudioPacer.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include "sensorycloud/audio/audio_pacer.hpp"
+
+using ::sensory::audio::AudioPacer;
+
+/// @brief Return the time since a start time.
+///
+/// @param start The start time.
+/// @returns The number of milliseconds since the start time.
+///
+inline long elapsed_ms(const AudioPacer::Clock::time_point& start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(AudioPacer::Clock::now() - start).count();
+}
+
+SCENARIO("A user wants to stream recorded audio at a multiple of real time") {
+    GIVEN("a pacer at ten times real time") {
+        // Each chunk of 1600 frames at 16kHz is 100ms, or 10ms at 10x.
+        AudioPacer pacer(16000, 10.0);
+        REQUIRE(16000 == pacer.get_sample_rate());
+        REQUIRE(10.0 == pacer.get_speed());
+        WHEN("chunks are paced") {
+            const auto start = AudioPacer::Clock::now();
+            for (int i = 0; i < 10; i++)
+                REQUIRE(AudioPacer::Clock::duration::zero() == pacer.pace(1600));
+            THEN("each chunk is released when it would have been captured") {
+                REQUIRE(100 <= elapsed_ms(start));
+                REQUIRE(250 > elapsed_ms(start));
+                REQUIRE(10 == pacer.get_num_chunks());
+                REQUIRE(16000 == pacer.get_num_frames());
+                REQUIRE(0 == pacer.get_num_late_chunks());
+            }
+        }
+        WHEN("time is spent between chunks") {
+            const auto start = AudioPacer::Clock::now();
+            for (int i = 0; i < 10; i++) {
+                pacer.pace(1600);
+                std::this_thread::sleep_for(std::chrono::milliseconds(4));
+            }
+            THEN("the time is absorbed by the schedule instead of drifting") {
+                // Without drift correction this takes 10 * (10 + 4) = 140ms.
+                REQUIRE(100 <= elapsed_ms(start));
+                REQUIRE(135 > elapsed_ms(start));
+            }
+        }
+    }
+    GIVEN("a pacer with a maximal lag of 20ms") {
+        AudioPacer pacer(16000, 1.0, std::chrono::milliseconds(20));
+        WHEN("a chunk is released far behind schedule") {
+            pacer.pace(16);
+            std::this_thread::sleep_for(std::chrono::milliseconds(60));
+            const auto lateness = pacer.pace(16);
+            THEN("the lateness is reported and the schedule restarts") {
+                REQUIRE(std::chrono::milliseconds(40) <= lateness);
+                REQUIRE(1 == pacer.get_num_late_chunks());
+                REQUIRE(1 == pacer.get_num_rebases());
+                REQUIRE(lateness == pacer.get_max_lateness());
+                const auto deadline = pacer.get_deadline(160);
+                REQUIRE(AudioPacer::Clock::now() + std::chrono::milliseconds(5) < deadline);
+            }
+        }
+    }
+    GIVEN("a pacer with a speed of zero") {
+        AudioPacer pacer(16000, 0.0);
+        WHEN("chunks are paced") {
+            const auto start = AudioPacer::Clock::now();
+            for (int i = 0; i < 10; i++) pacer.pace(16000);
+            THEN("the chunks are released without waiting") {
+                REQUIRE(50 > elapsed_ms(start));
+                REQUIRE(10 == pacer.get_num_chunks());
+            }
+        }
+    }
+    GIVEN("an invalid sample rate or speed") {
+        THEN("an error is thrown") {
+            REQUIRE_THROWS_AS(AudioPacer(0, 1.0), std::invalid_argument);
+            REQUIRE_THROWS_AS(AudioPacer(16000, -1.0), std::invalid_argument);
+        }
+    }
+}
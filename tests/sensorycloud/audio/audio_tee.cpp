@@ -0,0 +1,188 @@
+// Test cases for the AudioTee and TeeSubscriber.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sensorycloud/generated/v1/audio/audio.pb.h"
+#include "sensorycloud/audio/audio_tee.hpp"
+
+using ::sensory::audio::AudioChunk;
+using ::sensory::audio::AudioTee;
+using ::sensory::audio::TeeOverflowPolicy;
+using ::sensory::audio::TeeSubscriber;
+using ::sensory::api::v1::audio::ValidateEventRequest;
+using ::sensory::calldata::AudioChunkRequest;
+
+/// @brief Publish a chunk that holds a single sample.
+///
+/// @param tee The tee to publish to.
+/// @param value The value of the sample.
+///
+void publish(AudioTee& tee, const int16_t& value) { tee.publish(&value, 1); }
+
+/// @brief Read the value of the sample in the next chunk of a subscriber.
+///
+/// @param subscriber The subscriber to read from.
+/// @returns The value of the sample, or -1 if no chunk was read.
+///
+int read(TeeSubscriber& subscriber) {
+    AudioChunk chunk;
+    if (!subscriber.read(chunk, std::chrono::milliseconds(0))) return -1;
+    return *reinterpret_cast<const int16_t*>(chunk->data());
+}
+
+SCENARIO("A user wants to feed one capture to several streams") {
+    GIVEN("a tee with two subscribers") {
+        AudioTee tee;
+        auto first = tee.subscribe(4);
+        auto second = tee.subscribe(4);
+        REQUIRE(2 == tee.get_num_subscribers());
+        WHEN("a chunk is published") {
+            const std::vector<int16_t> samples = {1, 2, 3};
+            const auto chunk = tee.publish(samples.data(), samples.size());
+            THEN("both subscribers read the same immutable chunk") {
+                AudioChunk a, b;
+                REQUIRE(first->read(a, std::chrono::milliseconds(0)));
+                REQUIRE(second->read(b, std::chrono::milliseconds(0)));
+                REQUIRE(chunk.get() == a.get());
+                REQUIRE(chunk.get() == b.get());
+                REQUIRE(6 == chunk->size());
+            }
+            THEN("the chunk is released once every subscriber has read it") {
+                REQUIRE(1 == tee.get_num_retained_chunks());
+                REQUIRE(1 == read(*first));
+                REQUIRE(1 == tee.get_num_retained_chunks());
+                REQUIRE(1 == read(*second));
+                REQUIRE(0 == tee.get_num_retained_chunks());
+                REQUIRE(1 == tee.get_num_published_chunks());
+            }
+            THEN("the chunk can be set as the audio of a request") {
+                ValidateEventRequest request;
+                REQUIRE(first->read(request, std::chrono::milliseconds(0)));
+                REQUIRE(*chunk == request.audiocontent());
+            }
+            THEN("both subscribers set the shared chunk as the audio of chunk requests") {
+                AudioChunkRequest<ValidateEventRequest> a, b;
+                REQUIRE(first->read(a, std::chrono::milliseconds(0)));
+                REQUIRE(second->read(b, std::chrono::milliseconds(0)));
+                REQUIRE(reinterpret_cast<const uint8_t*>(chunk->data()) == a.get_audio_content().begin());
+                REQUIRE(reinterpret_cast<const uint8_t*>(chunk->data()) == b.get_audio_content().begin());
+            }
+        }
+        WHEN("a subscriber is destroyed") {
+            publish(tee, 1);
+            second.reset();
+            THEN("its unread chunks are released") {
+                REQUIRE(1 == tee.get_num_subscribers());
+                REQUIRE(1 == read(*first));
+                REQUIRE(0 == tee.get_num_retained_chunks());
+            }
+        }
+        WHEN("the tee is closed") {
+            publish(tee, 1);
+            tee.close();
+            THEN("subscribers read the remaining chunks and then stop") {
+                REQUIRE(1 == read(*first));
+                AudioChunk chunk;
+                REQUIRE_FALSE(first->read(chunk, std::chrono::milliseconds(1000)));
+                REQUIRE_THROWS_AS(publish(tee, 2), std::runtime_error);
+            }
+        }
+    }
+    GIVEN("a subscriber that subscribes late") {
+        AudioTee tee;
+        auto early = tee.subscribe(8);
+        publish(tee, 1);
+        auto late = tee.subscribe(8);
+        publish(tee, 2);
+        THEN("it reads from the next published chunk") {
+            REQUIRE(2 == read(*late));
+            REQUIRE(1 == read(*early));
+        }
+    }
+    GIVEN("a maximal lag of zero") {
+        AudioTee tee;
+        THEN("an error is thrown") {
+            REQUIRE_THROWS_AS(tee.subscribe(0), std::invalid_argument);
+        }
+    }
+}
+
+SCENARIO("A user wants slow streams to not stall the others") {
+    GIVEN("a fast subscriber and two slow subscribers") {
+        AudioTee tee;
+        auto fast = tee.subscribe(2);
+        auto dropping = tee.subscribe(2, TeeOverflowPolicy::DropOldest);
+        auto disconnecting = tee.subscribe(2, TeeOverflowPolicy::Disconnect);
+        WHEN("more chunks are published than the slow subscribers can hold") {
+            for (int16_t i = 0; i < 5; i++) {
+                publish(tee, i);
+                REQUIRE(i == read(*fast));
+            }
+            THEN("the dropping subscriber skips to the newest chunks") {
+                REQUIRE(3 == dropping->get_num_dropped_chunks());
+                REQUIRE(2 == dropping->get_lag());
+                REQUIRE(3 == read(*dropping));
+                REQUIRE(4 == read(*dropping));
+            }
+            THEN("the disconnecting subscriber stops and is flagged") {
+                REQUIRE(disconnecting->is_overrun());
+                REQUIRE(-1 == read(*disconnecting));
+            }
+            THEN("only the chunks the dropping subscriber needs are retained") {
+                REQUIRE(2 == tee.get_num_retained_chunks());
+                REQUIRE(5 == fast->get_num_chunks_read());
+            }
+        }
+    }
+    GIVEN("a publisher and concurrent subscribers") {
+        AudioTee tee;
+        auto lossless = tee.subscribe(1024);
+        auto stalled = tee.subscribe(4, TeeOverflowPolicy::DropOldest);
+        WHEN("chunks are published while one subscriber reads and one stalls") {
+            std::vector<int> values;
+            std::thread reader([&]() {
+                AudioChunk chunk;
+                while (lossless->read(chunk, std::chrono::milliseconds(1000)))
+                    values.push_back(*reinterpret_cast<const int16_t*>(chunk->data()));
+            });
+            for (int16_t i = 0; i < 500; i++) publish(tee, i);
+            tee.close();
+            reader.join();
+            THEN("the reading subscriber receives every chunk in order") {
+                REQUIRE(500 == values.size());
+                for (int i = 0; i < 500; i++) REQUIRE(i == values[i]);
+                REQUIRE(496 == stalled->get_num_dropped_chunks());
+                REQUIRE(4 == tee.get_num_retained_chunks());
+            }
+        }
+    }
+}
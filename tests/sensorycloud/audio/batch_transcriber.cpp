@@ -0,0 +1,234 @@
+// Test cases for the BatchTranscriber engine.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "sensorycloud/audio/batch_transcriber.hpp"
+#include "mock_transcribe_service.hpp"
+
+using ::sensory::audio::BatchTranscribeOptions;
+using ::sensory::audio::BatchTranscribeResult;
+using ::sensory::audio::BatchTranscriber;
+using ::sensory::audio::PCMAudio;
+using ::sensory::audio::find_batch_inputs;
+using ::sensory::audio::is_retryable;
+using ::sensory::audio::to_jsonl;
+
+/// @brief Decode a synthetic file named by its ID and number of samples.
+///
+/// @param path A path of the form `<id>_<samples>.wav`, or `bad.wav`.
+/// @returns Mono audio at 16kHz whose samples are all equal to the ID, which
+/// the mock service transcribes as one word named after the ID.
+///
+PCMAudio decode_synthetic(const std::string& path) {
+    if (path == "bad.wav") throw std::runtime_error("corrupt file");
+    const auto separator = path.find('_');
+    PCMAudio audio;
+    audio.sample_rate = SAMPLE_RATE;
+    audio.num_channels = 1;
+    audio.samples.assign(std::stoul(path.substr(separator + 1)), static_cast<int16_t>(std::stoi(path.substr(0, separator))));
+    return audio;
+}
+
+SCENARIO("A user wants to transcribe a batch of files") {
+    BatchTranscribeOptions options;
+    options.concurrency = 3;
+    options.prefetch = 4;
+    options.chunk_size = 1000;
+    options.retry_backoff = std::chrono::milliseconds(1);
+    options.decoder = decode_synthetic;
+    options.transcribe_config.set_modelname("model");
+    GIVEN("a batch of files and a healthy service") {
+        MockTranscribeService service;
+        std::vector<std::string> paths;
+        for (int i = 1; i <= 10; i++)
+            paths.push_back(std::to_string(i) + "_" + std::to_string(500 * i));
+        WHEN("the batch is run") {
+            std::map<std::string, BatchTranscribeResult> results;
+            std::size_t num_results = 0;
+            BatchTranscriber<MockTranscribeService> batch(service, options);
+            const auto summary = batch.run(paths, [&](const BatchTranscribeResult& result) {
+                results[result.path] = result;
+                num_results++;
+            });
+            THEN("every file is transcribed in full") {
+                REQUIRE(10 == summary.num_files);
+                REQUIRE(10 == summary.num_succeeded);
+                REQUIRE(0 == summary.num_failed);
+                REQUIRE(0 == summary.num_retries);
+                REQUIRE(10 == num_results);
+                for (int i = 1; i <= 10; i++) {
+                    const auto& result = results[paths[i - 1]];
+                    REQUIRE(result.status.ok());
+                    REQUIRE(1 == result.attempts);
+                    REQUIRE("w" + std::to_string(i) == result.transcript);
+                }
+            }
+            THEN("every sample is streamed") {
+                REQUIRE(500 * 55 == service.get_num_samples());
+            }
+            THEN("the concurrency is bounded") {
+                REQUIRE(service.max_active <= 3);
+            }
+            THEN("streams are opened in offline mode with the configured audio") {
+                const auto config = service.get_config(0);
+                REQUIRE(config.doofflinemode());
+                REQUIRE_THAT(config.modelname(), Catch::Equals("model"));
+                REQUIRE(16000 == config.audio().sampleratehertz());
+                REQUIRE(1 == config.audio().audiochannelcount());
+            }
+        }
+    }
+    GIVEN("a service that fails streams with a transient status") {
+        MockTranscribeService service({{1, 1}, {2, 5}});
+        const std::vector<std::string> paths = {"1_100", "2_100", "3_100", "bad.wav"};
+        WHEN("the batch is run") {
+            std::map<std::string, BatchTranscribeResult> results;
+            BatchTranscriber<MockTranscribeService> batch(service, options);
+            const auto summary = batch.run(paths, [&](const BatchTranscribeResult& result) {
+                results[result.path] = result;
+            });
+            THEN("transient failures are retried up to the maximal attempts") {
+                REQUIRE(4 == summary.num_files);
+                REQUIRE(2 == summary.num_succeeded);
+                REQUIRE(2 == summary.num_failed);
+                REQUIRE(3 == summary.num_retries);
+                REQUIRE(results["1_100"].status.ok());
+                REQUIRE(2 == results["1_100"].attempts);
+                REQUIRE(::grpc::StatusCode::UNAVAILABLE == results["2_100"].status.error_code());
+                REQUIRE(3 == results["2_100"].attempts);
+                REQUIRE(1 == results["3_100"].attempts);
+            }
+            THEN("files that fail to decode are reported without a stream") {
+                REQUIRE(::grpc::StatusCode::INVALID_ARGUMENT == results["bad.wav"].status.error_code());
+                REQUIRE_THAT(results["bad.wav"].status.error_message(), Catch::Equals("corrupt file"));
+                REQUIRE(0 == results["bad.wav"].attempts);
+            }
+        }
+    }
+    GIVEN("a service that throws when more streams are opened") {
+        MockTranscribeService service;
+        service.max_streams = 2;
+        std::vector<std::string> paths;
+        for (int i = 1; i <= 5; i++) paths.push_back(std::to_string(i) + "_100");
+        WHEN("the batch is run") {
+            std::map<std::string, BatchTranscribeResult> results;
+            BatchTranscriber<MockTranscribeService> batch(service, options);
+            const auto summary = batch.run(paths, [&](const BatchTranscribeResult& result) {
+                results[result.path] = result;
+            });
+            THEN("the files whose streams cannot be opened fail") {
+                REQUIRE(5 == results.size());
+                REQUIRE(2 == summary.num_succeeded);
+                REQUIRE(3 == summary.num_failed);
+                for (const auto& entry : results) {
+                    if (entry.second.status.ok()) continue;
+                    REQUIRE(::grpc::StatusCode::INTERNAL == entry.second.status.error_code());
+                    REQUIRE_THAT(entry.second.status.error_message(), Catch::Equals("too many streams"));
+                    REQUIRE(1 == entry.second.attempts);
+                }
+            }
+            THEN("the streams that opened complete before the batch returns") {
+                REQUIRE(0 == service.active);
+            }
+        }
+    }
+    GIVEN("a service and an output stream") {
+        MockTranscribeService service;
+        WHEN("the batch is run with JSONL output") {
+            std::ostringstream output;
+            BatchTranscriber<MockTranscribeService> batch(service, options);
+            batch.run({"7_10", "8_20"}, output);
+            THEN("one line is written for each file") {
+                const auto text = output.str();
+                REQUIRE(2 == std::count(text.begin(), text.end(), '\n'));
+                REQUIRE(text.find("\"transcript\":\"w7\"") != std::string::npos);
+                REQUIRE(text.find("\"transcript\":\"w8\"") != std::string::npos);
+            }
+        }
+    }
+    GIVEN("options with zero concurrency") {
+        MockTranscribeService service;
+        options.concurrency = 0;
+        THEN("an error is thrown") {
+            REQUIRE_THROWS_AS(BatchTranscriber<MockTranscribeService>(service, options), std::invalid_argument);
+        }
+    }
+}
+
+SCENARIO("A user wants to classify and report batch results") {
+    GIVEN("statuses from failed streams") {
+        THEN("transient failures are retryable") {
+            REQUIRE(is_retryable(::grpc::Status(::grpc::StatusCode::UNAVAILABLE, "")));
+            REQUIRE(is_retryable(::grpc::Status(::grpc::StatusCode::DEADLINE_EXCEEDED, "")));
+            REQUIRE(is_retryable(::grpc::Status(::grpc::StatusCode::RESOURCE_EXHAUSTED, "")));
+            REQUIRE(is_retryable(::grpc::Status(::grpc::StatusCode::ABORTED, "")));
+        }
+        THEN("permanent failures are not retryable") {
+            REQUIRE_FALSE(is_retryable(::grpc::Status::OK));
+            REQUIRE_FALSE(is_retryable(::grpc::Status(::grpc::StatusCode::INVALID_ARGUMENT, "")));
+            REQUIRE_FALSE(is_retryable(::grpc::Status(::grpc::StatusCode::UNAUTHENTICATED, "")));
+        }
+    }
+    GIVEN("a failed result") {
+        BatchTranscribeResult result;
+        result.path = "a \"quoted\".wav";
+        result.status = ::grpc::Status(::grpc::StatusCode::UNAVAILABLE, "down");
+        result.attempts = 3;
+        THEN("the result is serialized as one line of JSON") {
+            REQUIRE_THAT(to_jsonl(result), Catch::Equals(
+                "{\"attempts\":3,\"code\":14,\"message\":\"down\",\"ok\":false,"
+                "\"path\":\"a \\\"quoted\\\".wav\",\"transcript\":\"\"}"
+            ));
+        }
+    }
+    GIVEN("a manifest of paths") {
+        const std::string path = "test_batch_manifest.txt";
+        std::ofstream("test_batch_manifest.txt") << "# recordings\n  a.wav  \n\nb.flac\n";
+        THEN("the paths are read without comments and blank lines") {
+            REQUIRE(std::vector<std::string>({"a.wav", "b.flac"}) == find_batch_inputs(path));
+        }
+        std::remove(path.c_str());
+    }
+    GIVEN("the path of a single WAV file") {
+        THEN("the file is the only input") {
+            REQUIRE(std::vector<std::string>({"speech.WAV"}) == find_batch_inputs("speech.WAV"));
+        }
+    }
+    GIVEN("a manifest that does not exist") {
+        THEN("an error is thrown") {
+            REQUIRE_THROWS_AS(find_batch_inputs("does_not_exist.txt"), std::runtime_error);
+        }
+    }
+}
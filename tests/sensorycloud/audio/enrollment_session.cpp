@@ -0,0 +1,182 @@
+// Test cases for the sensory::audio::EnrollmentSession class.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <grpcpp/support/sync_stream.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include "sensorycloud/audio/enrollment_session.hpp"
+
+using ::sensory::audio::CreateEnrollmentSession;
+using ::sensory::audio::EnrollmentProgress;
+using ::sensory::api::v1::audio::CreateEnrollmentRequest;
+using ::sensory::api::v1::audio::CreateEnrollmentResponse;
+
+/// @brief A mock `CreateEnrollment` stream that completes a segment with
+/// every two writes and the enrollment after a number of segments.
+class MockStream : public ::grpc::ClientReaderWriterInterface<CreateEnrollmentRequest, CreateEnrollmentResponse> {
+ private:
+    /// The mutex for guarding the state of the stream.
+    std::mutex mutex;
+    /// The condition for waking the reader and writer.
+    std::condition_variable condition;
+    /// The responses that have not been read.
+    std::deque<CreateEnrollmentResponse> responses;
+    /// The number of calls to `Read`.
+    std::size_t num_reads = 0;
+    /// The number of responses that were sent.
+    std::size_t num_responses = 0;
+    /// The number of segments of the enrollment.
+    int num_segments;
+
+ public:
+    /// The number of writes that the stream received.
+    std::size_t num_writes = 0;
+    /// Whether writes-done was received.
+    bool writes_done = false;
+
+    /// @brief Initialize a new mock stream.
+    ///
+    /// @param num_segments_ The number of segments of the enrollment.
+    ///
+    explicit MockStream(const int& num_segments_) : num_segments(num_segments_) { }
+
+    void WaitForInitialMetadata() override { }
+
+    bool NextMessageSize(uint32_t* size) override {
+        *size = UINT32_MAX;
+        return true;
+    }
+
+    bool Read(CreateEnrollmentResponse* response) override {
+        std::unique_lock<std::mutex> lock(mutex);
+        num_reads++;
+        condition.notify_all();
+        condition.wait(lock, [&]() { return !responses.empty() || writes_done; });
+        if (responses.empty()) return false;
+        *response = responses.front();
+        responses.pop_front();
+        return true;
+    }
+
+    /// @details
+    /// Waits until the reader returns for the next response so that the
+    /// response has been processed when the write returns.
+    bool Write(const CreateEnrollmentRequest&, ::grpc::WriteOptions) override {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (writes_done) return false;
+        num_writes++;
+        CreateEnrollmentResponse response;
+        response.set_percentsegmentcomplete(num_writes % 2 == 0 ? 100 : 50);
+        response.set_percentcomplete(std::min<int64_t>(100, (num_writes / 2) * 100 / num_segments));
+        if (response.percentcomplete() >= 100) response.set_enrollmentid("enrollment");
+        responses.push_back(response);
+        num_responses++;
+        condition.notify_all();
+        condition.wait_for(lock, std::chrono::seconds(5), [&]() { return num_reads > num_responses; });
+        return true;
+    }
+
+    bool WritesDone() override {
+        std::lock_guard<std::mutex> lock(mutex);
+        writes_done = true;
+        condition.notify_all();
+        return true;
+    }
+
+    ::grpc::Status Finish() override { return ::grpc::Status::OK; }
+};
+
+SCENARIO("An enrollment session is initialized without a stream") {
+    GIVEN("a null stream") {
+        WHEN("the session is initialized") {
+            THEN("an exception is thrown") {
+                REQUIRE_THROWS_AS(CreateEnrollmentSession(nullptr), std::invalid_argument);
+            }
+        }
+    }
+}
+
+SCENARIO("An enrollment session stops writing when the enrollment completes") {
+    GIVEN("a session for an enrollment of two segments") {
+        auto mock = new MockStream(2);
+        std::vector<EnrollmentProgress> updates;
+        CreateEnrollmentSession session(CreateEnrollmentSession::Stream(mock),
+            [&](const EnrollmentProgress& progress, const CreateEnrollmentResponse&) {
+                updates.push_back(progress);
+            });
+        WHEN("more audio than the enrollment requires is written") {
+            std::vector<int16_t> samples(160, 1);
+            std::size_t num_written = 0;
+            for (int i = 0; i < 10; i++)
+                num_written += session.write(samples.data(), samples.size());
+            const auto status = session.finish();
+            THEN("the session stops after the enrollment completes") {
+                REQUIRE(status.ok());
+                REQUIRE(4 == num_written);
+                REQUIRE(4 == mock->num_writes);
+                REQUIRE(mock->writes_done);
+                REQUIRE(4 * 160 * sizeof(int16_t) == session.get_num_bytes_written());
+            }
+            THEN("the completing response is available") {
+                REQUIRE(session.is_complete());
+                REQUIRE("enrollment" == session.get_response().enrollmentid());
+                REQUIRE(100 == session.get_progress().percent_complete);
+            }
+            THEN("the progress callback reports each segment") {
+                REQUIRE(4 == updates.size());
+                REQUIRE(0 == updates[0].segment);
+                REQUIRE_FALSE(updates[0].is_segment_complete);
+                REQUIRE(0 == updates[1].segment);
+                REQUIRE(updates[1].is_segment_complete);
+                REQUIRE(50 == updates[1].percent_complete);
+                REQUIRE(1 == updates[2].segment);
+                REQUIRE(50 == updates[2].percent_segment_complete);
+                REQUIRE(1 == updates[3].segment);
+                REQUIRE(updates[3].is_segment_complete);
+                REQUIRE(100 == updates[3].percent_complete);
+            }
+        }
+        WHEN("the session is finished before the enrollment completes") {
+            std::vector<int16_t> samples(160, 1);
+            REQUIRE(session.write(samples.data(), samples.size()));
+            const auto status = session.finish();
+            THEN("the enrollment is incomplete and later writes fail") {
+                REQUIRE(status.ok());
+                REQUIRE_FALSE(session.is_complete());
+                REQUIRE(session.get_response().enrollmentid().empty());
+                REQUIRE_FALSE(session.write(samples.data(), samples.size()));
+                REQUIRE(1 == mock->num_writes);
+            }
+        }
+    }
+}
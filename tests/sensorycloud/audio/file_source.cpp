@@ -0,0 +1,183 @@
+// Test cases for the AudioFileSource.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "sensorycloud/generated/v1/audio/audio.pb.h"
+#include "sensorycloud/audio/file_source.hpp"
+
+using ::sensory::audio::AudioFileSource;
+using ::sensory::audio::AudioFileView;
+using ::sensory::audio::PCMAudio;
+using ::sensory::audio::set_audio_content;
+using ::sensory::audio::write_wav;
+using ::sensory::api::v1::audio::TranscribeRequest;
+using ::sensory::calldata::AudioChunkRequest;
+
+/// @brief Write raw bytes to a file.
+///
+/// @param path The path of the file to write.
+/// @param bytes The contents of the file.
+///
+void write_bytes(const std::string& path, const std::string& bytes) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(bytes.data(), bytes.size());
+}
+
+SCENARIO("A user wants to stream a WAV file without copying it") {
+    GIVEN("a 16kHz mono WAV file") {
+        const std::string path = "file_source_test.wav";
+        PCMAudio audio;
+        audio.sample_rate = 16000;
+        audio.num_channels = 1;
+        for (int i = 0; i < 1000; i++) audio.samples.push_back(static_cast<int16_t>(i * 31 - 15000));
+        write_wav(path, audio);
+        WHEN("the file is mapped") {
+            AudioFileSource source(path);
+            THEN("the format is read from the header") {
+                REQUIRE(source.is_wav());
+                REQUIRE(16000 == source.get_sample_rate());
+                REQUIRE(1 == source.get_num_channels());
+                REQUIRE(1000 == source.get_num_frames());
+                REQUIRE(source.is_native(16000, 1));
+                REQUIRE_FALSE(source.is_native(8000, 1));
+            }
+            THEN("chunks are consecutive views into the mapping") {
+                const auto first = source.next(400);
+                const auto second = source.next(400);
+                const auto third = source.next(400);
+                const auto last = source.next(400);
+                REQUIRE(400 == first.num_frames);
+                REQUIRE(first.samples + 400 == second.samples);
+                REQUIRE(200 == third.num_frames);
+                REQUIRE(last.empty());
+                REQUIRE(0 == source.get_remaining());
+                REQUIRE(audio.samples[0] == first.samples[0]);
+                REQUIRE(audio.samples[999] == third.samples[199]);
+            }
+            THEN("a view is set as the audio content of a request") {
+                TranscribeRequest request;
+                set_audio_content(request, source.view(10, 2));
+                REQUIRE(4 == request.audiocontent().size());
+                REQUIRE(std::string(reinterpret_cast<const char*>(&audio.samples[10]), 4) == request.audiocontent());
+            }
+            THEN("a view is set as the audio content of a chunk request without a copy") {
+                AudioChunkRequest<TranscribeRequest> request;
+                const auto view = source.view(10, 2);
+                set_audio_content(request, view);
+                REQUIRE(request.has_audio_content());
+                REQUIRE(4 == request.get_audio_content().size());
+                REQUIRE(reinterpret_cast<const uint8_t*>(view.data()) == request.get_audio_content().begin());
+            }
+            THEN("the source can seek and copy the audio") {
+                source.seek(990);
+                REQUIRE(10 == source.next(100).num_frames);
+                source.seek(5000);
+                REQUIRE(1000 == source.get_position());
+                REQUIRE(audio.samples == source.to_pcm().samples);
+            }
+        }
+        std::remove(path.c_str());
+    }
+    GIVEN("a view of a WAV file") {
+        const std::string path = "file_source_test_view.wav";
+        PCMAudio audio;
+        audio.sample_rate = 16000;
+        audio.num_channels = 1;
+        audio.samples = {1, 2, 3, 4};
+        write_wav(path, audio);
+        AudioFileView view;
+        {
+            AudioFileSource source(path);
+            view = source.next(4);
+        }
+        WHEN("the source is destroyed") {
+            THEN("the view keeps the mapping alive") {
+                REQUIRE(4 == view.num_frames);
+                REQUIRE(4 == view.samples[3]);
+            }
+        }
+        std::remove(path.c_str());
+    }
+    GIVEN("a file that is not a WAV file") {
+        const std::string path = "file_source_test.txt";
+        write_bytes(path, "this is not audio at all, just some text");
+        THEN("mapping it as WAV throws an error") {
+            REQUIRE_THROWS_AS(AudioFileSource(path), std::runtime_error);
+        }
+        std::remove(path.c_str());
+    }
+    GIVEN("a path that does not exist") {
+        THEN("mapping it throws an error") {
+            REQUIRE_THROWS_AS(AudioFileSource("file_source_test_missing.wav"), std::runtime_error);
+            REQUIRE_THROWS_AS(AudioFileSource("file_source_test_missing.pcm", 16000, 1), std::runtime_error);
+        }
+    }
+}
+
+SCENARIO("A user wants to stream a raw PCM file without copying it") {
+    GIVEN("a stereo raw PCM file with a trailing partial frame") {
+        const std::string path = "file_source_test.pcm";
+        const std::vector<int16_t> samples = {1, -1, 2, -2, 3, -3};
+        write_bytes(path, std::string(reinterpret_cast<const char*>(samples.data()), 12) + "\x01");
+        WHEN("the file is mapped") {
+            AudioFileSource source(path, 8000, 2);
+            THEN("the partial frame is ignored") {
+                REQUIRE_FALSE(source.is_wav());
+                REQUIRE(3 == source.get_num_frames());
+                REQUIRE_FALSE(source.is_native(16000, 1));
+                const auto view = source.next(8);
+                REQUIRE(3 == view.num_frames);
+                REQUIRE(12 == view.size());
+                REQUIRE(-3 == view.samples[5]);
+            }
+        }
+        std::remove(path.c_str());
+    }
+    GIVEN("an empty raw PCM file") {
+        const std::string path = "file_source_test_empty.pcm";
+        write_bytes(path, "");
+        WHEN("the file is mapped") {
+            AudioFileSource source(path, 16000, 1);
+            THEN("the source has no audio") {
+                REQUIRE(0 == source.get_num_frames());
+                REQUIRE(source.next(100).empty());
+            }
+        }
+        std::remove(path.c_str());
+    }
+    GIVEN("an invalid format") {
+        THEN("an error is thrown") {
+            REQUIRE_THROWS_AS(AudioFileSource("file.pcm", 0, 1), std::invalid_argument);
+            REQUIRE_THROWS_AS(AudioFileSource("file.pcm", 16000, 0), std::invalid_argument);
+        }
+    }
+}
@@ -0,0 +1,372 @@
+// Test cases for the FLACEncoder structure.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "sensorycloud/audio/flac_encoder.hpp"
+
+using ::sensory::audio::FLACEncoder;
+using ::sensory::audio::FLAC_MIN_BLOCK_SIZE;
+using ::sensory::audio::flac_crc8;
+using ::sensory::audio::flac_crc16;
+
+/// @brief A bit reader for decoding FLAC frames in tests.
+struct BitReader {
+    /// The bytes to read from.
+    const std::string& data;
+    /// The position of the reader in bits.
+    std::size_t position;
+
+    explicit BitReader(const std::string& data_, const std::size_t& offset = 0) :
+        data(data_), position(8 * offset) { }
+
+    uint32_t read(const uint32_t& count) {
+        uint32_t value = 0;
+        for (uint32_t i = 0; i < count; i++, position++) {
+            REQUIRE(position / 8 < data.size());
+            const auto byte = static_cast<uint8_t>(data[position / 8]);
+            value = (value << 1) | ((byte >> (7 - position % 8)) & 1);
+        }
+        return value;
+    }
+
+    int32_t read_signed(const uint32_t& count) {
+        const uint32_t value = read(count);
+        return static_cast<int32_t>(value << (32 - count)) >> (32 - count);
+    }
+
+    std::size_t byte() const { return position / 8; }
+};
+
+/// @brief Decode the frames of a FLAC stream with 16-bit samples.
+///
+/// @param stream The encoded FLAC stream, including the stream header.
+/// @param num_channels The number of channels in the stream.
+/// @param block_sizes The optional output for the block sizes of the frames.
+/// @returns The decoded interleaved samples.
+///
+std::vector<int16_t> decode(const std::string& stream,
+    const uint32_t& num_channels,
+    std::vector<uint32_t>* block_sizes = nullptr
+) {
+    REQUIRE(stream.substr(0, 4) == "fLaC");
+    BitReader reader(stream, 4 + 4 + 34);
+    std::vector<int16_t> output;
+    uint64_t expected_sample_number = 0;
+    while (reader.byte() < stream.size()) {
+        const std::size_t frame_start = reader.byte();
+        REQUIRE(reader.read(16) == 0xFFF9);
+        const uint32_t block_size_code = reader.read(4);
+        REQUIRE(reader.read(4) == 0);
+        REQUIRE(reader.read(4) == num_channels - 1);
+        REQUIRE(reader.read(3) == 4);
+        REQUIRE(reader.read(1) == 0);
+        // Decode the UTF-8 style sample number.
+        uint32_t lead = reader.read(8);
+        uint64_t sample_number = 0;
+        if (lead < 0x80) {
+            sample_number = lead;
+        } else {
+            uint32_t continuations = 0;
+            while (lead & (0x40 >> continuations)) continuations++;
+            sample_number = lead & (0x3F >> continuations);
+            for (uint32_t i = 0; i < continuations; i++) {
+                const uint32_t next = reader.read(8);
+                REQUIRE((next & 0xC0) == 0x80);
+                sample_number = (sample_number << 6) | (next & 0x3F);
+            }
+        }
+        REQUIRE(sample_number == expected_sample_number);
+        uint32_t block_size = 0;
+        if (block_size_code == 1) block_size = 192;
+        else if (block_size_code >= 2 && block_size_code <= 5) block_size = 576 << (block_size_code - 2);
+        else if (block_size_code == 6) block_size = reader.read(8) + 1;
+        else if (block_size_code == 7) block_size = reader.read(16) + 1;
+        else if (block_size_code >= 8) block_size = 256 << (block_size_code - 8);
+        else FAIL("reserved block size code");
+        const auto crc8 = flac_crc8(reinterpret_cast<const uint8_t*>(&stream[frame_start]), reader.byte() - frame_start);
+        REQUIRE(reader.read(8) == crc8);
+        // Decode the subframes.
+        std::vector<std::vector<int32_t>> channels(num_channels);
+        for (auto& x : channels) {
+            REQUIRE(reader.read(1) == 0);
+            const uint32_t type = reader.read(6);
+            REQUIRE(reader.read(1) == 0);
+            if (type == 0) {  // constant
+                x.assign(block_size, reader.read_signed(16));
+            } else if (type == 1) {  // verbatim
+                for (uint32_t i = 0; i < block_size; i++) x.push_back(reader.read_signed(16));
+            } else {  // fixed
+                REQUIRE((type & 0x38) == 0x08);
+                const uint32_t order = type & 0x07;
+                REQUIRE(order <= 4);
+                for (uint32_t i = 0; i < order; i++) x.push_back(reader.read_signed(16));
+                REQUIRE(reader.read(2) == 0);
+                const uint32_t partition_order = reader.read(4);
+                for (uint32_t p = 0; p < (1u << partition_order); p++) {
+                    const uint32_t parameter = reader.read(4);
+                    REQUIRE(parameter < 15);
+                    const uint32_t count = (block_size >> partition_order) - (p == 0 ? order : 0);
+                    for (uint32_t i = 0; i < count; i++) {
+                        uint32_t quotient = 0;
+                        while (reader.read(1) == 0) quotient++;
+                        const uint32_t folded = (quotient << parameter) | reader.read(parameter);
+                        const int32_t error = (folded & 1) ? -static_cast<int32_t>(folded >> 1) - 1 :
+                            static_cast<int32_t>(folded >> 1);
+                        const std::size_t n = x.size();
+                        int32_t prediction = 0;
+                        switch (order) {
+                        case 1: prediction = x[n - 1]; break;
+                        case 2: prediction = 2 * x[n - 1] - x[n - 2]; break;
+                        case 3: prediction = 3 * x[n - 1] - 3 * x[n - 2] + x[n - 3]; break;
+                        case 4: prediction = 4 * x[n - 1] - 6 * x[n - 2] + 4 * x[n - 3] - x[n - 4]; break;
+                        }
+                        x.push_back(prediction + error);
+                    }
+                }
+            }
+            REQUIRE(x.size() == block_size);
+        }
+        // Skip the padding and check the CRC of the frame.
+        if (reader.position % 8) reader.read(8 - reader.position % 8);
+        const auto crc16 = flac_crc16(reinterpret_cast<const uint8_t*>(&stream[frame_start]), reader.byte() - frame_start);
+        REQUIRE(reader.read(16) == crc16);
+        for (uint32_t i = 0; i < block_size; i++)
+            for (const auto& x : channels) output.push_back(static_cast<int16_t>(x[i]));
+        expected_sample_number += block_size;
+        if (block_sizes != nullptr) block_sizes->push_back(block_size);
+    }
+    return output;
+}
+
+/// @brief Generate a test signal that resembles voiced speech.
+///
+/// @param num_frames The number of samples per channel.
+/// @param num_channels The number of interleaved channels.
+/// @returns The interleaved samples.
+///
+std::vector<int16_t> make_signal(const std::size_t& num_frames, const uint32_t& num_channels = 1) {
+    std::vector<int16_t> samples;
+    uint32_t noise = 12345;
+    for (std::size_t i = 0; i < num_frames; i++) {
+        for (uint32_t c = 0; c < num_channels; c++) {
+            noise = noise * 1103515245 + 12345;
+            const double value = 8000 * std::sin(0.05 * i + c) + 3000 * std::sin(0.31 * i) +
+                static_cast<double>((noise >> 16) % 64) - 32;
+            samples.push_back(static_cast<int16_t>(value));
+        }
+    }
+    return samples;
+}
+
+TEST_CASE("flac_crc8 should match the check value of CRC-8/SMBUS") {
+    const std::string data = "123456789";
+    REQUIRE(0xF4 == flac_crc8(reinterpret_cast<const uint8_t*>(data.data()), data.size()));
+}
+
+TEST_CASE("flac_crc16 should match the check value of CRC-16/UMTS") {
+    const std::string data = "123456789";
+    REQUIRE(0xFEE8 == flac_crc16(reinterpret_cast<const uint8_t*>(data.data()), data.size()));
+}
+
+SCENARIO("a user wants to initialize a FLACEncoder") {
+    GIVEN("a valid audio format") {
+        WHEN("the encoder is initialized") {
+            FLACEncoder encoder(16000, 2, 1024);
+            THEN("the format is stored") {
+                REQUIRE(16000 == encoder.get_sample_rate());
+                REQUIRE(2 == encoder.get_num_channels());
+                REQUIRE(0 == encoder.get_num_samples());
+            }
+        }
+    }
+    GIVEN("an invalid audio format") {
+        THEN("an invalid argument is thrown") {
+            REQUIRE_THROWS_AS(FLACEncoder(0), std::invalid_argument);
+            REQUIRE_THROWS_AS(FLACEncoder(16000, 0), std::invalid_argument);
+            REQUIRE_THROWS_AS(FLACEncoder(16000, 9), std::invalid_argument);
+            REQUIRE_THROWS_AS(FLACEncoder(16000, 1, 15), std::invalid_argument);
+            REQUIRE_THROWS_AS(FLACEncoder(16000, 1, 65536), std::invalid_argument);
+        }
+    }
+}
+
+SCENARIO("a user wants the stream header of a FLACEncoder") {
+    GIVEN("an encoder for 16kHz mono audio") {
+        FLACEncoder encoder(16000, 1, 4096);
+        WHEN("the stream header is generated") {
+            const auto header = encoder.get_stream_header();
+            THEN("the header is the marker followed by the STREAMINFO block") {
+                REQUIRE(42 == header.size());
+                REQUIRE("fLaC" == header.substr(0, 4));
+                REQUIRE(std::string("\x80\x00\x00\x22", 4) == header.substr(4, 4));
+                BitReader reader(header, 8);
+                REQUIRE(16 == reader.read(16));
+                REQUIRE(4096 == reader.read(16));
+                REQUIRE(0 == reader.read(24));
+                REQUIRE(0 == reader.read(24));
+                REQUIRE(16000 == reader.read(20));
+                REQUIRE(0 == reader.read(3));
+                REQUIRE(15 == reader.read(5));
+            }
+        }
+    }
+}
+
+SCENARIO("a user wants to encode audio with a FLACEncoder") {
+    GIVEN("an encoder for 16kHz mono audio") {
+        FLACEncoder encoder(16000, 1, 4096);
+        WHEN("a chunk of speech-like audio is encoded") {
+            const auto samples = make_signal(4096);
+            std::string output;
+            encoder.encode(samples.data(), 4096, output);
+            THEN("the stream header is prepended") {
+                REQUIRE(encoder.get_stream_header() == output.substr(0, 42));
+            }
+            THEN("the audio decodes losslessly") {
+                REQUIRE(samples == decode(output, 1));
+            }
+            THEN("the audio is compressed") {
+                REQUIRE(output.size() < samples.size() * sizeof(int16_t) * 3 / 4);
+            }
+            THEN("the number of samples is updated") {
+                REQUIRE(4096 == encoder.get_num_samples());
+            }
+        }
+        WHEN("chunks of several sizes are encoded") {
+            const std::vector<std::size_t> sizes = {160, 192, 256, 1, 17, 1152, 4096, 5000, 300};
+            std::size_t total = 0;
+            for (const auto& size : sizes) total += size;
+            const auto samples = make_signal(total);
+            std::string output;
+            std::size_t offset = 0;
+            std::vector<std::size_t> num_pending;
+            for (const auto& size : sizes) {
+                std::string chunk;
+                encoder.encode(samples.data() + offset, size, chunk);
+                num_pending.push_back(encoder.get_num_pending_frames());
+                output += chunk;
+                offset += size;
+            }
+            THEN("each chunk is whole frames and the stream decodes losslessly") {
+                REQUIRE(samples == decode(output, 1));
+                REQUIRE(total == encoder.get_num_samples());
+            }
+            THEN("the short chunk is held back and encoded with the next one") {
+                REQUIRE(std::vector<std::size_t>{0, 0, 0, 1, 0, 0, 0, 0, 0} == num_pending);
+            }
+            THEN("no block is shorter than the minimal block size") {
+                std::vector<uint32_t> block_sizes;
+                decode(output, 1, &block_sizes);
+                for (const auto& block_size : block_sizes)
+                    REQUIRE(block_size >= FLAC_MIN_BLOCK_SIZE);
+            }
+        }
+        WHEN("a chunk shorter than the minimal block size ends the stream") {
+            const auto samples = make_signal(4105);
+            std::string output;
+            encoder.encode(samples.data(), 4100, output);
+            std::string last;
+            encoder.encode(samples.data() + 4100, 5, last);
+            THEN("the chunk is held back until the flush") {
+                REQUIRE(last.empty());
+                REQUIRE(5 == encoder.get_num_pending_frames());
+                encoder.flush(last);
+                REQUIRE(0 == encoder.get_num_pending_frames());
+                REQUIRE(4105 == encoder.get_num_samples());
+                std::vector<uint32_t> block_sizes;
+                REQUIRE(samples == decode(output + last, 1, &block_sizes));
+                REQUIRE(std::vector<uint32_t>{2050, 2050, 5} == block_sizes);
+            }
+        }
+        WHEN("silence is encoded") {
+            const std::vector<int16_t> samples(1024, 0);
+            std::string output;
+            encoder.encode(samples.data(), samples.size(), output);
+            THEN("a constant subframe is used") {
+                // The header, a 6 byte frame header, 3 byte subframe, and CRC.
+                REQUIRE(42 + 6 + 3 + 2 == output.size());
+                REQUIRE(samples == decode(output, 1));
+            }
+        }
+        WHEN("white noise at full scale is encoded") {
+            std::vector<int16_t> samples;
+            uint32_t noise = 1;
+            for (int i = 0; i < 512; i++) {
+                noise = noise * 1664525 + 1013904223;
+                samples.push_back(static_cast<int16_t>(noise >> 16));
+            }
+            std::string output;
+            encoder.encode(samples.data(), samples.size(), output);
+            THEN("the frame is never larger than the verbatim audio") {
+                REQUIRE(output.size() <= 42 + 6 + 1 + samples.size() * sizeof(int16_t) + 2);
+                REQUIRE(samples == decode(output, 1));
+            }
+        }
+        WHEN("audio with extreme sample values is encoded") {
+            std::vector<int16_t> samples;
+            for (int i = 0; i < 300; i++)
+                samples.push_back(i % 2 ? INT16_MAX : INT16_MIN);
+            std::string output;
+            encoder.encode(samples.data(), samples.size(), output);
+            THEN("the audio decodes losslessly") {
+                REQUIRE(samples == decode(output, 1));
+            }
+        }
+    }
+    GIVEN("an encoder with the smallest maximal block size") {
+        FLACEncoder encoder(16000, 1, FLAC_MIN_BLOCK_SIZE);
+        WHEN("a chunk that is not a multiple of the block size is encoded") {
+            const auto samples = make_signal(40);
+            std::string output;
+            encoder.encode(samples.data(), 40, output);
+            encoder.flush(output);
+            THEN("the remainder is held back for the last block") {
+                std::vector<uint32_t> block_sizes;
+                REQUIRE(samples == decode(output, 1, &block_sizes));
+                REQUIRE(std::vector<uint32_t>{16, 16, 8} == block_sizes);
+            }
+        }
+    }
+    GIVEN("an encoder for stereo audio with a small block size") {
+        FLACEncoder encoder(44100, 2, 256);
+        WHEN("a long chunk is encoded") {
+            const auto samples = make_signal(1000, 2);
+            std::string output;
+            encoder.encode(samples.data(), 1000, output);
+            THEN("the chunk is split into balanced frames that decode losslessly") {
+                std::vector<uint32_t> block_sizes;
+                REQUIRE(samples == decode(output, 2, &block_sizes));
+                REQUIRE(std::vector<uint32_t>{250, 250, 250, 250} == block_sizes);
+                REQUIRE(1000 == encoder.get_num_samples());
+            }
+        }
+    }
+}
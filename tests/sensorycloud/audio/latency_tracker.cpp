@@ -0,0 +1,301 @@
+// Test cases for latency measurement in the SensoryCloud C++ SDK.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <grpcpp/support/sync_stream.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "sensorycloud/audio/latency_tracker.hpp"
+
+using ::sensory::audio::LatencyTracker;
+using ::sensory::audio::LatencyTrackerOptions;
+using ::sensory::audio::LatencyTrackingStream;
+using ::sensory::util::LatencyHistogram;
+using ::sensory::api::v1::audio::TranscribeRequest;
+using ::sensory::api::v1::audio::TranscribeResponse;
+using ::sensory::api::v1::audio::ValidateEventResponse;
+using std::chrono::milliseconds;
+using std::chrono::microseconds;
+
+/// The sample rate of the test audio, one frame per millisecond.
+static constexpr uint32_t SAMPLE_RATE = 1000;
+
+/// @brief Return a transcription response with words ending at given times.
+static TranscribeResponse make_response(const std::vector<uint64_t>& end_times) {
+    TranscribeResponse response;
+    auto word_list = response.mutable_wordlist();
+    for (const auto& end_time : end_times) {
+        auto word = word_list->add_words();
+        word->set_word("word");
+        word->set_endtimems(end_time);
+    }
+    return response;
+}
+
+SCENARIO("a user wants to measure the latency of results") {
+    GIVEN("a tracker and audio sent in chunks of 100ms every 100ms") {
+        LatencyHistogram aggregate;
+        LatencyTrackerOptions options;
+        options.sample_rate = SAMPLE_RATE;
+        options.aggregate = &aggregate;
+        LatencyTracker tracker(options);
+        const auto start = LatencyTracker::Clock::now();
+        for (int chunk = 0; chunk < 10; chunk++)
+            tracker.on_write(100, start + milliseconds(100 * chunk));
+        THEN("the frames are counted") {
+            REQUIRE(1000 == tracker.get_num_frames());
+        }
+        WHEN("a result arrives for the end of a chunk") {
+            // The third chunk (200ms to 300ms) was sent at 200ms.
+            REQUIRE(tracker.on_result(300, start + milliseconds(450)));
+            THEN("the latency is measured from the send of that chunk") {
+                REQUIRE(1 == tracker.get_histogram().get_count());
+                REQUIRE(microseconds(250000) == tracker.get_histogram().get_max());
+            }
+            THEN("the latency is recorded in the aggregate") {
+                REQUIRE(1 == aggregate.get_count());
+                REQUIRE(microseconds(250000) == aggregate.get_max());
+            }
+        }
+        WHEN("a result arrives for the middle of a chunk") {
+            REQUIRE(tracker.on_result(250, start + milliseconds(450)));
+            THEN("the latency is measured from the send of that chunk") {
+                REQUIRE(microseconds(250000) == tracker.get_histogram().get_max());
+            }
+        }
+        WHEN("a result arrives for the first sample of a chunk") {
+            REQUIRE(tracker.on_result(301, start + milliseconds(450)));
+            THEN("the latency is measured from the send of that chunk") {
+                REQUIRE(microseconds(150000) == tracker.get_histogram().get_max());
+            }
+        }
+        WHEN("a result arrives that repeats audio of an earlier result") {
+            REQUIRE(tracker.on_result(500, start + milliseconds(600)));
+            REQUIRE_FALSE(tracker.on_result(400, start + milliseconds(700)));
+            REQUIRE_FALSE(tracker.on_result(500, start + milliseconds(700)));
+            THEN("only the first result is measured") {
+                REQUIRE(1 == tracker.get_histogram().get_count());
+                REQUIRE(microseconds(200000) == tracker.get_histogram().get_max());
+            }
+        }
+        WHEN("a result appears to end after the audio that was sent") {
+            REQUIRE(tracker.on_result(1010, start + milliseconds(1000)));
+            THEN("the latency is measured from the send of the last chunk") {
+                REQUIRE(microseconds(100000) == tracker.get_histogram().get_max());
+            }
+        }
+        WHEN("results arrive for each chunk") {
+            for (int chunk = 1; chunk <= 10; chunk++)
+                REQUIRE(tracker.on_result(100 * chunk, start + milliseconds(100 * chunk + 10 * chunk)));
+            THEN("the summary has the percentiles of the latencies") {
+                const auto summary = tracker.get_summary();
+                REQUIRE(10 == summary.count);
+                REQUIRE(microseconds(155000) == summary.mean);
+                REQUIRE(std::abs(summary.p50.count() - 150000) <= 4500);
+                REQUIRE(microseconds(200000) == summary.p99);
+                REQUIRE(microseconds(200000) == summary.max);
+            }
+        }
+    }
+    GIVEN("a tracker that retains 4 writes") {
+        LatencyTrackerOptions options;
+        options.sample_rate = SAMPLE_RATE;
+        options.capacity = 4;
+        LatencyTracker tracker(options);
+        const auto start = LatencyTracker::Clock::now();
+        for (int chunk = 0; chunk < 10; chunk++)
+            tracker.on_write(100, start + milliseconds(100 * chunk));
+        WHEN("a result arrives for audio of a write that left the ring") {
+            THEN("the result is not measured") {
+                REQUIRE_FALSE(tracker.on_result(600, start + milliseconds(1000)));
+                REQUIRE(1 == tracker.get_num_unmatched());
+                REQUIRE(0 == tracker.get_histogram().get_count());
+            }
+        }
+        WHEN("a result arrives for audio of a retained write") {
+            THEN("the result is measured") {
+                REQUIRE(tracker.on_result(601, start + milliseconds(1000)));
+                REQUIRE(microseconds(400000) == tracker.get_histogram().get_max());
+                REQUIRE(0 == tracker.get_num_unmatched());
+            }
+        }
+    }
+    GIVEN("invalid options") {
+        LatencyTrackerOptions options;
+        options.sample_rate = 0;
+        THEN("the tracker cannot be initialized") {
+            REQUIRE_THROWS_AS(LatencyTracker(options), std::invalid_argument);
+        }
+    }
+}
+
+SCENARIO("a user wants to measure the latency of responses") {
+    GIVEN("a tracker with 1s of audio sent at once") {
+        LatencyTrackerOptions options;
+        options.sample_rate = SAMPLE_RATE;
+        LatencyTracker tracker(options);
+        const auto start = LatencyTracker::Clock::now();
+        tracker.on_write(1000, start);
+        WHEN("a transcription response arrives") {
+            THEN("the latency is measured at the latest word") {
+                REQUIRE(tracker.observe(make_response({200, 700, 400}), start + milliseconds(50)));
+                REQUIRE(microseconds(50000) == tracker.get_histogram().get_max());
+                REQUIRE_FALSE(tracker.observe(make_response({300, 600}), start + milliseconds(60)));
+            }
+        }
+        WHEN("a transcription response without words arrives") {
+            THEN("the response is not measured") {
+                REQUIRE_FALSE(tracker.observe(TranscribeResponse(), start + milliseconds(50)));
+                REQUIRE_FALSE(tracker.observe(make_response({}), start + milliseconds(50)));
+            }
+        }
+        WHEN("an event response arrives") {
+            ValidateEventResponse response;
+            response.set_success(true);
+            response.set_resultendtime(0.5);
+            THEN("the latency is measured at the end of the event") {
+                REQUIRE(tracker.observe(response, start + milliseconds(80)));
+                REQUIRE(microseconds(80000) == tracker.get_histogram().get_max());
+            }
+        }
+        WHEN("an event response without a detection arrives") {
+            ValidateEventResponse response;
+            response.set_resultendtime(0.5);
+            THEN("the response is not measured") {
+                REQUIRE_FALSE(tracker.observe(response, start + milliseconds(80)));
+            }
+        }
+    }
+}
+
+/// @brief A mock `Transcribe` stream that responds to every write with a
+/// word that ends at the end of the audio, after a delay.
+class MockStream : public ::grpc::ClientReaderWriterInterface<TranscribeRequest, TranscribeResponse> {
+ private:
+    /// The mutex for guarding the state of the stream.
+    std::mutex mutex;
+    /// The condition for waking the reader.
+    std::condition_variable condition;
+    /// The number of frames that the stream received.
+    uint64_t num_frames = 0;
+    /// The responses that have not been read.
+    std::deque<TranscribeResponse> responses;
+    /// Whether the stream has ended.
+    bool ended = false;
+
+ public:
+    void WaitForInitialMetadata() override { }
+
+    bool NextMessageSize(uint32_t* size) override {
+        *size = UINT32_MAX;
+        return true;
+    }
+
+    bool Read(TranscribeResponse* response) override {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&]() { return !responses.empty() || ended; });
+        if (responses.empty()) return false;
+        *response = responses.front();
+        responses.pop_front();
+        lock.unlock();
+        std::this_thread::sleep_for(milliseconds(20));
+        return true;
+    }
+
+    bool Write(const TranscribeRequest& request, ::grpc::WriteOptions) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        num_frames += request.audiocontent().size() / sizeof(int16_t);
+        responses.push_back(make_response({num_frames * 1000 / SAMPLE_RATE}));
+        condition.notify_all();
+        return true;
+    }
+
+    bool WritesDone() override {
+        std::lock_guard<std::mutex> lock(mutex);
+        ended = true;
+        condition.notify_all();
+        return true;
+    }
+
+    ::grpc::Status Finish() override { return ::grpc::Status::OK; }
+};
+
+SCENARIO("a user wants to measure the latency of a stream") {
+    GIVEN("two streams that share an aggregate histogram") {
+        LatencyHistogram aggregate;
+        LatencyTrackerOptions options;
+        options.sample_rate = SAMPLE_RATE;
+        options.aggregate = &aggregate;
+        LatencyTrackingStream<TranscribeRequest, TranscribeResponse> stream1(
+            std::unique_ptr<MockStream>(new MockStream), options);
+        LatencyTrackingStream<TranscribeRequest, TranscribeResponse> stream2(
+            std::unique_ptr<MockStream>(new MockStream), options);
+        WHEN("audio is streamed through both streams") {
+            const std::vector<int16_t> chunk(100, 1);
+            for (auto stream : {&stream1, &stream2}) {
+                std::thread reader([stream]() {
+                    TranscribeResponse response;
+                    while (stream->Read(&response)) { }
+                });
+                TranscribeRequest config;
+                REQUIRE(stream->Write(config));
+                for (int i = 0; i < 5; i++) {
+                    TranscribeRequest request;
+                    request.set_audiocontent(reinterpret_cast<const char*>(chunk.data()), chunk.size() * sizeof(int16_t));
+                    REQUIRE(stream->Write(request));
+                }
+                REQUIRE(stream->WritesDone());
+                reader.join();
+                REQUIRE(stream->Finish().ok());
+            }
+            THEN("each stream measures the latency of its results") {
+                for (auto stream : {&stream1, &stream2}) {
+                    const auto summary = stream->get_tracker().get_summary();
+                    REQUIRE(500 == stream->get_tracker().get_num_frames());
+                    REQUIRE(5 == summary.count);
+                    REQUIRE(milliseconds(20) <= summary.p50);
+                    REQUIRE(summary.p50 <= summary.p95);
+                    REQUIRE(summary.p95 <= summary.p99);
+                }
+            }
+            THEN("the aggregate has the latencies of both streams") {
+                REQUIRE(10 == aggregate.get_count());
+                REQUIRE(milliseconds(20) <= aggregate.get_min());
+            }
+        }
+    }
+    GIVEN("no stream") {
+        THEN("the stream cannot be initialized") {
+            REQUIRE_THROWS_AS((LatencyTrackingStream<TranscribeRequest, TranscribeResponse>(nullptr)), std::invalid_argument);
+        }
+    }
+}
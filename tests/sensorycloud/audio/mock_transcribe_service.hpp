@@ -0,0 +1,299 @@
+// A mock audio service for testing offline transcription engines.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef SENSORYCLOUD_TESTS_AUDIO_MOCK_TRANSCRIBE_SERVICE_HPP_
+#define SENSORYCLOUD_TESTS_AUDIO_MOCK_TRANSCRIBE_SERVICE_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "sensorycloud/generated/v1/audio/audio.pb.h"
+#include "sensorycloud/calldata/awaitable_bidi_reactor.hpp"
+#include "sensorycloud/util/executor.hpp"
+
+/// The sample rate of the mock audio, 16 frames per millisecond.
+static constexpr uint32_t SAMPLE_RATE = 16000;
+
+/// @brief A stream that recognizes runs of constant, non-zero samples as
+/// words named after the sample value.
+///
+/// @details
+/// Reactions are delivered on the executor of the service in the order that
+/// operations are started. The transcript is delivered once the writes are
+/// closed and the service allows it.
+///
+class MockTranscribeStream : public ::grpc::ClientCallbackReaderWriter<
+    ::sensory::api::v1::audio::TranscribeRequest,
+    ::sensory::api::v1::audio::TranscribeResponse
+> {
+ private:
+    /// The executor to run reactions on.
+    ::sensory::util::ThreadPoolExecutor& executor;
+    /// The function that blocks until the transcript may be delivered.
+    std::function<void()> await_streams;
+    /// The number of streams that are in flight.
+    std::atomic<int>& active;
+    /// The reactor of the stream.
+    ::grpc::ClientBidiReactor<
+        ::sensory::api::v1::audio::TranscribeRequest,
+        ::sensory::api::v1::audio::TranscribeResponse
+    >* reactor;
+    /// The operations that were started before the call.
+    std::vector<std::function<void()>> pending;
+    /// Whether the call has started.
+    bool started;
+    /// The outstanding read.
+    ::sensory::api::v1::audio::TranscribeResponse* reading;
+    /// Whether the stream should fail once the config is written.
+    bool fail;
+
+    /// @brief Run an operation once the call has started.
+    ///
+    /// @param operation The operation to run on the executor.
+    ///
+    void post(const std::function<void()>& operation) {
+        if (started) executor.execute(operation);
+        else pending.push_back(operation);
+    }
+
+    /// @brief Complete the stream with a status.
+    ///
+    /// @param status The final status of the stream.
+    ///
+    void finish(const ::grpc::Status& status) {
+        reactor->OnReadDone(false);
+        active--;
+        reactor->OnDone(status);
+    }
+
+ public:
+    /// The config that the stream was opened with.
+    ::sensory::api::v1::audio::TranscribeConfig config;
+    /// The audio that the stream received.
+    std::vector<int16_t> audio;
+
+    /// @brief Initialize a new stream.
+    ///
+    /// @param executor_ The executor to run reactions on.
+    /// @param await_streams_ The function that blocks until the transcript
+    /// may be delivered.
+    /// @param active_ The number of streams that are in flight.
+    /// @param reactor_ The reactor to bind the stream to.
+    /// @param fail_ Whether the stream should fail once the config is written.
+    ///
+    MockTranscribeStream(
+        ::sensory::util::ThreadPoolExecutor& executor_,
+        const std::function<void()>& await_streams_,
+        std::atomic<int>& active_,
+        ::grpc::ClientBidiReactor<
+            ::sensory::api::v1::audio::TranscribeRequest,
+            ::sensory::api::v1::audio::TranscribeResponse
+        >* reactor_,
+        bool fail_
+    ) : executor(executor_),
+        await_streams(await_streams_),
+        active(active_),
+        reactor(reactor_),
+        started(false),
+        reading(nullptr),
+        fail(fail_) {
+        BindReactor(reactor);
+    }
+
+    void StartCall() override {
+        started = true;
+        for (const auto& operation : pending) executor.execute(operation);
+        pending.clear();
+    }
+    void Write(const ::sensory::api::v1::audio::TranscribeRequest* request, ::grpc::WriteOptions) override {
+        if (request->has_config()) config = request->config();
+        const auto& content = request->audiocontent();
+        const auto samples = reinterpret_cast<const int16_t*>(content.data());
+        audio.insert(audio.end(), samples, samples + content.size() / sizeof(int16_t));
+        if (fail) {
+            post([this]() {
+                reactor->OnWriteDone(false);
+                finish(::grpc::Status(::grpc::StatusCode::UNAVAILABLE, "unavailable"));
+            });
+        } else {
+            post([this]() { reactor->OnWriteDone(true); });
+        }
+    }
+    void WritesDone() override {
+        post([this]() {
+            reactor->OnWritesDoneDone(true);
+            await_streams();
+            auto word_list = reading->mutable_wordlist();
+            std::size_t start = 0;
+            for (std::size_t i = 1; i <= audio.size(); i++) {
+                if (i < audio.size() && audio[i] == audio[start]) continue;
+                if (audio[start] != 0) {
+                    auto word = word_list->add_words();
+                    word->set_word("w" + std::to_string(audio[start]));
+                    word->set_wordindex(word_list->words_size() - 1);
+                    word->set_begintimems(start * 1000 / SAMPLE_RATE);
+                    word->set_endtimems(i * 1000 / SAMPLE_RATE);
+                }
+                start = i;
+            }
+            word_list->set_firstwordindex(0);
+            word_list->set_lastwordindex(word_list->words_size() - 1);
+            if (word_list->words_size() > 0) reactor->OnReadDone(true);
+            finish(::grpc::Status::OK);
+        });
+    }
+    void Read(::sensory::api::v1::audio::TranscribeResponse* response) override { reading = response; }
+    void AddHold(int) override { }
+    void RemoveHold() override { }
+};
+
+/// @brief An audio service that opens mock transcription streams.
+///
+/// @details
+/// The first non-zero sample of the audio of a reactor identifies the audio
+/// to the service, e.g., to fail its streams.
+///
+class MockTranscribeService {
+ private:
+    /// The executor that delivers the reactions of the streams.
+    std::unique_ptr<::sensory::util::ThreadPoolExecutor> executor;
+    /// A mutex for guarding access to the streams.
+    mutable std::mutex mutex;
+    /// The condition for waking streams once every expected stream is open.
+    mutable std::condition_variable condition;
+    /// The streams that have been opened.
+    mutable std::vector<std::unique_ptr<MockTranscribeStream>> streams;
+    /// The number of streams to fail for each audio ID.
+    mutable std::map<int16_t, int> failures;
+    /// The number of streams to open before delivering transcripts.
+    const std::size_t num_expected;
+
+ public:
+    /// @brief The reactor type for `Transcribe` streams.
+    typedef ::sensory::calldata::AwaitableBidiReactor<
+        MockTranscribeService,
+        ::sensory::api::v1::audio::TranscribeRequest,
+        ::sensory::api::v1::audio::TranscribeResponse
+    > TranscribeBidiReactor;
+
+    /// The number of streams that are in flight.
+    mutable std::atomic<int> active;
+    /// The maximal number of streams that were in flight at once.
+    mutable std::atomic<int> max_active;
+    /// The sample rate of the audio configs of the streams.
+    mutable std::atomic<uint32_t> sample_rate;
+    /// The number of streams to open before `transcribe` throws.
+    std::size_t max_streams;
+
+    /// @brief Initialize a new service.
+    ///
+    /// @param failures_ The number of streams to fail for each audio ID.
+    /// @param num_expected_ The number of streams to open before delivering
+    /// transcripts, so that the streams are in flight at once.
+    ///
+    explicit MockTranscribeService(
+        const std::map<int16_t, int>& failures_ = {},
+        const std::size_t& num_expected_ = 0
+    ) : executor(new ::sensory::util::ThreadPoolExecutor(1)),
+        failures(failures_),
+        num_expected(num_expected_),
+        active(0),
+        max_active(0),
+        sample_rate(0),
+        max_streams(std::numeric_limits<std::size_t>::max()) { }
+
+    /// @brief Wait for the reactions of the streams before destruction.
+    ~MockTranscribeService() { executor.reset(); }
+
+    /// @brief Open a mock `Transcribe` stream.
+    ///
+    /// @param reactor The reactor of the stream.
+    /// @param audio_config The audio config of the stream.
+    /// @param transcribe_config The transcription config of the stream.
+    ///
+    /// @exception std::runtime_error If `max_streams` streams are open.
+    ///
+    template<typename Reactor>
+    void transcribe(
+        Reactor* reactor,
+        ::sensory::api::v1::audio::AudioConfig* audio_config,
+        ::sensory::api::v1::audio::TranscribeConfig* transcribe_config
+    ) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Throw before taking ownership of the configs, like a service that
+        // fails to set up the context of the stream.
+        if (streams.size() >= max_streams)
+            throw std::runtime_error("too many streams");
+        transcribe_config->set_allocated_audio(audio_config);
+        sample_rate = audio_config->sampleratehertz();
+        reactor->request.set_allocated_config(transcribe_config);
+        int16_t id = 0;
+        for (const auto& sample : reactor->get_audio())
+            if (sample != 0) { id = sample; break; }
+        const bool fail = failures[id]-- > 0;
+        streams.emplace_back(new MockTranscribeStream(*executor, [this]() {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return streams.size() >= num_expected; });
+        }, active, reactor, fail));
+        condition.notify_all();
+        const int count = ++active;
+        int expected = max_active;
+        while (count > expected && !max_active.compare_exchange_weak(expected, count)) { }
+        reactor->StartWrite(&reactor->request);
+        reactor->StartRead(&reactor->response);
+    }
+
+    /// @brief Return the config of a stream.
+    ///
+    /// @param index The index of the stream in the order it was opened.
+    /// @returns The config that the stream was opened with.
+    ///
+    ::sensory::api::v1::audio::TranscribeConfig get_config(const std::size_t& index) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return streams[index]->config;
+    }
+
+    /// @brief Return the number of samples that the streams received.
+    ///
+    /// @returns The total number of samples written to every stream.
+    ///
+    std::size_t get_num_samples() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::size_t num_samples = 0;
+        for (const auto& stream : streams) num_samples += stream->audio.size();
+        return num_samples;
+    }
+};
+
+#endif  // SENSORYCLOUD_TESTS_AUDIO_MOCK_TRANSCRIBE_SERVICE_HPP_
@@ -0,0 +1,127 @@
+// Test cases and benchmarks for the mu-law encoder.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "sensorycloud/audio/mulaw.hpp"
+#include "sensorycloud/audio/simd.hpp"
+
+using ::sensory::audio::mulaw_encode;
+using ::sensory::audio::mulaw_encode_scalar;
+using ::sensory::audio::mulaw_decode;
+using ::sensory::audio::get_simd_instruction_set;
+
+TEST_CASE("mulaw_encode should match the G.711 reference codes") {
+    REQUIRE(0xFF == mulaw_encode(static_cast<int16_t>(0)));
+    REQUIRE(0x7F == mulaw_encode(static_cast<int16_t>(-1)));
+    REQUIRE(0x80 == mulaw_encode(static_cast<int16_t>(32767)));
+    REQUIRE(0x00 == mulaw_encode(static_cast<int16_t>(-32768)));
+    REQUIRE(0xEF == mulaw_encode(static_cast<int16_t>(128)));
+    REQUIRE(0x6F == mulaw_encode(static_cast<int16_t>(-128)));
+}
+
+TEST_CASE("mulaw_decode should match the G.711 reference samples") {
+    REQUIRE(0 == mulaw_decode(0xFF));
+    REQUIRE(0 == mulaw_decode(0x7F));
+    REQUIRE(32124 == mulaw_decode(0x80));
+    REQUIRE(-32124 == mulaw_decode(0x00));
+}
+
+TEST_CASE("mulaw_decode should invert mulaw_encode within the quantization step") {
+    for (int32_t sample = -32768; sample <= 32767; sample++) {
+        const int16_t decoded = mulaw_decode(mulaw_encode(static_cast<int16_t>(sample)));
+        // The step of the largest segment is 1024, and clipping adds 643.
+        const int32_t tolerance = std::abs(sample) > 32124 ? 644 : (std::abs(sample) >> 4) + 8;
+        REQUIRE(std::abs(decoded - sample) <= tolerance);
+    }
+}
+
+TEST_CASE("mulaw_decode should be a fixed point of mulaw_encode") {
+    for (int code = 0; code < 256; code++) {
+        const auto decoded = mulaw_decode(static_cast<uint8_t>(code));
+        // The two codes for zero both decode to zero, which encodes to 0xFF.
+        if (code == 0x7F) continue;
+        REQUIRE(code == mulaw_encode(decoded));
+    }
+}
+
+SCENARIO("a user wants to encode a buffer of samples with mu-law") {
+    GIVEN("every 16-bit sample value") {
+        std::vector<int16_t> samples;
+        for (int32_t sample = -32768; sample <= 32767; sample++)
+            samples.push_back(static_cast<int16_t>(sample));
+        WHEN("the samples are encoded with the " << get_simd_instruction_set() << " kernel") {
+            std::vector<uint8_t> expected(samples.size());
+            mulaw_encode_scalar(samples.data(), samples.size(), expected.data());
+            std::vector<uint8_t> actual(samples.size());
+            mulaw_encode(samples.data(), samples.size(), actual.data());
+            THEN("the codes match the scalar encoder") {
+                REQUIRE(expected == actual);
+            }
+        }
+    }
+    GIVEN("buffers with lengths and offsets that are not a multiple of the vector width") {
+        std::vector<int16_t> samples;
+        for (int i = 0; i < 200; i++)
+            samples.push_back(static_cast<int16_t>(i * 331 - 30000));
+        WHEN("the buffers are encoded") {
+            THEN("every code matches the scalar encoder and nothing else is written") {
+                for (std::size_t offset = 0; offset < 3; offset++) {
+                    for (std::size_t length = 0; length < 70; length++) {
+                        std::vector<uint8_t> actual(length + 1, 0xA5);
+                        mulaw_encode(samples.data() + offset, length, actual.data());
+                        for (std::size_t i = 0; i < length; i++)
+                            REQUIRE(mulaw_encode(samples[offset + i]) == actual[i]);
+                        REQUIRE(0xA5 == actual[length]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Run the benchmarks with `test_sensorycloud_audio_mulaw "[benchmark]"`.
+TEST_CASE("mu-law encoder throughput", "[.][benchmark]") {
+    // One second of 16kHz audio.
+    std::vector<int16_t> samples(16000);
+    uint32_t noise = 1;
+    for (auto& sample : samples) {
+        noise = noise * 1664525 + 1013904223;
+        sample = static_cast<int16_t>(noise >> 16);
+    }
+    std::vector<uint8_t> output(samples.size());
+    BENCHMARK("scalar lookup table") {
+        mulaw_encode_scalar(samples.data(), samples.size(), output.data());
+        return output[0];
+    };
+    BENCHMARK(std::string("SIMD (") + get_simd_instruction_set() + ")") {
+        mulaw_encode(samples.data(), samples.size(), output.data());
+        return output[0];
+    };
+}
@@ -0,0 +1,214 @@
+// Test cases for multi-channel transcription in the SensoryCloud C++ SDK.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "sensorycloud/audio/multi_channel_transcriber.hpp"
+#include "mock_transcribe_service.hpp"
+
+using ::sensory::api::v1::audio::TranscribeWord;
+using ::sensory::audio::MultiChannelTranscribeOptions;
+using ::sensory::audio::MultiChannelTranscriber;
+using ::sensory::audio::PCMAudio;
+using ::sensory::audio::SpeakerWord;
+using ::sensory::audio::format_speaker_transcript;
+using ::sensory::audio::get_speaker;
+using ::sensory::audio::merge_channel_transcripts;
+
+/// @brief Return a word with a name and times.
+static TranscribeWord make_word(const std::string& name, const uint64_t& begin_ms, const uint64_t& end_ms) {
+    TranscribeWord word;
+    word.set_word(name);
+    word.set_begintimems(begin_ms);
+    word.set_endtimems(end_ms);
+    return word;
+}
+
+SCENARIO("a user wants to merge the transcripts of channels") {
+    GIVEN("names for some of the speakers") {
+        const std::vector<std::string> speakers{"agent", ""};
+        THEN("channels are named after the speakers or their index") {
+            REQUIRE("agent" == get_speaker(speakers, 0));
+            REQUIRE("channel 1" == get_speaker(speakers, 1));
+            REQUIRE("channel 2" == get_speaker(speakers, 2));
+        }
+    }
+    GIVEN("the transcripts of two channels") {
+        const std::vector<std::vector<TranscribeWord>> channels{
+            {make_word("hello", 0, 300), make_word("there", 300, 600), make_word("thanks", 1500, 1800)},
+            {make_word("hi", 700, 900), make_word("bye", 1500, 1700), make_word("now", 1900, 2000)}
+        };
+        WHEN("the transcripts are merged") {
+            const auto words = merge_channel_transcripts(channels, {"agent", "customer"});
+            THEN("the words are ordered by time and ties by channel") {
+                std::vector<std::string> names;
+                for (const auto& word : words) names.push_back(word.word.word());
+                REQUIRE(std::vector<std::string>{"hello", "there", "hi", "thanks", "bye", "now"} == names);
+                REQUIRE("customer" == words[2].speaker);
+                REQUIRE(1 == words[2].channel);
+            }
+            THEN("the words are formatted as turns") {
+                REQUIRE("agent: hello there\ncustomer: hi\nagent: thanks\ncustomer: bye now" == format_speaker_transcript(words));
+            }
+        }
+        WHEN("a channel has no words") {
+            const auto words = merge_channel_transcripts({channels[0], {}}, {});
+            THEN("the transcript has one turn") {
+                REQUIRE("channel 0: hello there thanks" == format_speaker_transcript(words));
+            }
+        }
+    }
+    GIVEN("no transcripts") {
+        THEN("the transcript is empty") {
+            REQUIRE(merge_channel_transcripts({}, {}).empty());
+            REQUIRE(format_speaker_transcript({}).empty());
+        }
+    }
+}
+
+/// @brief Return stereo audio with a word on each channel in turn.
+///
+/// @details
+/// The left channel says `w10` at 0ms and `w11` at 400ms, and the right
+/// channel says `w20` at 200ms and `w21` at 600ms. Each word lasts 100ms.
+///
+static PCMAudio make_call() {
+    PCMAudio audio;
+    audio.sample_rate = SAMPLE_RATE;
+    audio.num_channels = 2;
+    audio.samples.assign(2 * SAMPLE_RATE, 0);
+    const auto say = [&](const uint32_t& channel, const int16_t& word, const std::size_t& begin_ms) {
+        for (std::size_t frame = begin_ms * 16; frame < (begin_ms + 100) * 16; frame++)
+            audio.samples[2 * frame + channel] = word;
+    };
+    say(0, 10, 0);
+    say(1, 20, 200);
+    say(0, 11, 400);
+    say(1, 21, 600);
+    return audio;
+}
+
+SCENARIO("a user wants to transcribe each channel of a call") {
+    MultiChannelTranscribeOptions options;
+    options.chunk_size = 1000;
+    options.sample_rate = SAMPLE_RATE;
+    options.transcribe_config.set_modelname("model");
+    options.speakers = {"agent", "customer"};
+    GIVEN("a stereo call and a healthy service") {
+        MockTranscribeService service({}, 2);
+        MultiChannelTranscriber<MockTranscribeService> transcriber(service, options);
+        WHEN("the call is transcribed") {
+            const auto transcript = transcriber.transcribe(make_call());
+            THEN("the streams of both channels run at once") {
+                REQUIRE(2 == service.max_active);
+            }
+            THEN("the streams are mono, offline, and use the config") {
+                for (std::size_t index = 0; index < 2; index++) {
+                    const auto config = service.get_config(index);
+                    REQUIRE(1 == config.audio().audiochannelcount());
+                    REQUIRE(SAMPLE_RATE == config.audio().sampleratehertz());
+                    REQUIRE("model" == config.modelname());
+                    REQUIRE(config.doofflinemode());
+                }
+            }
+            THEN("each channel has its own transcript") {
+                REQUIRE(transcript.ok());
+                REQUIRE(std::vector<std::string>{"w10 w11", "w20 w21"} == transcript.transcripts);
+            }
+            THEN("the transcript alternates between the speakers") {
+                REQUIRE(4 == transcript.words.size());
+                REQUIRE("agent: w10\ncustomer: w20\nagent: w11\ncustomer: w21" == transcript.to_string());
+                REQUIRE(200 == transcript.words[1].word.begintimems());
+            }
+        }
+    }
+    GIVEN("a stereo call at 8kHz") {
+        MockTranscribeService service({}, 2);
+        MultiChannelTranscriber<MockTranscribeService> transcriber(service, options);
+        auto call = make_call();
+        PCMAudio narrowband;
+        narrowband.sample_rate = 8000;
+        narrowband.num_channels = 2;
+        for (std::size_t frame = 0; frame < call.get_num_frames(); frame += 2) {
+            narrowband.samples.push_back(call.samples[2 * frame]);
+            narrowband.samples.push_back(call.samples[2 * frame + 1]);
+        }
+        WHEN("the call is transcribed") {
+            const auto transcript = transcriber.transcribe(narrowband);
+            THEN("the channels are resampled before streaming") {
+                REQUIRE(SAMPLE_RATE == service.sample_rate);
+                REQUIRE(transcript.ok());
+                REQUIRE(2 == transcript.statuses.size());
+            }
+        }
+    }
+    GIVEN("a service that fails the stream of the second channel") {
+        MockTranscribeService service({{20, 1}}, 2);
+        MultiChannelTranscriber<MockTranscribeService> transcriber(service, options);
+        WHEN("the call is transcribed") {
+            const auto transcript = transcriber.transcribe(make_call());
+            THEN("the status of each channel is reported") {
+                REQUIRE_FALSE(transcript.ok());
+                REQUIRE(transcript.statuses[0].ok());
+                REQUIRE(::grpc::StatusCode::UNAVAILABLE == transcript.statuses[1].error_code());
+            }
+            THEN("the transcript has the words of the first channel") {
+                REQUIRE("agent: w10 w11" == transcript.to_string());
+                REQUIRE("" == transcript.transcripts[1]);
+            }
+        }
+    }
+    GIVEN("a service that fails to open the stream of the second channel") {
+        MockTranscribeService service;
+        service.max_streams = 1;
+        MultiChannelTranscriber<MockTranscribeService> transcriber(service, options);
+        WHEN("the call is transcribed") {
+            THEN("the error is thrown once the open stream has completed") {
+                REQUIRE_THROWS_AS(transcriber.transcribe(make_call()), std::runtime_error);
+                REQUIRE(0 == service.active);
+            }
+        }
+    }
+    GIVEN("audio without channels") {
+        MockTranscribeService service;
+        MultiChannelTranscriber<MockTranscribeService> transcriber(service, options);
+        PCMAudio audio;
+        audio.sample_rate = SAMPLE_RATE;
+        THEN("an error is thrown") {
+            REQUIRE_THROWS_AS(transcriber.transcribe(audio), std::invalid_argument);
+        }
+    }
+    GIVEN("invalid options") {
+        MockTranscribeService service;
+        options.chunk_size = 0;
+        THEN("the transcriber cannot be initialized") {
+            REQUIRE_THROWS_AS(MultiChannelTranscriber<MockTranscribeService>(service, options), std::invalid_argument);
+        }
+    }
+}
@@ -0,0 +1,311 @@
+// Test cases for the PCM conversion and metering functions.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "sensorycloud/audio/pcm.hpp"
+#include "sensorycloud/audio/simd.hpp"
+
+using ::sensory::audio::AudioLevel;
+using ::sensory::audio::LevelMeter;
+using ::sensory::audio::PcmConverter;
+using ::sensory::audio::TpdfDither;
+using ::sensory::audio::deinterleave;
+using ::sensory::audio::deinterleave_scalar;
+using ::sensory::audio::float_to_int16;
+using ::sensory::audio::float_to_int16_scalar;
+using ::sensory::audio::get_simd_instruction_set;
+using ::sensory::audio::int32_to_int16;
+using ::sensory::audio::int32_to_int16_scalar;
+using ::sensory::audio::measure_level;
+using ::sensory::audio::measure_level_scalar;
+using ::sensory::audio::to_dbfs;
+
+/// @brief Generate a deterministic pseudo-random 32-bit value.
+///
+/// @param state The state of the generator.
+/// @returns The next value of the sequence.
+///
+static inline uint32_t next_random(uint32_t& state) {
+    state = state * 1664525 + 1013904223;
+    return state;
+}
+
+TEST_CASE("float_to_int16 should scale, round, and saturate samples") {
+    const std::vector<float> samples = {0.f, 0.5f, -0.5f, -1.f, 1.f, 1.5f, -1.5f, 0.5f / 32768, 1.5f / 32768};
+    const std::vector<int16_t> expected = {0, 16384, -16384, -32768, 32767, 32767, -32768, 0, 2};
+    std::vector<int16_t> actual(samples.size());
+    REQUIRE(3 == float_to_int16(samples.data(), samples.size(), actual.data()));
+    REQUIRE(expected == actual);
+    REQUIRE(3 == float_to_int16_scalar(samples.data(), samples.size(), actual.data()));
+    REQUIRE(expected == actual);
+}
+
+TEST_CASE("int32_to_int16 should scale, round, and saturate samples") {
+    const std::vector<int32_t> samples = {0, INT32_MIN, INT32_MAX, 0x7FFF0000, 0x12348000, 0x12358000, -0x00018000};
+    const std::vector<int16_t> expected = {0, -32768, 32767, 32767, 0x1234, 0x1236, -2};
+    std::vector<int16_t> actual(samples.size());
+    REQUIRE(1 == int32_to_int16(samples.data(), samples.size(), actual.data()));
+    REQUIRE(expected == actual);
+    REQUIRE(1 == int32_to_int16_scalar(samples.data(), samples.size(), actual.data()));
+    REQUIRE(expected == actual);
+}
+
+TEST_CASE("TpdfDither should generate zero-mean noise within one LSB") {
+    TpdfDither dither(7);
+    std::vector<float> noise(100000);
+    dither.fill(noise.data(), noise.size());
+    double sum = 0;
+    for (const auto& value : noise) {
+        REQUIRE(value > -1.f);
+        REQUIRE(value < 1.f);
+        sum += value;
+    }
+    REQUIRE(std::abs(sum / noise.size()) < 0.01);
+}
+
+SCENARIO("a user wants to convert float or 32-bit audio to 16-bit audio") {
+    GIVEN("random samples with some outside of the 16-bit range") {
+        uint32_t state = 1;
+        std::vector<float> floats(1000);
+        std::vector<int32_t> ints(1000);
+        for (std::size_t i = 0; i < floats.size(); i++) {
+            floats[i] = static_cast<int32_t>(next_random(state)) / 2147483648.f * 1.1f;
+            ints[i] = static_cast<int32_t>(next_random(state));
+        }
+        WHEN("the samples are converted with the " << get_simd_instruction_set() << " kernels") {
+            THEN("the output and clip counts match the scalar code with and without dither") {
+                for (const bool& is_dithered : {false, true}) {
+                    TpdfDither expected_dither(3);
+                    TpdfDither actual_dither(3);
+                    std::vector<int16_t> expected(floats.size());
+                    std::vector<int16_t> actual(floats.size());
+                    const auto expected_clipped = float_to_int16_scalar(floats.data(), floats.size(),
+                        expected.data(), is_dithered ? &expected_dither : nullptr);
+                    const auto actual_clipped = float_to_int16(floats.data(), floats.size(),
+                        actual.data(), is_dithered ? &actual_dither : nullptr);
+                    REQUIRE(0 < expected_clipped);
+                    REQUIRE(expected_clipped == actual_clipped);
+                    REQUIRE(expected == actual);
+                    REQUIRE(int32_to_int16_scalar(ints.data(), ints.size(), expected.data(), is_dithered ? &expected_dither : nullptr) ==
+                        int32_to_int16(ints.data(), ints.size(), actual.data(), is_dithered ? &actual_dither : nullptr));
+                    REQUIRE(expected == actual);
+                }
+            }
+        }
+        WHEN("buffers with lengths and offsets that are not a multiple of the vector width are converted") {
+            THEN("every sample matches the scalar code and nothing else is written") {
+                for (std::size_t offset = 0; offset < 3; offset++) {
+                    for (std::size_t length = 0; length < 70; length++) {
+                        std::vector<int16_t> expected(length);
+                        float_to_int16_scalar(floats.data() + offset, length, expected.data());
+                        std::vector<int16_t> actual(length + 1, 0x5A5A);
+                        float_to_int16(floats.data() + offset, length, actual.data());
+                        REQUIRE(0x5A5A == actual[length]);
+                        actual.pop_back();
+                        REQUIRE(expected == actual);
+                    }
+                }
+            }
+        }
+    }
+    GIVEN("a constant signal of a quarter of an LSB") {
+        std::vector<float> samples(10000, 0.25f / 32768);
+        WHEN("the signal is converted without dither") {
+            std::vector<int16_t> output(samples.size());
+            float_to_int16(samples.data(), samples.size(), output.data());
+            THEN("the signal is lost") {
+                for (const auto& sample : output) REQUIRE(0 == sample);
+            }
+        }
+        WHEN("the signal is converted with dither") {
+            PcmConverter converter;
+            std::vector<int16_t> output;
+            converter.convert(samples.data(), samples.size(), output);
+            THEN("the mean of the output preserves the signal") {
+                double sum = 0;
+                for (const auto& sample : output) sum += sample;
+                REQUIRE(Approx(0.25).margin(0.03) == sum / output.size());
+                REQUIRE(samples.size() == converter.get_num_samples());
+                REQUIRE(0 == converter.get_num_clipped());
+            }
+        }
+    }
+    GIVEN("a converter without dither") {
+        PcmConverter converter(false);
+        WHEN("chunks with clipped samples are converted") {
+            const std::vector<float> floats = {2.f, 0.f, -2.f};
+            const std::vector<int32_t> ints = {INT32_MAX, 0};
+            std::vector<int16_t> output;
+            REQUIRE(2 == converter.convert(floats.data(), floats.size(), output));
+            REQUIRE(3 == output.size());
+            REQUIRE(1 == converter.convert(ints.data(), ints.size(), output));
+            REQUIRE(2 == output.size());
+            THEN("the clipped samples are counted across the chunks") {
+                REQUIRE(5 == converter.get_num_samples());
+                REQUIRE(3 == converter.get_num_clipped());
+            }
+        }
+    }
+}
+
+SCENARIO("a user wants to split interleaved audio into channels") {
+    GIVEN("interleaved stereo audio") {
+        std::vector<int16_t> samples;
+        for (int i = 0; i < 200; i++)
+            samples.push_back(static_cast<int16_t>(i * 331 - 30000));
+        WHEN("buffers of every length up to the vector width and beyond are split") {
+            THEN("the channels match the scalar code and nothing else is written") {
+                for (std::size_t frames = 0; frames < 70; frames++) {
+                    std::vector<int16_t> left(frames + 1, 0x5A5A);
+                    std::vector<int16_t> right(frames + 1, 0x5A5A);
+                    int16_t* outputs[2] = {left.data(), right.data()};
+                    deinterleave(samples.data(), frames, 2, outputs);
+                    for (std::size_t i = 0; i < frames; i++) {
+                        REQUIRE(samples[2 * i] == left[i]);
+                        REQUIRE(samples[2 * i + 1] == right[i]);
+                    }
+                    REQUIRE(0x5A5A == left[frames]);
+                    REQUIRE(0x5A5A == right[frames]);
+                }
+            }
+        }
+    }
+    GIVEN("interleaved audio with three channels") {
+        const std::vector<int16_t> samples = {1, 2, 3, 4, 5, 6};
+        WHEN("the audio is split") {
+            std::vector<int16_t> a(2), b(2), c(2);
+            int16_t* outputs[3] = {a.data(), b.data(), c.data()};
+            deinterleave(samples.data(), 2, 3, outputs);
+            THEN("each channel holds its samples") {
+                REQUIRE(std::vector<int16_t>({1, 4}) == a);
+                REQUIRE(std::vector<int16_t>({2, 5}) == b);
+                REQUIRE(std::vector<int16_t>({3, 6}) == c);
+            }
+        }
+    }
+    GIVEN("zero channels") {
+        const int16_t sample = 0;
+        int16_t* outputs[1] = {nullptr};
+        THEN("an exception is thrown") {
+            REQUIRE_THROWS_AS(deinterleave(&sample, 1, 0, outputs), std::invalid_argument);
+            REQUIRE_THROWS_AS(deinterleave_scalar(&sample, 1, 0, outputs), std::invalid_argument);
+        }
+    }
+}
+
+SCENARIO("a user wants to meter the level of audio") {
+    GIVEN("an empty buffer") {
+        THEN("the level is zero") {
+            const auto level = measure_level(nullptr, 0);
+            REQUIRE(0.f == level.rms);
+            REQUIRE(0.f == level.peak);
+            REQUIRE(-120.f == to_dbfs(level.rms));
+        }
+    }
+    GIVEN("a buffer of the most negative sample") {
+        // The pairwise sums of squares are 2^31, which overflows 32-bit lanes.
+        std::vector<int16_t> samples(100, INT16_MIN);
+        THEN("the level is full scale") {
+            const auto level = measure_level(samples.data(), samples.size());
+            REQUIRE(1.f == level.rms);
+            REQUIRE(1.f == level.peak);
+            REQUIRE(Approx(0.f).margin(1e-6) == to_dbfs(level.rms));
+        }
+    }
+    GIVEN("a square wave at half scale") {
+        std::vector<int16_t> samples(100);
+        for (std::size_t i = 0; i < samples.size(); i++)
+            samples[i] = (i % 2) ? 16384 : -16384;
+        THEN("the RMS and peak are half scale") {
+            const auto level = measure_level(samples.data(), samples.size());
+            REQUIRE(0.5f == level.rms);
+            REQUIRE(0.5f == level.peak);
+            REQUIRE(Approx(-6.0206f) == to_dbfs(level.rms));
+        }
+    }
+    GIVEN("random buffers with lengths that are not a multiple of the vector width") {
+        uint32_t state = 5;
+        std::vector<int16_t> samples(1000);
+        for (auto& sample : samples) sample = static_cast<int16_t>(next_random(state) >> 16);
+        THEN("the level matches the scalar code") {
+            for (std::size_t length = 0; length < samples.size(); length += 37) {
+                const auto expected = measure_level_scalar(samples.data(), length);
+                const auto actual = measure_level(samples.data(), length);
+                REQUIRE(expected.rms == actual.rms);
+                REQUIRE(expected.peak == actual.peak);
+            }
+        }
+    }
+    GIVEN("a level meter") {
+        LevelMeter meter;
+        WHEN("a loud chunk is followed by a quiet chunk") {
+            std::vector<int16_t> loud(160, 16384);
+            std::vector<int16_t> quiet(160, 1024);
+            meter.process(loud.data(), loud.size());
+            meter.process(quiet.data(), quiet.size());
+            THEN("the level is of the quiet chunk and the peak hold of the loud chunk") {
+                REQUIRE(1024.f / 32768 == meter.get_level().rms);
+                REQUIRE(1024.f / 32768 == meter.get_level().peak);
+                REQUIRE(0.5f == meter.get_peak_hold());
+            }
+            THEN("the peak hold can be reset") {
+                meter.reset_peak_hold();
+                REQUIRE(0.f == meter.get_peak_hold());
+            }
+        }
+    }
+}
+
+// Run the benchmarks with `test_sensorycloud_audio_pcm "[benchmark]"`.
+TEST_CASE("PCM conversion and metering throughput", "[.][benchmark]") {
+    // One second of 48kHz audio.
+    std::vector<float> floats(48000);
+    uint32_t state = 1;
+    for (auto& sample : floats) sample = static_cast<int32_t>(next_random(state)) / 2147483648.f;
+    std::vector<int16_t> output(floats.size());
+    const auto kernels = std::string(" (") + get_simd_instruction_set() + ")";
+    BENCHMARK("float to int16 scalar") {
+        return float_to_int16_scalar(floats.data(), floats.size(), output.data());
+    };
+    BENCHMARK("float to int16" + kernels) {
+        return float_to_int16(floats.data(), floats.size(), output.data());
+    };
+    TpdfDither dither;
+    BENCHMARK("float to int16 with dither" + kernels) {
+        return float_to_int16(floats.data(), floats.size(), output.data(), &dither);
+    };
+    BENCHMARK("level scalar") {
+        return measure_level_scalar(output.data(), output.size()).rms;
+    };
+    BENCHMARK("level" + kernels) {
+        return measure_level(output.data(), output.size()).rms;
+    };
+}
@@ -0,0 +1,187 @@
+// Test cases for the PreRollBuffer.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "sensorycloud/audio/pre_roll_buffer.hpp"
+
+using ::sensory::audio::PreRollBuffer;
+using ::sensory::api::v1::audio::ValidateEventResponse;
+
+/// @brief Create a ramp of samples.
+///
+/// @param start The value of the first sample.
+/// @param count The number of samples.
+/// @returns The samples `start, start + 1, ..., start + count - 1`.
+///
+std::vector<int16_t> ramp(const int16_t& start, const std::size_t& count) {
+    std::vector<int16_t> samples(count);
+    for (std::size_t i = 0; i < count; i++)
+        samples[i] = static_cast<int16_t>(start + i);
+    return samples;
+}
+
+SCENARIO("A user wants to create a pre-roll buffer") {
+    GIVEN("a sample rate, length, and number of channels") {
+        WHEN("the buffer is created") {
+            PreRollBuffer buffer(16000, std::chrono::milliseconds(1500), 2);
+            THEN("the capacity holds the length of audio") {
+                REQUIRE(16000 == buffer.get_sample_rate());
+                REQUIRE(2 == buffer.get_num_channels());
+                REQUIRE(24000 == buffer.get_capacity());
+                REQUIRE(0 == buffer.get_position());
+                REQUIRE(0 == buffer.get_oldest());
+                REQUIRE_FALSE(buffer.is_closed());
+            }
+        }
+        WHEN("any of the parameters is zero") {
+            THEN("an error is thrown") {
+                REQUIRE_THROWS_AS(PreRollBuffer(0, std::chrono::milliseconds(1000)), std::invalid_argument);
+                REQUIRE_THROWS_AS(PreRollBuffer(16000, std::chrono::milliseconds(0)), std::invalid_argument);
+                REQUIRE_THROWS_AS(PreRollBuffer(16000, std::chrono::milliseconds(1000), 0), std::invalid_argument);
+            }
+        }
+    }
+}
+
+SCENARIO("A user wants to read audio from a pre-roll buffer") {
+    GIVEN("a buffer that holds 10 frames") {
+        PreRollBuffer buffer(1000, std::chrono::milliseconds(10));
+        WHEN("frames are read with a cursor across the end of the history") {
+            const auto samples = ramp(0, 16);
+            buffer.write(samples.data(), 8);
+            uint64_t cursor = 0;
+            std::vector<int16_t> output(6);
+            REQUIRE(6 == buffer.read(cursor, output.data(), 6));
+            REQUIRE(ramp(0, 6) == output);
+            buffer.write(samples.data() + 8, 8);
+            THEN("the frames are read in order from where the cursor stopped") {
+                output.assign(12, 0);
+                REQUIRE(10 == buffer.read(cursor, output.data(), 12));
+                output.resize(10);
+                REQUIRE(ramp(6, 10) == output);
+                REQUIRE(16 == cursor);
+                REQUIRE(0 == buffer.get_num_lost_frames());
+            }
+        }
+        WHEN("the reader falls behind the history") {
+            const auto samples = ramp(0, 25);
+            buffer.write(samples.data(), 25);
+            uint64_t cursor = 3;
+            std::vector<int16_t> output(10);
+            THEN("the cursor skips to the oldest frame and the gap is counted") {
+                REQUIRE(15 == buffer.get_oldest());
+                REQUIRE(10 == buffer.read(cursor, output.data(), 10));
+                REQUIRE(ramp(15, 10) == output);
+                REQUIRE(25 == cursor);
+                REQUIRE(12 == buffer.get_num_lost_frames());
+            }
+        }
+        WHEN("a chunk is requested before it has been written") {
+            uint64_t cursor = 0;
+            std::vector<int16_t> output(4);
+            THEN("nothing is read when the timeout expires") {
+                REQUIRE(0 == buffer.read_chunk(cursor, output.data(), 4, std::chrono::milliseconds(5)));
+                REQUIRE(0 == cursor);
+            }
+        }
+        WHEN("a chunk is larger than the buffer") {
+            uint64_t cursor = 0;
+            std::vector<int16_t> output(11);
+            THEN("an error is thrown") {
+                REQUIRE_THROWS_AS(buffer.read_chunk(cursor, output.data(), 11, std::chrono::milliseconds(0)), std::invalid_argument);
+            }
+        }
+        WHEN("the buffer is closed with a partial chunk remaining") {
+            const auto samples = ramp(0, 3);
+            buffer.write(samples.data(), 3);
+            buffer.close();
+            uint64_t cursor = 0;
+            std::vector<int16_t> output(4);
+            THEN("the remaining frames are read without waiting") {
+                REQUIRE(3 == buffer.read_chunk(cursor, output.data(), 4, std::chrono::milliseconds(1000)));
+                REQUIRE(0 == buffer.read_chunk(cursor, output.data(), 4, std::chrono::milliseconds(1000)));
+            }
+        }
+    }
+}
+
+SCENARIO("A user wants to hand off from wake-word detection to transcription") {
+    GIVEN("a buffer with audio before and during a detection stream") {
+        PreRollBuffer buffer(1000, std::chrono::milliseconds(2000));
+        const auto samples = ramp(0, 1500);
+        buffer.write(samples.data(), 200);
+        buffer.mark_origin();
+        buffer.write(samples.data() + 200, 1000);
+        ValidateEventResponse response;
+        response.set_success(true);
+        response.set_resultendtime(0.75);
+        WHEN("the handoff position is computed") {
+            THEN("it maps the end of the detection onto the buffer") {
+                REQUIRE(200 == buffer.get_origin());
+                REQUIRE(950 == buffer.to_position(0.75));
+                REQUIRE(950 == buffer.get_handoff_position(response));
+                REQUIRE(850 == buffer.get_handoff_position(response, std::chrono::milliseconds(100)));
+            }
+            THEN("the lead never reaches before the detection stream") {
+                REQUIRE(200 == buffer.get_handoff_position(response, std::chrono::milliseconds(5000)));
+            }
+        }
+        WHEN("the response is not a detection") {
+            response.set_success(false);
+            THEN("an error is thrown") {
+                REQUIRE_THROWS_AS(buffer.get_handoff_position(response), std::invalid_argument);
+            }
+        }
+        WHEN("a transcription reads from the handoff while audio is live") {
+            auto cursor = buffer.get_handoff_position(response);
+            std::thread writer([&]() {
+                for (std::size_t i = 1200; i < 1500; i += 30) {
+                    buffer.write(samples.data() + i, 30);
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                buffer.close();
+            });
+            std::vector<int16_t> transcribed;
+            std::vector<int16_t> chunk(64);
+            while (true) {
+                const auto count = buffer.read_chunk(cursor, chunk.data(), chunk.size(), std::chrono::milliseconds(1000));
+                if (count == 0) break;
+                transcribed.insert(transcribed.end(), chunk.begin(), chunk.begin() + count);
+            }
+            writer.join();
+            THEN("every frame after the wake word is read exactly once") {
+                REQUIRE(ramp(950, 550) == transcribed);
+                REQUIRE(1500 == cursor);
+                REQUIRE(0 == buffer.get_num_lost_frames());
+            }
+        }
+    }
+}
@@ -0,0 +1,287 @@
+// Test cases for the Resampler structure and downmix function.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "sensorycloud/audio/resampler.hpp"
+
+using ::sensory::audio::downmix;
+using ::sensory::audio::Resampler;
+
+/// The ratio of the circumference of a circle to its diameter.
+static const double PI = 3.14159265358979323846;
+
+/// @brief Generate a sine tone.
+///
+/// @param frequency The frequency of the tone in Hz.
+/// @param sample_rate The sample rate in Hz.
+/// @param num_frames The number of samples.
+/// @param amplitude The amplitude of the tone.
+/// @returns The samples of the tone.
+///
+std::vector<int16_t> make_tone(
+    const double& frequency,
+    const double& sample_rate,
+    const std::size_t& num_frames,
+    const double& amplitude = 10000
+) {
+    std::vector<int16_t> samples;
+    for (std::size_t i = 0; i < num_frames; i++)
+        samples.push_back(static_cast<int16_t>(std::lround(amplitude * std::sin(2 * PI * frequency * i / sample_rate))));
+    return samples;
+}
+
+/// @brief Fit a sine tone to samples with least squares.
+///
+/// @param samples The samples to fit the tone to.
+/// @param frequency The frequency of the tone in Hz.
+/// @param sample_rate The sample rate in Hz.
+/// @param amplitude The output amplitude of the fitted tone.
+/// @returns The RMS of the residual of the fit.
+///
+double fit_tone(
+    const std::vector<int16_t>& samples,
+    const double& frequency,
+    const double& sample_rate,
+    double& amplitude
+) {
+    double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0;
+    for (std::size_t i = 0; i < samples.size(); i++) {
+        const double s = std::sin(2 * PI * frequency * i / sample_rate);
+        const double c = std::cos(2 * PI * frequency * i / sample_rate);
+        ss += s * s; sc += s * c; cc += c * c;
+        ys += samples[i] * s; yc += samples[i] * c;
+    }
+    const double determinant = ss * cc - sc * sc;
+    const double a = (ys * cc - yc * sc) / determinant;
+    const double b = (yc * ss - ys * sc) / determinant;
+    amplitude = std::sqrt(a * a + b * b);
+    double error = 0;
+    for (std::size_t i = 0; i < samples.size(); i++) {
+        const double fit = a * std::sin(2 * PI * frequency * i / sample_rate) +
+            b * std::cos(2 * PI * frequency * i / sample_rate);
+        error += (samples[i] - fit) * (samples[i] - fit);
+    }
+    return std::sqrt(error / samples.size());
+}
+
+/// @brief Return the RMS of samples.
+///
+/// @param samples The samples to compute the RMS of.
+/// @returns The root mean square of the samples.
+///
+double rms(const std::vector<int16_t>& samples) {
+    double sum = 0;
+    for (const auto& sample : samples) sum += static_cast<double>(sample) * sample;
+    return std::sqrt(sum / samples.size());
+}
+
+SCENARIO("a user wants to downmix audio to mono") {
+    GIVEN("stereo audio with every combination of signs and parities") {
+        std::vector<int16_t> samples;
+        for (int i = 0; i < 101; i++) {
+            samples.push_back(static_cast<int16_t>(i * 657 - 32768));
+            samples.push_back(static_cast<int16_t>(32767 - i * 331));
+        }
+        WHEN("the audio is downmixed") {
+            THEN("each sample is the floor of the mean of the channels") {
+                for (std::size_t frames = 0; frames <= 101; frames++) {
+                    std::vector<int16_t> output(frames + 1, 7);
+                    downmix(samples.data(), frames, 2, output.data());
+                    for (std::size_t i = 0; i < frames; i++) {
+                        const int32_t sum = samples[2 * i] + samples[2 * i + 1];
+                        REQUIRE(static_cast<int16_t>(std::floor(sum / 2.0)) == output[i]);
+                    }
+                    REQUIRE(7 == output[frames]);
+                }
+            }
+        }
+        WHEN("the audio is downmixed in place") {
+            std::vector<int16_t> expected(101);
+            downmix(samples.data(), 101, 2, expected.data());
+            downmix(samples.data(), 101, 2, samples.data());
+            THEN("the result is the same as downmixing to a separate buffer") {
+                REQUIRE(expected == std::vector<int16_t>(samples.begin(), samples.begin() + 101));
+            }
+        }
+    }
+    GIVEN("audio with three channels") {
+        const std::vector<int16_t> samples = {1, 2, 4, -1, -2, -4, 3, 3, 3};
+        WHEN("the audio is downmixed") {
+            std::vector<int16_t> output(3);
+            downmix(samples.data(), 3, 3, output.data());
+            THEN("each sample is the floor of the mean of the channels") {
+                REQUIRE(std::vector<int16_t>({2, -3, 3}) == output);
+            }
+        }
+    }
+    GIVEN("mono audio") {
+        const std::vector<int16_t> samples = {1, -2, 3};
+        WHEN("the audio is downmixed") {
+            std::vector<int16_t> output(3);
+            downmix(samples.data(), 3, 1, output.data());
+            THEN("the samples are copied") {
+                REQUIRE(samples == output);
+            }
+        }
+    }
+    GIVEN("zero channels") {
+        THEN("an invalid argument is thrown") {
+            std::vector<int16_t> output(1);
+            REQUIRE_THROWS_AS(downmix(output.data(), 1, 0, output.data()), std::invalid_argument);
+        }
+    }
+}
+
+SCENARIO("a user wants to initialize a Resampler") {
+    GIVEN("valid parameters") {
+        Resampler resampler(44100, 16000, 2);
+        THEN("the parameters are stored") {
+            REQUIRE(44100 == resampler.get_input_rate());
+            REQUIRE(16000 == resampler.get_output_rate());
+            REQUIRE(2 == resampler.get_num_channels());
+            REQUIRE(0 < resampler.get_delay());
+        }
+    }
+    GIVEN("invalid parameters") {
+        THEN("an invalid argument is thrown") {
+            REQUIRE_THROWS_AS(Resampler(0, 16000), std::invalid_argument);
+            REQUIRE_THROWS_AS(Resampler(16000, 0), std::invalid_argument);
+            REQUIRE_THROWS_AS(Resampler(16000, 8000, 0), std::invalid_argument);
+            REQUIRE_THROWS_AS(Resampler(16000, 8000, 1, 4), std::invalid_argument);
+            REQUIRE_THROWS_AS(Resampler(16000, 8000, 1, 512), std::invalid_argument);
+            REQUIRE_THROWS_AS(Resampler(44100, 16001), std::invalid_argument);
+        }
+    }
+}
+
+SCENARIO("a user wants to resample audio with equal rates") {
+    GIVEN("a resampler from 16kHz to 16kHz") {
+        Resampler resampler(16000, 16000, 2);
+        WHEN("audio is processed") {
+            const std::vector<int16_t> samples = {1, 2, 3, 4, 5, 6};
+            std::vector<int16_t> output;
+            resampler.process(samples.data(), 3, output);
+            resampler.flush(output);
+            THEN("the audio is passed through without delay") {
+                REQUIRE(0 == resampler.get_delay());
+                REQUIRE(samples == output);
+            }
+        }
+    }
+}
+
+SCENARIO("a user wants to resample audio between common rates") {
+    const std::vector<std::pair<uint32_t, uint32_t>> rates = {
+        {8000, 16000}, {44100, 16000}, {48000, 16000}, {16000, 8000}, {22050, 16000}
+    };
+    for (const auto& rate : rates) {
+        GIVEN("a resampler from " << rate.first << "Hz to " << rate.second << "Hz") {
+            const auto input = make_tone(1000, rate.first, rate.first);
+            WHEN("a one second 1kHz tone is resampled in one chunk") {
+                Resampler resampler(rate.first, rate.second);
+                std::vector<int16_t> output;
+                resampler.process(input.data(), input.size(), output);
+                const auto num_processed = output.size();
+                resampler.flush(output);
+                THEN("the number of samples follows the ratio of the rates and the delay") {
+                    REQUIRE(rate.second == num_processed);
+                    REQUIRE(rate.second + resampler.get_delay() == output.size());
+                }
+                THEN("the tone is preserved with little distortion") {
+                    const std::vector<int16_t> steady(output.begin() + 2 * resampler.get_delay(), output.begin() + rate.second);
+                    double amplitude = 0;
+                    const double error = fit_tone(steady, 1000, rate.second, amplitude);
+                    REQUIRE(amplitude == Approx(10000).epsilon(0.01));
+                    REQUIRE(error < 10000 * 0.003);
+                }
+            }
+            WHEN("the tone is resampled in chunks of irregular size") {
+                Resampler resampler(rate.first, rate.second);
+                std::vector<int16_t> expected;
+                resampler.process(input.data(), input.size(), expected);
+                resampler.flush(expected);
+                std::vector<int16_t> output;
+                std::size_t offset = 0;
+                for (std::size_t size = 1; offset < input.size(); size = size * 3 % 1021 + 1) {
+                    const auto count = std::min(size, input.size() - offset);
+                    resampler.process(input.data() + offset, count, output);
+                    offset += count;
+                }
+                resampler.flush(output);
+                THEN("the output is identical to resampling in one chunk") {
+                    REQUIRE(expected == output);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("a user wants to resample audio without aliasing") {
+    GIVEN("a resampler from 48kHz to 16kHz") {
+        Resampler resampler(48000, 16000);
+        WHEN("a tone above the output Nyquist rate is resampled") {
+            const auto input = make_tone(12000, 48000, 48000);
+            std::vector<int16_t> output;
+            resampler.process(input.data(), input.size(), output);
+            THEN("the tone is attenuated by more than 60dB") {
+                const std::vector<int16_t> steady(output.begin() + 2 * resampler.get_delay(), output.end());
+                REQUIRE(rms(steady) < 10000 / std::sqrt(2) / 1000);
+            }
+        }
+    }
+}
+
+SCENARIO("a user wants to resample multi-channel audio") {
+    GIVEN("a resampler from 8kHz to 16kHz with two channels") {
+        Resampler stereo(8000, 16000, 2);
+        Resampler mono(8000, 16000, 1);
+        const auto left = make_tone(440, 8000, 800);
+        const auto right = make_tone(1000, 8000, 800, 5000);
+        std::vector<int16_t> interleaved;
+        for (std::size_t i = 0; i < left.size(); i++) {
+            interleaved.push_back(left[i]);
+            interleaved.push_back(right[i]);
+        }
+        WHEN("the audio is resampled") {
+            std::vector<int16_t> output, expected_left, expected_right;
+            stereo.process(interleaved.data(), left.size(), output);
+            mono.process(left.data(), left.size(), expected_left);
+            mono.reset();
+            mono.process(right.data(), right.size(), expected_right);
+            THEN("each channel is resampled independently") {
+                REQUIRE(2 * expected_left.size() == output.size());
+                for (std::size_t i = 0; i < expected_left.size(); i++) {
+                    REQUIRE(expected_left[i] == output[2 * i]);
+                    REQUIRE(expected_right[i] == output[2 * i + 1]);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,433 @@
+// Test cases for the sensory::audio::ResumableStream class.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <grpcpp/support/sync_stream.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sensorycloud/audio/resumable_stream.hpp"
+#include "sensorycloud/util/transcript_aggregator.hpp"
+
+using ::sensory::audio::ResumableStream;
+using ::sensory::audio::ResumableStreamOptions;
+using ::sensory::audio::find_resume_point;
+using ::sensory::audio::shift_response;
+using ::sensory::util::TranscriptAggregator;
+using ::sensory::api::v1::audio::TranscribeRequest;
+using ::sensory::api::v1::audio::TranscribeResponse;
+using ::sensory::api::v1::audio::TranscribeWord;
+using ::sensory::api::v1::audio::ValidateEventResponse;
+
+/// The sample rate of the test audio, one frame per millisecond.
+static constexpr uint32_t SAMPLE_RATE = 1000;
+
+/// @brief A mock `Transcribe` stream that recognizes runs of constant,
+/// non-zero samples as words named after the sample value.
+class MockStream : public ::grpc::ClientReaderWriterInterface<TranscribeRequest, TranscribeResponse> {
+ private:
+    /// The mutex for guarding the state of the stream.
+    std::mutex mutex;
+    /// The condition for waking the reader.
+    std::condition_variable condition;
+    /// The audio that the stream received.
+    std::vector<int16_t> audio;
+    /// The responses that have not been read.
+    std::deque<TranscribeResponse> responses;
+    /// The number of writes before the stream fails, negative to never fail.
+    int writes_until_failure;
+    /// The status of the stream after a failure.
+    ::grpc::Status failure;
+    /// Whether the stream failed.
+    bool failed = false;
+    /// Whether the stream has ended.
+    bool ended = false;
+    /// Whether the stream received a `FINAL` post-processing action.
+    bool final_received = false;
+
+ public:
+    /// @brief Initialize a new mock stream.
+    ///
+    /// @param writes_until_failure_ The number of writes before the stream
+    /// fails, negative to never fail.
+    /// @param failure_ The status of the stream after a failure.
+    ///
+    MockStream(const int& writes_until_failure_, const ::grpc::Status& failure_) :
+        writes_until_failure(writes_until_failure_), failure(failure_) { }
+
+    void WaitForInitialMetadata() override { }
+
+    bool NextMessageSize(uint32_t* size) override {
+        *size = UINT32_MAX;
+        return true;
+    }
+
+    bool Read(TranscribeResponse* response) override {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&]() { return !responses.empty() || ended; });
+        if (responses.empty()) return false;
+        *response = responses.front();
+        responses.pop_front();
+        return true;
+    }
+
+    bool Write(const TranscribeRequest& request, ::grpc::WriteOptions) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (failed || ended) return false;
+        if (writes_until_failure-- == 0) {
+            failed = ended = true;
+            condition.notify_all();
+            return false;
+        }
+        const auto& content = request.audiocontent();
+        const auto samples = reinterpret_cast<const int16_t*>(content.data());
+        audio.insert(audio.end(), samples, samples + content.size() / sizeof(int16_t));
+        if (request.has_postprocessingaction() &&
+            request.postprocessingaction().action() == ::sensory::api::v1::audio::FINAL)
+            final_received = true;
+        TranscribeResponse response;
+        auto word_list = response.mutable_wordlist();
+        std::size_t start = 0;
+        for (std::size_t i = 1; i <= audio.size(); i++) {
+            if (i < audio.size() && audio[i] == audio[start]) continue;
+            if (audio[start] != 0) {
+                auto word = word_list->add_words();
+                word->set_word("w" + std::to_string(audio[start]));
+                word->set_begintimems(start * 1000 / SAMPLE_RATE);
+                word->set_endtimems(i * 1000 / SAMPLE_RATE);
+                word->set_wordindex(word_list->words_size() - 1);
+            }
+            start = i;
+        }
+        word_list->set_firstwordindex(0);
+        word_list->set_lastwordindex(word_list->words_size() > 0 ? word_list->words_size() - 1 : 0);
+        responses.push_back(response);
+        condition.notify_all();
+        return true;
+    }
+
+    bool WritesDone() override {
+        std::lock_guard<std::mutex> lock(mutex);
+        ended = true;
+        condition.notify_all();
+        return !failed;
+    }
+
+    ::grpc::Status Finish() override {
+        std::lock_guard<std::mutex> lock(mutex);
+        return failed ? failure : ::grpc::Status::OK;
+    }
+
+    /// @brief Return the number of samples that the stream received.
+    std::size_t get_num_samples() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return audio.size();
+    }
+
+    /// @brief Return whether the stream received a `FINAL` action.
+    bool is_final_received() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return final_received;
+    }
+};
+
+/// @brief A factory of `MockStream`s that keeps shared ownership of them.
+struct MockOpener {
+    /// The streams that were opened.
+    std::vector<std::shared_ptr<MockStream>> streams;
+    /// The number of writes before each stream fails, by stream index.
+    std::vector<int> failures;
+    /// The status of a failed stream.
+    ::grpc::Status failure = ::grpc::Status(::grpc::StatusCode::UNAVAILABLE, "mock failure");
+    /// The maximal number of streams to open.
+    std::size_t max_streams = 16;
+
+    /// @brief A stream that forwards to a shared `MockStream`.
+    class Handle : public ::grpc::ClientReaderWriterInterface<TranscribeRequest, TranscribeResponse> {
+        std::shared_ptr<MockStream> stream;
+     public:
+        explicit Handle(const std::shared_ptr<MockStream>& stream_) : stream(stream_) { }
+        void WaitForInitialMetadata() override { stream->WaitForInitialMetadata(); }
+        bool NextMessageSize(uint32_t* size) override { return stream->NextMessageSize(size); }
+        bool Read(TranscribeResponse* response) override { return stream->Read(response); }
+        bool Write(const TranscribeRequest& request, ::grpc::WriteOptions options) override { return stream->Write(request, options); }
+        bool WritesDone() override { return stream->WritesDone(); }
+        ::grpc::Status Finish() override { return stream->Finish(); }
+    };
+
+    /// @brief Return the function that opens the mock streams.
+    ResumableStream<TranscribeRequest, TranscribeResponse>::Opener get() {
+        return [this](::grpc::ClientContext*) {
+            ResumableStream<TranscribeRequest, TranscribeResponse>::Stream stream;
+            if (streams.size() >= max_streams) return stream;
+            const auto index = streams.size();
+            streams.push_back(std::make_shared<MockStream>(index < failures.size() ? failures[index] : -1, failure));
+            stream.reset(new Handle(streams.back()));
+            return stream;
+        };
+    }
+};
+
+/// @brief Create a request with audio of a constant value.
+///
+/// @param value The value of the samples.
+/// @param num_samples The number of samples.
+/// @returns The request with the audio.
+///
+TranscribeRequest make_request(const int16_t& value, const std::size_t& num_samples) {
+    std::vector<int16_t> samples(num_samples, value);
+    TranscribeRequest request;
+    request.set_audiocontent(reinterpret_cast<const char*>(samples.data()), samples.size() * sizeof(int16_t));
+    return request;
+}
+
+/// @brief Stream words of 100ms with 50ms of silence after each, in chunks
+/// of 50ms, and collect the transcript on another thread.
+///
+/// @param stream The stream to write to and read from.
+/// @param num_words The number of words to write.
+/// @param aggregator The aggregator to collect the transcript in.
+/// @returns The number of writes that failed.
+///
+std::size_t stream_words(ResumableStream<TranscribeRequest, TranscribeResponse>& stream,
+    const int& num_words,
+    TranscriptAggregator& aggregator
+) {
+    std::thread reader([&]() {
+        TranscribeResponse response;
+        while (stream.Read(&response))
+            aggregator.process_response(response.wordlist());
+    });
+    std::size_t num_failures = 0;
+    for (int word = 1; word <= num_words; word++) {
+        num_failures += !stream.Write(make_request(word, 50));
+        num_failures += !stream.Write(make_request(word, 50));
+        num_failures += !stream.Write(make_request(0, 50));
+    }
+    num_failures += !stream.WritesDone();
+    reader.join();
+    return num_failures;
+}
+
+SCENARIO("A resume point is requested from a transcript") {
+    GIVEN("a transcript with words from 0ms-100ms and 150ms-250ms") {
+        std::vector<TranscribeWord> words(2);
+        words[0].set_begintimems(0);
+        words[0].set_endtimems(100);
+        words[1].set_begintimems(150);
+        words[1].set_endtimems(250);
+        std::size_t num_kept = 0;
+        WHEN("the earliest replayable audio is in a gap") {
+            const auto resume_ms = find_resume_point(words, 120, num_kept);
+            THEN("the resume point is the earliest audio") {
+                REQUIRE(120 == resume_ms);
+                REQUIRE(1 == num_kept);
+            }
+        }
+        WHEN("the earliest replayable audio is inside a word") {
+            const auto resume_ms = find_resume_point(words, 200, num_kept);
+            THEN("the resume point moves to the end of the word") {
+                REQUIRE(250 == resume_ms);
+                REQUIRE(2 == num_kept);
+            }
+        }
+        WHEN("all of the audio is replayable") {
+            const auto resume_ms = find_resume_point(words, 0, num_kept);
+            THEN("no words are kept") {
+                REQUIRE(0 == resume_ms);
+                REQUIRE(0 == num_kept);
+            }
+        }
+    }
+}
+
+SCENARIO("Responses are shifted into the time of a logical stream") {
+    GIVEN("a transcription response") {
+        TranscribeResponse response;
+        auto word = response.mutable_wordlist()->add_words();
+        word->set_begintimems(10);
+        word->set_endtimems(20);
+        word->set_wordindex(0);
+        response.mutable_wordlist()->set_firstwordindex(0);
+        response.mutable_wordlist()->set_lastwordindex(0);
+        WHEN("the response is shifted") {
+            shift_response(response, 1000, 3);
+            THEN("the times and word indexes are shifted") {
+                REQUIRE(1010 == response.wordlist().words(0).begintimems());
+                REQUIRE(1020 == response.wordlist().words(0).endtimems());
+                REQUIRE(3 == response.wordlist().words(0).wordindex());
+                REQUIRE(3 == response.wordlist().firstwordindex());
+                REQUIRE(3 == response.wordlist().lastwordindex());
+            }
+        }
+    }
+    GIVEN("a successful event validation response") {
+        ValidateEventResponse response;
+        response.set_success(true);
+        response.set_resultstarttime(0.5f);
+        response.set_resultendtime(1.f);
+        WHEN("the response is shifted") {
+            shift_response(response, 2000, 3);
+            THEN("the times are shifted in seconds") {
+                REQUIRE(Approx(2.5f) == response.resultstarttime());
+                REQUIRE(Approx(3.f) == response.resultendtime());
+            }
+        }
+    }
+}
+
+SCENARIO("A resumable stream is initialized with invalid options") {
+    GIVEN("options with zero channels") {
+        MockOpener opener;
+        ResumableStreamOptions options;
+        options.num_channels = 0;
+        WHEN("the stream is initialized") {
+            THEN("an exception is thrown") {
+                REQUIRE_THROWS_AS((ResumableStream<TranscribeRequest, TranscribeResponse>(opener.get(), options)), std::invalid_argument);
+            }
+        }
+    }
+    GIVEN("an opener that fails") {
+        MockOpener opener;
+        opener.max_streams = 0;
+        WHEN("the stream is initialized") {
+            THEN("an exception is thrown") {
+                REQUIRE_THROWS_AS((ResumableStream<TranscribeRequest, TranscribeResponse>(opener.get(), ResumableStreamOptions())), std::runtime_error);
+            }
+        }
+    }
+}
+
+SCENARIO("A resumable stream recovers from a transient failure") {
+    GIVEN("a stream that fails with UNAVAILABLE after one second of audio") {
+        MockOpener opener;
+        opener.failures = {20};
+        ResumableStreamOptions options;
+        options.sample_rate = SAMPLE_RATE;
+        options.replay_duration = std::chrono::milliseconds(1000);
+        options.reconnect_backoff = std::chrono::milliseconds(1);
+        ResumableStream<TranscribeRequest, TranscribeResponse> stream(opener.get(), options);
+        WHEN("ten words are streamed") {
+            TranscriptAggregator aggregator;
+            const auto num_failures = stream_words(stream, 10, aggregator);
+            THEN("the stream is reopened once and finishes successfully") {
+                REQUIRE(0 == num_failures);
+                REQUIRE(1 == stream.get_num_reconnects());
+                REQUIRE(2 == opener.streams.size());
+                REQUIRE(stream.Finish().ok());
+            }
+            THEN("the audio is replayed from the end of the word that spans the oldest retained audio") {
+                // 1050ms were written when the first stream failed, so 50ms
+                // were dropped from the replay buffer; the word at 0ms-100ms
+                // spans that point and is kept.
+                REQUIRE(1000 == opener.streams[0]->get_num_samples());
+                REQUIRE(1500 - 100 == opener.streams[1]->get_num_samples());
+            }
+            THEN("the transcript is complete and in the time of the logical stream") {
+                REQUIRE("w1 w2 w3 w4 w5 w6 w7 w8 w9 w10" == aggregator.get_transcript());
+                const auto& words = aggregator.get_word_list();
+                for (std::size_t i = 0; i < words.size(); i++) {
+                    REQUIRE(i == words[i].wordindex());
+                    REQUIRE(150 * i == words[i].begintimems());
+                    REQUIRE(150 * i + 100 == words[i].endtimems());
+                }
+            }
+        }
+    }
+    GIVEN("a stream that fails after a FINAL post-processing action") {
+        MockOpener opener;
+        opener.failures = {2};
+        ResumableStreamOptions options;
+        options.sample_rate = SAMPLE_RATE;
+        options.reconnect_backoff = std::chrono::milliseconds(1);
+        ResumableStream<TranscribeRequest, TranscribeResponse> stream(opener.get(), options);
+        WHEN("audio and the action are written") {
+            std::thread reader([&]() {
+                TranscribeResponse response;
+                while (stream.Read(&response)) continue;
+            });
+            REQUIRE(stream.Write(make_request(1, 50)));
+            auto request = make_request(0, 50);
+            request.mutable_postprocessingaction()->set_action(::sensory::api::v1::audio::FINAL);
+            REQUIRE(stream.Write(request));
+            REQUIRE(stream.Write(make_request(0, 50)));
+            REQUIRE(stream.WritesDone());
+            reader.join();
+            THEN("the action is replayed on the new stream") {
+                REQUIRE(2 == opener.streams.size());
+                REQUIRE(opener.streams[1]->is_final_received());
+                REQUIRE(150 == opener.streams[1]->get_num_samples());
+            }
+        }
+    }
+}
+
+SCENARIO("A resumable stream fails permanently") {
+    GIVEN("a stream that fails with a status that is not retryable") {
+        MockOpener opener;
+        opener.failures = {5};
+        opener.failure = ::grpc::Status(::grpc::StatusCode::INVALID_ARGUMENT, "bad audio");
+        ResumableStreamOptions options;
+        options.sample_rate = SAMPLE_RATE;
+        options.reconnect_backoff = std::chrono::milliseconds(1);
+        ResumableStream<TranscribeRequest, TranscribeResponse> stream(opener.get(), options);
+        WHEN("words are streamed") {
+            TranscriptAggregator aggregator;
+            const auto num_failures = stream_words(stream, 4, aggregator);
+            THEN("the stream is not reopened and the status is returned") {
+                REQUIRE(0 < num_failures);
+                REQUIRE(0 == stream.get_num_reconnects());
+                REQUIRE(1 == opener.streams.size());
+                REQUIRE(::grpc::StatusCode::INVALID_ARGUMENT == stream.Finish().error_code());
+            }
+        }
+    }
+    GIVEN("a stream that cannot be reopened") {
+        MockOpener opener;
+        opener.failures = {5};
+        opener.max_streams = 1;
+        ResumableStreamOptions options;
+        options.sample_rate = SAMPLE_RATE;
+        options.max_reconnects = 2;
+        options.reconnect_backoff = std::chrono::milliseconds(1);
+        ResumableStream<TranscribeRequest, TranscribeResponse> stream(opener.get(), options);
+        WHEN("words are streamed") {
+            TranscriptAggregator aggregator;
+            const auto num_failures = stream_words(stream, 4, aggregator);
+            THEN("the stream ends with the status of the failure") {
+                REQUIRE(0 < num_failures);
+                REQUIRE(0 == stream.get_num_reconnects());
+                REQUIRE(::grpc::StatusCode::UNAVAILABLE == stream.Finish().error_code());
+            }
+        }
+    }
+}
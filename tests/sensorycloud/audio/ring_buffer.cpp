@@ -0,0 +1,160 @@
+// Test cases for the AudioRingBuffer and AudioCaptureAdapter.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "sensorycloud/audio/ring_buffer.hpp"
+
+using ::sensory::audio::AudioCaptureAdapter;
+using ::sensory::audio::AudioRingBuffer;
+
+/// @brief A stand-in for `PaStreamCallbackTimeInfo`.
+struct MockTimeInfo {
+    double inputBufferAdcTime;
+    double currentTime;
+    double outputBufferDacTime;
+};
+
+SCENARIO("A user wants to buffer captured audio in a ring") {
+    GIVEN("a stereo ring with a capacity that is not a power of two") {
+        AudioRingBuffer ring(6, 2);
+        THEN("the capacity is rounded up to a power of two") {
+            REQUIRE(8 == ring.capacity());
+            REQUIRE(2 == ring.get_num_channels());
+            REQUIRE(0 == ring.size());
+        }
+        WHEN("frames are written and read across the end of the ring") {
+            const std::vector<int16_t> first = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+            const std::vector<int16_t> second = {13, 14, 15, 16, 17, 18, 19, 20, 21, 22};
+            REQUIRE(6 == ring.write(first.data(), 6));
+            std::vector<int16_t> output(12);
+            REQUIRE(6 == ring.read(output.data(), 6));
+            REQUIRE(first == output);
+            REQUIRE(5 == ring.write(second.data(), 5));
+            THEN("the frames are read back in order") {
+                output.assign(10, 0);
+                REQUIRE(ring.try_read_chunk(output.data(), 5));
+                REQUIRE(second == output);
+                REQUIRE(0 == ring.size());
+            }
+        }
+        WHEN("more frames are written than fit") {
+            const std::vector<int16_t> samples(20, 7);
+            REQUIRE(8 == ring.write(samples.data(), 10));
+            REQUIRE(0 == ring.write(samples.data(), 1));
+            THEN("the newest frames are dropped and counted") {
+                REQUIRE(8 == ring.size());
+                REQUIRE(2 == ring.get_num_overruns());
+                REQUIRE(3 == ring.get_num_dropped_frames());
+            }
+        }
+        WHEN("a chunk is requested before it has been captured") {
+            const std::vector<int16_t> samples(6, 1);
+            ring.write(samples.data(), 3);
+            std::vector<int16_t> output(8, 0);
+            THEN("nothing is read and an underrun is counted") {
+                REQUIRE_FALSE(ring.try_read_chunk(output.data(), 4));
+                REQUIRE(1 == ring.get_num_underruns());
+                REQUIRE(3 == ring.size());
+            }
+            THEN("waiting for the chunk times out") {
+                REQUIRE_FALSE(ring.read_chunk(output.data(), 4, std::chrono::milliseconds(5)));
+                REQUIRE(1 == ring.get_num_underruns());
+            }
+            THEN("a partial read returns the buffered frames") {
+                REQUIRE(3 == ring.read(output.data(), 4));
+                REQUIRE(0 == ring.get_num_underruns());
+            }
+        }
+    }
+    GIVEN("invalid parameters") {
+        THEN("errors are thrown") {
+            REQUIRE_THROWS_AS(AudioRingBuffer(0), std::invalid_argument);
+            REQUIRE_THROWS_AS(AudioRingBuffer(16, 0), std::invalid_argument);
+        }
+    }
+}
+
+SCENARIO("A user wants to stream captured audio between threads") {
+    GIVEN("a producer and a consumer of a small ring") {
+        AudioRingBuffer ring(64);
+        const std::size_t NUM_FRAMES = 100000;
+        const std::size_t CHUNK_SIZE = 37;
+        WHEN("the producer writes blocks as the consumer drains chunks") {
+            std::thread producer([&ring, NUM_FRAMES]() {
+                std::vector<int16_t> block(16);
+                std::size_t position = 0;
+                while (position < NUM_FRAMES) {
+                    const std::size_t size = std::min<std::size_t>(block.size(), NUM_FRAMES - position);
+                    for (std::size_t i = 0; i < size; i++)
+                        block[i] = static_cast<int16_t>(position + i);
+                    // Retry instead of dropping to verify the ordering.
+                    position += ring.write(block.data(), size);
+                }
+            });
+            std::vector<int16_t> chunk(CHUNK_SIZE);
+            std::size_t position = 0;
+            bool in_order = true;
+            while (NUM_FRAMES - position >= CHUNK_SIZE) {
+                if (!ring.read_chunk(chunk.data(), CHUNK_SIZE, std::chrono::milliseconds(1000), std::chrono::microseconds(10)))
+                    break;
+                for (std::size_t i = 0; i < CHUNK_SIZE; i++)
+                    in_order &= chunk[i] == static_cast<int16_t>(position + i);
+                position += CHUNK_SIZE;
+            }
+            producer.join();
+            THEN("every frame arrives in order") {
+                REQUIRE(in_order);
+                REQUIRE(NUM_FRAMES / CHUNK_SIZE * CHUNK_SIZE == position);
+                REQUIRE(NUM_FRAMES % CHUNK_SIZE == ring.size());
+            }
+        }
+    }
+}
+
+SCENARIO("A user wants to fill a ring from a capture callback") {
+    GIVEN("an adapter for a mono ring") {
+        AudioRingBuffer ring(16);
+        AudioCaptureAdapter adapter(ring);
+        REQUIRE(&ring == &adapter.get_ring());
+        WHEN("the callback receives blocks of audio") {
+            const std::vector<int16_t> samples = {1, 2, 3, 4};
+            MockTimeInfo time_info;
+            REQUIRE(0 == AudioCaptureAdapter::callback<MockTimeInfo>(samples.data(), nullptr, 4, &time_info, 0, &adapter));
+            REQUIRE(0 == AudioCaptureAdapter::callback<MockTimeInfo>(samples.data(), nullptr, 4, &time_info, AudioCaptureAdapter::INPUT_OVERFLOW, &adapter));
+            REQUIRE(0 == AudioCaptureAdapter::callback<MockTimeInfo>(nullptr, nullptr, 4, &time_info, 0, &adapter));
+            THEN("the audio is written to the ring and the callbacks are counted") {
+                REQUIRE(8 == ring.size());
+                REQUIRE(3 == adapter.get_num_callbacks());
+                REQUIRE(1 == adapter.get_num_input_overflows());
+            }
+        }
+    }
+}
@@ -0,0 +1,293 @@
+// Test cases for the speech sinks.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <grpcpp/test/mock_stream.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sensorycloud/audio/speech_sink.hpp"
+#include "sensorycloud/audio/wav.hpp"
+
+using ::grpc::testing::MockClientReader;
+using ::sensory::api::v1::audio::AudioConfig_AudioEncoding_FLAC;
+using ::sensory::api::v1::audio::SynthesizeSpeechResponse;
+using ::sensory::audio::AudioPlaybackAdapter;
+using ::sensory::audio::AudioRingBuffer;
+using ::sensory::audio::PlaybackSink;
+using ::sensory::audio::SpeechSink;
+using ::sensory::audio::WavFileSink;
+using ::sensory::audio::read_wav;
+using ::sensory::audio::stream_speech;
+using ::sensory::audio::write_wav_header;
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::Return;
+using ::testing::SetArgPointee;
+
+/// @brief A sink that records the audio it receives.
+class RecordingSink : public SpeechSink {
+ protected:
+    void on_format(const uint32_t& sample_rate_, const uint32_t& num_channels_) override {
+        formats.push_back({sample_rate_, num_channels_});
+    }
+    void on_samples(const int16_t* samples_, const std::size_t& num_frames_) override {
+        samples.insert(samples.end(), samples_, samples_ + num_frames_ * get_num_channels());
+        chunks.push_back(num_frames_);
+    }
+    void on_finish() override { finishes++; }
+
+ public:
+    /// The formats that were received.
+    std::vector<std::vector<uint32_t>> formats;
+    /// The samples that were received.
+    std::vector<int16_t> samples;
+    /// The number of frames in each call to `on_samples`.
+    std::vector<std::size_t> chunks;
+    /// The number of times that the audio finished.
+    int finishes = 0;
+
+    /// @brief Initialize a new recording sink.
+    ///
+    /// @param sample_rate_ The default sample rate of the sink.
+    ///
+    explicit RecordingSink(const uint32_t& sample_rate_ = 0) : SpeechSink(sample_rate_) { }
+};
+
+/// @brief Encode samples as little-endian bytes.
+///
+/// @param samples The samples to encode.
+/// @returns The bytes of the samples.
+///
+std::string to_bytes(const std::vector<int16_t>& samples) {
+    std::string bytes;
+    for (const auto& sample : samples) {
+        bytes.push_back(static_cast<char>(static_cast<uint16_t>(sample) & 0xFF));
+        bytes.push_back(static_cast<char>(static_cast<uint16_t>(sample) >> 8));
+    }
+    return bytes;
+}
+
+/// @brief Create a response with an audio config.
+///
+/// @param sample_rate The sample rate of the config.
+/// @param num_channels The number of channels of the config.
+/// @returns The response.
+///
+SynthesizeSpeechResponse make_config(const uint32_t& sample_rate, const uint32_t& num_channels = 1) {
+    SynthesizeSpeechResponse response;
+    response.mutable_config()->set_sampleratehertz(sample_rate);
+    response.mutable_config()->set_audiochannelcount(num_channels);
+    return response;
+}
+
+/// @brief Create a response with audio content.
+///
+/// @param bytes The audio content of the response.
+/// @returns The response.
+///
+SynthesizeSpeechResponse make_audio(const std::string& bytes) {
+    SynthesizeSpeechResponse response;
+    response.set_audiocontent(bytes);
+    return response;
+}
+
+SCENARIO("A user wants to consume synthesized speech as it arrives") {
+    const std::vector<int16_t> samples = {0, 1, -1, 256, -256, 32767, -32768, 12345};
+    GIVEN("a recording sink") {
+        RecordingSink sink;
+        WHEN("raw PCM arrives after an audio config") {
+            sink.process(make_config(22050));
+            const auto bytes = to_bytes(samples);
+            sink.process(make_audio(bytes.substr(0, 5)));
+            sink.process(make_audio(bytes.substr(5)));
+            sink.finish();
+            THEN("the samples are reassembled across chunks") {
+                REQUIRE(std::vector<std::vector<uint32_t>>({{22050, 1}}) == sink.formats);
+                REQUIRE(samples == sink.samples);
+                REQUIRE(std::vector<std::size_t>({2, 6}) == sink.chunks);
+                REQUIRE(8 == sink.get_num_frames());
+                REQUIRE(1 == sink.finishes);
+                REQUIRE(sink.get_time_to_first_audio() > std::chrono::microseconds(0));
+            }
+        }
+        WHEN("a WAV file arrives one byte at a time") {
+            std::ostringstream wav;
+            write_wav_header(wav, 24000, 2, 0);
+            wav << to_bytes(samples);
+            const auto bytes = wav.str();
+            for (const auto& byte : bytes) sink.write(&byte, 1);
+            sink.finish();
+            THEN("the header is parsed and stripped") {
+                REQUIRE(std::vector<std::vector<uint32_t>>({{24000, 2}}) == sink.formats);
+                REQUIRE(samples == sink.samples);
+                REQUIRE(4 == sink.get_num_frames());
+            }
+        }
+        WHEN("audio arrives without a format") {
+            THEN("an error is thrown") {
+                REQUIRE_THROWS_AS(sink.process(make_audio(to_bytes(samples))), std::runtime_error);
+            }
+        }
+        WHEN("the config describes compressed audio") {
+            auto response = make_config(22050);
+            response.mutable_config()->set_encoding(AudioConfig_AudioEncoding_FLAC);
+            THEN("an error is thrown") {
+                REQUIRE_THROWS_AS(sink.process(response), std::runtime_error);
+            }
+        }
+        WHEN("audio arrives after the sink finished") {
+            sink.finish();
+            sink.finish();
+            THEN("an error is thrown") {
+                REQUIRE(1 == sink.finishes);
+                REQUIRE_THROWS_AS(sink.process(make_audio("ab")), std::runtime_error);
+            }
+        }
+    }
+    GIVEN("a recording sink with a default sample rate") {
+        RecordingSink sink(16000);
+        WHEN("a single sample arrives without a format") {
+            sink.write("\x01\x02", 2);
+            sink.finish();
+            THEN("the default format is used") {
+                REQUIRE(std::vector<std::vector<uint32_t>>({{16000, 1}}) == sink.formats);
+                REQUIRE(std::vector<int16_t>({0x0201}) == sink.samples);
+            }
+        }
+    }
+}
+
+SCENARIO("A user wants to write synthesized speech to a WAV file") {
+    const std::string path = "test_speech_sink.wav";
+    const std::vector<int16_t> samples = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    GIVEN("a WAV file sink") {
+        WavFileSink sink(path);
+        REQUIRE(path == sink.get_path());
+        sink.process(make_config(22050));
+        sink.process(make_audio(to_bytes(samples)));
+        WHEN("the stream is still open") {
+            THEN("the audio written so far can be read") {
+                const auto audio = read_wav(path);
+                REQUIRE(22050 == audio.sample_rate);
+                REQUIRE(samples == audio.samples);
+            }
+        }
+        WHEN("the stream finishes") {
+            sink.finish();
+            THEN("the sizes in the header are patched") {
+                std::ifstream file(path, std::ios::binary);
+                const std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+                REQUIRE(64 == bytes.size());
+                REQUIRE(20 == static_cast<uint8_t>(bytes[40]));
+                REQUIRE(56 == static_cast<uint8_t>(bytes[4]));
+                REQUIRE(samples == read_wav(path).samples);
+            }
+        }
+    }
+    std::remove(path.c_str());
+}
+
+SCENARIO("A user wants to play synthesized speech as it arrives") {
+    GIVEN("a playback sink and a playback adapter on a small ring") {
+        AudioRingBuffer ring(8);
+        AudioPlaybackAdapter adapter(ring);
+        PlaybackSink sink(ring, 16000, std::chrono::milliseconds(2000));
+        WHEN("more audio arrives than fits in the ring while it plays") {
+            std::vector<int16_t> samples(100);
+            for (std::size_t i = 0; i < samples.size(); i++) samples[i] = static_cast<int16_t>(i + 1);
+            std::vector<int16_t> played;
+            std::thread playback([&]() {
+                std::vector<int16_t> block(4);
+                while (played.size() < samples.size()) {
+                    adapter.play(block.data(), block.size());
+                    for (const auto& sample : block)
+                        if (sample != 0) played.push_back(sample);
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            });
+            sink.process(make_audio(to_bytes(samples)));
+            playback.join();
+            THEN("the sink waits for space and nothing is dropped") {
+                REQUIRE(samples == played);
+                REQUIRE(0 == ring.get_num_overruns());
+            }
+        }
+        WHEN("playback stalls") {
+            PlaybackSink impatient(ring, 16000, std::chrono::milliseconds(5));
+            impatient.process(make_audio(to_bytes(std::vector<int16_t>(12, 1))));
+            THEN("the audio that does not fit is dropped after the timeout") {
+                REQUIRE(8 == ring.size());
+                REQUIRE(4 == ring.get_num_dropped_frames());
+            }
+        }
+        WHEN("the adapter plays from an empty ring") {
+            std::vector<int16_t> block(4, 7);
+            REQUIRE(0 == AudioPlaybackAdapter::callback<void>(nullptr, block.data(), 4, nullptr, 0, &adapter));
+            THEN("silence is played and the underflow is counted") {
+                REQUIRE(std::vector<int16_t>(4, 0) == block);
+                REQUIRE(1 == adapter.get_num_underflows());
+                REQUIRE(4 == adapter.get_num_silent_frames());
+            }
+        }
+    }
+    GIVEN("a stereo ring and mono audio") {
+        AudioRingBuffer ring(8, 2);
+        PlaybackSink sink(ring, 16000);
+        THEN("an error is thrown") {
+            sink.process(make_config(16000, 1));
+            REQUIRE_THROWS_AS(sink.process(make_audio("abcd")), std::runtime_error);
+        }
+    }
+}
+
+SCENARIO("A user wants to read a synthesis stream into a sink") {
+    GIVEN("a stream with a config and two chunks of audio") {
+        MockClientReader<SynthesizeSpeechResponse> reader;
+        EXPECT_CALL(reader, Read(_))
+            .WillOnce(DoAll(SetArgPointee<0>(make_config(22050)), Return(true)))
+            .WillOnce(DoAll(SetArgPointee<0>(make_audio(to_bytes({1, 2}))), Return(true)))
+            .WillOnce(DoAll(SetArgPointee<0>(make_audio(to_bytes({3}))), Return(true)))
+            .WillOnce(Return(false));
+        EXPECT_CALL(reader, Finish()).WillOnce(Return(::grpc::Status::OK));
+        RecordingSink sink;
+        WHEN("the stream is read into the sink") {
+            const auto status = stream_speech(reader, sink);
+            THEN("the audio is consumed and the sink is finished") {
+                REQUIRE(status.ok());
+                REQUIRE(std::vector<int16_t>({1, 2, 3}) == sink.samples);
+                REQUIRE(sink.is_finished());
+            }
+        }
+    }
+}
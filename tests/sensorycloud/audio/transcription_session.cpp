@@ -0,0 +1,363 @@
+// Test cases for the TranscriptionSession.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <grpcpp/support/sync_stream.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "sensorycloud/audio/transcription_session.hpp"
+
+using ::sensory::audio::TranscriptionSession;
+using ::sensory::audio::TranscriptionSessionOptions;
+using ::sensory::api::v1::audio::AudioConfig;
+using ::sensory::api::v1::audio::TranscribeConfig;
+using ::sensory::api::v1::audio::TranscribeRequest;
+using ::sensory::api::v1::audio::TranscribeResponse;
+
+/// The sample rate of the test audio, one frame per millisecond.
+static constexpr uint32_t SAMPLE_RATE = 1000;
+
+/// @brief A mock `Transcribe` stream that recognizes runs of constant,
+/// non-zero samples as words named after the sample value.
+class MockStream : public ::grpc::ClientReaderWriterInterface<TranscribeRequest, TranscribeResponse> {
+ private:
+    /// The mutex for guarding the state of the stream.
+    std::mutex mutex;
+    /// The condition for waking the reader and writer.
+    std::condition_variable condition;
+    /// The audio that the stream received.
+    std::vector<int16_t> audio;
+    /// The responses that have not been read.
+    std::deque<TranscribeResponse> responses;
+    /// The number of calls to `Read`.
+    std::size_t num_reads = 0;
+    /// The number of responses that were sent.
+    std::size_t num_responses = 0;
+    /// The number of writes before the stream fails, negative to never fail.
+    int writes_until_failure;
+    /// Whether the responses have out-of-range word indices.
+    bool malformed;
+    /// Whether the stream failed.
+    bool failed = false;
+    /// Whether the stream has ended.
+    bool ended = false;
+
+    /// @brief Queue a response with the words in the received audio.
+    ///
+    /// @details
+    /// Waits until the reader returns for the next response so that the
+    /// response has been processed when the write returns.
+    ///
+    void respond(std::unique_lock<std::mutex>& lock) {
+        TranscribeResponse response;
+        auto word_list = response.mutable_wordlist();
+        std::size_t start = 0;
+        for (std::size_t i = 1; i <= audio.size(); i++) {
+            if (i < audio.size() && audio[i] == audio[start]) continue;
+            if (audio[start] != 0) {
+                auto word = word_list->add_words();
+                word->set_word("w" + std::to_string(audio[start]));
+                word->set_begintimems(start * 1000 / SAMPLE_RATE);
+                word->set_endtimems(i * 1000 / SAMPLE_RATE);
+                word->set_wordindex(word_list->words_size() - 1 + (malformed ? 100 : 0));
+            }
+            start = i;
+        }
+        word_list->set_firstwordindex(0);
+        word_list->set_lastwordindex(word_list->words_size() > 0 ? word_list->words_size() - 1 : 0);
+        response.set_hasvoiceactivity(!audio.empty() && audio.back() != 0);
+        responses.push_back(response);
+        num_responses++;
+        condition.notify_all();
+        // The reader stops at a malformed response, so do not wait for it.
+        if (malformed) return;
+        condition.wait_for(lock, std::chrono::seconds(5), [&]() { return num_reads > num_responses; });
+    }
+
+ public:
+    /// @brief Initialize a new mock stream.
+    ///
+    /// @param writes_until_failure_ The number of writes before the stream
+    /// fails, negative to never fail.
+    /// @param malformed_ Whether the responses have out-of-range word
+    /// indices.
+    ///
+    MockStream(const int& writes_until_failure_, const bool& malformed_) :
+        writes_until_failure(writes_until_failure_), malformed(malformed_) { }
+
+    void WaitForInitialMetadata() override { }
+
+    bool NextMessageSize(uint32_t* size) override {
+        *size = UINT32_MAX;
+        return true;
+    }
+
+    bool Read(TranscribeResponse* response) override {
+        std::unique_lock<std::mutex> lock(mutex);
+        num_reads++;
+        condition.notify_all();
+        condition.wait(lock, [&]() { return !responses.empty() || ended; });
+        if (responses.empty()) return false;
+        *response = responses.front();
+        responses.pop_front();
+        return true;
+    }
+
+    bool Write(const TranscribeRequest& request, ::grpc::WriteOptions) override {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (failed || ended) return false;
+        if (writes_until_failure-- == 0) {
+            failed = ended = true;
+            condition.notify_all();
+            return false;
+        }
+        const auto& content = request.audiocontent();
+        const auto samples = reinterpret_cast<const int16_t*>(content.data());
+        audio.insert(audio.end(), samples, samples + content.size() / sizeof(int16_t));
+        respond(lock);
+        return true;
+    }
+
+    bool WritesDone() override {
+        std::unique_lock<std::mutex> lock(mutex);
+        ended = true;
+        condition.notify_all();
+        return !failed;
+    }
+
+    ::grpc::Status Finish() override {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (failed) return ::grpc::Status(::grpc::StatusCode::UNAVAILABLE, "mock failure");
+        return ::grpc::Status::OK;
+    }
+
+    /// @brief Return the number of samples that the stream received.
+    std::size_t get_num_samples() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return audio.size();
+    }
+};
+
+/// @brief A mock audio service that opens `MockStream`s.
+class MockService {
+ public:
+    /// @brief The type of `Transcribe` streams.
+    typedef std::unique_ptr<::grpc::ClientReaderWriterInterface<TranscribeRequest, TranscribeResponse>> TranscribeStream;
+
+    /// The streams that are open, which the session destroys once they are
+    /// finalized.
+    mutable std::vector<MockStream*> streams;
+    /// The model names of the streams that were opened.
+    mutable std::vector<std::string> models;
+    /// The number of writes before each stream fails, by stream index.
+    std::vector<int> failures;
+    /// Whether each stream sends malformed responses, by stream index.
+    std::vector<bool> malformed;
+
+    /// @brief Open a mock `Transcribe` stream.
+    TranscribeStream transcribe(::grpc::ClientContext*, AudioConfig* audio_config, TranscribeConfig* transcribe_config) const {
+        std::unique_ptr<AudioConfig> audio(audio_config);
+        std::unique_ptr<TranscribeConfig> config(transcribe_config);
+        REQUIRE(SAMPLE_RATE == audio->sampleratehertz());
+        models.push_back(config->modelname());
+        const auto index = streams.size();
+        auto stream = new MockStream(
+            index < failures.size() ? failures[index] : -1,
+            index < malformed.size() && malformed[index]
+        );
+        streams.push_back(stream);
+        return TranscribeStream(stream);
+    }
+};
+
+/// @brief Create the audio of a sequence of words.
+///
+/// @param num_words The number of words.
+/// @param word_ms The duration of each word.
+/// @param gap_ms The duration of the silence after each word.
+/// @param expected The transcript of the audio.
+/// @returns The samples of the audio.
+///
+std::vector<int16_t> make_speech(const int& num_words, const int& word_ms, const int& gap_ms, std::string& expected) {
+    std::vector<int16_t> samples;
+    for (int i = 1; i <= num_words; i++) {
+        samples.insert(samples.end(), word_ms * SAMPLE_RATE / 1000, static_cast<int16_t>(i));
+        samples.insert(samples.end(), gap_ms * SAMPLE_RATE / 1000, 0);
+        expected += (i == 1 ? "w" : " w") + std::to_string(i);
+    }
+    return samples;
+}
+
+/// @brief Write audio to a session in chunks.
+///
+/// @param session The session to write to.
+/// @param samples The samples to write.
+/// @param chunk_size The number of samples in each chunk.
+///
+void write_chunks(TranscriptionSession<MockService>& session, const std::vector<int16_t>& samples, const std::size_t& chunk_size) {
+    for (std::size_t i = 0; i < samples.size(); i += chunk_size)
+        session.write(samples.data() + i, std::min(chunk_size, samples.size() - i));
+}
+
+/// @brief Create the options for a session with short segments.
+///
+/// @returns Options with 1-1.5s segments and 200ms of overlap.
+///
+TranscriptionSessionOptions make_options() {
+    TranscriptionSessionOptions options;
+    options.sample_rate = SAMPLE_RATE;
+    options.transcribe_config.set_modelname("speech_recognition_en");
+    options.min_segment_duration = std::chrono::milliseconds(1000);
+    options.max_segment_duration = std::chrono::milliseconds(1500);
+    options.overlap = std::chrono::milliseconds(200);
+    return options;
+}
+
+SCENARIO("A user wants to transcribe a session that is longer than a stream") {
+    GIVEN("speech with pauses between words") {
+        MockService service;
+        std::string expected;
+        const auto samples = make_speech(30, 100, 100, expected);
+        WHEN("the speech is transcribed by a session") {
+            TranscriptionSession<MockService> session(service, make_options());
+            std::vector<std::string> committed;
+            session.set_words_callback([&](const std::vector<::sensory::api::v1::audio::TranscribeWord>& words) {
+                for (const auto& word : words) committed.push_back(word.word());
+            });
+            std::size_t max_stream_samples = 0;
+            for (std::size_t i = 0; i < samples.size(); i += 50) {
+                session.write(samples.data() + i, 50);
+                max_stream_samples = std::max(max_stream_samples, service.streams.back()->get_num_samples());
+            }
+            REQUIRE(session.finish().ok());
+            THEN("no stream receives more than the maximal duration and overlap") {
+                REQUIRE(1500 + 200 >= max_stream_samples);
+            }
+            THEN("the streams rotate and the transcript is stitched") {
+                REQUIRE(1 < session.get_num_streams());
+                REQUIRE(service.streams.size() == session.get_num_streams());
+                REQUIRE(expected == session.get_transcript());
+                REQUIRE(30 == committed.size());
+                REQUIRE(0 == session.get_num_failures());
+                REQUIRE(std::chrono::milliseconds(6000) == session.get_duration());
+            }
+            THEN("every stream uses the transcription config") {
+                for (const auto& model : service.models)
+                    REQUIRE("speech_recognition_en" == model);
+            }
+            THEN("the words are in session time") {
+                const auto words = session.get_word_list();
+                for (std::size_t i = 0; i < words.size(); i++) {
+                    REQUIRE(i == words[i].wordindex());
+                    REQUIRE(200 * i == words[i].begintimems());
+                }
+            }
+        }
+    }
+    GIVEN("continuous speech without pauses") {
+        MockService service;
+        std::string expected;
+        const auto samples = make_speech(40, 100, 0, expected);
+        WHEN("the speech is transcribed by a session") {
+            TranscriptionSession<MockService> session(service, make_options());
+            write_chunks(session, samples, 50);
+            REQUIRE(session.finish().ok());
+            THEN("the streams rotate at the maximal duration without losing words") {
+                REQUIRE(3 <= session.get_num_streams());
+                REQUIRE(expected == session.get_transcript());
+            }
+        }
+    }
+    GIVEN("a stream that fails in the middle of the session") {
+        MockService service;
+        service.failures = {10};
+        std::string expected;
+        const auto samples = make_speech(10, 100, 100, expected);
+        WHEN("the speech is transcribed by a session") {
+            TranscriptionSession<MockService> session(service, make_options());
+            write_chunks(session, samples, 50);
+            const auto status = session.finish();
+            THEN("the failed stream is replaced from the overlap") {
+                REQUIRE(::grpc::StatusCode::UNAVAILABLE == status.error_code());
+                REQUIRE(1 == session.get_num_failures());
+                REQUIRE(expected == session.get_transcript());
+            }
+        }
+    }
+    GIVEN("a stream that sends a response with an out-of-range word index") {
+        MockService service;
+        service.malformed = {true};
+        std::string expected;
+        const auto samples = make_speech(10, 100, 100, expected);
+        WHEN("the speech is transcribed by a session") {
+            TranscriptionSession<MockService> session(service, make_options());
+            write_chunks(session, samples, 50);
+            const auto status = session.finish();
+            THEN("the stream is replaced and the error is reported") {
+                REQUIRE(::grpc::StatusCode::INTERNAL == status.error_code());
+                REQUIRE(status.error_message().find("Attempting to update word") != std::string::npos);
+                REQUIRE(1 == session.get_num_failures());
+                REQUIRE(2 <= session.get_num_streams());
+            }
+            THEN("the replacement stream transcribes the rest of the speech") {
+                const auto transcript = session.get_transcript();
+                REQUIRE(transcript.size() >= 3);
+                REQUIRE("w10" == transcript.substr(transcript.size() - 3));
+            }
+        }
+    }
+    GIVEN("a service whose streams always fail") {
+        MockService service;
+        service.failures = {0, 0, 0, 0, 0};
+        auto options = make_options();
+        options.max_restarts = 2;
+        WHEN("audio is written to a session") {
+            TranscriptionSession<MockService> session(service, options);
+            const std::vector<int16_t> samples(50, 1);
+            THEN("the session gives up after the maximal number of restarts") {
+                session.write(samples.data(), samples.size());
+                session.write(samples.data(), samples.size());
+                REQUIRE_THROWS_AS(session.write(samples.data(), samples.size()), std::runtime_error);
+            }
+        }
+    }
+    GIVEN("inconsistent options") {
+        MockService service;
+        auto options = make_options();
+        options.max_segment_duration = std::chrono::milliseconds(500);
+        THEN("an error is thrown") {
+            REQUIRE_THROWS_AS(TranscriptionSession<MockService>(service, options), std::invalid_argument);
+        }
+    }
+}
@@ -0,0 +1,261 @@
+// Test cases for the VoiceActivityGate structure.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "sensorycloud/audio/voice_activity_gate.hpp"
+#include "sensorycloud/generated/v1/audio/audio.pb.h"
+
+using ::sensory::audio::AudioEncoder;
+using ::sensory::audio::VoiceActivityGate;
+using ::sensory::audio::VoiceActivityGateOptions;
+using ::sensory::audio::write_gated;
+using ::sensory::api::v1::audio::AudioConfig;
+using ::sensory::api::v1::audio::ValidateEventRequest;
+
+/// The ratio of the circumference of a circle to its diameter.
+static const double PI = 3.14159265358979323846;
+
+/// @brief Generate a chunk of quiet noise.
+///
+/// @param num_samples The number of samples in the chunk.
+/// @param amplitude The peak amplitude of the noise.
+/// @returns The samples of the chunk.
+///
+std::vector<int16_t> make_noise(const std::size_t& num_samples, const int& amplitude = 20) {
+    static uint32_t state = 1;
+    std::vector<int16_t> samples;
+    for (std::size_t i = 0; i < num_samples; i++) {
+        state = state * 1664525 + 1013904223;
+        samples.push_back(static_cast<int16_t>(static_cast<int>(state >> 16) % (2 * amplitude + 1) - amplitude));
+    }
+    return samples;
+}
+
+/// @brief Generate a chunk of a voiced tone.
+///
+/// @param num_samples The number of samples in the chunk.
+/// @returns The samples of the chunk.
+///
+std::vector<int16_t> make_voice(const std::size_t& num_samples) {
+    std::vector<int16_t> samples;
+    for (std::size_t i = 0; i < num_samples; i++)
+        samples.push_back(static_cast<int16_t>(5000 * std::sin(2 * PI * 200 * i / 16000.0)));
+    return samples;
+}
+
+/// @brief A stream that records the requests written to it.
+struct FakeStream {
+    /// The requests that were written to the stream.
+    std::vector<ValidateEventRequest> requests;
+    /// The result of writes to the stream.
+    bool ok = true;
+
+    bool Write(const ValidateEventRequest& request) {
+        requests.push_back(request);
+        return ok;
+    }
+};
+
+SCENARIO("a user wants to initialize a VoiceActivityGate") {
+    GIVEN("zero channels") {
+        THEN("an invalid argument is thrown") {
+            REQUIRE_THROWS_AS(VoiceActivityGate(VoiceActivityGateOptions(), 0), std::invalid_argument);
+        }
+    }
+    GIVEN("a zero sample rate") {
+        VoiceActivityGateOptions options;
+        options.sample_rate = 0;
+        THEN("an invalid argument is thrown") {
+            REQUIRE_THROWS_AS(VoiceActivityGate(options), std::invalid_argument);
+        }
+    }
+    GIVEN("default options") {
+        VoiceActivityGate gate;
+        THEN("the counters are zero") {
+            REQUIRE(0 == gate.get_num_samples_received());
+            REQUIRE(0 == gate.get_num_samples_sent());
+            REQUIRE(0 == gate.get_num_samples_suppressed());
+            REQUIRE(0 == gate.get_bytes_saved());
+        }
+    }
+}
+
+SCENARIO("a user wants to measure the features of a chunk") {
+    GIVEN("a gate") {
+        VoiceActivityGate gate;
+        std::vector<int16_t> output;
+        WHEN("digital silence is processed") {
+            const std::vector<int16_t> silence(160, 0);
+            gate.process(silence.data(), silence.size(), output);
+            THEN("the energy is the floor of the meter") {
+                REQUIRE(gate.get_energy_db() == Approx(-120));
+                REQUIRE(0 == gate.get_zero_crossing_rate());
+            }
+        }
+        WHEN("a full-scale alternating signal is processed") {
+            std::vector<int16_t> signal;
+            for (int i = 0; i < 160; i++) signal.push_back(i % 2 ? -32768 : 32767);
+            gate.process(signal.data(), signal.size(), output);
+            THEN("the energy is 0dBFS and every sample crosses zero") {
+                REQUIRE(gate.get_energy_db() == Approx(0).margin(0.01));
+                REQUIRE(gate.get_zero_crossing_rate() == Approx(1));
+            }
+        }
+    }
+}
+
+SCENARIO("a user wants to suppress silence between utterances") {
+    GIVEN("a gate with a hangover, pre-roll, and keep-alive") {
+        VoiceActivityGateOptions options;
+        options.hangover_chunks = 2;
+        options.pre_roll_chunks = 2;
+        options.keep_alive_chunks = 4;
+        options.keep_alive_samples = 16;
+        VoiceActivityGate gate(options);
+        const std::size_t CHUNK = 160;
+        WHEN("silence is followed by speech and silence") {
+            std::vector<VoiceActivityGate::Decision> decisions;
+            std::vector<std::size_t> sizes;
+            std::vector<std::vector<int16_t>> chunks;
+            for (int i = 0; i < 6; i++) chunks.push_back(make_noise(CHUNK));
+            for (int i = 0; i < 3; i++) chunks.push_back(make_voice(CHUNK));
+            for (int i = 0; i < 6; i++) chunks.push_back(make_noise(CHUNK));
+            for (const auto& chunk : chunks) {
+                std::vector<int16_t> output;
+                decisions.push_back(gate.process(chunk.data(), chunk.size(), output));
+                sizes.push_back(output.size());
+            }
+            THEN("silence is suppressed with periodic keep-alives") {
+                using Decision = VoiceActivityGate::Decision;
+                const std::vector<Decision> expected = {
+                    Decision::Silence, Decision::Silence, Decision::Silence, Decision::KeepAlive,
+                    Decision::Silence, Decision::Silence,
+                    Decision::Speech, Decision::Speech, Decision::Speech,
+                    Decision::Hangover, Decision::Hangover,
+                    Decision::Silence, Decision::Silence, Decision::Silence, Decision::KeepAlive
+                };
+                REQUIRE(expected == decisions);
+                REQUIRE(16 == sizes[3]);
+                REQUIRE(0 == sizes[4]);
+            }
+            THEN("the pre-roll is sent ahead of the first speech chunk") {
+                REQUIRE(3 * CHUNK == sizes[6]);
+                REQUIRE(CHUNK == sizes[7]);
+                REQUIRE(CHUNK == sizes[10]);
+            }
+            THEN("the counters account for the suppressed audio") {
+                REQUIRE(15 * CHUNK == gate.get_num_samples_received());
+                REQUIRE(7 * CHUNK + 2 * 16 == gate.get_num_samples_sent());
+                REQUIRE(8 * CHUNK == gate.get_num_samples_suppressed());
+                REQUIRE(2 * (8 * CHUNK - 2 * 16) == gate.get_bytes_saved());
+            }
+            THEN("server times are mapped back to the timeline of the source") {
+                // keep-alive, pre-roll and utterance, keep-alive
+                REQUIRE(3 == gate.get_num_timeline_segments());
+                // The first keep-alive replaced the chunk ending at 40ms.
+                REQUIRE(40 == gate.to_source_time(0));
+                // The pre-roll starts at 40ms in the source, 1ms in the sent audio.
+                REQUIRE(640 == gate.to_source_frame(16));
+                REQUIRE(40 == gate.to_source_time(1));
+                REQUIRE(60 == gate.to_source_time(21));
+                // The hangover ends at 110ms in the source, 71ms in the sent audio.
+                REQUIRE(109 == gate.to_source_time(70));
+                REQUIRE(150 == gate.to_source_time(71));
+            }
+        }
+    }
+    GIVEN("a gate without pre-roll or keep-alive") {
+        VoiceActivityGateOptions options;
+        options.pre_roll_chunks = 0;
+        options.keep_alive_chunks = 0;
+        VoiceActivityGate gate(options);
+        WHEN("a long silence is processed") {
+            std::size_t sent = 0;
+            for (int i = 0; i < 100; i++) {
+                const auto chunk = make_noise(160);
+                std::vector<int16_t> output;
+                REQUIRE(VoiceActivityGate::Decision::Silence == gate.process(chunk.data(), chunk.size(), output));
+                sent += output.size();
+            }
+            THEN("nothing is sent") {
+                REQUIRE(0 == sent);
+                REQUIRE(2 * 100 * 160 == gate.get_bytes_saved());
+            }
+        }
+    }
+    GIVEN("a gate after loud broadband noise") {
+        VoiceActivityGate gate;
+        WHEN("white noise far above the threshold is processed") {
+            const auto first = make_noise(160);
+            std::vector<int16_t> output;
+            gate.process(first.data(), first.size(), output);
+            const auto hiss = make_noise(160, 10000);
+            const auto decision = gate.process(hiss.data(), hiss.size(), output);
+            THEN("the high zero-crossing rate rejects the noise") {
+                REQUIRE(gate.get_zero_crossing_rate() > gate.get_options().max_zero_crossing_rate);
+                REQUIRE(VoiceActivityGate::Decision::Speech != decision);
+            }
+        }
+    }
+}
+
+SCENARIO("a user wants to write gated audio to a stream") {
+    GIVEN("a stream, a gate, and an encoder") {
+        AudioConfig config;
+        config.set_sampleratehertz(16000);
+        config.set_audiochannelcount(1);
+        AudioEncoder encoder(&config);
+        VoiceActivityGateOptions options;
+        options.keep_alive_chunks = 0;
+        options.pre_roll_chunks = 1;
+        VoiceActivityGate gate(options);
+        FakeStream stream;
+        WHEN("silence and speech are written") {
+            const auto silence = make_noise(160);
+            const auto voice = make_voice(160);
+            REQUIRE(write_gated<ValidateEventRequest>(&stream, gate, encoder, silence.data(), silence.size()));
+            REQUIRE(write_gated<ValidateEventRequest>(&stream, gate, encoder, voice.data(), voice.size()));
+            THEN("only the speech and its pre-roll are written") {
+                REQUIRE(1 == stream.requests.size());
+                REQUIRE(2 * 2 * 160 == stream.requests[0].audiocontent().size());
+            }
+        }
+        WHEN("the stream fails") {
+            stream.ok = false;
+            const auto silence = make_noise(160);
+            const auto voice = make_voice(160);
+            REQUIRE(write_gated<ValidateEventRequest>(&stream, gate, encoder, silence.data(), silence.size()));
+            THEN("the failure is reported") {
+                REQUIRE_FALSE(write_gated<ValidateEventRequest>(&stream, gate, encoder, voice.data(), voice.size()));
+            }
+        }
+    }
+}
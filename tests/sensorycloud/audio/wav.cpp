@@ -0,0 +1,133 @@
+// Test cases for WAV file decoding and encoding.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "sensorycloud/audio/wav.hpp"
+
+using ::sensory::audio::PCMAudio;
+using ::sensory::audio::read_wav;
+using ::sensory::audio::write_wav;
+
+/// @brief Write raw bytes to a file.
+///
+/// @param path The path of the file to write.
+/// @param bytes The contents of the file.
+///
+void write_bytes(const std::string& path, const std::string& bytes) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(bytes.data(), bytes.size());
+}
+
+/// @brief Read raw bytes from a file.
+///
+/// @param path The path of the file to read.
+/// @returns The contents of the file.
+///
+std::string read_bytes(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+SCENARIO("A user wants to write and read WAV files") {
+    const std::string path = "test_audio_wav.wav";
+    GIVEN("stereo PCM audio") {
+        PCMAudio audio;
+        audio.sample_rate = 44100;
+        audio.num_channels = 2;
+        audio.samples = {0, 1, -1, 32767, -32768, 1234, -4321, 7};
+        REQUIRE(4 == audio.get_num_frames());
+        WHEN("the audio is written and read back") {
+            write_wav(path, audio);
+            const auto decoded = read_wav(path);
+            THEN("the format and samples are preserved") {
+                REQUIRE(44100 == decoded.sample_rate);
+                REQUIRE(2 == decoded.num_channels);
+                REQUIRE(audio.samples == decoded.samples);
+            }
+            THEN("the file has a canonical 44 byte header") {
+                REQUIRE(44 + 2 * audio.samples.size() == read_bytes(path).size());
+            }
+        }
+        WHEN("an unknown chunk with an odd size precedes the data") {
+            write_wav(path, audio);
+            auto bytes = read_bytes(path);
+            bytes.insert(36, std::string("LIST\x03\x00\x00\x00" "abc\x00", 12));
+            write_bytes(path, bytes);
+            THEN("the chunk and its pad byte are skipped") {
+                REQUIRE(audio.samples == read_wav(path).samples);
+            }
+        }
+        WHEN("the data chunk is truncated") {
+            write_wav(path, audio);
+            auto bytes = read_bytes(path);
+            bytes.resize(bytes.size() - 3);
+            write_bytes(path, bytes);
+            THEN("the complete frames before the end of the file are read") {
+                const auto decoded = read_wav(path);
+                REQUIRE(3 == decoded.get_num_frames());
+                REQUIRE(std::vector<int16_t>(audio.samples.begin(), audio.samples.begin() + 6) == decoded.samples);
+            }
+        }
+        WHEN("the sizes in the header were never patched") {
+            write_wav(path, audio);
+            auto bytes = read_bytes(path);
+            std::fill(bytes.begin() + 40, bytes.begin() + 44, '\0');
+            write_bytes(path, bytes);
+            THEN("the data is read up to the end of the file") {
+                REQUIRE(audio.samples == read_wav(path).samples);
+            }
+        }
+        WHEN("the file is not 16-bit PCM") {
+            write_wav(path, audio);
+            auto bytes = read_bytes(path);
+            bytes[34] = 8;  // bits per sample
+            write_bytes(path, bytes);
+            THEN("an error is thrown") {
+                REQUIRE_THROWS_AS(read_wav(path), std::runtime_error);
+            }
+        }
+    }
+    GIVEN("a file that is not a WAV file") {
+        write_bytes(path, "not a wave file");
+        THEN("an error is thrown") {
+            REQUIRE_THROWS_AS(read_wav(path), std::runtime_error);
+        }
+    }
+    GIVEN("a file that does not exist") {
+        THEN("an error is thrown") {
+            REQUIRE_THROWS_AS(read_wav("does_not_exist.wav"), std::runtime_error);
+        }
+    }
+    std::remove(path.c_str());
+}
@@ -0,0 +1,192 @@
+// Test cases for the AudioChunkRequest structure.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+#include "sensorycloud/calldata/audio_chunk_request.hpp"
+#include "sensorycloud/generated/v1/audio/audio.pb.h"
+
+using ::sensory::calldata::AudioChunkRequest;
+using ::sensory::calldata::is_audio_chunk_request;
+using ::sensory::api::v1::audio::TranscribeConfig;
+using ::sensory::api::v1::audio::TranscribeRequest;
+using ::sensory::api::v1::audio::TranscribeResponse;
+using ::sensory::api::v1::audio::ValidateEnrolledEventRequest;
+
+/// @brief Serialize a request and return the bytes on the wire.
+///
+/// @tparam Request The type of the request.
+/// @param request The request to serialize.
+/// @param buffer The output buffer for inspecting the slices.
+/// @returns The serialized bytes of the request.
+///
+template<typename Request>
+std::string serialize(const Request& request, ::grpc::ByteBuffer& buffer) {
+    bool own_buffer = false;
+    REQUIRE(::grpc::SerializationTraits<Request>::Serialize(request, &buffer, &own_buffer).ok());
+    REQUIRE(own_buffer);
+    std::vector<::grpc::Slice> slices;
+    REQUIRE(buffer.Dump(&slices).ok());
+    std::string bytes;
+    for (const auto& slice : slices)
+        bytes.append(reinterpret_cast<const char*>(slice.begin()), slice.size());
+    return bytes;
+}
+
+TEST_CASE("is_audio_chunk_request should detect audio chunk requests") {
+    REQUIRE(is_audio_chunk_request<AudioChunkRequest<TranscribeRequest>>::value);
+    REQUIRE_FALSE(is_audio_chunk_request<TranscribeRequest>::value);
+}
+
+SCENARIO("A user wants to send the configuration of an audio stream") {
+    GIVEN("an audio chunk request with a configuration") {
+        AudioChunkRequest<TranscribeRequest> request;
+        auto config = new TranscribeConfig;
+        config->set_modelname("model");
+        request.set_allocated_config(config);
+        WHEN("the request is serialized") {
+            ::grpc::ByteBuffer buffer;
+            const auto bytes = serialize(request, buffer);
+            THEN("the bytes match the serialized protobuf message") {
+                REQUIRE_FALSE(request.has_audio_content());
+                REQUIRE(bytes == request.get_message().SerializeAsString());
+                REQUIRE(bytes.size() == request.ByteSizeLong());
+            }
+        }
+    }
+}
+
+SCENARIO("A user wants to send audio content without copies") {
+    GIVEN("an audio chunk request with copied samples") {
+        std::vector<int16_t> samples(4000);
+        for (std::size_t i = 0; i < samples.size(); i++)
+            samples[i] = static_cast<int16_t>(i);
+        const auto size = samples.size() * sizeof(int16_t);
+        AudioChunkRequest<TranscribeRequest> request;
+        request.set_audio_content(samples.data(), size);
+        WHEN("the request is serialized") {
+            ::grpc::ByteBuffer buffer;
+            const auto bytes = serialize(request, buffer);
+            THEN("the bytes match the serialization of the protobuf message") {
+                TranscribeRequest expected;
+                expected.set_audiocontent(samples.data(), size);
+                REQUIRE(bytes == expected.SerializeAsString());
+                REQUIRE(bytes.size() == request.ByteSizeLong());
+            }
+            THEN("the request does not reference the caller's samples") {
+                std::vector<::grpc::Slice> slices;
+                REQUIRE(buffer.Dump(&slices).ok());
+                REQUIRE(2 == slices.size());
+                REQUIRE(reinterpret_cast<const uint8_t*>(samples.data()) != slices[1].begin());
+            }
+            THEN("the request can be deserialized into the protobuf message") {
+                AudioChunkRequest<TranscribeRequest> output;
+                REQUIRE(::grpc::SerializationTraits<AudioChunkRequest<TranscribeRequest>>::Deserialize(&buffer, &output).ok());
+                REQUIRE(output.get_message().audiocontent() == std::string(reinterpret_cast<const char*>(samples.data()), size));
+            }
+        }
+    }
+    GIVEN("an audio chunk request for a different stream type") {
+        const std::string samples(200, 'x');
+        AudioChunkRequest<ValidateEnrolledEventRequest> request;
+        request.set_audio_content(samples.data(), samples.size());
+        THEN("the bytes match the serialization of the protobuf message") {
+            ::grpc::ByteBuffer buffer;
+            ValidateEnrolledEventRequest expected;
+            expected.set_audiocontent(samples);
+            REQUIRE(serialize(request, buffer) == expected.SerializeAsString());
+        }
+    }
+    GIVEN("an audio chunk request with shared samples") {
+        auto samples = std::make_shared<std::vector<int16_t>>(160, 7);
+        std::weak_ptr<std::vector<int16_t>> weak = samples;
+        std::unique_ptr<AudioChunkRequest<TranscribeRequest>> request(new AudioChunkRequest<TranscribeRequest>);
+        request->set_audio_content(samples, samples->data(), samples->size() * sizeof(int16_t));
+        THEN("the samples are referenced rather than copied") {
+            ::grpc::ByteBuffer buffer;
+            serialize(*request, buffer);
+            std::vector<::grpc::Slice> slices;
+            REQUIRE(buffer.Dump(&slices).ok());
+            REQUIRE(2 == slices.size());
+            REQUIRE(reinterpret_cast<const uint8_t*>(samples->data()) == slices[1].begin());
+        }
+        WHEN("the caller releases the samples") {
+            samples.reset();
+            THEN("the request keeps the samples alive") {
+                REQUIRE_FALSE(weak.expired());
+            }
+            AND_WHEN("the request is serialized and destroyed") {
+                {
+                    ::grpc::ByteBuffer buffer;
+                    serialize(*request, buffer);
+                    request.reset();
+                    REQUIRE_FALSE(weak.expired());
+                }
+                THEN("the samples are released with the last slice") {
+                    REQUIRE(weak.expired());
+                }
+            }
+        }
+    }
+    GIVEN("an audio chunk request with a length that needs a multi-byte varint") {
+        const std::string samples(100000, 'y');
+        AudioChunkRequest<TranscribeRequest> request;
+        request.set_audio_content(samples.data(), samples.size());
+        THEN("the bytes match the serialization of the protobuf message") {
+            ::grpc::ByteBuffer buffer;
+            TranscribeRequest expected;
+            expected.set_audiocontent(samples);
+            REQUIRE(serialize(request, buffer) == expected.SerializeAsString());
+        }
+    }
+}
+
+/// @brief An asynchronous stub interface that records started streams.
+struct MockAsync {
+    /// The number of streams that were started.
+    int starts = 0;
+
+    /// @brief Start a transcription stream.
+    void Transcribe(::grpc::ClientContext*, ::grpc::ClientBidiReactor<TranscribeRequest, TranscribeResponse>*) {
+        starts++;
+    }
+};
+
+SCENARIO("A service wants to start a stream of protobuf requests") {
+    GIVEN("a reactor of protobuf requests") {
+        MockAsync async;
+        ::grpc::ClientContext context;
+        ::grpc::ClientBidiReactor<TranscribeRequest, TranscribeResponse> reactor;
+        WHEN("the stream is started") {
+            ::sensory::calldata::start_bidi_stream(&async, &MockAsync::Transcribe, nullptr, "", &context, &reactor);
+            THEN("the generated stub is used") {
+                REQUIRE(1 == async.starts);
+            }
+        }
+    }
+}
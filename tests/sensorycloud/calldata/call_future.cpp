@@ -0,0 +1,156 @@
+// Test cases for the FutureCallback and ConcurrencyLimiter structures.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "sensorycloud/calldata/callback_data.hpp"
+#include "sensorycloud/calldata/call_future.hpp"
+#include "sensorycloud/generated/health/health.pb.h"
+
+using ::sensory::calldata::CallResult;
+using ::sensory::calldata::ConcurrencyLimiter;
+using ::sensory::calldata::FutureCallback;
+using ::sensory::util::Future;
+using ::sensory::util::when_all;
+using ::sensory::api::common::ServerHealthResponse;
+
+/// @brief A service that completes calls on background threads.
+struct MockService {
+    /// The type of the call data of the service.
+    typedef ::sensory::calldata::CallbackData<
+        MockService,
+        ::sensory::api::health::HealthRequest,
+        ServerHealthResponse
+    > MockCallbackData;
+
+    /// The threads that complete the calls.
+    std::vector<std::thread> threads;
+    /// The number of calls in flight.
+    std::atomic<int> inFlight;
+    /// The maximal number of calls in flight that was observed.
+    std::atomic<int> maxInFlight;
+
+    /// @brief Initialize the service without any calls in flight.
+    MockService() : inFlight(0), maxInFlight(0) { }
+
+    /// @brief Join the threads of the calls.
+    ~MockService() { for (auto& thread : threads) thread.join(); }
+
+    /// @brief Start an asynchronous call like the services of the SDK.
+    ///
+    /// @param id The ID to respond with.
+    /// @param callback The callback to invoke with the call data.
+    /// @returns The call data of the call.
+    ///
+    template<typename Callback>
+    std::shared_ptr<MockCallbackData> get_health(const std::string& id, const Callback& callback) {
+        std::shared_ptr<MockCallbackData> call(new MockCallbackData);
+        const auto count = ++inFlight;
+        int expected = maxInFlight.load();
+        while (count > expected && !maxInFlight.compare_exchange_weak(expected, count)) { }
+        threads.emplace_back([this, call, callback, id]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            call->response.set_id(id);
+            if (id.empty())
+                call->status = ::grpc::Status(::grpc::StatusCode::INVALID_ARGUMENT, "empty ID");
+            inFlight--;
+            callback(call.get());
+            call->setIsDone();
+        });
+        return call;
+    }
+};
+
+SCENARIO("A user wants a future for an asynchronous call") {
+    GIVEN("a service and a future callback") {
+        MockService service;
+        FutureCallback<ServerHealthResponse> callback;
+        auto future = callback.get_future();
+        WHEN("a successful call is started with the callback") {
+            service.get_health("id", callback);
+            THEN("the future resolves with the status and response") {
+                const auto& result = future.get();
+                REQUIRE(result.status.ok());
+                REQUIRE_THAT(result.response.id(), Catch::Equals("id"));
+            }
+        }
+        WHEN("a failing call is started with the callback") {
+            service.get_health("", callback);
+            THEN("the future resolves with the error status") {
+                REQUIRE(::grpc::StatusCode::INVALID_ARGUMENT == future.get().status.error_code());
+            }
+        }
+    }
+}
+
+SCENARIO("A user wants to limit the number of calls in flight") {
+    GIVEN("a limit of zero") {
+        THEN("an invalid argument error is thrown") {
+            REQUIRE_THROWS_AS(ConcurrencyLimiter(0), std::invalid_argument);
+        }
+    }
+    GIVEN("a limiter with a limit of 4 and many calls to make") {
+        MockService service;
+        ConcurrencyLimiter limiter(4);
+        std::vector<Future<CallResult<ServerHealthResponse>>> futures;
+        for (int i = 0; i < 64; i++) {
+            const auto id = std::to_string(i);
+            futures.push_back(limiter.submit<ServerHealthResponse>(
+                [&service, &id](const FutureCallback<ServerHealthResponse>& callback) {
+                    service.get_health(id, callback);
+                }));
+        }
+        const auto all = when_all(futures);
+        const auto& results = all.get();
+        limiter.wait();
+        THEN("every call completes in order of submission") {
+            REQUIRE(64 == results.size());
+            bool ok = true;
+            for (int i = 0; i < 64; i++)
+                ok &= results[i].response.id() == std::to_string(i);
+            REQUIRE(ok);
+            REQUIRE(0 == limiter.get_in_flight());
+        }
+        THEN("no more than 4 calls were in flight") {
+            REQUIRE(4 >= service.maxInFlight);
+            REQUIRE(1 < service.maxInFlight);
+        }
+    }
+    GIVEN("a limiter and a launch function that throws") {
+        ConcurrencyLimiter limiter(1);
+        THEN("the slot is released and the exception is propagated") {
+            REQUIRE_THROWS_AS(limiter.submit<ServerHealthResponse>(
+                [](const FutureCallback<ServerHealthResponse>&) {
+                    throw std::runtime_error("failed to start");
+                }), std::runtime_error);
+            REQUIRE(0 == limiter.get_in_flight());
+        }
+    }
+}
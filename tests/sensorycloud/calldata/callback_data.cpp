@@ -25,6 +25,9 @@
 
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch.hpp>
+#include <functional>
+#include <memory>
+#include <vector>
 #include "sensorycloud/calldata/callback_data.hpp"
 #include "sensorycloud/generated/health/health.pb.h"
 #include "sensorycloud/generated/health/health.grpc.pb.h"
@@ -89,3 +92,30 @@ SCENARIO("A user wants to wait for the callback to fire from a CallbackData") {
         }
     }
 }
+
+SCENARIO("A user wants the callback of a CallbackData to run on an executor") {
+    GIVEN("a call, a callback, and an executor that defers tasks") {
+        std::shared_ptr<MockCallbackData> call(new MockCallbackData);
+        std::vector<std::function<void()>> tasks;
+        std::shared_ptr<::sensory::util::Executor> executor(new ::sensory::util::FunctionExecutor(
+            [&tasks](std::function<void()> task) { tasks.push_back(std::move(task)); }));
+        int num_callbacks = 0;
+        auto handler = MockCallbackData::dispatch(call, [&num_callbacks](MockCallbackData*) { num_callbacks++; }, executor);
+        WHEN("the call completes") {
+            handler(::grpc::Status(::grpc::StatusCode::CANCELLED, "cancelled"));
+            THEN("the status is stored and the callback is handed to the executor") {
+                REQUIRE(::grpc::StatusCode::CANCELLED == call->getStatus().error_code());
+                REQUIRE(1 == tasks.size());
+                REQUIRE(0 == num_callbacks);
+                REQUIRE_FALSE(call->getIsDone());
+            }
+            AND_WHEN("the executor runs the task") {
+                tasks.front()();
+                THEN("the callback runs and the call is done") {
+                    REQUIRE(1 == num_callbacks);
+                    REQUIRE(call->getIsDone());
+                }
+            }
+        }
+    }
+}
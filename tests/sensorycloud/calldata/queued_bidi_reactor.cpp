@@ -0,0 +1,378 @@
+// Test cases for the QueuedBidiReactor structure.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sensorycloud/calldata/queued_bidi_reactor.hpp"
+#include "sensorycloud/generated/v1/audio/audio.pb.h"
+
+using ::sensory::calldata::QueueFullPolicy;
+using ::sensory::calldata::WriteQueueOptions;
+using ::sensory::api::v1::audio::TranscribeRequest;
+using ::sensory::api::v1::audio::TranscribeResponse;
+
+/// @brief A dummy type acting as the encapsulating type of the reactor.
+struct MockQueuedBidiReactorFriend { };
+/// @brief The reactor to test based on arbitrary SDK messages.
+typedef sensory::calldata::QueuedBidiReactor<
+    MockQueuedBidiReactorFriend,
+    TranscribeRequest,
+    TranscribeResponse
+> MockQueuedBidiReactor;
+
+/// @brief A stream that records the writes started by a reactor.
+class MockStream : public ::grpc::ClientCallbackReaderWriter<TranscribeRequest, TranscribeResponse> {
+ public:
+    /// A mutex for guarding access to the recorded writes.
+    std::mutex mutex;
+    /// The messages that were written to the stream.
+    std::vector<std::string> writes;
+    /// The buffer hints of the messages that were written to the stream.
+    std::vector<bool> hints;
+    /// The number of times that writes done was called.
+    std::atomic<int> writesDone;
+    /// A flag determining whether a write is outstanding.
+    std::atomic<bool> isWriting;
+    /// The number of holds on the stream.
+    std::atomic<int> holds;
+    /// The number of times the call was started.
+    std::atomic<int> starts;
+
+    /// @brief Initialize the stream with the initial config write in flight.
+    MockStream() : writesDone(0), isWriting(true), holds(0), starts(0) { }
+
+    /// @brief Bind the stream to a reactor.
+    ///
+    /// @param reactor The reactor to bind the stream to.
+    ///
+    void bind(::grpc::ClientBidiReactor<TranscribeRequest, TranscribeResponse>* reactor) {
+        BindReactor(reactor);
+    }
+
+    void StartCall() override { starts++; }
+    void Write(const TranscribeRequest* request, ::grpc::WriteOptions options) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        writes.push_back(request->audiocontent());
+        hints.push_back(options.get_buffer_hint());
+        isWriting = true;
+    }
+    void WritesDone() override { writesDone++; }
+    void Read(TranscribeResponse*) override { }
+    void AddHold(int count) override { holds += count; }
+    void RemoveHold() override { holds--; }
+
+    /// @brief Complete the outstanding write on the reactor.
+    ///
+    /// @param reactor The reactor to notify of the completion.
+    /// @returns `true` if a write was outstanding, `false` otherwise.
+    ///
+    bool complete(MockQueuedBidiReactor& reactor) {
+        if (!isWriting.exchange(false)) return false;
+        reactor.OnWriteDone(true);
+        return true;
+    }
+};
+
+/// @brief Create a transcription request with the given audio content.
+///
+/// @param content The audio content of the request.
+/// @returns The request.
+///
+inline TranscribeRequest make_request(const std::string& content) {
+    TranscribeRequest request;
+    request.set_audiocontent(content);
+    return request;
+}
+
+SCENARIO("A user wants to queue writes on a bidirectional stream") {
+    GIVEN("a reactor with a write in flight for the initial configuration") {
+        MockQueuedBidiReactor reactor;
+        MockStream stream;
+        stream.bind(&reactor);
+        WHEN("messages are enqueued") {
+            REQUIRE(reactor.enqueueWrite(make_request("a")));
+            REQUIRE(reactor.enqueueWrite(make_request("b")));
+            REQUIRE(reactor.enqueueWrite(make_request("c")));
+            THEN("the messages wait for the initial write to complete") {
+                REQUIRE(stream.writes.empty());
+                REQUIRE(3 == reactor.getQueueSize());
+            }
+            THEN("completions chain the queued writes in order") {
+                REQUIRE(stream.complete(reactor));
+                REQUIRE(stream.complete(reactor));
+                REQUIRE(stream.complete(reactor));
+                REQUIRE(stream.complete(reactor));
+                REQUIRE_FALSE(stream.complete(reactor));
+                REQUIRE(std::vector<std::string>({"a", "b", "c"}) == stream.writes);
+                REQUIRE(0 == reactor.getQueueSize());
+            }
+            THEN("small messages are hinted when more messages are queued") {
+                while (stream.complete(reactor)) { }
+                REQUIRE(std::vector<bool>({true, true, false}) == stream.hints);
+            }
+        }
+        WHEN("the call is started") {
+            reactor.StartCall();
+            THEN("a hold is placed on the stream for the write flow") {
+                REQUIRE(1 == stream.starts);
+                REQUIRE(1 == stream.holds);
+            }
+            AND_WHEN("the write queue is closed and drained") {
+                reactor.enqueueWritesDone();
+                stream.complete(reactor);
+                THEN("the hold is released after writes done") {
+                    REQUIRE(1 == stream.writesDone);
+                    REQUIRE(0 == stream.holds);
+                }
+            }
+            AND_WHEN("a write fails") {
+                reactor.OnWriteDone(false);
+                THEN("the hold is released") {
+                    REQUIRE(0 == stream.holds);
+                }
+            }
+        }
+        WHEN("the write queue is closed") {
+            REQUIRE(reactor.enqueueWrite(make_request("a")));
+            reactor.enqueueWritesDone();
+            THEN("new messages are rejected") {
+                REQUIRE_FALSE(reactor.enqueueWrite(make_request("b")));
+            }
+            THEN("queued messages are written before writes done") {
+                REQUIRE(0 == stream.writesDone);
+                while (stream.complete(reactor)) { }
+                REQUIRE(std::vector<std::string>({"a"}) == stream.writes);
+                REQUIRE(1 == stream.writesDone);
+            }
+        }
+        WHEN("a write fails") {
+            reactor.OnWriteDone(false);
+            THEN("new messages are rejected") {
+                REQUIRE_FALSE(reactor.enqueueWrite(make_request("a")));
+                REQUIRE(0 == reactor.getDroppedCount());
+            }
+        }
+    }
+    GIVEN("a reactor with coalescing disabled") {
+        WriteQueueOptions options;
+        options.coalesce_bytes = 0;
+        MockQueuedBidiReactor reactor(options);
+        MockStream stream;
+        stream.bind(&reactor);
+        WHEN("messages are written") {
+            reactor.enqueueWrite(make_request("a"));
+            reactor.enqueueWrite(make_request("b"));
+            while (stream.complete(reactor)) { }
+            THEN("no buffer hints are set") {
+                REQUIRE(std::vector<bool>({false, false}) == stream.hints);
+            }
+        }
+    }
+}
+
+SCENARIO("A user wants to control the behavior of a full write queue") {
+    GIVEN("invalid watermarks") {
+        WriteQueueOptions options;
+        options.low_watermark = options.high_watermark;
+        THEN("an invalid argument error is thrown") {
+            REQUIRE_THROWS_AS(MockQueuedBidiReactor(options), std::invalid_argument);
+        }
+    }
+    GIVEN("a reactor with a full queue and the fail policy") {
+        WriteQueueOptions options;
+        options.capacity = 2;
+        options.high_watermark = 2;
+        options.low_watermark = 0;
+        options.policy = QueueFullPolicy::Fail;
+        MockQueuedBidiReactor reactor(options);
+        MockStream stream;
+        stream.bind(&reactor);
+        REQUIRE(reactor.enqueueWrite(make_request("a")));
+        REQUIRE(reactor.enqueueWrite(make_request("b")));
+        WHEN("another message is enqueued") {
+            const auto ok = reactor.enqueueWrite(make_request("c"));
+            THEN("the message is rejected") {
+                REQUIRE_FALSE(ok);
+                REQUIRE(1 == reactor.getDroppedCount());
+                while (stream.complete(reactor)) { }
+                REQUIRE(std::vector<std::string>({"a", "b"}) == stream.writes);
+            }
+        }
+        WHEN("another message is enqueued with the drop oldest policy") {
+            const auto ok = reactor.enqueueWrite(make_request("c"), QueueFullPolicy::DropOldest);
+            THEN("the oldest message is discarded") {
+                REQUIRE(ok);
+                REQUIRE(1 == reactor.getDroppedCount());
+                REQUIRE(2 == reactor.getQueueSize());
+                while (stream.complete(reactor)) { }
+                REQUIRE(std::vector<std::string>({"b", "c"}) == stream.writes);
+            }
+        }
+        WHEN("another message is enqueued with the block policy") {
+            std::atomic<bool> isEnqueued(false);
+            std::thread producer([&reactor, &isEnqueued]() {
+                isEnqueued = reactor.enqueueWrite(make_request("c"), QueueFullPolicy::Block);
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            const auto wasBlocked = !isEnqueued.load();
+            // Complete the initial write to free a slot in the queue.
+            stream.complete(reactor);
+            producer.join();
+            THEN("the producer blocks until space is available") {
+                REQUIRE(wasBlocked);
+                REQUIRE(isEnqueued);
+                while (stream.complete(reactor)) { }
+                REQUIRE(std::vector<std::string>({"a", "b", "c"}) == stream.writes);
+            }
+        }
+        WHEN("the stream finishes while a producer is blocked") {
+            std::atomic<bool> isEnqueued(true);
+            std::thread producer([&reactor, &isEnqueued]() {
+                isEnqueued = reactor.enqueueWrite(make_request("c"), QueueFullPolicy::Block);
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            reactor.OnDone({::grpc::StatusCode::CANCELLED, "cancelled"});
+            producer.join();
+            THEN("the producer is released and the message is rejected") {
+                REQUIRE_FALSE(isEnqueued);
+                REQUIRE(reactor.getIsDone());
+            }
+        }
+    }
+}
+
+SCENARIO("A user wants to be notified when the write queue backs up") {
+    GIVEN("a reactor with watermark callbacks") {
+        WriteQueueOptions options;
+        options.capacity = 4;
+        options.high_watermark = 3;
+        options.low_watermark = 1;
+        MockQueuedBidiReactor reactor(options);
+        MockStream stream;
+        stream.bind(&reactor);
+        int high = 0;
+        int low = 0;
+        reactor.setHighWatermarkCallback([&high]() { high++; });
+        reactor.setLowWatermarkCallback([&low]() { low++; });
+        WHEN("the queue fills to the high watermark") {
+            reactor.enqueueWrite(make_request("a"));
+            reactor.enqueueWrite(make_request("b"));
+            REQUIRE(0 == high);
+            reactor.enqueueWrite(make_request("c"));
+            reactor.enqueueWrite(make_request("d"));
+            THEN("the high watermark callback fires once") {
+                REQUIRE(1 == high);
+                REQUIRE(0 == low);
+            }
+            AND_WHEN("the queue drains to the low watermark") {
+                stream.complete(reactor);  // 3 remain in the queue
+                stream.complete(reactor);  // 2 remain in the queue
+                REQUIRE(0 == low);
+                stream.complete(reactor);  // 1 remains in the queue
+                while (stream.complete(reactor)) { }
+                THEN("the low watermark callback fires once") {
+                    REQUIRE(1 == high);
+                    REQUIRE(1 == low);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("A user wants to measure the latency of queued writes") {
+    GIVEN("a reactor with a write done callback") {
+        MockQueuedBidiReactor reactor;
+        MockStream stream;
+        stream.bind(&reactor);
+        std::vector<std::chrono::microseconds> latencies;
+        std::vector<std::size_t> backlogs;
+        reactor.setWriteDoneCallback([&](const std::chrono::microseconds& latency, const std::size_t& backlog) {
+            latencies.push_back(latency);
+            backlogs.push_back(backlog);
+        });
+        WHEN("queued writes complete") {
+            reactor.enqueueWrite(make_request("a"));
+            reactor.enqueueWrite(make_request("b"));
+            stream.complete(reactor);  // the initial configuration
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            stream.complete(reactor);
+            stream.complete(reactor);
+            THEN("the callback fires for each queued write but not the configuration") {
+                REQUIRE(2 == latencies.size());
+                REQUIRE(latencies[0] >= std::chrono::milliseconds(5));
+                REQUIRE(std::vector<std::size_t>({1, 0}) == backlogs);
+            }
+        }
+    }
+}
+
+SCENARIO("Multiple threads want to write to a queued bidirectional stream") {
+    GIVEN("a reactor with a small queue and several blocking producers") {
+        WriteQueueOptions options;
+        options.capacity = 8;
+        options.high_watermark = 6;
+        options.low_watermark = 2;
+        MockQueuedBidiReactor reactor(options);
+        MockStream stream;
+        stream.bind(&reactor);
+        const int NUM_PRODUCERS = 4;
+        const int WRITES_PER_PRODUCER = 500;
+        std::vector<std::thread> producers;
+        for (int p = 0; p < NUM_PRODUCERS; p++) {
+            producers.emplace_back([&reactor, p, WRITES_PER_PRODUCER]() {
+                for (int i = 0; i < WRITES_PER_PRODUCER; i++)
+                    reactor.enqueueWrite(make_request(std::to_string(p * WRITES_PER_PRODUCER + i)));
+            });
+        }
+        // Act as the network, completing writes as they are started.
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(stream.mutex);
+                if (stream.writes.size() == NUM_PRODUCERS * WRITES_PER_PRODUCER) break;
+            }
+            if (!stream.complete(reactor)) std::this_thread::yield();
+        }
+        for (auto& producer : producers) producer.join();
+        WHEN("all of the writes complete") {
+            THEN("every message was written exactly once") {
+                std::vector<int> values;
+                for (const auto& write : stream.writes) values.push_back(std::stoi(write));
+                std::sort(values.begin(), values.end());
+                bool ok = true;
+                for (std::size_t i = 0; i < values.size(); i++)
+                    ok &= values[i] == static_cast<int>(i);
+                REQUIRE(ok);
+                REQUIRE(0 == reactor.getDroppedCount());
+            }
+        }
+    }
+}
@@ -0,0 +1,204 @@
+// Test cases for the ReadAheadBidiReactor structure.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sensorycloud/calldata/read_ahead_bidi_reactor.hpp"
+#include "sensorycloud/generated/v1/audio/audio.pb.h"
+
+using ::sensory::api::v1::audio::TranscribeRequest;
+using ::sensory::api::v1::audio::TranscribeResponse;
+
+/// @brief A dummy type acting as the encapsulating type of the reactor.
+struct MockReadAheadBidiReactorFriend { };
+/// @brief The reactor to test based on arbitrary SDK messages.
+typedef sensory::calldata::ReadAheadBidiReactor<
+    MockReadAheadBidiReactorFriend,
+    TranscribeRequest,
+    TranscribeResponse
+> MockReadAheadBidiReactor;
+
+/// @brief A stream that records the reads started by a reactor.
+class MockStream : public ::grpc::ClientCallbackReaderWriter<TranscribeRequest, TranscribeResponse> {
+ public:
+    /// The buffer of the outstanding read.
+    std::atomic<TranscribeResponse*> reading;
+    /// The number of reads that were started.
+    std::atomic<int> reads;
+    /// The number of holds on the stream.
+    std::atomic<int> holds;
+
+    /// @brief Initialize the stream without any outstanding reads.
+    MockStream() : reading(nullptr), reads(0), holds(0) { }
+
+    /// @brief Bind the stream to a reactor.
+    ///
+    /// @param reactor The reactor to bind the stream to.
+    ///
+    void bind(::grpc::ClientBidiReactor<TranscribeRequest, TranscribeResponse>* reactor) {
+        BindReactor(reactor);
+    }
+
+    void StartCall() override { }
+    void Write(const TranscribeRequest*, ::grpc::WriteOptions) override { }
+    void WritesDone() override { }
+    void Read(TranscribeResponse* response) override {
+        reads++;
+        reading = response;
+    }
+    void AddHold(int count) override { holds += count; }
+    void RemoveHold() override { holds--; }
+
+    /// @brief Deliver a response to the outstanding read of the reactor.
+    ///
+    /// @param reactor The reactor to deliver the response to.
+    /// @param action_id The post-processing action ID of the response.
+    /// @returns `true` if a read was outstanding, `false` otherwise.
+    ///
+    bool deliver(MockReadAheadBidiReactor& reactor, const std::string& action_id) {
+        auto response = reading.exchange(nullptr);
+        if (response == nullptr) return false;
+        response->mutable_postprocessingaction()->set_actionid(action_id);
+        reactor.OnReadDone(true);
+        return true;
+    }
+
+    /// @brief Close the read flow of the reactor.
+    ///
+    /// @param reactor The reactor to notify of the end of the stream.
+    ///
+    void finish(MockReadAheadBidiReactor& reactor) {
+        reading = nullptr;
+        reactor.OnReadDone(false);
+    }
+};
+
+SCENARIO("A user wants to read ahead on a bidirectional stream") {
+    GIVEN("a reactor with a read-ahead capacity of 2 and an outstanding read") {
+        MockReadAheadBidiReactor reactor(2);
+        MockStream stream;
+        stream.bind(&reactor);
+        reactor.StartRead(&reactor.response);
+        reactor.StartCall();
+        THEN("holds are placed on the stream for the read and write flows") {
+            REQUIRE(2 == stream.holds);
+        }
+        WHEN("no responses have arrived") {
+            TranscribeResponse response;
+            THEN("non-blocking pops fail") {
+                REQUIRE_FALSE(reactor.tryPopResponse(response));
+            }
+            THEN("pops with a timeout expire") {
+                REQUIRE_FALSE(reactor.popResponse(response, std::chrono::milliseconds(10)));
+            }
+        }
+        WHEN("responses arrive while there is space in the ring") {
+            REQUIRE(stream.deliver(reactor, "a"));
+            REQUIRE(stream.deliver(reactor, "b"));
+            THEN("the next read is started immediately") {
+                REQUIRE(3 == stream.reads);
+                REQUIRE(2 == reactor.getResponseCount());
+            }
+            THEN("responses are popped in order") {
+                TranscribeResponse response;
+                REQUIRE(reactor.tryPopResponse(response));
+                REQUIRE_THAT(response.postprocessingaction().actionid(), Catch::Equals("a"));
+                REQUIRE(reactor.popResponse(response));
+                REQUIRE_THAT(response.postprocessingaction().actionid(), Catch::Equals("b"));
+            }
+        }
+        WHEN("a response arrives while the ring is full") {
+            REQUIRE(stream.deliver(reactor, "a"));
+            REQUIRE(stream.deliver(reactor, "b"));
+            REQUIRE(stream.deliver(reactor, "c"));
+            THEN("reads are paused") {
+                REQUIRE(3 == stream.reads);
+                REQUIRE_FALSE(stream.deliver(reactor, "d"));
+            }
+            AND_WHEN("the consumer frees a slot") {
+                TranscribeResponse response;
+                REQUIRE(reactor.tryPopResponse(response));
+                THEN("the held response is queued and reads resume") {
+                    REQUIRE(4 == stream.reads);
+                    REQUIRE(2 == reactor.getResponseCount());
+                    REQUIRE(stream.deliver(reactor, "d"));
+                    std::vector<std::string> action_ids;
+                    while (reactor.tryPopResponse(response))
+                        action_ids.push_back(response.postprocessingaction().actionid());
+                    REQUIRE(std::vector<std::string>({"b", "c", "d"}) == action_ids);
+                }
+            }
+        }
+        WHEN("the server closes the stream") {
+            REQUIRE(stream.deliver(reactor, "a"));
+            stream.finish(reactor);
+            THEN("the read hold is released") {
+                REQUIRE(1 == stream.holds);
+            }
+            THEN("buffered responses are drained before the end is reported") {
+                TranscribeResponse response;
+                REQUIRE(reactor.popResponse(response));
+                REQUIRE_THAT(response.postprocessingaction().actionid(), Catch::Equals("a"));
+                REQUIRE_FALSE(reactor.popResponse(response));
+            }
+        }
+    }
+}
+
+SCENARIO("A consumer thread wants to block on responses from a stream") {
+    GIVEN("a reactor with a small ring and a server producing many responses") {
+        MockReadAheadBidiReactor reactor(4);
+        MockStream stream;
+        stream.bind(&reactor);
+        reactor.StartRead(&reactor.response);
+        reactor.StartCall();
+        const int NUM_RESPONSES = 1000;
+        std::vector<std::string> action_ids;
+        std::thread consumer([&reactor, &action_ids]() {
+            TranscribeResponse response;
+            while (reactor.popResponse(response))
+                action_ids.push_back(response.postprocessingaction().actionid());
+        });
+        for (int i = 0; i < NUM_RESPONSES; i++)
+            while (!stream.deliver(reactor, std::to_string(i)))
+                std::this_thread::yield();
+        // Wait for the final read to be started before closing the stream.
+        while (stream.reading.load() == nullptr) std::this_thread::yield();
+        stream.finish(reactor);
+        consumer.join();
+        THEN("every response is delivered to the consumer in order") {
+            REQUIRE(NUM_RESPONSES == action_ids.size());
+            bool ok = true;
+            for (int i = 0; i < NUM_RESPONSES; i++)
+                ok &= action_ids[i] == std::to_string(i);
+            REQUIRE(ok);
+        }
+    }
+}
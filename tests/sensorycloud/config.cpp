@@ -122,6 +122,33 @@ SCENARIO("A user wants to change the gRPC timeout") {
     }
 }
 
+SCENARIO("A user wants to change the executor for asynchronous callbacks") {
+    GIVEN("an initialized cloud host") {
+        sensory::Config config("localhost:50051", "tenant_id", "deviceID");
+        THEN("callbacks are invoked inline by default") {
+            REQUIRE(nullptr != std::dynamic_pointer_cast<sensory::util::InlineExecutor>(config.get_executor()));
+        }
+        WHEN("the executor is set") {
+            auto executor = std::make_shared<sensory::util::ThreadPoolExecutor>(2);
+            config.set_executor(executor);
+            THEN("the executor is stored") {
+                REQUIRE(executor == config.get_executor());
+            }
+            AND_WHEN("the config is copied") {
+                const sensory::Config copy(config);
+                THEN("the copy shares the executor") {
+                    REQUIRE(executor == copy.get_executor());
+                }
+            }
+        }
+        WHEN("the executor is set to null") {
+            THEN("an invalid argument error is thrown") {
+                REQUIRE_THROWS_AS(config.set_executor(nullptr), std::invalid_argument);
+            }
+        }
+    }
+}
+
 SCENARIO("A user wants to control the security of the connection to a cloud host") {
     WHEN("The cloud host is initialized with isSecure=true") {
         sensory::Config config("localhost:50051", "tenant_id", "deviceID", true);
@@ -25,10 +25,17 @@
 
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch.hpp>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
 #include "sensorycloud/io/path.hpp"
 
 using sensory::io::path::normalize_uri;
 using sensory::io::path::is_file;
+using sensory::io::path::is_directory;
+using sensory::io::path::list_files;
 
 // ---------------------------------------------------------------------------
 // MARK: normalize_uri
@@ -117,3 +124,63 @@ SCENARIO("Paths need to be checked to determine if they are files or not") {
         }
     }
 }
+
+// ---------------------------------------------------------------------------
+// MARK: is_directory
+// ---------------------------------------------------------------------------
+
+SCENARIO("Paths need to be checked to determine if they are directories or not") {
+    GIVEN("a path to a directory") {
+        THEN("true is returned") {
+            REQUIRE(is_directory("/usr"));
+        }
+    }
+    GIVEN("a path to a file") {
+        THEN("false is returned") {
+            REQUIRE_FALSE(is_directory("/bin/ls"));
+        }
+    }
+    GIVEN("an invalid path") {
+        THEN("false is returned") {
+            REQUIRE_FALSE(is_directory("/foo/bar/zam"));
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// MARK: list_files
+// ---------------------------------------------------------------------------
+
+SCENARIO("Directories need to be listed to find the files in them") {
+    GIVEN("a directory with files and a sub-directory") {
+        char pattern[] = "/tmp/sensorycloud_path_XXXXXX";
+        const std::string directory = mkdtemp(pattern);
+        const std::vector<std::string> names = {"b.wav", "a.WAV", "c.txt"};
+        for (const auto& name : names) std::ofstream(directory + "/" + name) << "data";
+        mkdir((directory + "/d.wav").c_str(), 0700);
+        WHEN("the files are listed without an extension") {
+            const auto files = list_files(directory);
+            THEN("every regular file is returned in sorted order") {
+                REQUIRE(std::vector<std::string>({
+                    directory + "/a.WAV", directory + "/b.wav", directory + "/c.txt"
+                }) == files);
+            }
+        }
+        WHEN("the files are listed with an extension") {
+            const auto files = list_files(directory + "/", ".wav");
+            THEN("the files with the extension are returned in any case") {
+                REQUIRE(std::vector<std::string>({
+                    directory + "/a.WAV", directory + "/b.wav"
+                }) == files);
+            }
+        }
+        for (const auto& name : names) std::remove((directory + "/" + name).c_str());
+        rmdir((directory + "/d.wav").c_str());
+        rmdir(directory.c_str());
+    }
+    GIVEN("a path that is not a directory") {
+        THEN("a runtime error is thrown") {
+            REQUIRE_THROWS_AS(list_files("/foo/bar/zam"), std::runtime_error);
+        }
+    }
+}
@@ -593,3 +593,85 @@ SCENARIO("A client requires a synchronous interface to the audio service") {
         }
     }
 }
+
+// ---------------------------------------------------------------------------
+// MARK: AudioService (callback interface)
+// ---------------------------------------------------------------------------
+
+/// @brief A callback reader that completes the stream on the first read.
+class MockSynthesizeSpeechReader :
+    public ::grpc::ClientCallbackReader<SynthesizeSpeechResponse> {
+ public:
+    /// The reactor that the reader is bound to.
+    ::grpc::ClientReadReactor<SynthesizeSpeechResponse>* reactor = nullptr;
+
+    void bind(::grpc::ClientReadReactor<SynthesizeSpeechResponse>* reactor_) {
+        reactor = reactor_;
+        BindReactor(reactor);
+    }
+
+    void StartCall() override { }
+    void Read(SynthesizeSpeechResponse*) override { reactor->OnDone(Status::OK); }
+    void AddHold(int) override { }
+    void RemoveHold() override { }
+};
+
+/// @brief A synthesis stub that captures the request of the callback call.
+class MockAudioSynthesisCallbackStub :
+    public ::sensory::api::v1::audio::MockAudioSynthesisStub {
+ public:
+    /// @brief The callback interface of the stub.
+    class MockAsync : public async_interface {
+     public:
+        /// A copy of the request that the stream was opened with.
+        SynthesizeSpeechRequest request;
+        /// The callback reader bound to the reactor.
+        MockSynthesizeSpeechReader reader;
+
+        void SynthesizeSpeech(ClientContext*,
+            const SynthesizeSpeechRequest* request_,
+            ::grpc::ClientReadReactor<SynthesizeSpeechResponse>* reactor
+        ) override {
+            request.CopyFrom(*request_);
+            reader.bind(reactor);
+        }
+    } mock_async;
+
+    async_interface* async() override { return &mock_async; }
+};
+
+SCENARIO("A client requires a callback interface to the audio service") {
+    GIVEN("An initialized audio service.") {
+        Config config("hostname.com", 443, "tenant ID", "device ID", false);
+        OAuthService oauth_service(config);
+        InMemoryCredentialStore keychain;
+        TokenManager<InMemoryCredentialStore> token_manager(oauth_service, keychain);
+        auto synthesis_stub = new MockAudioSynthesisCallbackStub;
+        AudioService<InMemoryCredentialStore> service(config,
+            token_manager,
+            new ::sensory::api::v1::audio::MockAudioModelsStub,
+            new ::sensory::api::v1::audio::MockAudioBiometricsStub,
+            new ::sensory::api::v1::audio::MockAudioEventsStub,
+            new ::sensory::api::v1::audio::MockAudioTranscriptionsStub,
+            synthesis_stub
+        );
+
+        // ----- Synthesize Speech ---------------------------------------------
+
+        WHEN("SynthesizeSpeech is called with a reactor") {
+            AudioService<InMemoryCredentialStore>::SynthesizeSpeechReadReactor reactor;
+            service.synthesize_speech(&reactor,
+                "text_to_spectrogram_craig_en-us",
+                22050,
+                "Hello, World!"
+            );
+            THEN("the stream is opened with the config and the phrase") {
+                const auto& request = synthesis_stub->mock_async.request;
+                REQUIRE("text_to_spectrogram_craig_en-us" == request.config().modelname());
+                REQUIRE(22050 == request.config().sampleratehertz());
+                REQUIRE("Hello, World!" == request.phrase());
+                REQUIRE(reactor.await().ok());
+            }
+        }
+    }
+}
@@ -0,0 +1,414 @@
+// Test cases for the enrollment token cache in the SensoryCloud C++ SDK.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <thread>
+#include "sensorycloud/token_manager/enrollment_token_cache.hpp"
+#include "sensorycloud/token_manager/file_system_credential_store.hpp"
+#include "sensorycloud/token_manager/in_memory_credential_store.hpp"
+#include "sensorycloud/generated/v1/audio/audio.pb.h"
+#include "sensorycloud/generated/v1/video/video.pb.h"
+
+using sensory::token_manager::EnrollmentTokenCache;
+using sensory::token_manager::EnrollmentTokenCacheOptions;
+using sensory::token_manager::FileSystemCredentialStore;
+using sensory::token_manager::InMemoryCredentialStore;
+
+/// @brief Return an enrollment token with binary content.
+static std::string make_token(char seed, std::size_t size = 48) {
+    std::string token(size, '\0');
+    for (std::size_t i = 0; i < size; i++)
+        token[i] = static_cast<char>(seed * 31 + i * 7);
+    return token;
+}
+
+SCENARIO("a user wants to cache enrollment tokens") {
+    GIVEN("an enrollment token cache backed by an in-memory store") {
+        InMemoryCredentialStore store;
+        EnrollmentTokenCache<InMemoryCredentialStore> cache(store);
+        WHEN("the cache is initialized") {
+            THEN("an encryption key is generated in the store") {
+                REQUIRE(store.contains("enrollmentToken.key"));
+                REQUIRE(2 * sensory::util::AEAD_KEY_SIZE == store.at("enrollmentToken.key").size());
+            }
+            THEN("the cache is empty") {
+                REQUIRE_FALSE(cache.contains("enrollment"));
+                REQUIRE(0 == cache.get_num_memory_entries());
+                REQUIRE(0 == cache.get_num_stored_entries());
+                REQUIRE(0 == cache.get_num_stored_bytes());
+            }
+        }
+        WHEN("a token that is not cached is looked up") {
+            std::string token = "unchanged";
+            THEN("the look-up misses") {
+                REQUIRE_FALSE(cache.get("enrollment", token));
+                REQUIRE("unchanged" == token);
+                REQUIRE(0 == cache.get_num_hits());
+                REQUIRE(1 == cache.get_num_misses());
+            }
+        }
+        WHEN("a token is inserted") {
+            const auto expected = make_token('a');
+            cache.put("enrollment", expected);
+            THEN("the token is cached in both tiers") {
+                REQUIRE(cache.contains("enrollment"));
+                REQUIRE(1 == cache.get_num_memory_entries());
+                REQUIRE(1 == cache.get_num_stored_entries());
+                REQUIRE(0 < cache.get_num_stored_bytes());
+            }
+            THEN("the token is returned by a look-up") {
+                std::string token;
+                REQUIRE(cache.get("enrollment", token));
+                REQUIRE(expected == token);
+                REQUIRE(1 == cache.get_num_hits());
+                REQUIRE(0 == cache.get_num_misses());
+            }
+            THEN("the token is not stored in plain-text") {
+                const auto key = "enrollmentToken." + std::string("656e726f6c6c6d656e74");
+                REQUIRE(store.contains(key));
+                REQUIRE(std::string::npos == store.at(key).find(expected));
+            }
+            THEN("the token is replaced by another insertion") {
+                const auto replacement = make_token('b', 100);
+                cache.put("enrollment", replacement);
+                std::string token;
+                REQUIRE(cache.get("enrollment", token));
+                REQUIRE(replacement == token);
+                REQUIRE(1 == cache.get_num_stored_entries());
+            }
+            THEN("the token is removed by erase") {
+                cache.erase("enrollment");
+                std::string token;
+                REQUIRE_FALSE(cache.contains("enrollment"));
+                REQUIRE_FALSE(cache.get("enrollment", token));
+                REQUIRE(0 == cache.get_num_stored_entries());
+                REQUIRE(0 == cache.get_num_stored_bytes());
+            }
+            THEN("the token is removed by clear, but the key is kept") {
+                cache.clear();
+                REQUIRE_FALSE(cache.contains("enrollment"));
+                REQUIRE(0 == cache.get_num_memory_entries());
+                REQUIRE(0 == cache.get_num_stored_entries());
+                REQUIRE(store.contains("enrollmentToken.key"));
+            }
+            THEN("the token is available from another cache over the store") {
+                EnrollmentTokenCache<InMemoryCredentialStore> other(store);
+                REQUIRE(0 == other.get_num_memory_entries());
+                REQUIRE(1 == other.get_num_stored_entries());
+                std::string token;
+                REQUIRE(other.get("enrollment", token));
+                REQUIRE(expected == token);
+                REQUIRE(1 == other.get_num_memory_entries());
+            }
+        }
+    }
+}
+
+SCENARIO("a user wants the enrollment token cache to be bounded") {
+    GIVEN("a cache with a memory tier of 2 tokens and a store of 3 tokens") {
+        InMemoryCredentialStore store;
+        EnrollmentTokenCacheOptions options;
+        options.max_memory_entries = 2;
+        options.max_stored_entries = 3;
+        EnrollmentTokenCache<InMemoryCredentialStore> cache(store, options);
+        WHEN("3 tokens are inserted") {
+            cache.put("a", make_token('a'));
+            cache.put("b", make_token('b'));
+            cache.put("c", make_token('c'));
+            THEN("the least recently used token is evicted from memory") {
+                REQUIRE(2 == cache.get_num_memory_entries());
+                REQUIRE(3 == cache.get_num_stored_entries());
+            }
+            THEN("the evicted token is loaded from the store") {
+                std::string token;
+                REQUIRE(cache.get("a", token));
+                REQUIRE(make_token('a') == token);
+                REQUIRE(2 == cache.get_num_memory_entries());
+            }
+        }
+        WHEN("a 4th token is inserted after the oldest token is used") {
+            cache.put("a", make_token('a'));
+            cache.put("b", make_token('b'));
+            cache.put("c", make_token('c'));
+            std::string token;
+            REQUIRE(cache.get("a", token));
+            cache.put("d", make_token('d'));
+            THEN("the least recently used token is evicted from the store") {
+                REQUIRE(3 == cache.get_num_stored_entries());
+                REQUIRE(cache.contains("a"));
+                REQUIRE_FALSE(cache.contains("b"));
+                REQUIRE(cache.contains("c"));
+                REQUIRE(cache.contains("d"));
+                REQUIRE_FALSE(store.contains("enrollmentToken.62"));
+                REQUIRE_FALSE(cache.get("b", token));
+            }
+        }
+        WHEN("the store is reopened after a token in memory is used") {
+            cache.put("a", make_token('a'));
+            cache.put("b", make_token('b'));
+            cache.put("c", make_token('c'));
+            std::string token;
+            REQUIRE(cache.get("c", token));
+            REQUIRE(cache.get("a", token));
+            EnrollmentTokenCache<InMemoryCredentialStore> reopened(store, options);
+            reopened.put("d", make_token('d'));
+            THEN("the least recently used token is evicted from the store") {
+                REQUIRE(reopened.contains("a"));
+                REQUIRE_FALSE(reopened.contains("b"));
+                REQUIRE(reopened.contains("c"));
+                REQUIRE(reopened.contains("d"));
+            }
+        }
+    }
+    GIVEN("a cache with a store bounded in bytes") {
+        InMemoryCredentialStore store;
+        EnrollmentTokenCacheOptions options;
+        options.max_stored_bytes = 400;
+        EnrollmentTokenCache<InMemoryCredentialStore> cache(store, options);
+        WHEN("tokens are inserted past the bound") {
+            for (char seed = 'a'; seed <= 'h'; seed++)
+                cache.put(std::string(1, seed), make_token(seed, 100));
+            THEN("the store remains in bounds") {
+                REQUIRE(400 >= cache.get_num_stored_bytes());
+                REQUIRE(0 < cache.get_num_stored_entries());
+                REQUIRE(cache.contains("h"));
+                REQUIRE_FALSE(cache.contains("a"));
+            }
+        }
+        WHEN("a token larger than the bound is inserted") {
+            cache.put("big", make_token('z', 1000));
+            THEN("the token is not cached") {
+                std::string token;
+                REQUIRE_FALSE(cache.get("big", token));
+                REQUIRE(0 == cache.get_num_memory_entries());
+                REQUIRE(0 == cache.get_num_stored_entries());
+                REQUIRE(0 == cache.get_num_stored_bytes());
+            }
+        }
+    }
+}
+
+SCENARIO("a user wants invalid enrollment tokens to be rejected") {
+    GIVEN("a cache without a memory tier") {
+        InMemoryCredentialStore store;
+        EnrollmentTokenCacheOptions options;
+        options.max_memory_entries = 0;
+        EnrollmentTokenCache<InMemoryCredentialStore> cache(store, options);
+        cache.put("a", make_token('a'));
+        cache.put("b", make_token('b'));
+        WHEN("a stored token is tampered with") {
+            auto value = store.at("enrollmentToken.61");
+            value[value.size() / 2] = value[value.size() / 2] == 'A' ? 'B' : 'A';
+            store.emplace("enrollmentToken.61", value);
+            THEN("the look-up misses and the token is removed") {
+                std::string token;
+                REQUIRE_FALSE(cache.get("a", token));
+                REQUIRE_FALSE(cache.contains("a"));
+                REQUIRE_FALSE(store.contains("enrollmentToken.61"));
+                REQUIRE(1 == cache.get_num_misses());
+            }
+        }
+        WHEN("a stored token is moved to another enrollment") {
+            store.emplace("enrollmentToken.61", store.at("enrollmentToken.62"));
+            THEN("the look-up misses") {
+                std::string token;
+                REQUIRE_FALSE(cache.get("a", token));
+                REQUIRE(cache.get("b", token));
+            }
+        }
+        WHEN("a stored token is not valid base64") {
+            store.emplace("enrollmentToken.61", "not base64!");
+            THEN("the look-up misses") {
+                std::string token;
+                REQUIRE_FALSE(cache.get("a", token));
+            }
+        }
+        WHEN("the encryption key is replaced") {
+            store.emplace("enrollmentToken.key", "corrupt");
+            EnrollmentTokenCache<InMemoryCredentialStore> other(store, options);
+            THEN("the unreadable tokens are discarded") {
+                std::string token;
+                REQUIRE(0 == other.get_num_stored_entries());
+                REQUIRE_FALSE(other.get("a", token));
+                REQUIRE_FALSE(store.contains("enrollmentToken.61"));
+            }
+        }
+    }
+    GIVEN("a cache with a token that expires in 1 second") {
+        InMemoryCredentialStore store;
+        EnrollmentTokenCache<InMemoryCredentialStore> cache(store);
+        cache.put("a", make_token('a'), 1);
+        cache.put("b", make_token('b'), 0);
+        WHEN("the token is looked up immediately") {
+            THEN("the look-up hits") {
+                std::string token;
+                REQUIRE(cache.get("a", token));
+            }
+        }
+        WHEN("the token is looked up after expiring") {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+            THEN("the look-up misses and the token is removed") {
+                std::string token;
+                REQUIRE_FALSE(cache.contains("a"));
+                REQUIRE_FALSE(cache.get("a", token));
+                REQUIRE(1 == cache.get_num_stored_entries());
+                REQUIRE(cache.get("b", token));
+            }
+        }
+    }
+}
+
+SCENARIO("a user wants to provide the enrollment token encryption key") {
+    GIVEN("a key of the wrong size") {
+        InMemoryCredentialStore store;
+        EnrollmentTokenCacheOptions options;
+        options.encryption_key = "too short";
+        THEN("the cache cannot be initialized") {
+            REQUIRE_THROWS_AS(EnrollmentTokenCache<InMemoryCredentialStore>(store, options), std::invalid_argument);
+        }
+    }
+    GIVEN("a cache with a provided key") {
+        InMemoryCredentialStore store;
+        EnrollmentTokenCacheOptions options;
+        options.encryption_key = sensory::util::aead_generate_key();
+        EnrollmentTokenCache<InMemoryCredentialStore> cache(store, options);
+        cache.put("a", make_token('a'));
+        THEN("the key is not written to the store") {
+            REQUIRE_FALSE(store.contains("enrollmentToken.key"));
+        }
+        WHEN("another cache opens the store with the same key") {
+            EnrollmentTokenCache<InMemoryCredentialStore> other(store, options);
+            THEN("the token is decrypted") {
+                std::string token;
+                REQUIRE(other.get("a", token));
+                REQUIRE(make_token('a') == token);
+            }
+        }
+        WHEN("another cache opens the store with another key") {
+            options.encryption_key = sensory::util::aead_generate_key();
+            EnrollmentTokenCache<InMemoryCredentialStore> other(store, options);
+            THEN("the token is not decrypted") {
+                std::string token;
+                REQUIRE_FALSE(other.get("a", token));
+            }
+        }
+    }
+}
+
+SCENARIO("a user wants to attach cached enrollment tokens to requests") {
+    GIVEN("a cache with the token from an audio enrollment") {
+        InMemoryCredentialStore store;
+        EnrollmentTokenCache<InMemoryCredentialStore> cache(store);
+        ::sensory::api::v1::audio::CreateEnrollmentResponse response;
+        response.set_enrollmentid("audio-enrollment");
+        response.mutable_enrollmenttoken()->set_token(make_token('a'));
+        response.mutable_enrollmenttoken()->set_expiration(3600);
+        REQUIRE(cache.put(response));
+        WHEN("the token is attached to an authentication config") {
+            ::sensory::api::v1::audio::AuthenticateConfig config;
+            config.set_enrollmentid("audio-enrollment");
+            THEN("the config has the token") {
+                REQUIRE(cache.attach(config));
+                REQUIRE(make_token('a') == config.enrollmenttoken());
+            }
+        }
+        WHEN("the token is attached to an enrolled event config") {
+            ::sensory::api::v1::audio::ValidateEnrolledEventConfig config;
+            config.set_enrollmentid("audio-enrollment");
+            THEN("the config has the token") {
+                REQUIRE(cache.attach(config));
+                REQUIRE(make_token('a') == config.enrollmenttoken());
+            }
+        }
+        WHEN("a config for an uncached enrollment is attached to") {
+            ::sensory::api::v1::audio::AuthenticateConfig config;
+            config.set_enrollmentid("other-enrollment");
+            THEN("no token is attached") {
+                REQUIRE_FALSE(cache.attach(config));
+                REQUIRE(config.enrollmenttoken().empty());
+            }
+        }
+        WHEN("a config for an enrollment group is attached to") {
+            ::sensory::api::v1::audio::AuthenticateConfig config;
+            config.set_enrollmentgroupid("group");
+            THEN("no token is attached") {
+                REQUIRE_FALSE(cache.attach(config));
+                REQUIRE(config.enrollmenttoken().empty());
+            }
+        }
+    }
+    GIVEN("a video enrollment response with a token") {
+        InMemoryCredentialStore store;
+        EnrollmentTokenCache<InMemoryCredentialStore> cache(store);
+        ::sensory::api::v1::video::CreateEnrollmentResponse response;
+        response.set_enrollmentid("video-enrollment");
+        response.mutable_enrollmenttoken()->set_token(make_token('v'));
+        REQUIRE(cache.put(response));
+        WHEN("the token is attached to an authentication config") {
+            ::sensory::api::v1::video::AuthenticateConfig config;
+            config.set_enrollmentid("video-enrollment");
+            THEN("the config has the token") {
+                REQUIRE(cache.attach(config));
+                REQUIRE(make_token('v') == config.enrollmenttoken());
+            }
+        }
+    }
+    GIVEN("an enrollment response without a token") {
+        InMemoryCredentialStore store;
+        EnrollmentTokenCache<InMemoryCredentialStore> cache(store);
+        ::sensory::api::v1::audio::CreateEnrollmentResponse response;
+        response.set_enrollmentid("audio-enrollment");
+        THEN("nothing is cached") {
+            REQUIRE_FALSE(cache.put(response));
+            REQUIRE(0 == cache.get_num_stored_entries());
+        }
+    }
+}
+
+SCENARIO("a user wants to cache enrollment tokens on a file system") {
+    GIVEN("a file-system credential store") {
+        FileSystemCredentialStore store(".", "com.sensory.test.enrollment_token_cache");
+        EnrollmentTokenCache<FileSystemCredentialStore> cache(store);
+        cache.clear();
+        WHEN("tokens are inserted") {
+            cache.put("a", make_token('a'));
+            cache.put("b", make_token('b'), 3600);
+            THEN("the tokens are available from another cache over the store") {
+                EnrollmentTokenCache<FileSystemCredentialStore> other(store);
+                std::string token;
+                REQUIRE(2 == other.get_num_stored_entries());
+                REQUIRE(other.get("a", token));
+                REQUIRE(make_token('a') == token);
+                REQUIRE(other.get("b", token));
+                REQUIRE(make_token('b') == token);
+            }
+        }
+        cache.clear();
+        store.erase("enrollmentToken.key");
+        store.erase("enrollmentToken.index");
+    }
+}
@@ -0,0 +1,119 @@
+// Test cases for authenticated encryption in the SensoryCloud C++ SDK.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "sensorycloud/util/aead.hpp"
+
+using sensory::util::AEAD_KEY_SIZE;
+using sensory::util::AEAD_NONCE_SIZE;
+using sensory::util::AEAD_TAG_SIZE;
+using sensory::util::aead_generate_key;
+using sensory::util::aead_seal;
+using sensory::util::aead_open;
+
+SCENARIO("a user wants to generate an encryption key") {
+    WHEN("two keys are generated") {
+        const auto key1 = aead_generate_key();
+        const auto key2 = aead_generate_key();
+        THEN("the keys have the expected size") {
+            REQUIRE(AEAD_KEY_SIZE == key1.size());
+            REQUIRE(AEAD_KEY_SIZE == key2.size());
+        }
+        THEN("the keys are different") {
+            REQUIRE(key1 != key2);
+        }
+    }
+}
+
+SCENARIO("a user wants to seal and open a message") {
+    GIVEN("a key and a message") {
+        const auto key = aead_generate_key();
+        const std::string message("a secret\0message", 16);
+        WHEN("the message is sealed") {
+            const auto sealed = aead_seal(key, message, "context");
+            THEN("the sealed message has a nonce and a tag") {
+                REQUIRE(AEAD_NONCE_SIZE + message.size() + AEAD_TAG_SIZE == sealed.size());
+            }
+            THEN("the plaintext does not appear in the sealed message") {
+                REQUIRE(std::string::npos == sealed.find("secret"));
+            }
+            THEN("sealing again produces a different output") {
+                REQUIRE(sealed != aead_seal(key, message, "context"));
+            }
+            THEN("the message opens with the same key and associated data") {
+                std::string plaintext;
+                REQUIRE(aead_open(key, sealed, "context", plaintext));
+                REQUIRE(message == plaintext);
+            }
+            THEN("the message does not open with another key") {
+                std::string plaintext = "unchanged";
+                REQUIRE_FALSE(aead_open(aead_generate_key(), sealed, "context", plaintext));
+                REQUIRE("unchanged" == plaintext);
+            }
+            THEN("the message does not open with other associated data") {
+                std::string plaintext;
+                REQUIRE_FALSE(aead_open(key, sealed, "other", plaintext));
+            }
+            THEN("the message does not open when a byte is flipped") {
+                for (std::size_t i = 0; i < sealed.size(); i++) {
+                    auto tampered = sealed;
+                    tampered[i] ^= 0x01;
+                    std::string plaintext;
+                    REQUIRE_FALSE(aead_open(key, tampered, "context", plaintext));
+                }
+            }
+            THEN("the message does not open when truncated") {
+                std::string plaintext;
+                REQUIRE_FALSE(aead_open(key, sealed.substr(0, sealed.size() - 1), "context", plaintext));
+                REQUIRE_FALSE(aead_open(key, sealed.substr(0, AEAD_NONCE_SIZE), "context", plaintext));
+                REQUIRE_FALSE(aead_open(key, "", "context", plaintext));
+            }
+        }
+        WHEN("an empty message is sealed") {
+            const auto sealed = aead_seal(key, "");
+            THEN("the sealed message opens to an empty message") {
+                std::string plaintext = "unchanged";
+                REQUIRE(AEAD_NONCE_SIZE + AEAD_TAG_SIZE == sealed.size());
+                REQUIRE(aead_open(key, sealed, "", plaintext));
+                REQUIRE(plaintext.empty());
+            }
+        }
+    }
+    GIVEN("a key of the wrong size") {
+        const std::string key(16, 'k');
+        WHEN("a message is sealed") {
+            THEN("an error is thrown") {
+                REQUIRE_THROWS_AS(aead_seal(key, "message"), std::invalid_argument);
+            }
+        }
+        WHEN("a message is opened") {
+            THEN("an error is thrown") {
+                std::string plaintext;
+                REQUIRE_THROWS_AS(aead_open(key, std::string(64, 'x'), "", plaintext), std::invalid_argument);
+            }
+        }
+    }
+}
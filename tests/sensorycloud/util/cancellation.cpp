@@ -0,0 +1,171 @@
+// Test cases for the cancellation types in the sensory::util namespace.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "sensorycloud/util/cancellation.hpp"
+
+using ::sensory::util::CancellationRegistration;
+using ::sensory::util::CancellationSource;
+using ::sensory::util::CancellationToken;
+using ::sensory::util::cancel_on;
+using ::sensory::util::scoped_cancel_on;
+
+/// @brief A call that records requests for cancellation.
+struct MockCall {
+    /// The number of times that the call was cancelled.
+    std::atomic<int> cancellations;
+
+    /// @brief Initialize a call that was never cancelled.
+    MockCall() : cancellations(0) { }
+
+    /// @brief Cancel the call.
+    void tryCancel() { cancellations++; }
+};
+
+SCENARIO("A user wants to request cancellation with a token") {
+    GIVEN("a default constructed token") {
+        CancellationToken token;
+        THEN("the token can never be cancelled") {
+            REQUIRE_FALSE(token.can_be_cancelled());
+            REQUIRE_FALSE(token.is_cancelled());
+        }
+        THEN("calls can be linked to the token without effect") {
+            MockCall call;
+            auto registration = scoped_cancel_on(token, call);
+            REQUIRE(0 == call.cancellations);
+        }
+    }
+    GIVEN("a source and a token") {
+        CancellationSource source;
+        auto token = source.get_token();
+        int count = 0;
+        CancellationRegistration registration(token, [&count]() { count++; });
+        THEN("the token is not cancelled") {
+            REQUIRE(token.can_be_cancelled());
+            REQUIRE_FALSE(token.is_cancelled());
+            REQUIRE(0 == count);
+        }
+        WHEN("the source is cancelled twice") {
+            source.cancel();
+            source.cancel();
+            THEN("the callback runs once and the token is cancelled") {
+                REQUIRE(1 == count);
+                REQUIRE(token.is_cancelled());
+                REQUIRE(source.is_cancelled());
+            }
+            AND_WHEN("a callback is registered after cancellation") {
+                CancellationRegistration late(token, [&count]() { count++; });
+                THEN("the callback runs immediately") {
+                    REQUIRE(2 == count);
+                }
+            }
+        }
+        WHEN("the registration is reset before cancellation") {
+            registration.reset();
+            source.cancel();
+            THEN("the callback does not run") {
+                REQUIRE(0 == count);
+                REQUIRE(0 == token.get_state()->size());
+            }
+        }
+    }
+}
+
+SCENARIO("A user wants to cancel groups of calls together") {
+    GIVEN("a process-wide source with a session source") {
+        CancellationSource shutdown;
+        std::unique_ptr<CancellationSource> session(new CancellationSource(shutdown.get_token()));
+        auto call = std::make_shared<MockCall>();
+        cancel_on(session->get_token(), call);
+        MockCall reactor;
+        auto registration = scoped_cancel_on(session->get_token(), reactor);
+        WHEN("the session is cancelled") {
+            session->cancel();
+            THEN("the calls of the session are cancelled") {
+                REQUIRE(1 == call->cancellations);
+                REQUIRE(1 == reactor.cancellations);
+                REQUIRE_FALSE(shutdown.is_cancelled());
+            }
+        }
+        WHEN("the process is shut down") {
+            shutdown.cancel();
+            THEN("the session and its calls are cancelled") {
+                REQUIRE(session->is_cancelled());
+                REQUIRE(1 == call->cancellations);
+                REQUIRE(1 == reactor.cancellations);
+            }
+        }
+        WHEN("the session is destroyed before shutdown") {
+            registration.reset();
+            session.reset();
+            shutdown.cancel();
+            THEN("the parent does not reference the destroyed session") {
+                REQUIRE(0 == call->cancellations);
+                REQUIRE(0 == shutdown.get_token().get_state()->size());
+            }
+        }
+    }
+}
+
+SCENARIO("A user wants to link many short-lived calls to a long-lived token") {
+    GIVEN("a source and many calls that are released after completion") {
+        CancellationSource source;
+        for (int i = 0; i < 1000; i++) {
+            auto call = std::make_shared<MockCall>();
+            cancel_on(source.get_token(), call);
+        }
+        THEN("registrations of released calls are pruned") {
+            REQUIRE(128 > source.get_token().get_state()->size());
+        }
+    }
+}
+
+SCENARIO("A user wants to unregister while cancellation is in progress") {
+    GIVEN("a callback that is running on another thread") {
+        CancellationSource source;
+        std::atomic<bool> isStarted(false);
+        std::atomic<bool> isFinished(false);
+        CancellationRegistration registration(source.get_token(), [&]() {
+            isStarted = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            isFinished = true;
+        });
+        std::thread thread([&source]() { source.cancel(); });
+        while (!isStarted) std::this_thread::yield();
+        WHEN("the registration is reset") {
+            registration.reset();
+            THEN("the reset blocks until the callback finishes") {
+                REQUIRE(isFinished);
+            }
+        }
+        thread.join();
+    }
+}
@@ -0,0 +1,117 @@
+// Test cases for the executors in the sensory::util namespace.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include "sensorycloud/util/executor.hpp"
+
+using ::sensory::util::FunctionExecutor;
+using ::sensory::util::InlineExecutor;
+using ::sensory::util::ThreadPoolExecutor;
+
+SCENARIO("A user wants to execute tasks inline") {
+    GIVEN("an inline executor") {
+        InlineExecutor executor;
+        WHEN("a task is executed") {
+            std::thread::id id;
+            executor.execute([&id]() { id = std::this_thread::get_id(); });
+            THEN("the task runs immediately on the calling thread") {
+                REQUIRE(std::this_thread::get_id() == id);
+            }
+        }
+    }
+}
+
+SCENARIO("A user wants to execute tasks on a thread pool") {
+    GIVEN("a number of threads of zero") {
+        THEN("an invalid argument error is thrown") {
+            REQUIRE_THROWS_AS(ThreadPoolExecutor(0), std::invalid_argument);
+        }
+    }
+    GIVEN("a thread pool with a single thread") {
+        std::vector<int> order;
+        std::set<std::thread::id> ids;
+        {
+            ThreadPoolExecutor executor;
+            REQUIRE(1 == executor.get_num_threads());
+            for (int i = 0; i < 100; i++) {
+                executor.execute([&order, &ids, i]() {
+                    order.push_back(i);
+                    ids.insert(std::this_thread::get_id());
+                });
+            }
+        }  // Destroying the executor drains the queue of tasks.
+        THEN("every task runs in order on the worker thread") {
+            REQUIRE(100 == order.size());
+            bool ok = true;
+            for (int i = 0; i < 100; i++) ok &= order[i] == i;
+            REQUIRE(ok);
+            REQUIRE(1 == ids.size());
+            REQUIRE(0 == ids.count(std::this_thread::get_id()));
+        }
+    }
+    GIVEN("a thread pool with several threads and several producers") {
+        std::atomic<int> count(0);
+        {
+            ThreadPoolExecutor executor(4);
+            std::vector<std::thread> producers;
+            for (int p = 0; p < 4; p++) {
+                producers.emplace_back([&executor, &count]() {
+                    for (int i = 0; i < 1000; i++)
+                        executor.execute([&count]() { count++; });
+                });
+            }
+            for (auto& producer : producers) producer.join();
+        }
+        THEN("every task runs exactly once") {
+            REQUIRE(4000 == count);
+        }
+    }
+}
+
+SCENARIO("A user wants to forward tasks to an existing task system") {
+    GIVEN("a function executor that defers tasks to a queue") {
+        std::vector<std::function<void()>> deferred;
+        FunctionExecutor executor([&deferred](std::function<void()> task) {
+            deferred.push_back(std::move(task));
+        });
+        WHEN("a task is executed") {
+            bool isRun = false;
+            executor.execute([&isRun]() { isRun = true; });
+            THEN("the task is forwarded to the function") {
+                REQUIRE_FALSE(isRun);
+                REQUIRE(1 == deferred.size());
+                deferred.front()();
+                REQUIRE(isRun);
+            }
+        }
+    }
+}
@@ -0,0 +1,163 @@
+// Test cases for the Future and Promise structures.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sensorycloud/util/future.hpp"
+
+using ::sensory::util::Future;
+using ::sensory::util::Promise;
+using ::sensory::util::when_all;
+using ::sensory::util::when_any;
+
+SCENARIO("A user wants to pass a value between threads with a promise") {
+    GIVEN("a default constructed future") {
+        Future<int> future;
+        THEN("the future is not valid") {
+            REQUIRE_FALSE(future.valid());
+        }
+    }
+    GIVEN("a promise and its future") {
+        Promise<std::string> promise;
+        auto future = promise.get_future();
+        THEN("the future is valid and not ready") {
+            REQUIRE(future.valid());
+            REQUIRE_FALSE(future.is_ready());
+            REQUIRE_FALSE(future.wait_for(std::chrono::milliseconds(1)));
+        }
+        WHEN("the value is set from another thread") {
+            std::thread thread([&promise]() { promise.set_value("value"); });
+            THEN("the value is available to copies of the future") {
+                const auto copy = future;
+                REQUIRE_THAT(copy.get(), Catch::Equals("value"));
+                REQUIRE_THAT(future.get(), Catch::Equals("value"));
+                REQUIRE(future.is_ready());
+            }
+            thread.join();
+        }
+        WHEN("the value is set twice") {
+            promise.set_value("value");
+            THEN("a logic error is thrown") {
+                REQUIRE_THROWS_AS(promise.set_value("other"), std::logic_error);
+            }
+        }
+        WHEN("a continuation is registered") {
+            int count = 0;
+            future.on_ready([&count]() { count++; });
+            THEN("the continuation runs when the value is set") {
+                REQUIRE(0 == count);
+                promise.set_value("value");
+                REQUIRE(1 == count);
+            }
+        }
+        WHEN("a continuation is registered after the value is set") {
+            promise.set_value("value");
+            int count = 0;
+            future.on_ready([&count]() { count++; });
+            THEN("the continuation runs immediately") {
+                REQUIRE(1 == count);
+            }
+        }
+    }
+}
+
+SCENARIO("A user wants to wait for all of a set of futures") {
+    GIVEN("an empty set of futures") {
+        THEN("the combined future is immediately ready") {
+            auto all = when_all(std::vector<Future<int>>());
+            REQUIRE(all.is_ready());
+            REQUIRE(all.get().empty());
+        }
+    }
+    GIVEN("a set of pending futures") {
+        std::vector<Promise<int>> promises(3);
+        std::vector<Future<int>> futures;
+        for (const auto& promise : promises) futures.push_back(promise.get_future());
+        auto all = when_all(futures);
+        WHEN("some of the futures are ready") {
+            promises[2].set_value(2);
+            promises[0].set_value(0);
+            THEN("the combined future is not ready") {
+                REQUIRE_FALSE(all.is_ready());
+            }
+            AND_WHEN("the remaining future is ready") {
+                promises[1].set_value(1);
+                THEN("the values are in the order of the inputs") {
+                    REQUIRE(all.is_ready());
+                    REQUIRE(std::vector<int>({0, 1, 2}) == all.get());
+                }
+            }
+        }
+    }
+    GIVEN("many futures resolved from many threads") {
+        const int NUM_FUTURES = 1000;
+        std::vector<Promise<int>> promises(NUM_FUTURES);
+        std::vector<Future<int>> futures;
+        for (const auto& promise : promises) futures.push_back(promise.get_future());
+        auto all = when_all(futures);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&promises, t, NUM_FUTURES]() {
+                for (int i = t; i < NUM_FUTURES; i += 4) promises[i].set_value(i);
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        THEN("every value is gathered") {
+            const auto& values = all.get();
+            REQUIRE(NUM_FUTURES == values.size());
+            bool ok = true;
+            for (int i = 0; i < NUM_FUTURES; i++) ok &= values[i] == i;
+            REQUIRE(ok);
+        }
+    }
+}
+
+SCENARIO("A user wants to wait for any of a set of futures") {
+    GIVEN("an empty set of futures") {
+        THEN("an invalid argument error is thrown") {
+            REQUIRE_THROWS_AS(when_any(std::vector<Future<int>>()), std::invalid_argument);
+        }
+    }
+    GIVEN("a set of pending futures") {
+        std::vector<Promise<int>> promises(3);
+        std::vector<Future<int>> futures;
+        for (const auto& promise : promises) futures.push_back(promise.get_future());
+        auto any = when_any(futures);
+        THEN("the combined future is not ready") {
+            REQUIRE_FALSE(any.is_ready());
+        }
+        WHEN("futures become ready") {
+            promises[1].set_value(1);
+            promises[0].set_value(0);
+            THEN("the index of the first ready future is reported") {
+                REQUIRE(1 == any.get());
+            }
+        }
+    }
+}
@@ -0,0 +1,156 @@
+// Test cases for the latency histogram in the SensoryCloud C++ SDK.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "sensorycloud/util/latency_histogram.hpp"
+
+using ::sensory::util::LatencyHistogram;
+using std::chrono::microseconds;
+
+SCENARIO("a user wants to map latencies onto histogram buckets") {
+    GIVEN("the bucket functions of the histogram") {
+        THEN("small latencies have a bucket each") {
+            for (uint64_t value = 0; value < LatencyHistogram::SUB_BUCKETS; value++) {
+                REQUIRE(value == LatencyHistogram::get_bucket(value));
+                REQUIRE(value == LatencyHistogram::get_bucket_start(value));
+                REQUIRE(1 == LatencyHistogram::get_bucket_width(value));
+            }
+        }
+        THEN("every bucket contains the latencies that map to it") {
+            for (std::size_t bucket = 0; bucket < LatencyHistogram::NUM_BUCKETS; bucket++) {
+                const auto start = LatencyHistogram::get_bucket_start(bucket);
+                const auto width = LatencyHistogram::get_bucket_width(bucket);
+                REQUIRE(bucket == LatencyHistogram::get_bucket(start));
+                REQUIRE(bucket == LatencyHistogram::get_bucket(start + width - 1));
+                if (bucket + 1 < LatencyHistogram::NUM_BUCKETS)
+                    REQUIRE(start + width == LatencyHistogram::get_bucket_start(bucket + 1));
+            }
+        }
+        THEN("buckets are no wider than a sixteenth of their start") {
+            for (std::size_t bucket = LatencyHistogram::SUB_BUCKETS; bucket < LatencyHistogram::NUM_BUCKETS; bucket++)
+                REQUIRE(LatencyHistogram::get_bucket_width(bucket) * 16 <= LatencyHistogram::get_bucket_start(bucket));
+        }
+        THEN("huge latencies map to the last bucket") {
+            REQUIRE(LatencyHistogram::NUM_BUCKETS - 1 == LatencyHistogram::get_bucket(UINT64_MAX));
+        }
+    }
+}
+
+SCENARIO("a user wants to summarize latencies") {
+    GIVEN("an empty histogram") {
+        LatencyHistogram histogram;
+        THEN("the statistics are zero") {
+            REQUIRE(0 == histogram.get_count());
+            REQUIRE(microseconds(0) == histogram.get_min());
+            REQUIRE(microseconds(0) == histogram.get_max());
+            REQUIRE(microseconds(0) == histogram.get_mean());
+            REQUIRE(microseconds(0) == histogram.get_percentile(99));
+        }
+    }
+    GIVEN("a histogram with the latencies 1ms to 1000ms") {
+        LatencyHistogram histogram;
+        for (int64_t ms = 1; ms <= 1000; ms++)
+            histogram.record(microseconds(1000 * ms));
+        WHEN("the histogram is summarized") {
+            const auto summary = histogram.get_summary();
+            THEN("the count, mean, and extrema are exact") {
+                REQUIRE(1000 == summary.count);
+                REQUIRE(microseconds(500500) == summary.mean);
+                REQUIRE(microseconds(1000) == histogram.get_min());
+                REQUIRE(microseconds(1000000) == summary.max);
+            }
+            THEN("the percentiles are within 3% of the true values") {
+                REQUIRE(std::abs(summary.p50.count() - 500000) <= 15000);
+                REQUIRE(std::abs(summary.p95.count() - 950000) <= 28500);
+                REQUIRE(std::abs(summary.p99.count() - 990000) <= 29700);
+            }
+            THEN("the extreme percentiles are the extrema") {
+                REQUIRE(microseconds(1000) == histogram.get_percentile(0));
+                REQUIRE(microseconds(1000000) == histogram.get_percentile(100));
+            }
+        }
+        WHEN("the histogram is reset") {
+            histogram.reset();
+            THEN("the histogram is empty") {
+                REQUIRE(0 == histogram.get_count());
+                REQUIRE(microseconds(0) == histogram.get_percentile(50));
+            }
+        }
+    }
+    GIVEN("a histogram with a negative latency") {
+        LatencyHistogram histogram;
+        histogram.record(microseconds(-5));
+        THEN("the latency is recorded as zero") {
+            REQUIRE(1 == histogram.get_count());
+            REQUIRE(microseconds(0) == histogram.get_max());
+        }
+    }
+}
+
+SCENARIO("a user wants to aggregate latencies from many streams") {
+    GIVEN("two histograms") {
+        LatencyHistogram fast;
+        LatencyHistogram slow;
+        for (int i = 0; i < 90; i++) fast.record(microseconds(10000));
+        for (int i = 0; i < 10; i++) slow.record(microseconds(500000));
+        WHEN("the histograms are merged") {
+            LatencyHistogram aggregate;
+            aggregate.merge(fast);
+            aggregate.merge(slow);
+            THEN("the aggregate has the latencies of both") {
+                REQUIRE(100 == aggregate.get_count());
+                REQUIRE(microseconds(10000) == aggregate.get_min());
+                REQUIRE(microseconds(500000) == aggregate.get_max());
+                REQUIRE(microseconds(59000) == aggregate.get_mean());
+                REQUIRE(std::abs(aggregate.get_percentile(50).count() - 10000) <= 300);
+                REQUIRE(std::abs(aggregate.get_percentile(95).count() - 500000) <= 15000);
+            }
+        }
+    }
+    GIVEN("a histogram shared by many threads") {
+        LatencyHistogram histogram;
+        WHEN("the threads record concurrently") {
+            std::vector<std::thread> threads;
+            for (int thread = 0; thread < 4; thread++) {
+                threads.emplace_back([&histogram, thread]() {
+                    for (int i = 0; i < 10000; i++)
+                        histogram.record(microseconds(1000 * (thread + 1)));
+                });
+            }
+            for (auto& thread : threads) thread.join();
+            THEN("every latency is counted") {
+                REQUIRE(40000 == histogram.get_count());
+                REQUIRE(microseconds(1000) == histogram.get_min());
+                REQUIRE(microseconds(4000) == histogram.get_max());
+                REQUIRE(microseconds(2500) == histogram.get_mean());
+            }
+        }
+    }
+}
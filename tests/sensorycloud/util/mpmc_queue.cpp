@@ -0,0 +1,156 @@
+// Test cases for the sensory::util::MPMCQueue structure.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sensorycloud/util/mpmc_queue.hpp"
+
+using ::sensory::util::MPMCQueue;
+using ::sensory::util::next_power_of_two;
+
+TEST_CASE("next_power_of_two should round values up to a power of two") {
+    REQUIRE(1 == next_power_of_two(0));
+    REQUIRE(1 == next_power_of_two(1));
+    REQUIRE(2 == next_power_of_two(2));
+    REQUIRE(4 == next_power_of_two(3));
+    REQUIRE(1024 == next_power_of_two(1000));
+    REQUIRE(1024 == next_power_of_two(1024));
+}
+
+SCENARIO("A user wants to create a bounded MPMC queue") {
+    GIVEN("a capacity of zero") {
+        THEN("an invalid argument error is thrown") {
+            REQUIRE_THROWS_AS(MPMCQueue<int>(0), std::invalid_argument);
+        }
+    }
+    GIVEN("a capacity that is not a power of two") {
+        MPMCQueue<int> queue(5);
+        THEN("the capacity is rounded up to the next power of two") {
+            REQUIRE(8 == queue.capacity());
+        }
+        THEN("the queue is initially empty") {
+            REQUIRE(queue.empty());
+            REQUIRE(0 == queue.size());
+        }
+    }
+}
+
+SCENARIO("A user wants to push and pop from a bounded MPMC queue") {
+    GIVEN("an empty queue with capacity 4") {
+        MPMCQueue<std::string> queue(4);
+        WHEN("an element is popped from the empty queue") {
+            std::string value = "unchanged";
+            const auto ok = queue.try_pop(value);
+            THEN("the pop fails and the output is untouched") {
+                REQUIRE_FALSE(ok);
+                REQUIRE_THAT(value, Catch::Equals("unchanged"));
+            }
+        }
+        WHEN("the queue is filled to capacity") {
+            REQUIRE(queue.try_push(std::string("a")));
+            REQUIRE(queue.try_push(std::string("b")));
+            REQUIRE(queue.try_push(std::string("c")));
+            REQUIRE(queue.try_push(std::string("d")));
+            THEN("additional pushes fail") {
+                std::string value = "e";
+                REQUIRE_FALSE(queue.try_push(std::move(value)));
+                REQUIRE_THAT(value, Catch::Equals("e"));
+                REQUIRE(4 == queue.size());
+            }
+            THEN("elements are popped in FIFO order") {
+                std::string value;
+                for (const auto& expected : {"a", "b", "c", "d"}) {
+                    REQUIRE(queue.try_pop(value));
+                    REQUIRE_THAT(value, Catch::Equals(expected));
+                }
+                REQUIRE(queue.empty());
+            }
+        }
+        WHEN("elements are pushed and popped across many laps of the ring") {
+            bool ok = true;
+            for (int i = 0; i < 100; i++) {
+                ok &= queue.try_push(std::to_string(i));
+                std::string value;
+                ok &= queue.try_pop(value);
+                ok &= value == std::to_string(i);
+            }
+            THEN("every element round trips") {
+                REQUIRE(ok);
+                REQUIRE(queue.empty());
+            }
+        }
+    }
+}
+
+SCENARIO("Multiple threads want to share a bounded MPMC queue") {
+    GIVEN("a queue with several producers and consumers") {
+        MPMCQueue<int> queue(16);
+        const int NUM_PRODUCERS = 4;
+        const int NUM_CONSUMERS = 4;
+        const int ITEMS_PER_PRODUCER = 10000;
+        std::atomic<int> consumed(0);
+        std::vector<std::vector<int>> outputs(NUM_CONSUMERS);
+        std::vector<std::thread> threads;
+        for (int p = 0; p < NUM_PRODUCERS; p++) {
+            threads.emplace_back([&queue, p, ITEMS_PER_PRODUCER]() {
+                for (int i = 0; i < ITEMS_PER_PRODUCER; i++) {
+                    int value = p * ITEMS_PER_PRODUCER + i;
+                    while (!queue.try_push(std::move(value))) std::this_thread::yield();
+                }
+            });
+        }
+        for (int c = 0; c < NUM_CONSUMERS; c++) {
+            threads.emplace_back([&queue, &consumed, &outputs, c]() {
+                int value;
+                while (consumed.load() < NUM_PRODUCERS * ITEMS_PER_PRODUCER) {
+                    if (queue.try_pop(value)) {
+                        outputs[c].push_back(value);
+                        consumed++;
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        WHEN("all of the elements are consumed") {
+            std::vector<int> all;
+            for (const auto& output : outputs)
+                all.insert(all.end(), output.begin(), output.end());
+            std::sort(all.begin(), all.end());
+            THEN("every element was delivered exactly once") {
+                REQUIRE(NUM_PRODUCERS * ITEMS_PER_PRODUCER == all.size());
+                bool ok = true;
+                for (std::size_t i = 0; i < all.size(); i++)
+                    ok &= all[i] == static_cast<int>(i);
+                REQUIRE(ok);
+            }
+        }
+    }
+}
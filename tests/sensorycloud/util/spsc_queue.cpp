@@ -0,0 +1,114 @@
+// Test cases for the SPSCQueue structure.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sensorycloud/util/spsc_queue.hpp"
+
+using ::sensory::util::SPSCQueue;
+
+SCENARIO("A user wants to create a bounded SPSC queue") {
+    GIVEN("a capacity of zero") {
+        THEN("an invalid argument error is thrown") {
+            REQUIRE_THROWS_AS(SPSCQueue<int>(0), std::invalid_argument);
+        }
+    }
+    GIVEN("a capacity that is not a power of two") {
+        SPSCQueue<int> queue(3);
+        THEN("the capacity is rounded up to the next power of two") {
+            REQUIRE(4 == queue.capacity());
+        }
+        THEN("the queue is initially empty") {
+            REQUIRE(queue.empty());
+            REQUIRE_FALSE(queue.full());
+            REQUIRE(nullptr == queue.front());
+        }
+    }
+}
+
+SCENARIO("A user wants to push and pop from a bounded SPSC queue") {
+    GIVEN("an empty queue with capacity 2") {
+        SPSCQueue<std::string> queue(2);
+        WHEN("the queue is filled to capacity") {
+            REQUIRE(queue.try_push(std::string("a")));
+            REQUIRE(queue.try_push(std::string("b")));
+            THEN("the queue is full and additional pushes fail") {
+                REQUIRE(queue.full());
+                std::string value = "c";
+                REQUIRE_FALSE(queue.try_push(std::move(value)));
+                REQUIRE_THAT(value, Catch::Equals("c"));
+            }
+            THEN("elements are popped in FIFO order") {
+                std::string value;
+                REQUIRE(queue.try_pop(value));
+                REQUIRE_THAT(value, Catch::Equals("a"));
+                REQUIRE(queue.try_pop(value));
+                REQUIRE_THAT(value, Catch::Equals("b"));
+                REQUIRE_FALSE(queue.try_pop(value));
+            }
+            THEN("elements can be processed in place") {
+                REQUIRE(nullptr != queue.front());
+                REQUIRE_THAT(*queue.front(), Catch::Equals("a"));
+                queue.pop();
+                REQUIRE_THAT(*queue.front(), Catch::Equals("b"));
+                queue.pop();
+                REQUIRE(queue.empty());
+            }
+        }
+    }
+}
+
+SCENARIO("Two threads want to share a bounded SPSC queue") {
+    GIVEN("a producer and a consumer") {
+        SPSCQueue<int> queue(8);
+        const int NUM_ITEMS = 100000;
+        std::vector<int> output;
+        output.reserve(NUM_ITEMS);
+        std::thread producer([&queue, NUM_ITEMS]() {
+            for (int i = 0; i < NUM_ITEMS; i++) {
+                int value = i;
+                while (!queue.try_push(std::move(value))) std::this_thread::yield();
+            }
+        });
+        std::thread consumer([&queue, &output, NUM_ITEMS]() {
+            int value;
+            while (static_cast<int>(output.size()) < NUM_ITEMS) {
+                if (queue.try_pop(value)) output.push_back(value);
+                else std::this_thread::yield();
+            }
+        });
+        producer.join();
+        consumer.join();
+        THEN("every element was delivered once and in order") {
+            REQUIRE(NUM_ITEMS == output.size());
+            bool ok = true;
+            for (int i = 0; i < NUM_ITEMS; i++) ok &= output[i] == i;
+            REQUIRE(ok);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+// Test cases for the TranscriptStitcher.
+//
+// Copyright (c) 2023 Sensory, Inc.
+//
+// Author: Christian Kauten (ckauten@sensoryinc.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXTERNRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "sensorycloud/util/transcript_stitcher.hpp"
+
+using ::sensory::util::TranscriptStitcher;
+using ::sensory::api::v1::audio::TranscribeWord;
+
+/// @brief Create a word.
+///
+/// @param text The text of the word.
+/// @param begin The start time of the word in milliseconds.
+/// @param end The end time of the word in milliseconds.
+/// @returns The word.
+///
+TranscribeWord make_word(const std::string& text, const uint64_t& begin, const uint64_t& end) {
+    TranscribeWord word;
+    word.set_word(text);
+    word.set_begintimems(begin);
+    word.set_endtimems(end);
+    return word;
+}
+
+SCENARIO("A client needs to stitch the transcripts of consecutive streams") {
+    GIVEN("an empty stitcher") {
+        TranscriptStitcher stitcher;
+        THEN("the transcript is empty") {
+            REQUIRE(stitcher.get_word_list().empty());
+            REQUIRE(stitcher.get_transcript().empty());
+            REQUIRE(0 == stitcher.get_num_segments());
+        }
+        WHEN("two segments that overlap by 1000ms are committed") {
+            // The first segment covers 0-5000ms and the second 4000-9000ms,
+            // with the cut in the middle of the overlap at 4500ms.
+            const std::vector<TranscribeWord> first = {
+                make_word("the", 1000, 1200),
+                make_word("quick", 4000, 4400),
+                make_word("bro", 4800, 5000)
+            };
+            const std::vector<TranscribeWord> second = {
+                make_word("ick", 0, 400),
+                make_word("brown", 800, 1200),
+                make_word("fox", 2000, 2300)
+            };
+            REQUIRE(2 == stitcher.commit(first, 0, 4500));
+            REQUIRE(2 == stitcher.commit(second, 4000));
+            THEN("each word is kept from the segment that holds its midpoint") {
+                REQUIRE("the quick brown fox" == stitcher.get_transcript());
+                REQUIRE("the,quick,brown,fox" == stitcher.get_transcript(","));
+                REQUIRE(2 == stitcher.get_num_segments());
+                REQUIRE(TranscriptStitcher::END_OF_SESSION == stitcher.get_cut_ms());
+            }
+            THEN("the words are in session time and re-indexed") {
+                const auto& words = stitcher.get_word_list();
+                REQUIRE(4800 == words[2].begintimems());
+                REQUIRE(5200 == words[2].endtimems());
+                REQUIRE(6000 == words[3].begintimems());
+                for (std::size_t i = 0; i < words.size(); i++)
+                    REQUIRE(i == words[i].wordindex());
+            }
+        }
+        WHEN("a segment is cut before the previous segment") {
+            stitcher.commit({}, 0, 5000);
+            THEN("an error is thrown") {
+                REQUIRE_THROWS_AS(stitcher.commit({}, 3000, 4000), std::invalid_argument);
+            }
+        }
+    }
+}